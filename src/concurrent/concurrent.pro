@@ -13,6 +13,7 @@ PRECOMPILED_HEADER = ../corelib/global/qt_pch.h
 SOURCES += \
         qtconcurrentfilter.cpp \
         qtconcurrentmap.cpp \
+        qtconcurrentpipeline.cpp \
         qtconcurrentrun.cpp \
         qtconcurrentthreadengine.cpp \
         qtconcurrentiteratekernel.cpp \
@@ -28,6 +29,7 @@ HEADERS += \
         qtconcurrentmap.h \
         qtconcurrentmapkernel.h \
         qtconcurrentmedian.h \
+        qtconcurrentpipeline.h \
         qtconcurrentreducekernel.h \
         qtconcurrentrun.h \
         qtconcurrentrunbase.h \
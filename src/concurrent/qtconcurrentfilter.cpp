@@ -114,6 +114,9 @@
     will call reduce at a time, so using a mutex to lock the result variable
     is not necessary. The QtConcurrent::ReduceOptions enum provides a way to
     control the order in which the reduction is done.
+    QtConcurrent::ParallelReduce does not give these guarantees: the reduce
+    function is called from several threads at once, on separate partial
+    results, and is also used to combine two partial results.
 
     \section1 Additional API Features
 
@@ -171,7 +171,9 @@ public:
                           ReduceFunctor _reduce,
                           ReduceOptions reduceOption)
         : IterateKernelType(begin, end), reducedResult(), keep(_keep), reduce(_reduce), reducer(reduceOption)
-    { }
+    {
+        this->rangePartitioning = reduceOption.testFlag(RangePartitioning);
+    }
 
 #if 0
     FilteredReducedKernel(ReducedResultType initialValue,
@@ -45,6 +45,9 @@
 #if !defined(QT_NO_CONCURRENT) || defined(Q_CLANG_QDOC)
 
 #include <QtCore/qatomic.h>
+#include <QtCore/qmutex.h>
+#include <QtCore/qpair.h>
+#include <QtCore/qvector.h>
 #include <QtConcurrent/qtconcurrentmedian.h>
 #include <QtConcurrent/qtconcurrentthreadengine.h>
 
@@ -184,7 +187,8 @@ public:
 
     IterateKernel(Iterator _begin, Iterator _end)
         : begin(_begin), end(_end), current(_begin), currentIndex(0),
-           forIteration(selectIteration(typename std::iterator_traits<Iterator>::iterator_category())), progressReportingEnabled(true)
+           forIteration(selectIteration(typename std::iterator_traits<Iterator>::iterator_category())), progressReportingEnabled(true),
+           rangePartitioning(false)
     {
         iterationCount =  forIteration ? std::distance(_begin, _end) : 0;
     }
@@ -201,10 +205,27 @@ public:
         progressReportingEnabled = this->isProgressReportingEnabled();
         if (progressReportingEnabled && iterationCount > 0)
             this->setProgressRange(0, iterationCount);
+
+        if (forIteration && rangePartitioning) {
+            // Split the iterations upfront into one contiguous range per
+            // thread, stored last range first so that takeRange() hands
+            // them out in order.
+            const int rangeCount = qBound(1, this->threadPool->maxThreadCount(), qMax(1, iterationCount));
+            pendingRanges.reserve(rangeCount);
+            for (int i = rangeCount - 1; i >= 0; --i) {
+                const int rangeBegin = int(qint64(iterationCount) * i / rangeCount);
+                const int rangeEnd = int(qint64(iterationCount) * (i + 1) / rangeCount);
+                if (rangeBegin < rangeEnd)
+                    pendingRanges.append(qMakePair(rangeBegin, rangeEnd));
+            }
+            pendingRangeCount.storeRelaxed(pendingRanges.size());
+        }
     }
 
     bool shouldStartThread() override
     {
+        if (forIteration && rangePartitioning)
+            return (pendingRangeCount.loadRelaxed() > 0) && !this->shouldThrottleThread();
         if (forIteration)
             return (currentIndex.loadRelaxed() < iterationCount) && !this->shouldThrottleThread();
         else // whileIteration
@@ -213,6 +234,8 @@ public:
 
     ThreadFunctionResult threadFunction() override
     {
+        if (forIteration && rangePartitioning)
+            return this->rangeThreadFunction();
         if (forIteration)
             return this->forThreadFunction();
         else // whileIteration
@@ -270,6 +293,73 @@ public:
         return ThreadFinished;
     }
 
+    bool takeRange(int *rangeBegin, int *rangeEnd)
+    {
+        QMutexLocker locker(&rangeMutex);
+        if (pendingRanges.isEmpty())
+            return false;
+        const QPair<int, int> range = pendingRanges.takeLast();
+        pendingRangeCount.storeRelaxed(pendingRanges.size());
+        *rangeBegin = range.first;
+        *rangeEnd = range.second;
+        return true;
+    }
+
+    // Puts back what is left of a range when its thread is throttled.
+    void returnRange(int rangeBegin, int rangeEnd)
+    {
+        QMutexLocker locker(&rangeMutex);
+        pendingRanges.append(qMakePair(rangeBegin, rangeEnd));
+        pendingRangeCount.storeRelaxed(pendingRanges.size());
+    }
+
+    // Each thread works through a range of its own instead of reserving
+    // blocks from currentIndex, so the threads never contend for the
+    // next block. Within the range, the blocks are sized as usual.
+    ThreadFunctionResult rangeThreadFunction()
+    {
+        BlockSizeManagerV2 blockSizeManager(iterationCount);
+        ResultReporter<T> resultReporter(this);
+
+        int beginIndex;
+        int rangeEnd;
+        while (takeRange(&beginIndex, &rangeEnd)) {
+            if (shouldStartThread())
+                this->startThread();
+
+            while (beginIndex < rangeEnd) {
+                if (this->isCanceled())
+                    return ThreadFinished;
+
+                this->waitForResume(); // (only waits if the qfuture is paused.)
+
+                const int endIndex = qMin(beginIndex + blockSizeManager.blockSize(), rangeEnd);
+                const int finalBlockSize = endIndex - beginIndex;
+                resultReporter.reserveSpace(finalBlockSize);
+
+                blockSizeManager.timeBeforeUser();
+                const bool resultsAvailable = this->runIterations(begin, beginIndex, endIndex, resultReporter.getPointer());
+                blockSizeManager.timeAfterUser();
+
+                if (resultsAvailable)
+                    resultReporter.reportResults(beginIndex);
+
+                if (progressReportingEnabled) {
+                    completed.fetchAndAddAcquire(finalBlockSize);
+                    this->setProgressValue(this->completed.loadRelaxed());
+                }
+
+                beginIndex = endIndex;
+                if (this->shouldThrottleThread()) {
+                    if (beginIndex < rangeEnd)
+                        returnRange(beginIndex, rangeEnd);
+                    return ThrottleThread;
+                }
+            }
+        }
+        return ThreadFinished;
+    }
+
     ThreadFunctionResult whileThreadFunction()
     {
         if (iteratorThreads.testAndSetAcquire(0, 1) == false)
@@ -318,6 +408,11 @@ public:
 
     bool progressReportingEnabled;
     QAtomicInt completed;
+
+    bool rangePartitioning;
+    QMutex rangeMutex;
+    QVector<QPair<int, int> > pendingRanges;
+    QAtomicInt pendingRangeCount;
 };
 
 } // namespace QtConcurrent
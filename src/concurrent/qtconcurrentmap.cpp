@@ -127,8 +127,24 @@
     \value OrderedReduce Reduction is done in the order of the
     original sequence.
     \value SequentialReduce Reduction is done sequentially: only one
-    thread will enter the reduce function at a time. (Parallel reduction
-    might be supported in a future version of Qt Concurrent.)
+    thread will enter the reduce function at a time.
+    \value ParallelReduce Each thread reduces its blocks of results into
+    partial results, which are then combined pairwise, in parallel. The
+    reduce function is called from several threads at once, each on its
+    own partial result, and is also called to combine two partial results.
+    The first result of each block is copied into its partial result
+    rather than passed to the reduce function. This requires the reduce
+    function to be associative and commutative, and not to depend on any
+    state shared between calls. It also requires the map or filter
+    function to return the type of the final result, so that the reduce
+    function can combine two partial results. Otherwise, or if combined
+    with OrderedReduce, UnorderedReduce is used instead. This value was
+    introduced in Qt 5.15.1.
+    \value RangePartitioning The sequence is split upfront into one
+    contiguous range per thread of the pool, instead of threads reserving
+    blocks from a shared position while they run. This suits cheap map or
+    filter functions on large sequences. It only applies to sequences with
+    random access iterators. This value was introduced in Qt 5.15.1.
 */
 
 /*!
@@ -221,6 +237,10 @@
     undefined, while QtConcurrent::OrderedReduce ensures that the reduction
     is done in the order of the original sequence.
 
+    QtConcurrent::ParallelReduce does not give these guarantees: the reduce
+    function is called from several threads at once, on separate partial
+    results, and is also used to combine two partial results.
+
     \section1 Additional API Features
 
     \section2 Using Iterators instead of Sequence
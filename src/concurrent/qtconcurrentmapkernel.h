@@ -99,7 +99,9 @@ public:
     typedef ReducedResultType ReturnType;
     MappedReducedKernel(Iterator begin, Iterator end, MapFunctor _map, ReduceFunctor _reduce, ReduceOptions reduceOptions)
         : IterateKernel<Iterator, ReducedResultType>(begin, end), reducedResult(), map(_map), reduce(_reduce), reducer(reduceOptions)
-    { }
+    {
+        this->rangePartitioning = reduceOptions.testFlag(RangePartitioning);
+    }
 
     MappedReducedKernel(ReducedResultType initialValue,
                      MapFunctor _map,
@@ -0,0 +1,147 @@
+/****************************************************************************
+**
+** Copyright (C) 2020 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtConcurrent module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+/*!
+    \enum QtConcurrent::PipelineOrder
+    \since 5.15.1
+
+    This enum specifies whether a stage of a QtConcurrent::Pipeline keeps
+    the order of the items that pass through it.
+
+    \value OrderedStage The results of the stage are handed to the next
+           stage in the order of the items they were made from, even if the
+           stage runs several workers.
+    \value UnorderedStage The results are handed on as soon as they are
+           ready.
+*/
+
+/*!
+    \class QtConcurrent::Pipeline
+    \inmodule QtConcurrent
+    \since 5.15.1
+    \brief The Pipeline class runs a stream of items through a chain of
+    stages on a QThreadPool.
+
+    A pipeline is created for the type of its input, \a In. Each call to
+    map() or filter() returns a pipeline that has one more stage, with
+    \a Out being the type of the items that leave its last stage. sink()
+    adds the final stage and starts the workers of all stages; after that,
+    items are fed into the pipeline with push(), and close() tells it that
+    no more items will come:
+
+    \snippet code/src_concurrent_qtconcurrentpipeline.cpp 0
+
+    The stages are connected by queues that hold at most the capacity
+    passed to the constructor. A stage whose output queue is full waits
+    until the next stage has taken an item, and push() blocks as long as
+    the first queue is full. The memory used by a pipeline thus does not
+    depend on the length of the stream. A worker that waits on a queue
+    gives its thread back to the pool until it can continue.
+
+    If a stage throws an exception, or the pipeline is canceled, all stages
+    stop, push() returns \c false and the future returned by sink() reports
+    the exception, or that it was canceled.
+
+    All copies of a Pipeline share the same queues and stages. The stages
+    must be added and sink() called from one thread; once the pipeline was
+    started, push(), close() and cancel() can be called from any thread.
+*/
+
+/*!
+    \fn template <typename In, typename Out> QtConcurrent::Pipeline<In, Out>::Pipeline(int capacity, QThreadPool *pool)
+
+    Creates a pipeline with no stages whose workers run on \a pool. Every
+    queue of the pipeline holds at most \a capacity items.
+*/
+
+/*!
+    \fn template <typename In, typename Out> template <typename MapFunctor> QtConcurrent::Pipeline<In, Result> QtConcurrent::Pipeline<In, Out>::map(MapFunctor function, int workerCount, PipelineOrder order) const
+
+    Adds a stage that calls \a function for each item and hands on the
+    result. The stage runs \a workerCount workers; \a order specifies
+    whether it keeps the order of the items.
+*/
+
+/*!
+    \fn template <typename In, typename Out> template <typename KeepFunctor> QtConcurrent::Pipeline<In, Out> QtConcurrent::Pipeline<In, Out>::filter(KeepFunctor function, int workerCount, PipelineOrder order) const
+
+    Adds a stage that hands on only the items for which \a function returns
+    \c true. The stage runs \a workerCount workers; \a order specifies
+    whether it keeps the order of the items.
+*/
+
+/*!
+    \fn template <typename In, typename Out> template <typename SinkFunctor> QFuture<void> QtConcurrent::Pipeline<In, Out>::sink(SinkFunctor function) const
+
+    Adds the final stage, which calls \a function for each item, and starts
+    the pipeline. \a function is called from one thread at a time, in the
+    order the previous stage hands on the items.
+
+    Returns a future that finishes when the last item has passed through
+    the pipeline after close() was called, or when it was canceled or one
+    of its stages failed. In all cases, the future finishes only once the
+    workers of all stages have stopped.
+*/
+
+/*!
+    \fn template <typename In, typename Out> bool QtConcurrent::Pipeline<In, Out>::push(const In &value) const
+
+    Feeds \a value into the pipeline, blocking while its first queue is
+    full. Returns \c false if the pipeline was not started, was canceled,
+    or one of its stages failed.
+*/
+
+/*!
+    \fn template <typename In, typename Out> void QtConcurrent::Pipeline<In, Out>::close() const
+
+    Tells the pipeline that no more items will be pushed. The stages
+    finish once they have processed the items that are left.
+*/
+
+/*!
+    \fn template <typename In, typename Out> void QtConcurrent::Pipeline<In, Out>::cancel() const
+
+    Stops all stages. Items that are still queued are dropped.
+*/
+
+/*!
+    \fn template <typename In, typename Out> QFuture<void> QtConcurrent::Pipeline<In, Out>::future() const
+
+    Returns the future that reports the progress of the pipeline.
+*/
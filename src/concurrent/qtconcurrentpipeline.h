@@ -0,0 +1,421 @@
+/****************************************************************************
+**
+** Copyright (C) 2020 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtConcurrent module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef QTCONCURRENT_PIPELINE_H
+#define QTCONCURRENT_PIPELINE_H
+
+#include <QtConcurrent/qtconcurrent_global.h>
+
+#ifndef QT_NO_CONCURRENT
+
+#include <QtCore/qatomic.h>
+#include <QtCore/qfuture.h>
+#include <QtCore/qmutex.h>
+#include <QtCore/qpair.h>
+#include <QtCore/qqueue.h>
+#include <QtCore/qsharedpointer.h>
+#include <QtCore/qthreadpool.h>
+#include <QtCore/qvector.h>
+#include <QtCore/qwaitcondition.h>
+
+#include <functional>
+#include <type_traits>
+
+QT_BEGIN_NAMESPACE
+
+
+namespace QtConcurrent {
+
+enum PipelineOrder {
+    OrderedStage,
+    UnorderedStage
+};
+
+#ifndef Q_QDOC
+
+// Gives the thread's slot in the pool to other tasks while it waits, so
+// that stages blocked on each other cannot starve the pool
+class PipelineThreadReleaser
+{
+public:
+    explicit PipelineThreadReleaser(QThreadPool *pool)
+        : m_pool(pool)
+    { if (pool) pool->releaseThread(); }
+    ~PipelineThreadReleaser()
+    { if (m_pool) m_pool->reserveThread(); }
+
+private:
+    QThreadPool *m_pool;
+};
+
+class PipelineQueueBase
+{
+public:
+    virtual ~PipelineQueueBase() {}
+    virtual void abort() = 0;
+};
+
+// A bounded queue between two stages. Every item carries the sequence
+// number of its position in the queue. A producer of an ordered stage
+// appends the item it made of the item number n of its input only after
+// those made of 0..n-1.
+template <typename T>
+class PipelineQueue : public PipelineQueueBase
+{
+public:
+    explicit PipelineQueue(int maxItems)
+        : capacity(qMax(1, maxItems)), nextSeq(0), nextTurn(0), closed(false), aborted(false)
+    { }
+
+    // Blocks while the queue is full or it is not the turn of seq yet.
+    // Returns false if the pipeline was aborted.
+    bool push(qint64 seq, const T &value, bool ordered, QThreadPool *pool)
+    {
+        QMutexLocker locker(&mutex);
+        if (!waitForTurn(seq, ordered, true, pool))
+            return false;
+        items.enqueue(qMakePair(nextSeq++, value));
+        notEmpty.wakeOne();
+        if (ordered) {
+            ++nextTurn;
+            notFull.wakeAll();
+        }
+        return true;
+    }
+
+    // Lets the turn of seq pass without appending an item.
+    bool skip(qint64 seq, bool ordered, QThreadPool *pool)
+    {
+        if (!ordered)
+            return true;
+        QMutexLocker locker(&mutex);
+        if (!waitForTurn(seq, ordered, false, pool))
+            return false;
+        ++nextTurn;
+        notFull.wakeAll();
+        return true;
+    }
+
+    // Blocks while the queue is empty. Returns false once it was closed
+    // and drained, or the pipeline was aborted.
+    bool pop(qint64 *seq, T *value, QThreadPool *pool)
+    {
+        QMutexLocker locker(&mutex);
+        if (items.isEmpty() && !closed && !aborted) {
+            PipelineThreadReleaser releaser(pool);
+            while (items.isEmpty() && !closed && !aborted)
+                notEmpty.wait(&mutex);
+        }
+        if (aborted || items.isEmpty())
+            return false;
+        const QPair<qint64, T> item = items.dequeue();
+        *seq = item.first;
+        *value = item.second;
+        notFull.wakeAll();
+        return true;
+    }
+
+    void close()
+    {
+        QMutexLocker locker(&mutex);
+        closed = true;
+        notEmpty.wakeAll();
+    }
+
+    void abort() override
+    {
+        QMutexLocker locker(&mutex);
+        aborted = true;
+        notEmpty.wakeAll();
+        notFull.wakeAll();
+    }
+
+private:
+    bool mustWait(qint64 seq, bool ordered, bool needsRoom) const
+    {
+        return !aborted && ((ordered && seq != nextTurn) || (needsRoom && items.size() >= capacity));
+    }
+
+    bool waitForTurn(qint64 seq, bool ordered, bool needsRoom, QThreadPool *pool)
+    {
+        if (mustWait(seq, ordered, needsRoom)) {
+            PipelineThreadReleaser releaser(pool);
+            while (mustWait(seq, ordered, needsRoom))
+                notFull.wait(&mutex);
+        }
+        return !aborted;
+    }
+
+    QMutex mutex;
+    QWaitCondition notEmpty;
+    QWaitCondition notFull;
+    QQueue<QPair<qint64, T> > items;
+    const int capacity;
+    qint64 nextSeq;
+    qint64 nextTurn;
+    bool closed;
+    bool aborted;
+};
+
+template <typename In>
+class PipelineData
+{
+public:
+    PipelineData(int maxItems, QThreadPool *threadPool)
+        : input(new PipelineQueue<In>(maxItems)), pool(threadPool), capacity(maxItems), started(0),
+          liveWorkers(0)
+    {
+        queues.append(input);
+        futureInterface.reportStarted();
+    }
+
+    void abort()
+    {
+        for (const QSharedPointer<PipelineQueueBase> &queue : qAsConst(queues))
+            queue->abort();
+    }
+
+#ifndef QT_NO_EXCEPTIONS
+    void fail(const QException &e)
+    {
+        futureInterface.reportException(e);
+        abort();
+    }
+#endif
+
+    // the future finishes once the last worker of any stage has exited
+    void startWorker(std::function<void()> work)
+    {
+        liveWorkers.ref();
+        pool->start(std::move(work));
+    }
+
+    void workerDone()
+    {
+        if (!liveWorkers.deref())
+            futureInterface.reportFinished();
+    }
+
+    QSharedPointer<PipelineQueue<In> > input;
+    QThreadPool *pool;
+    const int capacity;
+    QAtomicInt started; // read by push() on any thread
+    QAtomicInt liveWorkers;
+    QFutureInterface<void> futureInterface;
+    QVector<QSharedPointer<PipelineQueueBase> > queues;
+    QVector<std::function<void()> > stages; // each one starts the workers of a stage
+};
+
+#endif // Q_QDOC
+
+template <typename In, typename Out = In>
+class Pipeline
+{
+public:
+    explicit Pipeline(int capacity = 64, QThreadPool *pool = QThreadPool::globalInstance())
+        : d(new PipelineData<In>(capacity, pool)), tail(d->input)
+    {
+        static_assert(std::is_same<In, Out>::value,
+                      "A Pipeline is created for its input type, use map() to change it");
+    }
+
+    template <typename MapFunctor>
+    Pipeline<In, typename std::decay<decltype(std::declval<MapFunctor &>()(std::declval<const Out &>()))>::type>
+    map(MapFunctor function, int workerCount = 1, PipelineOrder order = OrderedStage) const
+    {
+        typedef typename std::decay<decltype(function(std::declval<const Out &>()))>::type Result;
+        QSharedPointer<PipelineQueue<Result> > output(new PipelineQueue<Result>(d->capacity));
+        addStage(workerCount, output, [function, order](const QSharedPointer<PipelineData<In> > &data,
+                                                         qint64 seq, const Out &value,
+                                                         PipelineQueue<Result> *out) mutable {
+            return out->push(seq, function(value), order == OrderedStage, data->pool);
+        });
+        return Pipeline<In, Result>(d, output);
+    }
+
+    template <typename KeepFunctor>
+    Pipeline<In, Out> filter(KeepFunctor function, int workerCount = 1, PipelineOrder order = OrderedStage) const
+    {
+        QSharedPointer<PipelineQueue<Out> > output(new PipelineQueue<Out>(d->capacity));
+        addStage(workerCount, output, [function, order](const QSharedPointer<PipelineData<In> > &data,
+                                                         qint64 seq, const Out &value,
+                                                         PipelineQueue<Out> *out) mutable {
+            const bool ordered = order == OrderedStage;
+            if (function(value))
+                return out->push(seq, value, ordered, data->pool);
+            return out->skip(seq, ordered, data->pool);
+        });
+        return Pipeline<In, Out>(d, output);
+    }
+
+    template <typename SinkFunctor>
+    QFuture<void> sink(SinkFunctor function) const
+    {
+        if (d->started.loadAcquire()) {
+            qWarning("QtConcurrent::Pipeline::sink: The pipeline was already started");
+            return future();
+        }
+        QSharedPointer<PipelineData<In> > data = d;
+        QSharedPointer<PipelineQueue<Out> > input = tail;
+        d->stages.append([data, input, function]() {
+            data->startWorker([data, input, function]() mutable {
+                qint64 seq;
+                Out value;
+                while (input->pop(&seq, &value, data->pool)) {
+                    if (data->futureInterface.isCanceled()) {
+                        data->abort();
+                        break;
+                    }
+#ifndef QT_NO_EXCEPTIONS
+                    try {
+#endif
+                        function(value);
+#ifndef QT_NO_EXCEPTIONS
+                    } catch (QException &e) {
+                        data->fail(e);
+                        break;
+                    } catch (...) {
+                        data->fail(QUnhandledException());
+                        break;
+                    }
+#endif
+                }
+                data->workerDone();
+            });
+        });
+
+        // holds the future open until the workers of all stages were started
+        d->liveWorkers.ref();
+        for (const std::function<void()> &startStage : qAsConst(d->stages))
+            startStage();
+        d->stages.clear();
+        d->started.storeRelease(1);
+        d->workerDone();
+        return future();
+    }
+
+    bool push(const In &value) const
+    {
+        if (!d->started.loadAcquire()) {
+            qWarning("QtConcurrent::Pipeline::push: Call sink() before pushing items");
+            return false;
+        }
+        if (d->futureInterface.isCanceled()) {
+            d->abort();
+            return false;
+        }
+        return d->input->push(0, value, false, nullptr);
+    }
+
+    void close() const { d->input->close(); }
+
+    void cancel() const
+    {
+        d->futureInterface.cancel();
+        d->abort();
+    }
+
+    QFuture<void> future() const { return d->futureInterface.future(); }
+
+private:
+    template <typename, typename> friend class Pipeline;
+
+    Pipeline(const QSharedPointer<PipelineData<In> > &data, const QSharedPointer<PipelineQueue<Out> > &output)
+        : d(data), tail(output)
+    { }
+
+    // Adds a stage of workerCount workers that pass each item of this
+    // pipeline's tail through process(), which appends to output
+    template <typename Result, typename Process>
+    void addStage(int workerCount, const QSharedPointer<PipelineQueue<Result> > &output, Process process) const
+    {
+        if (d->started.loadAcquire()) {
+            qWarning("QtConcurrent::Pipeline: Cannot add a stage to a started pipeline");
+            return;
+        }
+        d->queues.append(output);
+        QSharedPointer<PipelineData<In> > data = d;
+        QSharedPointer<PipelineQueue<Out> > input = tail;
+        workerCount = qMax(1, workerCount);
+        d->stages.append([data, input, output, process, workerCount]() {
+            QSharedPointer<QAtomicInt> remaining(new QAtomicInt(workerCount));
+            for (int i = 0; i < workerCount; ++i) {
+                data->startWorker([data, input, output, process, remaining]() mutable {
+                    qint64 seq;
+                    Out value;
+                    while (input->pop(&seq, &value, data->pool)) {
+                        if (data->futureInterface.isCanceled()) {
+                            data->abort();
+                            break;
+                        }
+#ifndef QT_NO_EXCEPTIONS
+                        try {
+#endif
+                            if (!process(data, seq, value, output.data()))
+                                break;
+#ifndef QT_NO_EXCEPTIONS
+                        } catch (QException &e) {
+                            data->fail(e);
+                            break;
+                        } catch (...) {
+                            data->fail(QUnhandledException());
+                            break;
+                        }
+#endif
+                    }
+                    // the last worker of the stage ends its output
+                    if (!remaining->deref())
+                        output->close();
+                    data->workerDone();
+                });
+            }
+        });
+    }
+
+    QSharedPointer<PipelineData<In> > d;
+    QSharedPointer<PipelineQueue<Out> > tail;
+};
+
+} // namespace QtConcurrent
+
+QT_END_NAMESPACE
+
+#endif // QT_NO_CONCURRENT
+
+#endif
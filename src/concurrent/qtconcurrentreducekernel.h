@@ -53,6 +53,8 @@
 #include <QtCore/qvector.h>
 
 #include <mutex>
+#include <type_traits>
+#include <utility>
 
 QT_BEGIN_NAMESPACE
 
@@ -92,24 +94,53 @@ public:
 enum ReduceOption {
     UnorderedReduce = 0x1,
     OrderedReduce = 0x2,
-    SequentialReduce = 0x4
-    // ParallelReduce = 0x8
+    SequentialReduce = 0x4,
+    ParallelReduce = 0x8,
+    RangePartitioning = 0x10
 };
 Q_DECLARE_FLAGS(ReduceOptions, ReduceOption)
 #ifndef Q_CLANG_QDOC
 Q_DECLARE_OPERATORS_FOR_FLAGS(ReduceOptions)
 #endif
+
+// ParallelReduce needs the reduce functor to combine two partial results,
+// which is only the case if it reduces values of the result type itself
+template <typename ReduceFunctor, typename ReduceResultType, typename T, typename = void>
+struct CanReduceInParallel : std::false_type { };
+
+template <typename ReduceFunctor, typename ReduceResultType, typename T>
+struct CanReduceInParallel<ReduceFunctor, ReduceResultType, T,
+        typename std::enable_if<std::is_same<ReduceResultType, T>::value,
+                                decltype(void(std::declval<ReduceFunctor &>()(std::declval<ReduceResultType &>(),
+                                                                               std::declval<const T &>())))>::type>
+    : std::true_type { };
+
 // supports both ordered and out-of-order reduction
 template <typename ReduceFunctor, typename ReduceResultType, typename T>
 class ReduceKernel
 {
     typedef QMap<int, IntermediateResults<T> > ResultsMap;
+    typedef QMap<int, ReduceResultType> PartialsMap;
+    typedef CanReduceInParallel<ReduceFunctor, ReduceResultType, T> ParallelReduceSupported;
 
     const ReduceOptions reduceOptions;
 
     QMutex mutex;
     int progress, resultsMapSize, threadCount;
     ResultsMap resultsMap;
+    PartialsMap partials; // partial results of ParallelReduce, by tree level
+
+    static ReduceOptions effectiveOptions(ReduceOptions options)
+    {
+        if (!(options & ParallelReduce))
+            return options;
+        if (ParallelReduceSupported::value && !(options & OrderedReduce))
+            return options;
+        options &= ~ReduceOptions(ParallelReduce);
+        if (!(options & OrderedReduce))
+            options |= UnorderedReduce;
+        return options;
+    }
 
     bool canReduce(int begin) const
     {
@@ -139,9 +170,52 @@ class ReduceKernel
         }
     }
 
+    void reducePartial(ReduceFunctor &, const IntermediateResults<T> &, std::false_type)
+    { }
+
+    // Reduces the block into a partial result without holding the lock,
+    // then merges it with the partial results that are already there the
+    // way a binary counter carries: two partials of the same level are
+    // combined into one of the next level. Combining happens outside the
+    // lock, so several threads can work on different levels at once.
+    void reducePartial(ReduceFunctor &reduce, const IntermediateResults<T> &result, std::true_type)
+    {
+        if (result.vector.isEmpty())
+            return;
+        ReduceResultType partial = result.vector.at(0);
+        for (int i = 1; i < result.vector.size(); ++i)
+            reduce(partial, result.vector.at(i));
+
+        std::unique_lock<QMutex> locker(mutex);
+        for (int level = 0; ; ++level) {
+            typename PartialsMap::iterator it = partials.find(level);
+            if (it == partials.end()) {
+                partials.insert(level, partial);
+                return;
+            }
+            const ReduceResultType other = it.value();
+            partials.erase(it);
+
+            locker.unlock();
+            reduce(partial, other);
+            locker.lock();
+        }
+    }
+
+    void reducePartials(ReduceFunctor &, ReduceResultType &, std::false_type)
+    { }
+
+    void reducePartials(ReduceFunctor &reduce, ReduceResultType &r, std::true_type)
+    {
+        typename PartialsMap::const_iterator it = partials.constBegin();
+        for (; it != partials.constEnd(); ++it)
+            reduce(r, it.value());
+        partials.clear();
+    }
+
 public:
     ReduceKernel(ReduceOptions _reduceOptions)
-        : reduceOptions(_reduceOptions), progress(0), resultsMapSize(0),
+        : reduceOptions(effectiveOptions(_reduceOptions)), progress(0), resultsMapSize(0),
           threadCount(QThreadPool::globalInstance()->maxThreadCount())
     { }
 
@@ -149,6 +223,11 @@ public:
                    ReduceResultType &r,
                    const IntermediateResults<T> &result)
     {
+        if (reduceOptions & ParallelReduce) {
+            reducePartial(reduce, result, ParallelReduceSupported());
+            return;
+        }
+
         std::unique_lock<QMutex> locker(mutex);
         if (!canReduce(result.begin)) {
             ++resultsMapSize;
@@ -208,6 +287,7 @@ public:
     void finish(ReduceFunctor &reduce, ReduceResultType &r)
     {
         reduceResults(reduce, r, resultsMap);
+        reducePartials(reduce, r, ParallelReduceSupported());
     }
 
     inline bool shouldThrottle()
@@ -370,6 +370,652 @@ static inline const uchar *simdFindNonAscii(const uchar *src, const uchar *end,
 }
 #endif
 
+// The multi-byte kernels below decode and encode runs of valid UTF-8 and
+// UTF-16 in parallel. They leave encoding errors and lone surrogates to the
+// scalar code, so the results are always the same as the scalar code's.
+//
+// They compact their results with shuffles from these tables: entry n of
+// utf8CompressIndices gathers the bytes selected by the bits of n to the front
+// of an 8-byte group, entry n of utf16CompressIndices does the same for the
+// 16-bit lanes of a 16-byte group.
+static Q_DECL_CONSTEXPR quint64 byteIndices(uint mask, uint pos = 0, uint out = 0)
+{
+    return pos == 8 ? 0
+         : (mask & (1U << pos)) ? (quint64(pos) << (8 * out)) | byteIndices(mask, pos + 1, out + 1)
+         : byteIndices(mask, pos + 1, out);
+}
+
+static Q_DECL_CONSTEXPR uint nthSetBit(uint mask, uint n, uint pos = 0)
+{
+    return pos == 8 ? 0x80
+         : !(mask & (1U << pos)) ? nthSetBit(mask, n, pos + 1)
+         : n ? nthSetBit(mask, n - 1, pos + 1) : pos;
+}
+
+static Q_DECL_CONSTEXPR quint64 laneIndices(uint mask, uint first, uint k = 0)
+{
+    return k == 4 ? 0
+         : ((nthSetBit(mask, first + k) == 0x80 ? quint64(0x8080)
+                                                 : quint64(0x100 + 0x202 * nthSetBit(mask, first + k))) << (16 * k))
+           | laneIndices(mask, first, k + 1);
+}
+
+#define BYTE_INDICES(n)     byteIndices(n)
+#define LANE_INDICES(n)     { laneIndices(n, 0), laneIndices(n, 4) }
+#define INDICES4(E, n)      E(n), E(n + 1), E(n + 2), E(n + 3)
+#define INDICES16(E, n)     INDICES4(E, n), INDICES4(E, n + 4), INDICES4(E, n + 8), INDICES4(E, n + 12)
+#define INDICES64(E, n)     INDICES16(E, n), INDICES16(E, n + 16), INDICES16(E, n + 32), INDICES16(E, n + 48)
+#define INDICES256(E)       INDICES64(E, 0), INDICES64(E, 64), INDICES64(E, 128), INDICES64(E, 192)
+static Q_DECL_UNUSED Q_DECL_CONSTEXPR quint64 utf8CompressIndices[256] = { INDICES256(BYTE_INDICES) };
+static Q_DECL_UNUSED Q_DECL_CONSTEXPR quint64 utf16CompressIndices[256][2] = { INDICES256(LANE_INDICES) };
+#undef INDICES256
+#undef INDICES64
+#undef INDICES16
+#undef INDICES4
+#undef LANE_INDICES
+#undef BYTE_INDICES
+
+#if defined(__SSE2__) && QT_COMPILER_SUPPORTS_HERE(AVX2)
+static inline bool hasSimdMultiByte()
+{
+    return qCpuHasFeature(AVX2) && qCpuHasFeature(POPCNT);
+}
+
+// Stores the bytes of the low half of \a data that are selected by \a mask to
+// \a dst, followed by garbage up to 8 bytes. The callers compute where each
+// store goes from the whole mask, so that the stores don't depend on each other.
+QT_FUNCTION_TARGET(AVX2)
+static inline void compressStore8(uchar *dst, __m128i data, uint mask)
+{
+    const __m128i indices = _mm_loadl_epi64(reinterpret_cast<const __m128i *>(utf8CompressIndices + mask));
+    _mm_storel_epi64(reinterpret_cast<__m128i *>(dst), _mm_shuffle_epi8(data, indices));
+}
+
+// Same for the 16-bit lanes of \a chars
+QT_FUNCTION_TARGET(AVX2)
+static inline void compressStoreUtf16(ushort *dst, __m128i chars, uint lanes)
+{
+    const __m128i indices = _mm_loadu_si128(reinterpret_cast<const __m128i *>(utf16CompressIndices[lanes]));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(dst), _mm_shuffle_epi8(chars, indices));
+}
+
+// Decodes every byte in \a data as if it were the last of a character, with
+// \a prev1 and \a prev2 holding the bytes preceding it
+QT_FUNCTION_TARGET(AVX2)
+static inline __m256i decodeChars(__m128i data, __m128i prev1, __m128i prev2)
+{
+    const __m256i bytes = _mm256_cvtepu8_epi16(data);
+    const __m256i p1 = _mm256_cvtepu8_epi16(prev1);
+    const __m256i low = _mm256_and_si256(bytes, _mm256_set1_epi16(0x3f));
+    const __m256i mid = _mm256_slli_epi16(_mm256_and_si256(p1, _mm256_set1_epi16(0x3f)), 6);
+    const __m256i high = _mm256_slli_epi16(_mm256_cvtepu8_epi16(prev2), 12);
+    const __m256i threeBytes = _mm256_cmpeq_epi16(_mm256_and_si256(p1, _mm256_set1_epi16(0xc0)),
+                                                  _mm256_set1_epi16(0x80));
+    const __m256i chars = _mm256_or_si256(_mm256_or_si256(low, mid), _mm256_and_si256(high, threeBytes));
+    return _mm256_blendv_epi8(chars, bytes, _mm256_cmpgt_epi16(_mm256_set1_epi16(0x80), bytes));
+}
+
+// Replaces the characters in \a chars that decodeChars() decoded from the third
+// and fourth bytes of four-byte sequences with the surrogates of the character;
+// \a prev3 holds the bytes three before \a data
+QT_FUNCTION_TARGET(AVX2)
+static inline __m256i decodeSurrogates(__m256i chars, __m128i data, __m128i prev1, __m128i prev2, __m128i prev3)
+{
+    const __m256i bytes = _mm256_cvtepu8_epi16(data);
+    const __m256i p1 = _mm256_cvtepu8_epi16(prev1);
+    const __m256i p2 = _mm256_cvtepu8_epi16(prev2);
+    const __m256i high = _mm256_or_si256(_mm256_slli_epi16(_mm256_and_si256(p2, _mm256_set1_epi16(7)), 8),
+                                         _mm256_or_si256(_mm256_slli_epi16(_mm256_and_si256(p1, _mm256_set1_epi16(0x3f)), 2),
+                                                         _mm256_and_si256(_mm256_srli_epi16(bytes, 4), _mm256_set1_epi16(3))));
+    const __m256i low = _mm256_or_si256(_mm256_slli_epi16(_mm256_and_si256(p1, _mm256_set1_epi16(0xf)), 6),
+                                        _mm256_and_si256(bytes, _mm256_set1_epi16(0x3f)));
+    const __m256i isHigh = _mm256_cmpgt_epi16(p2, _mm256_set1_epi16(0xef));
+    const __m256i isLow = _mm256_cmpgt_epi16(_mm256_cvtepu8_epi16(prev3), _mm256_set1_epi16(0xef));
+    chars = _mm256_blendv_epi8(chars, _mm256_add_epi16(high, _mm256_set1_epi16(short(0xd800 - 0x40))), isHigh);
+    return _mm256_blendv_epi8(chars, _mm256_or_si256(low, _mm256_set1_epi16(short(0xdc00))), isLow);
+}
+
+QT_FUNCTION_TARGET(AVX2) QT_FUNCTION_TARGET(POPCNT)
+static void simdDecodeMultiByte(ushort *&dst, const uchar *&nextSimd, const uchar *&src, const uchar *end)
+{
+    // work on copies, so the pointers aren't reloaded after every store
+    ushort *out = dst;
+    const uchar *in = src;
+    const uchar *next = end;
+
+    // do 32 bytes at a time; in must be at the start of a character
+    while (end - in >= 32) {
+        const __m256i data = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(in));
+        if (!_mm256_movemask_epi8(data)) {
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(out), _mm256_cvtepu8_epi16(_mm256_castsi256_si128(data)));
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + 16), _mm256_cvtepu8_epi16(_mm256_extracti128_si256(data, 1)));
+            in += 32;
+            out += 32;
+            continue;
+        }
+
+        // the one to three bytes preceding each byte (zero before the block)
+        const __m256i shifted = _mm256_permute2x128_si256(data, data, 0x08);
+        const __m256i prev1 = _mm256_alignr_epi8(data, shifted, 15);
+        const __m256i prev2 = _mm256_alignr_epi8(data, shifted, 14);
+
+        // classify the bytes and check that every lead byte is followed by
+        // exactly as many continuation bytes as it needs
+        const __m256i top2 = _mm256_and_si256(data, _mm256_set1_epi8(char(0xc0)));
+        const uint cont = _mm256_movemask_epi8(_mm256_cmpeq_epi8(top2, _mm256_set1_epi8(char(0x80))));
+        const uint lead = _mm256_movemask_epi8(_mm256_cmpeq_epi8(top2, _mm256_set1_epi8(char(0xc0))));
+        const uint lead3 = _mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_max_epu8(data, _mm256_set1_epi8(char(0xe0))), data));
+        const uint lead4 = _mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_max_epu8(data, _mm256_set1_epi8(char(0xf0))), data));
+        const uint misplaced = ((lead << 1) | (lead3 << 2) | (lead4 << 3)) ^ cont;
+
+        // reject overlong sequences, surrogates and code points above U+10FFFF
+        const __m256i belowA0 = _mm256_cmpeq_epi8(_mm256_min_epu8(data, _mm256_set1_epi8(char(0x9f))), data);
+        const __m256i below90 = _mm256_cmpeq_epi8(_mm256_min_epu8(data, _mm256_set1_epi8(char(0x8f))), data);
+        __m256i invalid = _mm256_cmpeq_epi8(_mm256_and_si256(data, _mm256_set1_epi8(char(0xfe))), _mm256_set1_epi8(char(0xc0)));
+        invalid = _mm256_or_si256(invalid, _mm256_cmpeq_epi8(_mm256_max_epu8(data, _mm256_set1_epi8(char(0xf5))), data));
+        invalid = _mm256_or_si256(invalid, _mm256_and_si256(_mm256_cmpeq_epi8(prev1, _mm256_set1_epi8(char(0xe0))), belowA0));
+        invalid = _mm256_or_si256(invalid, _mm256_andnot_si256(belowA0, _mm256_cmpeq_epi8(prev1, _mm256_set1_epi8(char(0xed)))));
+        invalid = _mm256_or_si256(invalid, _mm256_and_si256(_mm256_cmpeq_epi8(prev1, _mm256_set1_epi8(char(0xf0))), below90));
+        invalid = _mm256_or_si256(invalid, _mm256_andnot_si256(below90, _mm256_cmpeq_epi8(prev1, _mm256_set1_epi8(char(0xf4)))));
+        const uint invalidBytes = _mm256_movemask_epi8(invalid);
+
+        // a byte ends a character if it isn't a lead byte and the next one
+        // isn't a continuation byte (we don't know the byte after the block).
+        // Only characters that end before the first invalid byte, and before
+        // the byte preceding the first misplaced (or missing) continuation
+        // byte, are known to be valid.
+        uint ends = ~lead & ~(cont >> 1) & 0x7fffffff;
+        if (misplaced) {
+            const uint firstMisplaced = qCountTrailingZeroBits(misplaced);
+            ends &= firstMisplaced ? (1U << (firstMisplaced - 1)) - 1 : 0;
+        }
+        if (invalidBytes)
+            ends &= (1U << qCountTrailingZeroBits(invalidBytes)) - 1;
+        // the third byte of a four-byte sequence holds the high surrogate, if
+        // the character is known to end with the fourth one
+        ends |= (ends & (lead4 << 3)) >> 1;
+        if (!ends) {
+            // let the scalar code handle the error and a few characters after it
+            next = in + 16;
+            break;
+        }
+
+        // decode every byte as if it were the last of a character and keep the
+        // ones that are
+        __m256i chars1 = decodeChars(_mm256_castsi256_si128(data), _mm256_castsi256_si128(prev1),
+                                     _mm256_castsi256_si128(prev2));
+        __m256i chars2 = decodeChars(_mm256_extracti128_si256(data, 1), _mm256_extracti128_si256(prev1, 1),
+                                     _mm256_extracti128_si256(prev2, 1));
+        if (lead4) {
+            const __m256i prev3 = _mm256_alignr_epi8(data, shifted, 13);
+            chars1 = decodeSurrogates(chars1, _mm256_castsi256_si128(data), _mm256_castsi256_si128(prev1),
+                                      _mm256_castsi256_si128(prev2), _mm256_castsi256_si128(prev3));
+            chars2 = decodeSurrogates(chars2, _mm256_extracti128_si256(data, 1), _mm256_extracti128_si256(prev1, 1),
+                                      _mm256_extracti128_si256(prev2, 1), _mm256_extracti128_si256(prev3, 1));
+        }
+        compressStoreUtf16(out, _mm256_castsi256_si128(chars1), ends & 0xff);
+        compressStoreUtf16(out + qPopulationCount(ends & 0xff), _mm256_extracti128_si256(chars1, 1), (ends >> 8) & 0xff);
+        compressStoreUtf16(out + qPopulationCount(ends & 0xffff), _mm256_castsi256_si128(chars2), (ends >> 16) & 0xff);
+        compressStoreUtf16(out + qPopulationCount(ends & 0xffffff), _mm256_extracti128_si256(chars2, 1), ends >> 24);
+        out += qPopulationCount(ends);
+        in += qBitScanReverse(ends) + 1;
+    }
+
+    dst = out;
+    src = in;
+    nextSimd = next;
+}
+
+// Stores the bytes of \a bytes1 and \a bytes2 that are selected by \a mask to
+// \a dst, followed by garbage up to 8 bytes, and returns the end of the output
+QT_FUNCTION_TARGET(AVX2) QT_FUNCTION_TARGET(POPCNT)
+static inline uchar *compressStore32(uchar *dst, __m128i bytes1, __m128i bytes2, uint mask)
+{
+    compressStore8(dst, bytes1, mask & 0xff);
+    compressStore8(dst + qPopulationCount(mask & 0xff), _mm_srli_si128(bytes1, 8), (mask >> 8) & 0xff);
+    compressStore8(dst + qPopulationCount(mask & 0xffff), bytes2, (mask >> 16) & 0xff);
+    compressStore8(dst + qPopulationCount(mask & 0xffffff), _mm_srli_si128(bytes2, 8), mask >> 24);
+    return dst + qPopulationCount(mask);
+}
+
+QT_FUNCTION_TARGET(AVX2) QT_FUNCTION_TARGET(POPCNT)
+static void simdEncodeMultiByte(uchar *&dst, const ushort *&nextSimd, const ushort *&src, const ushort *end)
+{
+    uchar *out = dst;
+    const ushort *in = src;
+    const ushort *next = end;
+
+    // do sixteen characters at a time
+    while (end - in >= 32) {
+        const __m256i data = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(in));
+        if (_mm256_testz_si256(data, _mm256_set1_epi16(short(0xff80)))) {
+            const __m128i bytes = _mm_packus_epi16(_mm256_castsi256_si128(data), _mm256_extracti128_si256(data, 1));
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(out), bytes);
+            in += 16;
+            out += 16;
+            continue;
+        }
+
+        const __m256i oneByte = _mm256_cmpeq_epi16(_mm256_and_si256(data, _mm256_set1_epi16(short(0xff80))),
+                                                   _mm256_setzero_si256());
+        const __m256i low6 = _mm256_and_si256(data, _mm256_set1_epi16(0x3f));
+        const __m256i twoBytes = _mm256_or_si256(_mm256_or_si256(_mm256_set1_epi16(short(0x80c0)), _mm256_srli_epi16(data, 6)),
+                                                 _mm256_slli_epi16(low6, 8));
+        const __m256i keepOneOrTwo = _mm256_or_si256(_mm256_set1_epi16(0xff),
+                                                     _mm256_andnot_si256(oneByte, _mm256_set1_epi16(short(0xff00))));
+        if (_mm256_testz_si256(data, _mm256_set1_epi16(short(0xf800)))) {
+            // only one- and two-byte characters: encode them in one 16-bit lane each
+            const __m256i bytes = _mm256_blendv_epi8(twoBytes, data, oneByte);
+            out = compressStore32(out, _mm256_castsi256_si128(bytes), _mm256_extracti128_si256(bytes, 1),
+                                  _mm256_movemask_epi8(keepOneOrTwo));
+            in += 16;
+            continue;
+        }
+
+        // encode every character in two 16-bit halves: the first two bytes in
+        // the first one, the third and fourth bytes (if any) in the second one
+        const __m256i upToTwoBytes = _mm256_cmpeq_epi16(_mm256_and_si256(data, _mm256_set1_epi16(short(0xf800))),
+                                                        _mm256_setzero_si256());
+        const __m256i threeBytes = _mm256_or_si256(_mm256_or_si256(_mm256_set1_epi16(short(0x80e0)), _mm256_srli_epi16(data, 12)),
+                                                   _mm256_slli_epi16(_mm256_and_si256(_mm256_srli_epi16(data, 6),
+                                                                                      _mm256_set1_epi16(0x3f)), 8));
+        __m256i first = _mm256_blendv_epi8(_mm256_blendv_epi8(threeBytes, twoBytes, upToTwoBytes), data, oneByte);
+        __m256i second = _mm256_or_si256(_mm256_set1_epi16(0x80), low6);
+        __m256i keepFirst = keepOneOrTwo;
+        __m256i keepSecond = _mm256_andnot_si256(upToTwoBytes, _mm256_set1_epi16(0xff));
+
+        // surrogate pairs are encoded in the lane of the high surrogate and
+        // lone surrogates are left to the scalar code; a pair split by the end
+        // of the block is done in the next iteration
+        uint count = 16;
+        bool lone = false;
+        const __m256i surrogates = _mm256_cmpeq_epi16(_mm256_and_si256(data, _mm256_set1_epi16(short(0xf800))),
+                                                      _mm256_set1_epi16(short(0xd800)));
+        if (!_mm256_testz_si256(surrogates, surrogates)) {
+            const __m256i kind = _mm256_and_si256(data, _mm256_set1_epi16(short(0xfc00)));
+            const __m256i high = _mm256_cmpeq_epi16(kind, _mm256_set1_epi16(short(0xd800)));
+            const __m256i low = _mm256_cmpeq_epi16(kind, _mm256_set1_epi16(short(0xdc00)));
+            // the unit after each unit (zero after the block) and vice versa
+            const __m256i lowUnits = _mm256_alignr_epi8(_mm256_permute2x128_si256(data, data, 0x81), data, 2);
+            const __m256i nextIsLow = _mm256_alignr_epi8(_mm256_permute2x128_si256(low, low, 0x81), low, 2);
+            const __m256i pairHigh = _mm256_and_si256(high, nextIsLow);
+            const __m256i pairLow = _mm256_alignr_epi8(pairHigh, _mm256_permute2x128_si256(pairHigh, pairHigh, 0x08), 14);
+            if (const uint unpaired = _mm256_movemask_epi8(_mm256_andnot_si256(_mm256_or_si256(pairHigh, pairLow), surrogates))) {
+                count = qCountTrailingZeroBits(unpaired) / 2;
+                lone = count < 15 || (in[15] & 0xfc00) != 0xd800;
+                if (lone) {
+                    next = in + count + 2;
+                    if (!count)
+                        break;
+                }
+            }
+
+            // adding 0x40 to the high surrogate puts the plane (the code point
+            // >> 16) in its bits 6 to 10, followed by the next ten bits of the
+            // code point, of which the low surrogate holds the last ten
+            const __m256i highBits = _mm256_add_epi16(data, _mm256_set1_epi16(0x40));
+            const __m256i fourBytes1 = _mm256_or_si256(_mm256_or_si256(_mm256_set1_epi16(short(0x80f0)),
+                                                                       _mm256_and_si256(_mm256_srli_epi16(highBits, 8), _mm256_set1_epi16(7))),
+                                                       _mm256_and_si256(_mm256_slli_epi16(highBits, 6), _mm256_set1_epi16(0x3f00)));
+            const __m256i fourBytes2 = _mm256_or_si256(_mm256_or_si256(_mm256_set1_epi16(short(0x8080)),
+                                                                       _mm256_and_si256(_mm256_slli_epi16(highBits, 4), _mm256_set1_epi16(0x30))),
+                                                       _mm256_or_si256(_mm256_and_si256(_mm256_srli_epi16(lowUnits, 6), _mm256_set1_epi16(0xf)),
+                                                                       _mm256_and_si256(_mm256_slli_epi16(lowUnits, 8), _mm256_set1_epi16(0x3f00))));
+            first = _mm256_blendv_epi8(first, fourBytes1, pairHigh);
+            second = _mm256_blendv_epi8(second, fourBytes2, pairHigh);
+            keepFirst = _mm256_andnot_si256(pairLow, _mm256_or_si256(keepFirst, pairHigh));
+            keepSecond = _mm256_andnot_si256(pairLow, _mm256_or_si256(keepSecond, pairHigh));
+        }
+
+        // put the bytes of every character in one 32-bit lane (the unpacking
+        // works within 128-bit halves, so the lower one holds characters 0 to 3
+        // and 8 to 11) and store the ones that are used
+        const __m256i bytesLow = _mm256_unpacklo_epi16(first, second);
+        const __m256i bytesHigh = _mm256_unpackhi_epi16(first, second);
+        const uint keepLow = _mm256_movemask_epi8(_mm256_unpacklo_epi16(keepFirst, keepSecond));
+        const uint keepHigh = _mm256_movemask_epi8(_mm256_unpackhi_epi16(keepFirst, keepSecond));
+        quint64 keepMask = (keepLow & 0xffff) | (keepHigh << 16) | (quint64(keepLow >> 16) << 32)
+                | (quint64(keepHigh >> 16) << 48);
+        if (count < 16)
+            keepMask &= (Q_UINT64_C(1) << (4 * count)) - 1;
+        out = compressStore32(out, _mm256_castsi256_si128(bytesLow), _mm256_castsi256_si128(bytesHigh),
+                              uint(keepMask));
+        out = compressStore32(out, _mm256_extracti128_si256(bytesLow, 1), _mm256_extracti128_si256(bytesHigh, 1),
+                              uint(keepMask >> 32));
+        in += count;
+        if (lone)
+            break;
+    }
+
+    dst = out;
+    src = in;
+    nextSimd = next;
+}
+
+// Returns where the scalar code needs to continue (at the start of a
+// character), or nullptr if the data is not valid UTF-8
+QT_FUNCTION_TARGET(AVX2)
+static const uchar *simdValidateUtf8(const uchar *src, const uchar *end, bool &isValidAscii)
+{
+    // do 32 bytes at a time
+    __m256i previous = _mm256_setzero_si256();
+    quint64 pending = 0;    // continuation bytes expected at the start of the next block
+    for ( ; end - src >= 32; src += 32) {
+        const __m256i data = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src));
+        if (!_mm256_movemask_epi8(data) && !pending) {
+            previous = data;
+            continue;
+        }
+        isValidAscii = false;
+
+        // the same checks as in simdDecodeMultiByte, plus sequences that
+        // continue into the next block
+        const __m256i prev1 = _mm256_alignr_epi8(data, _mm256_permute2x128_si256(previous, data, 0x21), 15);
+        const __m256i top2 = _mm256_and_si256(data, _mm256_set1_epi8(char(0xc0)));
+        const quint64 cont = uint(_mm256_movemask_epi8(_mm256_cmpeq_epi8(top2, _mm256_set1_epi8(char(0x80)))));
+        const quint64 lead = uint(_mm256_movemask_epi8(_mm256_cmpeq_epi8(top2, _mm256_set1_epi8(char(0xc0)))));
+        const quint64 lead3 = uint(_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_max_epu8(data, _mm256_set1_epi8(char(0xe0))), data)));
+        const quint64 lead4 = uint(_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_max_epu8(data, _mm256_set1_epi8(char(0xf0))), data)));
+        const quint64 expected = (lead << 1) | (lead3 << 2) | (lead4 << 3) | pending;
+        pending = expected >> 32;
+
+        const __m256i belowA0 = _mm256_cmpeq_epi8(_mm256_min_epu8(data, _mm256_set1_epi8(char(0x9f))), data);
+        const __m256i below90 = _mm256_cmpeq_epi8(_mm256_min_epu8(data, _mm256_set1_epi8(char(0x8f))), data);
+        __m256i invalid = _mm256_cmpeq_epi8(_mm256_and_si256(data, _mm256_set1_epi8(char(0xfe))), _mm256_set1_epi8(char(0xc0)));
+        invalid = _mm256_or_si256(invalid, _mm256_cmpeq_epi8(_mm256_max_epu8(data, _mm256_set1_epi8(char(0xf5))), data));
+        invalid = _mm256_or_si256(invalid, _mm256_and_si256(_mm256_cmpeq_epi8(prev1, _mm256_set1_epi8(char(0xe0))), belowA0));
+        invalid = _mm256_or_si256(invalid, _mm256_andnot_si256(belowA0, _mm256_cmpeq_epi8(prev1, _mm256_set1_epi8(char(0xed)))));
+        invalid = _mm256_or_si256(invalid, _mm256_and_si256(_mm256_cmpeq_epi8(prev1, _mm256_set1_epi8(char(0xf0))), below90));
+        invalid = _mm256_or_si256(invalid, _mm256_andnot_si256(below90, _mm256_cmpeq_epi8(prev1, _mm256_set1_epi8(char(0xf4)))));
+        if (uint(expected) != uint(cont) || _mm256_movemask_epi8(invalid))
+            return nullptr;
+        previous = data;
+    }
+
+    if (pending) {
+        // back up to the lead byte of the unfinished character
+        do {
+            --src;
+        } while ((*src & 0xc0) == 0x80);
+    }
+    return src;
+}
+#elif defined(__ARM_NEON__) && defined(Q_PROCESSOR_ARM_64)
+static inline bool hasSimdMultiByte()
+{
+    return true;
+}
+
+// Returns a mask with one bit set per byte of \a v that is 0xff
+static inline uint neonMovemask(uint8x16_t v)
+{
+    const uint8x16_t bits = { 1, 1 << 1, 1 << 2, 1 << 3, 1 << 4, 1 << 5, 1 << 6, 1 << 7,
+                              1, 1 << 1, 1 << 2, 1 << 3, 1 << 4, 1 << 5, 1 << 6, 1 << 7 };
+    const uint8x16_t masked = vandq_u8(v, bits);
+    return vaddv_u8(vget_low_u8(masked)) | (uint(vaddv_u8(vget_high_u8(masked))) << 8);
+}
+
+static inline void compressStore8(uchar *dst, uint8x16_t data, uint mask)
+{
+    vst1_u8(dst, vqtbl1_u8(data, vcreate_u8(utf8CompressIndices[mask])));
+}
+
+static inline void compressStoreUtf16(ushort *dst, uint16x8_t chars, uint lanes)
+{
+    const uint8x16_t indices = vld1q_u8(reinterpret_cast<const uint8_t *>(utf16CompressIndices[lanes]));
+    vst1q_u16(dst, vreinterpretq_u16_u8(vqtbl1q_u8(vreinterpretq_u8_u16(chars), indices)));
+}
+
+// Decodes every byte in \a b as if it were the last of a character, with
+// \a p1 and \a p2 holding the bytes preceding it
+static inline uint16x8_t decodeChars(uint16x8_t b, uint16x8_t p1, uint16x8_t p2)
+{
+    const uint16x8_t low = vandq_u16(b, vdupq_n_u16(0x3f));
+    const uint16x8_t mid = vshlq_n_u16(vandq_u16(p1, vdupq_n_u16(0x3f)), 6);
+    const uint16x8_t high = vshlq_n_u16(p2, 12);
+    const uint16x8_t threeBytes = vceqq_u16(vandq_u16(p1, vdupq_n_u16(0xc0)), vdupq_n_u16(0x80));
+    const uint16x8_t chars = vorrq_u16(vorrq_u16(low, mid), vandq_u16(high, threeBytes));
+    return vbslq_u16(vcltq_u16(b, vdupq_n_u16(0x80)), b, chars);
+}
+
+// Same as the AVX2 version
+static inline uint16x8_t decodeSurrogates(uint16x8_t chars, uint16x8_t b, uint16x8_t p1, uint16x8_t p2, uint16x8_t p3)
+{
+    const uint16x8_t high = vorrq_u16(vshlq_n_u16(vandq_u16(p2, vdupq_n_u16(7)), 8),
+                                      vorrq_u16(vshlq_n_u16(vandq_u16(p1, vdupq_n_u16(0x3f)), 2),
+                                                vandq_u16(vshrq_n_u16(b, 4), vdupq_n_u16(3))));
+    const uint16x8_t low = vorrq_u16(vshlq_n_u16(vandq_u16(p1, vdupq_n_u16(0xf)), 6),
+                                     vandq_u16(b, vdupq_n_u16(0x3f)));
+    chars = vbslq_u16(vcgeq_u16(p2, vdupq_n_u16(0xf0)), vaddq_u16(high, vdupq_n_u16(0xd800 - 0x40)), chars);
+    return vbslq_u16(vcgeq_u16(p3, vdupq_n_u16(0xf0)), vorrq_u16(low, vdupq_n_u16(0xdc00)), chars);
+}
+
+static void simdDecodeMultiByte(ushort *&dst, const uchar *&nextSimd, const uchar *&src, const uchar *end)
+{
+    ushort *out = dst;
+    const uchar *in = src;
+    const uchar *next = end;
+
+    // do sixteen bytes at a time; see the AVX2 version for the details
+    const uint8x16_t zero = vdupq_n_u8(0);
+    while (end - in >= 16) {
+        const uint8x16_t data = vld1q_u8(in);
+        if (vmaxvq_u8(data) < 0x80) {
+            vst1q_u16(out, vmovl_u8(vget_low_u8(data)));
+            vst1q_u16(out + 8, vmovl_high_u8(data));
+            in += 16;
+            out += 16;
+            continue;
+        }
+
+        const uint8x16_t prev1 = vextq_u8(zero, data, 15);
+        const uint8x16_t prev2 = vextq_u8(zero, data, 14);
+        const uint8x16_t top2 = vandq_u8(data, vdupq_n_u8(0xc0));
+        const uint cont = neonMovemask(vceqq_u8(top2, vdupq_n_u8(0x80)));
+        const uint lead = neonMovemask(vceqq_u8(top2, vdupq_n_u8(0xc0)));
+        const uint lead3 = neonMovemask(vcgeq_u8(data, vdupq_n_u8(0xe0)));
+        const uint lead4 = neonMovemask(vcgeq_u8(data, vdupq_n_u8(0xf0)));
+        const uint misplaced = (((lead << 1) | (lead3 << 2) | (lead4 << 3)) ^ cont) & 0xffff;
+
+        const uint8x16_t belowA0 = vcltq_u8(data, vdupq_n_u8(0xa0));
+        const uint8x16_t below90 = vcltq_u8(data, vdupq_n_u8(0x90));
+        uint8x16_t invalid = vceqq_u8(vandq_u8(data, vdupq_n_u8(0xfe)), vdupq_n_u8(0xc0));
+        invalid = vorrq_u8(invalid, vcgeq_u8(data, vdupq_n_u8(0xf5)));
+        invalid = vorrq_u8(invalid, vandq_u8(vceqq_u8(prev1, vdupq_n_u8(0xe0)), belowA0));
+        invalid = vorrq_u8(invalid, vbicq_u8(vceqq_u8(prev1, vdupq_n_u8(0xed)), belowA0));
+        invalid = vorrq_u8(invalid, vandq_u8(vceqq_u8(prev1, vdupq_n_u8(0xf0)), below90));
+        invalid = vorrq_u8(invalid, vbicq_u8(vceqq_u8(prev1, vdupq_n_u8(0xf4)), below90));
+        const uint invalidBytes = neonMovemask(invalid);
+
+        uint ends = ~lead & ~(cont >> 1) & 0x7fff;
+        if (misplaced) {
+            const uint firstMisplaced = qCountTrailingZeroBits(misplaced);
+            ends &= firstMisplaced ? (1U << (firstMisplaced - 1)) - 1 : 0;
+        }
+        if (invalidBytes)
+            ends &= (1U << qCountTrailingZeroBits(invalidBytes)) - 1;
+        ends |= (ends & (lead4 << 3)) >> 1;
+        if (!ends) {
+            next = in + 16;
+            break;
+        }
+
+        uint16x8_t chars1 = decodeChars(vmovl_u8(vget_low_u8(data)), vmovl_u8(vget_low_u8(prev1)),
+                                        vmovl_u8(vget_low_u8(prev2)));
+        uint16x8_t chars2 = decodeChars(vmovl_high_u8(data), vmovl_high_u8(prev1), vmovl_high_u8(prev2));
+        if (lead4) {
+            const uint8x16_t prev3 = vextq_u8(zero, data, 13);
+            chars1 = decodeSurrogates(chars1, vmovl_u8(vget_low_u8(data)), vmovl_u8(vget_low_u8(prev1)),
+                                      vmovl_u8(vget_low_u8(prev2)), vmovl_u8(vget_low_u8(prev3)));
+            chars2 = decodeSurrogates(chars2, vmovl_high_u8(data), vmovl_high_u8(prev1),
+                                      vmovl_high_u8(prev2), vmovl_high_u8(prev3));
+        }
+        compressStoreUtf16(out, chars1, ends & 0xff);
+        compressStoreUtf16(out + qPopulationCount(ends & 0xff), chars2, ends >> 8);
+        out += qPopulationCount(ends);
+        in += qBitScanReverse(ends) + 1;
+    }
+
+    dst = out;
+    src = in;
+    nextSimd = next;
+}
+
+static void simdEncodeMultiByte(uchar *&dst, const ushort *&nextSimd, const ushort *&src, const ushort *end)
+{
+    uchar *out = dst;
+    const ushort *in = src;
+    const ushort *next = end;
+
+    // do eight characters at a time; see the AVX2 version for the details
+    const uint16x8_t zero = vdupq_n_u16(0);
+    while (end - in >= 16) {
+        const uint16x8_t data = vld1q_u16(in);
+        if (vmaxvq_u16(data) < 0x80) {
+            vst1_u8(out, vmovn_u16(data));
+            in += 8;
+            out += 8;
+            continue;
+        }
+
+        const uint16x8_t oneByte = vcltq_u16(data, vdupq_n_u16(0x80));
+        const uint16x8_t low6 = vandq_u16(data, vdupq_n_u16(0x3f));
+        const uint16x8_t twoBytes = vorrq_u16(vorrq_u16(vdupq_n_u16(0x80c0), vshrq_n_u16(data, 6)),
+                                              vshlq_n_u16(low6, 8));
+        if (vmaxvq_u16(data) < 0x800) {
+            const uint8x16_t bytes = vreinterpretq_u8_u16(vbslq_u16(oneByte, data, twoBytes));
+            const uint keepMask = neonMovemask(vreinterpretq_u8_u16(vorrq_u16(vdupq_n_u16(0xff),
+                                                                              vbicq_u16(vdupq_n_u16(0xff00), oneByte))));
+            compressStore8(out, bytes, keepMask & 0xff);
+            compressStore8(out + qPopulationCount(keepMask & 0xff), vextq_u8(bytes, bytes, 8), keepMask >> 8);
+            out += qPopulationCount(keepMask);
+            in += 8;
+            continue;
+        }
+
+        const uint16x8_t upToTwoBytes = vcltq_u16(data, vdupq_n_u16(0x800));
+        const uint16x8_t threeBytes = vorrq_u16(vorrq_u16(vdupq_n_u16(0x80e0), vshrq_n_u16(data, 12)),
+                                                vshlq_n_u16(vandq_u16(vshrq_n_u16(data, 6), vdupq_n_u16(0x3f)), 8));
+        uint16x8_t first = vbslq_u16(oneByte, data, vbslq_u16(upToTwoBytes, twoBytes, threeBytes));
+        uint16x8_t second = vorrq_u16(vdupq_n_u16(0x80), low6);
+        uint16x8_t keepFirst = vorrq_u16(vdupq_n_u16(0xff), vbicq_u16(vdupq_n_u16(0xff00), oneByte));
+        uint16x8_t keepSecond = vbicq_u16(vdupq_n_u16(0xff), upToTwoBytes);
+
+        uint count = 8;
+        const uint16x8_t surrogates = vceqq_u16(vandq_u16(data, vdupq_n_u16(0xf800)), vdupq_n_u16(0xd800));
+        if (vmaxvq_u16(surrogates)) {
+            const uint16x8_t kind = vandq_u16(data, vdupq_n_u16(0xfc00));
+            const uint16x8_t pairHigh = vandq_u16(vceqq_u16(kind, vdupq_n_u16(0xd800)),
+                                                  vextq_u16(vceqq_u16(kind, vdupq_n_u16(0xdc00)), zero, 1));
+            const uint16x8_t pairLow = vextq_u16(zero, pairHigh, 7);
+            if (const uint lone = neonMovemask(vreinterpretq_u8_u16(vbicq_u16(surrogates, vorrq_u16(pairHigh, pairLow))))) {
+                count = qCountTrailingZeroBits(lone) / 2;
+                next = in + count + 2;
+                if (!count)
+                    break;
+            }
+
+            const uint16x8_t lowUnits = vextq_u16(data, zero, 1);
+            const uint16x8_t plane = vaddq_u16(vandq_u16(vshrq_n_u16(data, 6), vdupq_n_u16(0xf)), vdupq_n_u16(1));
+            const uint16x8_t byte1 = vorrq_u16(vshlq_n_u16(vandq_u16(plane, vdupq_n_u16(3)), 4),
+                                               vandq_u16(vshrq_n_u16(data, 2), vdupq_n_u16(0xf)));
+            const uint16x8_t byte2 = vorrq_u16(vshlq_n_u16(vandq_u16(data, vdupq_n_u16(3)), 4),
+                                               vandq_u16(vshrq_n_u16(lowUnits, 6), vdupq_n_u16(0xf)));
+            const uint16x8_t fourBytes1 = vorrq_u16(vorrq_u16(vdupq_n_u16(0x80f0), vshrq_n_u16(plane, 2)),
+                                                    vshlq_n_u16(byte1, 8));
+            const uint16x8_t fourBytes2 = vorrq_u16(vorrq_u16(vdupq_n_u16(0x8080), byte2),
+                                                    vshlq_n_u16(vandq_u16(lowUnits, vdupq_n_u16(0x3f)), 8));
+            first = vbslq_u16(pairHigh, fourBytes1, first);
+            second = vbslq_u16(pairHigh, fourBytes2, second);
+            keepFirst = vbicq_u16(vorrq_u16(keepFirst, pairHigh), pairLow);
+            keepSecond = vbicq_u16(vorrq_u16(keepSecond, pairHigh), pairLow);
+        }
+
+        const uint8x16_t bytes1 = vreinterpretq_u8_u16(vzip1q_u16(first, second));
+        const uint8x16_t bytes2 = vreinterpretq_u8_u16(vzip2q_u16(first, second));
+        uint keepMask = neonMovemask(vreinterpretq_u8_u16(vzip1q_u16(keepFirst, keepSecond)))
+                | (neonMovemask(vreinterpretq_u8_u16(vzip2q_u16(keepFirst, keepSecond))) << 16);
+        if (count < 8)
+            keepMask &= (1U << (4 * count)) - 1;
+        compressStore8(out, bytes1, keepMask & 0xff);
+        compressStore8(out + qPopulationCount(keepMask & 0xff), vextq_u8(bytes1, bytes1, 8), (keepMask >> 8) & 0xff);
+        compressStore8(out + qPopulationCount(keepMask & 0xffff), bytes2, (keepMask >> 16) & 0xff);
+        compressStore8(out + qPopulationCount(keepMask & 0xffffff), vextq_u8(bytes2, bytes2, 8), keepMask >> 24);
+        out += qPopulationCount(keepMask);
+        in += count;
+        if (count < 8)
+            break;
+    }
+
+    dst = out;
+    src = in;
+    nextSimd = next;
+}
+
+static const uchar *simdValidateUtf8(const uchar *src, const uchar *end, bool &isValidAscii)
+{
+    // do sixteen bytes at a time; see the AVX2 version for the details
+    uint8x16_t previous = vdupq_n_u8(0);
+    uint pending = 0;
+    for ( ; end - src >= 16; src += 16) {
+        const uint8x16_t data = vld1q_u8(src);
+        if (vmaxvq_u8(data) < 0x80 && !pending) {
+            previous = data;
+            continue;
+        }
+        isValidAscii = false;
+
+        const uint8x16_t prev1 = vextq_u8(previous, data, 15);
+        const uint8x16_t top2 = vandq_u8(data, vdupq_n_u8(0xc0));
+        const uint cont = neonMovemask(vceqq_u8(top2, vdupq_n_u8(0x80)));
+        const uint lead = neonMovemask(vceqq_u8(top2, vdupq_n_u8(0xc0)));
+        const uint lead3 = neonMovemask(vcgeq_u8(data, vdupq_n_u8(0xe0)));
+        const uint lead4 = neonMovemask(vcgeq_u8(data, vdupq_n_u8(0xf0)));
+        const uint expected = (lead << 1) | (lead3 << 2) | (lead4 << 3) | pending;
+        pending = expected >> 16;
+
+        const uint8x16_t belowA0 = vcltq_u8(data, vdupq_n_u8(0xa0));
+        const uint8x16_t below90 = vcltq_u8(data, vdupq_n_u8(0x90));
+        uint8x16_t invalid = vceqq_u8(vandq_u8(data, vdupq_n_u8(0xfe)), vdupq_n_u8(0xc0));
+        invalid = vorrq_u8(invalid, vcgeq_u8(data, vdupq_n_u8(0xf5)));
+        invalid = vorrq_u8(invalid, vandq_u8(vceqq_u8(prev1, vdupq_n_u8(0xe0)), belowA0));
+        invalid = vorrq_u8(invalid, vbicq_u8(vceqq_u8(prev1, vdupq_n_u8(0xed)), belowA0));
+        invalid = vorrq_u8(invalid, vandq_u8(vceqq_u8(prev1, vdupq_n_u8(0xf0)), below90));
+        invalid = vorrq_u8(invalid, vbicq_u8(vceqq_u8(prev1, vdupq_n_u8(0xf4)), below90));
+        if ((expected & 0xffff) != cont || vmaxvq_u8(invalid))
+            return nullptr;
+        previous = data;
+    }
+
+    if (pending) {
+        do {
+            --src;
+        } while ((*src & 0xc0) == 0x80);
+    }
+    return src;
+}
+#else
+static inline bool hasSimdMultiByte()
+{
+    return false;
+}
+
+static inline void simdDecodeMultiByte(ushort *&, const uchar *&nextSimd, const uchar *&, const uchar *end)
+{
+    nextSimd = end;
+}
+
+static inline void simdEncodeMultiByte(uchar *&, const ushort *&nextSimd, const ushort *&, const ushort *end)
+{
+    nextSimd = end;
+}
+
+static inline const uchar *simdValidateUtf8(const uchar *src, const uchar *, bool &)
+{
+    return src;
+}
+#endif
+
 QByteArray QUtf8::convertFromUnicode(const QChar *uc, int len)
 {
     // create a QByteArray with the worst case scenario size
@@ -377,6 +1023,7 @@ QByteArray QUtf8::convertFromUnicode(const QChar *uc, int len)
     uchar *dst = reinterpret_cast<uchar *>(const_cast<char *>(result.constData()));
     const ushort *src = reinterpret_cast<const ushort *>(uc);
     const ushort *const end = src + len;
+    const ushort *nextSimd = hasSimdMultiByte() ? src : end;
 
     while (src != end) {
         const ushort *nextAscii = end;
@@ -384,6 +1031,12 @@ QByteArray QUtf8::convertFromUnicode(const QChar *uc, int len)
             break;
 
         do {
+            if (src >= nextSimd) {
+                simdEncodeMultiByte(dst, nextSimd, src, end);
+                if (src == end)
+                    break;
+            }
+
             ushort uc = *src++;
             int res = QUtf8Functions::toUtf8<QUtf8BaseTraits>(uc, dst, src, end);
             if (res < 0) {
@@ -426,6 +1079,7 @@ QByteArray QUtf8::convertFromUnicode(const QChar *uc, int len, QTextCodec::Conve
     }
 
     const ushort *nextAscii = src;
+    const ushort *nextSimd = hasSimdMultiByte() ? src : end;
     while (src != end) {
         int res;
         ushort uc;
@@ -436,6 +1090,11 @@ QByteArray QUtf8::convertFromUnicode(const QChar *uc, int len, QTextCodec::Conve
         } else {
             if (src >= nextAscii && simdEncodeAscii(cursor, nextAscii, src, end))
                 break;
+            if (src >= nextSimd) {
+                simdEncodeMultiByte(cursor, nextSimd, src, end);
+                if (src == end)
+                    break;
+            }
 
             uc = *src++;
             res = QUtf8Functions::toUtf8<QUtf8BaseTraits>(uc, cursor, src, end);
@@ -521,12 +1180,19 @@ QChar *QUtf8::convertToUnicode(QChar *buffer, const char *chars, int len) noexce
             src += 3;
         }
 
+        const uchar *nextSimd = hasSimdMultiByte() ? src : end;
         while (src < end) {
             nextAscii = end;
             if (simdDecodeAscii(dst, nextAscii, src, end))
                 break;
 
             do {
+                if (src >= nextSimd) {
+                    simdDecodeMultiByte(dst, nextSimd, src, end);
+                    if (src == end)
+                        break;
+                }
+
                 uchar b = *src++;
                 int res = QUtf8Functions::fromUtf8<QUtf8BaseTraits>(b, dst, src, end);
                 if (res < 0) {
@@ -611,11 +1277,19 @@ QString QUtf8::convertToUnicode(const char *chars, int len, QTextCodec::Converte
     // main body, stateless decoding
     res = 0;
     const uchar *nextAscii = src;
+    const uchar *nextSimd = hasSimdMultiByte() ? src : end;
     const uchar *start = src;
     while (res >= 0 && src < end) {
         if (src >= nextAscii && simdDecodeAscii(dst, nextAscii, src, end))
             break;
 
+        // the BOM is handled by the scalar code below
+        if (headerdone && src >= nextSimd) {
+            simdDecodeMultiByte(dst, nextSimd, src, end);
+            if (src == end)
+                break;
+        }
+
         ch = *src++;
         res = QUtf8Functions::fromUtf8<QUtf8BaseTraits>(ch, dst, src, end);
         if (!headerdone && res >= 0) {
@@ -667,9 +1341,14 @@ QUtf8::ValidUtf8Result QUtf8::isValidUtf8(const char *chars, qsizetype len)
 {
     const uchar *src = reinterpret_cast<const uchar *>(chars);
     const uchar *end = src + len;
-    const uchar *nextAscii = src;
     bool isValidAscii = true;
+    if (hasSimdMultiByte()) {
+        src = simdValidateUtf8(src, end, isValidAscii);
+        if (!src)
+            return { false, false };
+    }
 
+    const uchar *nextAscii = src;
     while (src < end) {
         if (src >= nextAscii)
             src = simdFindNonAscii(src, end, nextAscii);
@@ -72,3 +72,12 @@ i.toBack();
 while (i.hasPrevious())
     qDebug() << i.previous();
 //! [2]
+
+
+//! [3]
+QFuture<QByteArray> download = ...;
+QFuture<int> lineCount = download
+        .then([](const QByteArray &data) { return parse(data); })
+        .then(QtFuture::Launch::Async, [](const Document &document) { return document.lineCount(); })
+        .onFailed([](const ParseError &) { return 0; });
+//! [3]
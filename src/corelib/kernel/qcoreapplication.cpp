@@ -351,6 +351,8 @@ bool QCoreApplicationPrivate::is_app_closing = false;
 Q_CORE_EXPORT uint qGlobalPostedEventsCount()
 {
     QThreadData *currentThreadData = QThreadData::current();
+    const auto locker = qt_scoped_lock(currentThreadData->postEventList.mutex);
+    currentThreadData->postEventList.takeQueuedEvents();
     return currentThreadData->postEventList.size() - currentThreadData->postEventList.startOffset;
 }
 
@@ -502,6 +504,7 @@ void QCoreApplicationPrivate::cleanupThreadData()
 
         // need to clear the state of the mainData, just in case a new QCoreApplication comes along.
         const auto locker = qt_scoped_lock(thisThreadData->postEventList.mutex);
+        thisThreadData->postEventList.takeQueuedEvents();
         for (int i = 0; i < thisThreadData->postEventList.size(); ++i) {
             const QPostEvent &pe = thisThreadData->postEventList.at(i);
             if (pe.event) {
@@ -1539,6 +1542,39 @@ void QCoreApplication::postEvent(QObject *receiver, QEvent *event, int priority)
         return;
     }
 
+    // Queued calls with the default priority are never compressed, so they
+    // can skip the mutex and go onto the receiving thread's lock-free queue
+    if (event->type() == QEvent::MetaCall && priority == Qt::NormalEventPriority) {
+        QScopedPointer<QEvent> eventDeleter(event);
+        QScopedPointer<QPostEventList::QueuedEvent> node(
+                    new QPostEventList::QueuedEvent{ QPostEvent(receiver, event, priority), nullptr });
+        eventDeleter.take();
+
+        // synchronizes with the storeRelease in QObject::moveToThread
+        QThreadData *data = QObjectPrivate::get(receiver)->threadData.loadAcquire();
+        if (data) {
+            QPostEventList &list = data->postEventList;
+            Q_TRACE(QCoreApplication_postEvent_event_posted, receiver, event, event->type());
+            event->posted = true;
+            const bool wasEmpty = list.queueEvent(node.take());
+
+            // pairs with the fence in QObject::moveToThread(): either it
+            // takes this event from the old queue, or we see the new thread
+            // data here and move the event on ourselves
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (data != QObjectPrivate::get(receiver)->threadData.loadAcquire()) {
+                QMutexLocker locker(&list.mutex);
+                list.takeQueuedEvents();
+            }
+
+            // otherwise whoever queued the first event is waking the thread up
+            QAbstractEventDispatcher* dispatcher = data->eventDispatcher.loadAcquire();
+            if (wasEmpty && dispatcher)
+                dispatcher->wakeUp();
+            return;
+        }
+    }
+
     auto locker = QCoreApplicationPrivate::lockThreadPostEventList(receiver);
     if (!locker.threadData) {
         // posting during destruction? just delete the event to prevent a leak
@@ -1548,6 +1584,9 @@ void QCoreApplication::postEvent(QObject *receiver, QEvent *event, int priority)
 
     QThreadData *data = locker.threadData;
 
+    // keep the order of queued calls posted from this thread
+    data->postEventList.takeQueuedEvents();
+
     // if this is one of the compressible events, do compression
     if (receiver->d_func()->postedEvents
         && self && self->compressEvent(event, receiver, &data->postEventList)) {
@@ -1693,6 +1732,7 @@ void QCoreApplicationPrivate::sendPostedEvents(QObject *receiver, int event_type
     ++data->postEventList.recursion;
 
     auto locker = qt_unique_lock(data->postEventList.mutex);
+    data->postEventList.takeQueuedEvents();
 
     // by default, we assume that the event dispatcher can go to sleep after
     // processing all events. if any new events are posted while we send
@@ -1847,6 +1887,8 @@ void QCoreApplication::removePostedEvents(QObject *receiver, int eventType)
 {
     auto locker = QCoreApplicationPrivate::lockThreadPostEventList(receiver);
     QThreadData *data = locker.threadData;
+    if (data)
+        data->postEventList.takeQueuedEvents();
 
     // the QObject destructor calls this function directly.  this can
     // happen while the event loop is in the middle of posting events,
@@ -1910,6 +1952,7 @@ void QCoreApplicationPrivate::removePostedEvent(QEvent * event)
     QThreadData *data = QThreadData::current();
 
     const auto locker = qt_scoped_lock(data->postEventList.mutex);
+    data->postEventList.takeQueuedEvents();
 
     if (data->postEventList.size() == 0) {
 #if defined(QT_DEBUG)
@@ -45,6 +45,7 @@
 #include "qsocketnotifier.h"
 #include "qthread.h"
 #include "qelapsedtimer.h"
+#include "qdeadlinetimer.h"
 
 #include "qeventdispatcher_unix_p.h"
 #include <private/qthread_p.h>
@@ -59,6 +60,10 @@
 #  include <sys/eventfd.h>
 #endif
 
+#ifdef Q_OS_LINUX
+#  include <sys/epoll.h>
+#endif
+
 // VxWorks doesn't correctly set the _POSIX_... options
 #if defined(Q_OS_VXWORKS)
 #  if defined(_POSIX_MONOTONIC_CLOCK) && (_POSIX_MONOTONIC_CLOCK <= 0)
@@ -226,14 +231,183 @@ QEventDispatcherUNIXPrivate::QEventDispatcherUNIXPrivate()
 {
     if (Q_UNLIKELY(threadPipe.init() == false))
         qFatal("QEventDispatcherUNIXPrivate(): Cannot continue without a thread pipe");
+
+#ifdef Q_OS_LINUX
+    static const bool useEpoll = qEnvironmentVariableIntValue("QT_EVENT_DISPATCHER_EPOLL") > 0;
+    if (useEpoll && Q_UNLIKELY(!initEpoll()))
+        perror("QEventDispatcherUNIXPrivate(): Unable to use epoll, falling back to poll");
+#endif
 }
 
 QEventDispatcherUNIXPrivate::~QEventDispatcherUNIXPrivate()
 {
-    // cleanup timers
-    qDeleteAll(timerList);
+#ifdef Q_OS_LINUX
+    if (epollFd >= 0)
+        qt_safe_close(epollFd);
+    if (wakeUpEpollFd >= 0)
+        qt_safe_close(wakeUpEpollFd);
+#endif
+}
+
+#ifdef Q_OS_LINUX
+Q_STATIC_ASSERT(EPOLLIN == POLLIN && EPOLLOUT == POLLOUT && EPOLLPRI == POLLPRI);
+Q_STATIC_ASSERT(EPOLLERR == POLLERR && EPOLLHUP == POLLHUP);
+
+bool QEventDispatcherUNIXPrivate::initEpoll()
+{
+    epollFd = epoll_create1(EPOLL_CLOEXEC);
+    wakeUpEpollFd = epoll_create1(EPOLL_CLOEXEC);
+
+    epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN;
+    ev.data.fd = threadPipe.fds[0];
+    if (epollFd >= 0 && wakeUpEpollFd >= 0
+        && epoll_ctl(epollFd, EPOLL_CTL_ADD, ev.data.fd, &ev) == 0
+        && epoll_ctl(wakeUpEpollFd, EPOLL_CTL_ADD, ev.data.fd, &ev) == 0) {
+        return true;
+    }
+
+    const int error = errno;
+    if (epollFd >= 0)
+        qt_safe_close(epollFd);
+    if (wakeUpEpollFd >= 0)
+        qt_safe_close(wakeUpEpollFd);
+    epollFd = wakeUpEpollFd = -1;
+    errno = error;
+    return false;
+}
+
+// Recreates the notifier epoll set from socketNotifiers, to get rid of a
+// registration that can no longer be removed through its descriptor
+void QEventDispatcherUNIXPrivate::rebuildEpoll()
+{
+    const int fd = epoll_create1(EPOLL_CLOEXEC);
+    if (fd < 0) {
+        perror("QEventDispatcherUNIXPrivate: epoll_create1");
+        return;
+    }
+
+    epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN;
+    ev.data.fd = threadPipe.fds[0];
+    if (epoll_ctl(fd, EPOLL_CTL_ADD, ev.data.fd, &ev) != 0) {
+        perror("QEventDispatcherUNIXPrivate: epoll_ctl");
+        qt_safe_close(fd);
+        return;
+    }
+
+    qt_safe_close(epollFd);
+    epollFd = fd;
+    pollOnlyFds.clear();
+    for (auto it = socketNotifiers.cbegin(); it != socketNotifiers.cend(); ++it)
+        updateEpoll(it.key(), it.value().events(), true);
 }
 
+// Tells the kernel that the notifiers of fd now want events, fd having no
+// notifiers before if added is true.
+void QEventDispatcherUNIXPrivate::updateEpoll(int fd, short events, bool added)
+{
+    if (!added && pollOnlyFds.contains(fd)) {
+        if (!events)
+            pollOnlyFds.removeOne(fd);
+        return;
+    }
+
+    epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = events;
+    ev.data.fd = fd;
+    const int op = !events ? EPOLL_CTL_DEL : added ? EPOLL_CTL_ADD : EPOLL_CTL_MOD;
+    if (epoll_ctl(epollFd, op, fd, &ev) == 0)
+        return;
+
+    switch (errno) {
+    case EEXIST:
+    case ENOENT:
+        // The registration belongs to the file, not to the descriptor: it
+        // goes away when the file is closed and outlives a descriptor
+        // closed while the file remains open through another one.
+        if (events)
+            updateEpoll(fd, events, op == EPOLL_CTL_MOD);
+        break;
+    case EBADF:
+    case EPERM:
+        // Leave invalid descriptors, and those epoll does not support like
+        // regular files, to poll(), which reports them as invalid or as
+        // always ready like the poll based dispatcher does.
+        if (events)
+            pollOnlyFds.append(fd);
+        break;
+    default:
+        perror("QEventDispatcherUNIXPrivate: epoll_ctl");
+        break;
+    }
+}
+
+int QEventDispatcherUNIXPrivate::processEpollEvents(timespec *tm, bool include_notifiers)
+{
+    int timeout = -1;
+    if (tm) {
+        // Round up, timers are not to fire early
+        const qint64 msecs = qint64(tm->tv_sec) * 1000 + (tm->tv_nsec + 999999) / 1000000;
+        timeout = int(qMin<qint64>(msecs, INT_MAX));
+    }
+
+    pollfds.clear();
+    if (include_notifiers && !pollOnlyFds.isEmpty()) {
+        for (int fd : qAsConst(pollOnlyFds))
+            pollfds.append(qt_make_pollfd(fd, socketNotifiers.value(fd).events()));
+        timespec noWait = { 0, 0 };
+        if (qt_safe_poll(pollfds.data(), pollfds.size(), &noWait) > 0)
+            timeout = 0;
+    }
+
+    epoll_event events[64];
+    int ready;
+    const QDeadlineTimer deadline(timeout);
+    forever {
+        ready = epoll_wait(include_notifiers ? epollFd : wakeUpEpollFd,
+                           events, sizeof(events) / sizeof(events[0]), timeout);
+        if (ready != -1 || errno != EINTR)
+            break;
+        // Wait for what is left of the timeout only
+        if (timeout > 0)
+            timeout = int(deadline.remainingTime());
+    }
+    if (ready == -1)
+        perror("QEventDispatcherUNIXPrivate: epoll_wait");
+
+    int nevents = 0;
+    bool stale = false;
+    for (int i = 0; i < ready; ++i) {
+        pollfd pfd = qt_make_pollfd(events[i].data.fd, 0);
+        pfd.revents = short(events[i].events);
+        if (pfd.fd == threadPipe.fds[0]) {
+            nevents += threadPipe.check(pfd);
+        } else if (!socketNotifiers.contains(pfd.fd)) {
+            // The file was closed behind the back of its notifiers while
+            // another descriptor keeps it open. Its registration can only be
+            // removed through the same descriptor, if it still refers to
+            // that file; otherwise start over from the notifiers we have.
+            if (epoll_ctl(epollFd, EPOLL_CTL_DEL, pfd.fd, nullptr) != 0)
+                stale = true;
+        } else {
+            pollfds.append(pfd);
+        }
+    }
+    if (stale)
+        rebuildEpoll();
+
+    if (include_notifiers)
+        nevents += activateSocketNotifiers();
+    else
+        pollfds.clear();
+    return nevents;
+}
+#endif // Q_OS_LINUX
+
 void QEventDispatcherUNIXPrivate::setSocketNotifierPending(QSocketNotifier *notifier)
 {
     Q_ASSERT(notifier);
@@ -411,7 +585,14 @@ void QEventDispatcherUNIX::registerSocketNotifier(QSocketNotifier *notifier)
         qWarning("%s: Multiple socket notifiers for same socket %d and type %s",
                  Q_FUNC_INFO, sockfd, socketType(type));
 
+#ifdef Q_OS_LINUX
+    const bool added = sn_set.isEmpty();
+#endif
     sn_set.notifiers[type] = notifier;
+#ifdef Q_OS_LINUX
+    if (d->epollFd >= 0)
+        d->updateEpoll(sockfd, sn_set.events(), added);
+#endif
 }
 
 void QEventDispatcherUNIX::unregisterSocketNotifier(QSocketNotifier *notifier)
@@ -451,6 +632,10 @@ void QEventDispatcherUNIX::unregisterSocketNotifier(QSocketNotifier *notifier)
     }
 
     sn_set.notifiers[type] = nullptr;
+#ifdef Q_OS_LINUX
+    if (d->epollFd >= 0)
+        d->updateEpoll(sockfd, sn_set.events(), false);
+#endif
 
     if (sn_set.isEmpty())
         d->socketNotifiers.erase(i);
@@ -487,6 +672,17 @@ bool QEventDispatcherUNIX::processEvents(QEventLoop::ProcessEventsFlags flags)
     if (!canWait || (include_timers && d->timerList.timerWait(wait_tm)))
         tm = &wait_tm;
 
+    int nevents = 0;
+
+#ifdef Q_OS_LINUX
+    if (d->epollFd >= 0) {
+        nevents += d->processEpollEvents(tm, include_notifiers);
+        if (include_timers)
+            nevents += d->activateTimers();
+        return (nevents > 0);
+    }
+#endif
+
     d->pollfds.clear();
     d->pollfds.reserve(1 + (include_notifiers ? d->socketNotifiers.size() : 0));
 
@@ -497,8 +693,6 @@ bool QEventDispatcherUNIX::processEvents(QEventLoop::ProcessEventsFlags flags)
     // This must be last, as it's popped off the end below
     d->pollfds.append(d->threadPipe.prepare());
 
-    int nevents = 0;
-
     switch (qt_safe_poll(d->pollfds.data(), d->pollfds.size(), tm)) {
     case -1:
         perror("qt_safe_poll");
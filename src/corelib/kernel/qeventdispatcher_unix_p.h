@@ -140,6 +140,19 @@ public:
     int activateSocketNotifiers();
     void setSocketNotifierPending(QSocketNotifier *notifier);
 
+#ifdef Q_OS_LINUX
+    bool initEpoll();
+    void rebuildEpoll();
+    void updateEpoll(int fd, short events, bool added);
+    int processEpollEvents(timespec *tm, bool include_notifiers);
+
+    // With epoll, the notifiers stay registered in the kernel instead of
+    // being handed over to poll() on every wait
+    int epollFd = -1;           // notifiers and thread pipe
+    int wakeUpEpollFd = -1;     // thread pipe only, when excluding notifiers
+    QVector<int> pollOnlyFds;   // rejected by epoll, e.g. regular files
+#endif
+
     QThreadPipe threadPipe;
     QVector<pollfd> pollfds;
 
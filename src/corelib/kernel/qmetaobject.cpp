@@ -2331,7 +2331,7 @@ bool QMetaMethod::invoke(QObject *object,
                 }
             }
             if (types[i] != QMetaType::UnknownType) {
-                args[i] = QMetaType::create(types[i], param[i]);
+                args[i] = event->constructArg(types[i], param[i]);
                 ++argIndex;
             }
         }
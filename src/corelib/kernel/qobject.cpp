@@ -65,8 +65,10 @@
 #include <qsemaphore.h>
 #endif
 #include <qsharedpointer.h>
+#include <qpointer.h>
 
 #include <private/qorderedmutexlocker_p.h>
+#include <private/qfreelist_p.h>
 #include <private/qhooks_p.h>
 #include <qtcore_tracepoints_p.h>
 
@@ -222,7 +224,7 @@ QObjectPrivate::~QObjectPrivate()
         }
     }
 
-    if (postedEvents)
+    if (postedEvents || thisThreadData->postEventList.hasQueuedEvents())
         QCoreApplication::removePostedEvents(q_ptr, 0);
 
     thisThreadData->deref();
@@ -346,6 +348,22 @@ void QObjectPrivate::addConnection(int signal, Connection *c)
         c->next->prev = &c->next;
 }
 
+/*!
+  \internal
+
+  When \a batch is true, queued calls posted to this object are collected
+  into a single event until that event is delivered, instead of posting one
+  event per call. The calls keep their order among each other, but may
+  overtake events posted to the object after the first call of a batch.
+ */
+void QObjectPrivate::setBatchQueuedCalls(bool batch)
+{
+    Q_Q(QObject);
+    QBasicMutexLocker locker(signalSlotLock(q));
+    ensureConnectionData();
+    connections.loadRelaxed()->batchQueuedCalls = batch;
+}
+
 void QObjectPrivate::ConnectionData::removeConnection(QObjectPrivate::Connection *c)
 {
     Q_ASSERT(c->receiver.loadRelaxed());
@@ -504,6 +522,81 @@ QAbstractMetaCallEvent::~QAbstractMetaCallEvent()
 #endif
 }
 
+namespace {
+// Queued calls are usually created in one thread and deleted in another, at
+// rates where the allocator shows up in profiles. Their memory comes from a
+// lock-free free list shared by all threads, preceded by a header that holds
+// the free list index, or -1 for events allocated once the pool is in use.
+struct QMetaCallEventFreeListConstants : public QFreeListDefaultConstants
+{
+    enum { BlockCount = 3 };
+    static const int Sizes[BlockCount];
+};
+
+const int QMetaCallEventFreeListConstants::Sizes[QMetaCallEventFreeListConstants::BlockCount] = {
+    64,
+    192,
+    768
+};
+
+enum { MetaCallEventPoolSize = 64 + 192 + 768 };
+
+struct alignas(std::max_align_t) QMetaCallEventHeader
+{
+    int index;
+};
+
+struct QMetaCallEventStorage
+{
+    QMetaCallEventHeader header;
+    alignas(QMetaCallEvent) char event[sizeof(QMetaCallEvent)];
+};
+Q_STATIC_ASSERT(offsetof(QMetaCallEventStorage, event) == sizeof(QMetaCallEventHeader));
+
+typedef QFreeList<QMetaCallEventStorage, QMetaCallEventFreeListConstants> QMetaCallEventFreeList;
+Q_GLOBAL_STATIC(QMetaCallEventFreeList, metaCallEventFreeList)
+QBasicAtomicInt pooledMetaCallEvents = Q_BASIC_ATOMIC_INITIALIZER(0);
+} // unnamed namespace
+
+/*!
+    \internal
+ */
+void *QMetaCallEvent::operator new(std::size_t size)
+{
+    // subclasses don't fit into the pool
+    QMetaCallEventFreeList *freeList = size == sizeof(QMetaCallEvent) ? metaCallEventFreeList() : nullptr;
+    if (freeList && pooledMetaCallEvents.fetchAndAddRelaxed(1) < MetaCallEventPoolSize) {
+        const int index = freeList->next();
+        QMetaCallEventStorage &storage = (*freeList)[index];
+        storage.header.index = index;
+        return storage.event;
+    }
+    if (freeList)
+        pooledMetaCallEvents.deref();
+
+    QMetaCallEventHeader *header =
+            static_cast<QMetaCallEventHeader *>(::operator new(sizeof(QMetaCallEventHeader) + size));
+    header->index = -1;
+    return header + 1;
+}
+
+/*!
+    \internal
+ */
+void QMetaCallEvent::operator delete(void *ptr)
+{
+    if (!ptr)
+        return;
+    QMetaCallEventHeader *header = static_cast<QMetaCallEventHeader *>(ptr) - 1;
+    if (header->index < 0) {
+        ::operator delete(header);
+    } else if (QMetaCallEventFreeList *freeList = metaCallEventFreeList()) {
+        // this may be called by a global destructor after the pool is gone
+        freeList->release(header->index);
+        pooledMetaCallEvents.deref();
+    }
+}
+
 /*!
     \internal
  */
@@ -596,7 +689,12 @@ QMetaCallEvent::~QMetaCallEvent()
     if (d.nargs_) {
         int *typeIDs = types();
         for (int i = 0; i < d.nargs_; ++i) {
-            if (typeIDs[i] && d.args_[i])
+            if (!typeIDs[i] || !d.args_[i])
+                continue;
+            const char *arg = static_cast<const char *>(d.args_[i]);
+            if (arg >= argStorage_ && arg < argStorage_ + ArgStorageSize)
+                QMetaType::destruct(typeIDs[i], d.args_[i]);
+            else
                 QMetaType::destroy(typeIDs[i], d.args_[i]);
         }
         if (reinterpret_cast<void*>(d.args_) != reinterpret_cast<void*>(prealloc_))
@@ -606,6 +704,26 @@ QMetaCallEvent::~QMetaCallEvent()
         d.slotObj_->destroyIfLastRef();
 }
 
+/*!
+    \internal
+
+    Returns a copy of \a copy, of type \a type, to be used as an argument of
+    the call. Small values are stored in the event itself, larger ones on
+    the heap; either way the event destroys them.
+ */
+void *QMetaCallEvent::constructArg(int type, const void *copy)
+{
+    const QMetaType info(type);
+    const int align = int(alignof(std::max_align_t));
+    const int size = (info.sizeOf() + align - 1) & ~(align - 1);
+    if (size > 0 && argStorageUsed_ + size <= ArgStorageSize) {
+        void *where = argStorage_ + argStorageUsed_;
+        argStorageUsed_ += size;
+        return info.construct(where, copy);
+    }
+    return info.create(copy);
+}
+
 /*!
     \internal
  */
@@ -621,6 +739,86 @@ void QMetaCallEvent::placeMetaCall(QObject *object)
     }
 }
 
+/*!
+    \internal
+
+    Carries all queued calls posted to a receiver that batches its queued
+    calls (see QObjectPrivate::setBatchQueuedCalls()) since the batch was
+    posted. Calls are appended under the receiver's signalSlotLock for as
+    long as the batch is the receiver's pendingBatch.
+ */
+class QMetaCallBatchEvent : public QAbstractMetaCallEvent
+{
+public:
+    QMetaCallBatchEvent(QObject *receiver, QMetaCallEvent *first)
+        : QAbstractMetaCallEvent(nullptr, -1), receiver_(receiver)
+    {
+        calls.append(first);
+    }
+    ~QMetaCallBatchEvent();
+
+    void append(QMetaCallEvent *ev) { calls.append(ev); }
+    void placeMetaCall(QObject *object) override;
+
+private:
+    void detach();
+
+    QObject *receiver_;
+    QVector<QMetaCallEvent *> calls;
+    bool detached_ = false;
+};
+
+// must be called with the signalSlotLock of receiver_ held
+void QMetaCallBatchEvent::detach()
+{
+    QObjectPrivate::ConnectionData *cd = QObjectPrivate::get(receiver_)->connections.loadRelaxed();
+    if (cd && cd->pendingBatch == this)
+        cd->pendingBatch = nullptr;
+    detached_ = true;
+}
+
+QMetaCallBatchEvent::~QMetaCallBatchEvent()
+{
+    // the event was removed without being delivered
+    if (!detached_) {
+        QBasicMutexLocker locker(signalSlotLock(receiver_));
+        detach();
+    }
+    qDeleteAll(calls);
+}
+
+void QMetaCallBatchEvent::placeMetaCall(QObject *object)
+{
+    {
+        // calls queued from now on go into a new batch
+        QBasicMutexLocker locker(signalSlotLock(object));
+        detach();
+    }
+
+    // a slot may delete the receiver or move it to another thread
+    QPointer<QObject> guard;
+    if (calls.size() > 1)
+        guard = object;
+
+    for (int i = 0; i < calls.size(); ++i) {
+        QMetaCallEvent *ev = calls.at(i);
+        QObjectPrivate::Sender sender(object, const_cast<QObject *>(ev->sender()), ev->signalId());
+        ev->placeMetaCall(object);
+        delete ev;
+        calls[i] = nullptr;
+        if (!sender.receiver) {
+            if (guard) {
+                // moved: the remaining calls follow the receiver
+                for (int j = i + 1; j < calls.size(); ++j) {
+                    QCoreApplication::postEvent(object, calls.at(j));
+                    calls[j] = nullptr;
+                }
+            }
+            break;
+        }
+    }
+}
+
 /*!
     \class QSignalBlocker
     \brief Exception-safe wrapper around QObject::blockSignals().
@@ -1053,13 +1251,20 @@ QObject::~QObject()
             QObjectPrivate::ConnectionData *senderData = sender->d_func()->connections.loadRelaxed();
             Q_ASSERT(senderData);
 
+            senderData->removeConnection(node);
+
+            // activate() calls slot objects without taking a reference, so while
+            // the sender is emitting, leave the slot object to the orphaned
+            // connection; it's destroyed when the emission is done. Emissions
+            // do not take the sender's lock: checking only after the connection
+            // was removed, with an ordered operation that pairs with the ref()
+            // of the emission, makes sure that an emission not seen here does
+            // not see the connection either.
             QtPrivate::QSlotObjectBase *slotObj = nullptr;
-            if (node->isSlotObject) {
+            if (node->isSlotObject && senderData->ref.testAndSetOrdered(1, 1)) {
                 slotObj = node->slotObj;
                 node->isSlotObject = false;
             }
-
-            senderData->removeConnection(node);
             if (needToUnlock)
                 m->unlock();
 
@@ -1581,8 +1786,17 @@ void QObject::moveToThread(QThread *targetThread)
     currentData->ref();
 
     // move the object
+    currentData->postEventList.takeQueuedEvents();
     d_func()->setThreadData_helper(currentData, targetData);
 
+    // queued calls posted before the new thread data was published may
+    // still have gone to the old thread's queue; this forwards them. Pairs
+    // with the fence in QCoreApplication::postEvent(): either we find such
+    // an event here, or its poster sees the new thread data and forwards
+    // the event itself.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    currentData->postEventList.takeQueuedEvents();
+
     locker.unlock();
 
     // now currentData can commit suicide if it wants to
@@ -3746,20 +3960,32 @@ static void queued_activate(QObject *sender, int signal, QObjectPrivate::Connect
             types[n] = argumentTypes[n-1];
 
         for (int n = 1; n < nargs; ++n)
-            args[n] = QMetaType::create(types[n], argv[n]);
+            args[n] = ev->constructArg(types[n], argv[n]);
     }
 
     locker.relock();
     if (c->isSlotObject)
         c->slotObj->destroyIfLastRef();
-    if (!c->receiver.loadRelaxed()) {
+    QObject *receiver = c->receiver.loadRelaxed();
+    if (!receiver) {
         // the connection has been disconnected while we were unlocked
         locker.unlock();
         delete ev;
         return;
     }
 
-    QCoreApplication::postEvent(c->receiver.loadRelaxed(), ev);
+    QObjectPrivate::ConnectionData *cd = QObjectPrivate::get(receiver)->connections.loadRelaxed();
+    if (cd && cd->batchQueuedCalls) {
+        if (cd->pendingBatch) {
+            cd->pendingBatch->append(ev);
+            return;
+        }
+        cd->pendingBatch = new QMetaCallBatchEvent(receiver, ev);
+        QCoreApplication::postEvent(receiver, cd->pendingBatch);
+        return;
+    }
+
+    QCoreApplication::postEvent(receiver, ev);
 }
 
 template <bool callbacks_enabled>
@@ -3872,17 +4098,13 @@ void doActivate(QObject *sender, int signal_index, void **argv)
             QObjectPrivate::Sender senderData(receiverInSameThread ? receiver : nullptr, sender, signal_index);
 
             if (c->isSlotObject) {
-                c->slotObj->ref();
-
-                struct Deleter {
-                    void operator()(QtPrivate::QSlotObjectBase *slot) const {
-                        if (slot) slot->destroyIfLastRef();
-                    }
-                };
-                const std::unique_ptr<QtPrivate::QSlotObjectBase, Deleter> obj{c->slotObj};
+                // no need for a reference: a disconnected slot object stays
+                // alive in the orphaned connection for as long as we hold
+                // connections
+                QtPrivate::QSlotObjectBase *obj = c->slotObj;
 
                 {
-                    Q_TRACE_SCOPE(QMetaObject_activate_slot_functor, obj.get());
+                    Q_TRACE_SCOPE(QMetaObject_activate_slot_functor, obj);
                     obj->call(receiver, argv);
                 }
             } else if (c->callFunction && c->method_offset <= receiver->metaObject()->methodOffset()) {
@@ -3959,6 +4181,21 @@ void QMetaObject::activate(QObject *sender, int signalOffset, int local_signal_i
         doActivate<false>(sender, signal_index, argv);
  }
 
+/*!
+    \internal
+
+    Returns the index of the first signal of \a m among all the signals of
+    its class hierarchy. The offset of a class never changes, so the signals
+    moc generates compute it only once and pass it to activate(), instead of
+    walking the superclasses on every emission.
+
+    \sa QMetaObjectPrivate::signalOffset()
+*/
+int QMetaObject::signalOffset(const QMetaObject *m)
+{
+    return QMetaObjectPrivate::signalOffset(m);
+}
+
 /*!
     \internal
    signal_index comes from indexOfMethod()
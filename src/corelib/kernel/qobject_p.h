@@ -67,6 +67,7 @@ QT_BEGIN_NAMESPACE
 class QVariant;
 class QThreadData;
 class QObjectConnectionListVector;
+class QMetaCallBatchEvent;
 namespace QtSharedPointer { struct ExternalRefCountData; }
 
 /* for Qt Test */
@@ -265,6 +266,9 @@ public:
         Connection *senders = nullptr;
         Sender *currentSender = nullptr;   // object currently activating the object
         QAtomicPointer<Connection> orphaned;
+        // queued calls waiting for delivery when batching, see setBatchQueuedCalls()
+        QMetaCallBatchEvent *pendingBatch = nullptr;
+        bool batchQueuedCalls = false;
 
         ~ConnectionData()
         {
@@ -334,6 +338,7 @@ public:
     QObjectList senderList() const;
 
     void addConnection(int signal, Connection *c);
+    void setBatchQueuedCalls(bool batch);
 
     static QObjectPrivate *get(QObject *o) {
         return o->d_func();
@@ -558,12 +563,17 @@ public:
 
     ~QMetaCallEvent() override;
 
+    static void *operator new(std::size_t size);
+    static void operator delete(void *ptr);
+
     inline int id() const { return d.method_offset_ + d.method_relative_; }
     inline const void * const* args() const { return d.args_; }
     inline void ** args() { return d.args_; }
     inline const int *types() const { return reinterpret_cast<int*>(d.args_ + d.nargs_); }
     inline int *types() { return reinterpret_cast<int*>(d.args_ + d.nargs_); }
 
+    void *constructArg(int type, const void *copy);
+
     virtual void placeMetaCall(QObject *object) override;
 
 private:
@@ -579,6 +589,10 @@ private:
     } d;
     // preallocate enough space for three arguments
     char prealloc_[3*(sizeof(void*) + sizeof(int))];
+    // and for the values of small arguments, see constructArg()
+    enum { ArgStorageSize = 3 * 16 };
+    int argStorageUsed_ = 0;
+    alignas(std::max_align_t) char argStorage_[ArgStorageSize];
 };
 
 class QBoolBlocker
@@ -58,7 +58,7 @@ typedef QArrayData QByteArrayData;
 
 class QString;
 #ifndef Q_MOC_OUTPUT_REVISION
-#define Q_MOC_OUTPUT_REVISION 67
+#define Q_MOC_OUTPUT_REVISION 68
 #endif
 
 // The following macros can be defined by tools that understand Qt
@@ -396,6 +396,8 @@ struct Q_CORE_EXPORT QMetaObject
     static void activate(QObject *sender, int signal_index, void **argv);
     static void activate(QObject *sender, const QMetaObject *, int local_signal_index, void **argv);
     static void activate(QObject *sender, int signal_offset, int local_signal_index, void **argv);
+    // internal signal offset of a class, cached by moc-generated signals
+    static int signalOffset(const QMetaObject *m);
 
     static bool invokeMethod(QObject *obj, const char *member,
                              Qt::ConnectionType,
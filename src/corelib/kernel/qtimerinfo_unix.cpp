@@ -53,15 +53,40 @@
 
 #include <sys/times.h>
 
+#include <string.h>
+
 QT_BEGIN_NAMESPACE
 
 Q_CORE_EXPORT bool qt_disable_lowpriority_timers=false;
 
+#ifdef QT_BUILD_INTERNAL
+// Lets autotests run timer lists on a simulated clock
+Q_AUTOTEST_EXPORT timespec (*qt_timerinfo_clock)() = nullptr;
+#endif
+
 /*
  * Internal functions for manipulating timer data structures.  The
  * timerBitVec array is used for keeping track of timer identifiers.
  */
 
+static inline qint64 toTicks(const timespec &t)
+{
+    return qint64(t.tv_sec) * 1000 + t.tv_nsec / (1000 * 1000);
+}
+
+static void appendTimer(QTimerInfo **list, QTimerInfo *t)
+{
+    t->list = list;
+    if (QTimerInfo *first = *list) {
+        t->next = first;
+        t->prev = first->prev;
+        first->prev->next = t;
+        first->prev = t;
+    } else {
+        *list = t->next = t->prev = t;
+    }
+}
+
 QTimerInfoList::QTimerInfoList()
 {
 #if (_POSIX_MONOTONIC_CLOCK-0 <= 0) && !defined(Q_OS_MAC) && !defined(Q_OS_NACL)
@@ -83,11 +108,24 @@ QTimerInfoList::QTimerInfoList()
     }
 #endif
 
-    firstTimerInfo = nullptr;
+    memset(wheel, 0, sizeof(wheel));
+    memset(occupiedSlots, 0, sizeof(occupiedSlots));
+    farTimers = nullptr;
+    expiredTimers = nullptr;
+    wheelTime = toTicks(updateCurrentTime());
+}
+
+QTimerInfoList::~QTimerInfoList()
+{
+    qDeleteAll(timers);
 }
 
 timespec QTimerInfoList::updateCurrentTime()
 {
+#ifdef QT_BUILD_INTERNAL
+    if (Q_UNLIKELY(qt_timerinfo_clock))
+        return (currentTime = qt_timerinfo_clock());
+#endif
     return (currentTime = qt_gettime());
 }
 
@@ -150,10 +188,16 @@ bool QTimerInfoList::timeChanged(timespec *delta)
 */
 void QTimerInfoList::timerRepair(const timespec &diff)
 {
-    // repair all timers
-    for (int i = 0; i < size(); ++i) {
-        QTimerInfo *t = at(i);
+    // repair all timers, and sort the waiting ones into the wheel again
+    for (QTimerInfo *t : qAsConst(timers)) {
         t->timeout = t->timeout + diff;
+        if (t->list != &expiredTimers)
+            timerUnlink(t);
+    }
+    wheelTime = toTicks(currentTime);
+    for (QTimerInfo *t : qAsConst(timers)) {
+        if (!t->list)
+            timerInsert(t);
     }
 }
 
@@ -175,17 +219,253 @@ void QTimerInfoList::repairTimersIfNeeded()
 #endif
 
 /*
-  insert timer info into list
+  Detaches the timers from the list, returning them linked through next
+  and terminated by null.
+*/
+QTimerInfo *QTimerInfoList::takeTimers(QTimerInfo **list)
+{
+    QTimerInfo *first = *list;
+    if (!first)
+        return nullptr;
+
+    *list = nullptr;
+    first->prev->next = nullptr;
+    if (list != &farTimers && list != &expiredTimers) {
+        const int index = int(list - &wheel[0][0]);
+        occupiedSlots[index / WheelSize] &= ~(Q_UINT64_C(1) << (index % WheelSize));
+    }
+    return first;
+}
+
+/*
+  remove timer info from the wheel or the expired list
+*/
+void QTimerInfoList::timerUnlink(QTimerInfo *t)
+{
+    heapRemove(t);
+    QTimerInfo **list = t->list;
+    if (t->next == t) {
+        takeTimers(list);
+    } else {
+        t->prev->next = t->next;
+        t->next->prev = t->prev;
+        if (*list == t)
+            *list = t->next;
+    }
+    t->list = nullptr;
+}
+
+/*
+  insert timer info into the wheel
 */
-void QTimerInfoList::timerInsert(QTimerInfo *ti)
+void QTimerInfoList::timerInsert(QTimerInfo *t)
 {
-    int index = size();
-    while (index--) {
-        const QTimerInfo * const t = at(index);
-        if (!(ti->timeout < t->timeout))
+    // Timers due before the current tick go to its slot, which is the
+    // first one processed by advanceWheel()
+    const qint64 tick = qMax(toTicks(t->timeout), wheelTime);
+    const quint64 diff = quint64(tick ^ wheelTime);
+    int level = 0;
+    while (level < WheelLevels && (diff >> (WheelBits * (level + 1))))
+        ++level;
+
+    if (level == WheelLevels) {
+        appendTimer(&farTimers, t);
+    } else {
+        const int slot = int(tick >> (WheelBits * level)) & (WheelSize - 1);
+        appendTimer(&wheel[level][slot], t);
+        occupiedSlots[level] |= Q_UINT64_C(1) << slot;
+    }
+
+    // timers moving down the wheel are already in the heap
+    if (t->heapIndex < 0 && !t->activateRef)
+        heapInsert(t);
+}
+
+/*
+  The timers in the wheel that are not being activated are also kept in a
+  binary min-heap by timeout, which tells timerWait() when the first one
+  expires.
+*/
+void QTimerInfoList::heapInsert(QTimerInfo *t)
+{
+    t->heapIndex = waitingTimers.size();
+    waitingTimers.append(t);
+    heapSiftUp(t->heapIndex);
+}
+
+void QTimerInfoList::heapRemove(QTimerInfo *t)
+{
+    const int index = t->heapIndex;
+    if (index < 0)
+        return;
+
+    t->heapIndex = -1;
+    QTimerInfo *last = waitingTimers.takeLast();
+    if (last == t)
+        return;
+    waitingTimers[index] = last;
+    last->heapIndex = index;
+    heapSiftUp(index);
+    heapSiftDown(last->heapIndex);
+}
+
+void QTimerInfoList::heapSiftUp(int index)
+{
+    QTimerInfo *t = waitingTimers.at(index);
+    while (index > 0) {
+        const int parent = (index - 1) / 2;
+        QTimerInfo *p = waitingTimers.at(parent);
+        if (!(t->timeout < p->timeout))
+            break;
+        waitingTimers[index] = p;
+        p->heapIndex = index;
+        index = parent;
+    }
+    waitingTimers[index] = t;
+    t->heapIndex = index;
+}
+
+void QTimerInfoList::heapSiftDown(int index)
+{
+    QTimerInfo *t = waitingTimers.at(index);
+    const int size = waitingTimers.size();
+    for (int child = 2 * index + 1; child < size; child = 2 * index + 1) {
+        if (child + 1 < size && waitingTimers.at(child + 1)->timeout < waitingTimers.at(child)->timeout)
+            ++child;
+        QTimerInfo *c = waitingTimers.at(child);
+        if (!(c->timeout < t->timeout))
             break;
+        waitingTimers[index] = c;
+        c->heapIndex = index;
+        index = child;
     }
-    insert(index+1, ti);
+    waitingTimers[index] = t;
+    t->heapIndex = index;
+}
+
+/*
+  insert timer info into the expired list, keeping it sorted by timeout
+  and timers with the same timeout in insertion order
+*/
+void QTimerInfoList::insertExpired(QTimerInfo *t)
+{
+    heapRemove(t);
+
+    QTimerInfo *first = expiredTimers;
+    if (!first || !(t->timeout < first->prev->timeout)) {
+        appendTimer(&expiredTimers, t);
+        return;
+    }
+
+    QTimerInfo *pos = first->prev;
+    while (pos != first && t->timeout < pos->prev->timeout)
+        pos = pos->prev;
+
+    t->list = &expiredTimers;
+    t->next = pos;
+    t->prev = pos->prev;
+    pos->prev->next = t;
+    pos->prev = t;
+    if (pos == first)
+        expiredTimers = t;
+}
+
+/*
+  move the timers of a slot the wheel has reached down the levels
+*/
+void QTimerInfoList::cascade(QTimerInfo **list)
+{
+    QTimerInfo *t = takeTimers(list);
+    while (t) {
+        QTimerInfo *next = t->next;
+        timerInsert(t);
+        t = next;
+    }
+}
+
+/*
+  Advances the wheel to the given tick, moving the timers that expired by
+  currentTime to the expired list. Empty slots are skipped, so this does
+  not depend on how long it has been since the last call.
+*/
+void QTimerInfoList::advanceWheel(qint64 tick)
+{
+    while (wheelTime <= tick) {
+        // expire the slots of the current block of the first level
+        const qint64 blockEnd = wheelTime | (WheelSize - 1);
+        const qint64 last = qMin(tick, blockEnd);
+        quint64 occupied = occupiedSlots[0]
+                & (~Q_UINT64_C(0) << (wheelTime & (WheelSize - 1)))
+                & (~Q_UINT64_C(0) >> (WheelSize - 1 - (last & (WheelSize - 1))));
+        while (occupied) {
+            const int slot = qCountTrailingZeroBits(occupied);
+            occupied &= occupied - 1;
+            QTimerInfo *t = takeTimers(&wheel[0][slot]);
+            while (t) {
+                QTimerInfo *next = t->next;
+                // only the slot of the current tick can hold timers not due yet
+                if (currentTime < t->timeout)
+                    timerInsert(t);
+                else
+                    insertExpired(t);
+                t = next;
+            }
+        }
+
+        if (tick <= blockEnd) {
+            wheelTime = tick;
+            return;
+        }
+
+        // Find the first slot of a higher level holding timers. The slot
+        // the wheel is at is always empty above the first level, as its
+        // timers belong to a lower one.
+        qint64 next = -1;
+        for (int level = 1; level < WheelLevels; ++level) {
+            const int shift = WheelBits * level;
+            const int index = int(wheelTime >> shift) & (WheelSize - 1);
+            const quint64 later = occupiedSlots[level] & ~((Q_UINT64_C(2) << index) - 1);
+            if (later) {
+                next = ((wheelTime >> (shift + WheelBits)) << (shift + WheelBits))
+                        | (qint64(qCountTrailingZeroBits(later)) << shift);
+                break;
+            }
+        }
+        if (next < 0 && farTimers)
+            next = ((wheelTime >> (WheelBits * WheelLevels)) + 1) << (WheelBits * WheelLevels);
+
+        if (next < 0 || next > tick) {
+            // nothing to move down before tick
+            wheelTime = tick;
+            return;
+        }
+
+        wheelTime = next;
+        if (!(next & ((Q_INT64_C(1) << (WheelBits * WheelLevels)) - 1)))
+            cascade(&farTimers);
+        for (int level = WheelLevels - 1; level > 0; --level) {
+            const int shift = WheelBits * level;
+            if (!(next & ((Q_INT64_C(1) << shift) - 1)))
+                cascade(&wheel[level][int(next >> shift) & (WheelSize - 1)]);
+        }
+    }
+}
+
+/*
+  Returns the first timer to expire that is not already active: the first
+  of the expired list, which is sorted, or the top of the heap.
+*/
+const QTimerInfo *QTimerInfoList::firstWaitingTimer() const
+{
+    if (const QTimerInfo *first = expiredTimers) {
+        const QTimerInfo *t = first;
+        do {
+            if (!t->activateRef)
+                return t;
+            t = t->next;
+        } while (t != first);
+    }
+    return waitingTimers.isEmpty() ? nullptr : waitingTimers.constFirst();
 }
 
 inline timespec &operator+=(timespec &t1, int ms)
@@ -389,14 +669,7 @@ bool QTimerInfoList::timerWait(timespec &tm)
     repairTimersIfNeeded();
 
     // Find first waiting timer not already active
-    QTimerInfo *t = nullptr;
-    for (QTimerInfoList::const_iterator it = constBegin(); it != constEnd(); ++it) {
-        if (!(*it)->activateRef) {
-            t = *it;
-            break;
-        }
-    }
-
+    const QTimerInfo *t = firstWaitingTimer();
     if (!t)
       return false;
 
@@ -423,16 +696,13 @@ int QTimerInfoList::timerRemainingTime(int timerId)
     repairTimersIfNeeded();
     timespec tm = {0, 0};
 
-    for (int i = 0; i < count(); ++i) {
-        QTimerInfo *t = at(i);
-        if (t->id == timerId) {
-            if (currentTime < t->timeout) {
-                // time to wait
-                tm = roundToMillisecond(t->timeout - currentTime);
-                return tm.tv_sec*1000 + tm.tv_nsec/1000/1000;
-            } else {
-                return 0;
-            }
+    if (const QTimerInfo *t = timers.value(timerId)) {
+        if (currentTime < t->timeout) {
+            // time to wait
+            tm = roundToMillisecond(t->timeout - currentTime);
+            return tm.tv_sec*1000 + tm.tv_nsec/1000/1000;
+        } else {
+            return 0;
         }
     }
 
@@ -451,6 +721,7 @@ void QTimerInfoList::registerTimer(int timerId, int interval, Qt::TimerType time
     t->timerType = timerType;
     t->obj = object;
     t->activateRef = nullptr;
+    t->heapIndex = -1;
 
     timespec expected = updateCurrentTime() + interval;
 
@@ -493,6 +764,7 @@ void QTimerInfoList::registerTimer(int timerId, int interval, Qt::TimerType time
             ++t->timeout.tv_sec;
     }
 
+    timers.insert(timerId, t);
     timerInsert(t);
 
 #ifdef QTIMERINFO_DEBUG
@@ -508,39 +780,32 @@ void QTimerInfoList::registerTimer(int timerId, int interval, Qt::TimerType time
 bool QTimerInfoList::unregisterTimer(int timerId)
 {
     // set timer inactive
-    for (int i = 0; i < count(); ++i) {
-        QTimerInfo *t = at(i);
-        if (t->id == timerId) {
-            // found it
-            removeAt(i);
-            if (t == firstTimerInfo)
-                firstTimerInfo = nullptr;
-            if (t->activateRef)
-                *(t->activateRef) = nullptr;
-            delete t;
-            return true;
-        }
-    }
-    // id not found
-    return false;
+    QTimerInfo *t = timers.take(timerId);
+    if (!t)
+        return false; // id not found
+
+    timerUnlink(t);
+    if (t->activateRef)
+        *(t->activateRef) = nullptr;
+    delete t;
+    return true;
 }
 
 bool QTimerInfoList::unregisterTimers(QObject *object)
 {
     if (isEmpty())
         return false;
-    for (int i = 0; i < count(); ++i) {
-        QTimerInfo *t = at(i);
+    for (auto it = timers.begin(); it != timers.end(); ) {
+        QTimerInfo *t = it.value();
         if (t->obj == object) {
             // object found
-            removeAt(i);
-            if (t == firstTimerInfo)
-                firstTimerInfo = nullptr;
+            it = timers.erase(it);
+            timerUnlink(t);
             if (t->activateRef)
                 *(t->activateRef) = nullptr;
             delete t;
-            // move back one so that we don't skip the new current item
-            --i;
+        } else {
+            ++it;
         }
     }
     return true;
@@ -549,8 +814,7 @@ bool QTimerInfoList::unregisterTimers(QObject *object)
 QList<QAbstractEventDispatcher::TimerInfo> QTimerInfoList::registeredTimers(QObject *object) const
 {
     QList<QAbstractEventDispatcher::TimerInfo> list;
-    for (int i = 0; i < count(); ++i) {
-        const QTimerInfo * const t = at(i);
+    for (const QTimerInfo *t : timers) {
         if (t->obj == object) {
             list << QAbstractEventDispatcher::TimerInfo(t->id,
                                                         (t->timerType == Qt::VeryCoarseTimer
@@ -570,42 +834,20 @@ int QTimerInfoList::activateTimers()
     if (qt_disable_lowpriority_timers || isEmpty())
         return 0; // nothing to do
 
-    int n_act = 0, maxCount = 0;
-    firstTimerInfo = nullptr;
+    int n_act = 0;
 
     timespec currentTime = updateCurrentTime();
     // qDebug() << "Thread" << QThread::currentThreadId() << "woken up at" << currentTime;
     repairTimersIfNeeded();
 
-
-    // Find out how many timer have expired
-    for (QTimerInfoList::const_iterator it = constBegin(); it != constEnd(); ++it) {
-        if (currentTime < (*it)->timeout)
-            break;
-        maxCount++;
-    }
+    // Find out which timers have expired. Each is fired once: rescheduled
+    // timers go back to the wheel, even when due again already.
+    advanceWheel(toTicks(currentTime));
 
     //fire the timers.
-    while (maxCount--) {
-        if (isEmpty())
-            break;
-
-        QTimerInfo *currentTimerInfo = constFirst();
-        if (currentTime < currentTimerInfo->timeout)
-            break; // no timer has expired
-
-        if (!firstTimerInfo) {
-            firstTimerInfo = currentTimerInfo;
-        } else if (firstTimerInfo == currentTimerInfo) {
-            // avoid sending the same timer multiple times
-            break;
-        } else if (currentTimerInfo->interval <  firstTimerInfo->interval
-                   || currentTimerInfo->interval == firstTimerInfo->interval) {
-            firstTimerInfo = currentTimerInfo;
-        }
-
+    while (QTimerInfo *currentTimerInfo = expiredTimers) {
         // remove from list
-        removeFirst();
+        timerUnlink(currentTimerInfo);
 
 #ifdef QTIMERINFO_DEBUG
         float diff;
@@ -638,16 +880,19 @@ int QTimerInfoList::activateTimers()
         if (!currentTimerInfo->activateRef) {
             // send event, but don't allow it to recurse
             currentTimerInfo->activateRef = &currentTimerInfo;
+            heapRemove(currentTimerInfo);
 
             QTimerEvent e(currentTimerInfo->id);
             QCoreApplication::sendEvent(currentTimerInfo->obj, &e);
 
-            if (currentTimerInfo)
+            if (currentTimerInfo) {
                 currentTimerInfo->activateRef = nullptr;
+                if (currentTimerInfo->list != &expiredTimers)
+                    heapInsert(currentTimerInfo);
+            }
         }
     }
 
-    firstTimerInfo = nullptr;
     // qDebug() << "Thread" << QThread::currentThreadId() << "activated" << n_act << "timers";
     return n_act;
 }
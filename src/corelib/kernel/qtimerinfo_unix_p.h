@@ -56,6 +56,8 @@
 // #define QTIMERINFO_DEBUG
 
 #include "qabstracteventdispatcher.h"
+#include "qhash.h"
+#include "qvector.h"
 
 #include <sys/time.h> // struct timeval
 
@@ -70,6 +72,11 @@ struct QTimerInfo {
     QObject *obj;     // - object to receive event
     QTimerInfo **activateRef; // - ref from activateTimers
 
+    QTimerInfo **list; // - wheel slot or expired list holding the timer
+    QTimerInfo *next;  // - circular links within that list
+    QTimerInfo *prev;
+    int heapIndex;     // - position among the waiting timers, or -1
+
 #ifdef QTIMERINFO_DEBUG
     timeval expected; // when timer is expected to fire
     float cumulativeError;
@@ -77,7 +84,15 @@ struct QTimerInfo {
 #endif
 };
 
-class Q_CORE_EXPORT QTimerInfoList : public QList<QTimerInfo*>
+// Timers are kept in a hierarchical timer wheel with millisecond ticks. Each
+// level has WheelSize slots, a slot of level n covering WheelSize^n ticks. A
+// timer is stored at the lowest level whose current block of WheelSize slots
+// contains its timeout, and moves down a level whenever the wheel reaches
+// the slot it is in. The timers waiting in the wheel are also kept in a
+// binary heap by timeout, which tells how long to sleep. Registering,
+// re-arming and unregistering a timer is O(log n), and finding the next
+// timeout is O(1).
+class Q_CORE_EXPORT QTimerInfoList
 {
 #if ((_POSIX_MONOTONIC_CLOCK-0 <= 0) && !defined(Q_OS_MAC)) || defined(QT_BOOTSTRAPPED)
     timespec previousTime;
@@ -89,11 +104,36 @@ class Q_CORE_EXPORT QTimerInfoList : public QList<QTimerInfo*>
     void timerRepair(const timespec &);
 #endif
 
-    // state variables used by activateTimers()
-    QTimerInfo *firstTimerInfo;
+    enum {
+        WheelBits = 6,
+        WheelSize = 1 << WheelBits,
+        WheelLevels = 5
+    };
+
+    QHash<int, QTimerInfo *> timers;
+    QTimerInfo *wheel[WheelLevels][WheelSize];
+    quint64 occupiedSlots[WheelLevels];
+    QTimerInfo *farTimers;      // beyond the last level
+    QTimerInfo *expiredTimers;  // due, sorted by timeout, to be activated
+    QVector<QTimerInfo *> waitingTimers; // heap of the others not active
+    qint64 wheelTime;           // tick of the slots processed last
+
+    QTimerInfo *takeTimers(QTimerInfo **list);
+    void timerUnlink(QTimerInfo *);
+    void heapInsert(QTimerInfo *);
+    void heapRemove(QTimerInfo *);
+    void heapSiftUp(int index);
+    void heapSiftDown(int index);
+    void insertExpired(QTimerInfo *);
+    void cascade(QTimerInfo **list);
+    void advanceWheel(qint64 tick);
+    const QTimerInfo *firstWaitingTimer() const;
+
+    Q_DISABLE_COPY_MOVE(QTimerInfoList)
 
 public:
     QTimerInfoList();
+    ~QTimerInfoList();
 
     timespec currentTime;
     timespec updateCurrentTime();
@@ -101,6 +141,9 @@ public:
     // must call updateCurrentTime() first!
     void repairTimersIfNeeded();
 
+    bool isEmpty() const { return timers.isEmpty(); }
+    int size() const { return timers.size(); }
+
     bool timerWait(timespec &);
     void timerInsert(QTimerInfo *);
 
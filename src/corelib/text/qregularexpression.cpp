@@ -41,6 +41,7 @@
 
 #include "qregularexpression.h"
 
+#include <QtCore/qcache.h>
 #include <QtCore/qcoreapplication.h>
 #include <QtCore/qhashfunctions.h>
 #include <QtCore/qmutex.h>
@@ -52,6 +53,8 @@
 #include <QtCore/qatomic.h>
 #include <QtCore/qdatastream.h>
 
+#include <private/qlocking_p.h>
+
 #define PCRE2_CODE_UNIT_WIDTH 16
 
 #include <pcre2.h>
@@ -840,6 +843,33 @@ static int convertToPcreOptions(QRegularExpression::MatchOptions matchOptions)
     return options;
 }
 
+/*
+    The result of compiling a pattern with a given set of pattern options.
+    It is shared by all the QRegularExpressionPrivate objects that use the
+    same pattern and options (see QRegularExpressionCache below). The pcre2
+    code is never modified once it has been JIT-compiled, so it can be used
+    for matching from any number of threads at the same time.
+*/
+struct QRegularExpressionCompiledPattern : QSharedData
+{
+    QRegularExpressionCompiledPattern(const QString &pattern,
+                                      QRegularExpression::PatternOptions patternOptions);
+    ~QRegularExpressionCompiledPattern();
+
+    void getPatternInfo();
+    void optimizePattern();
+
+    pcre2_code_16 *code;
+    int errorCode;
+    int errorOffset;
+    int capturingCount;
+    bool usingCrLfNewlines;
+    bool usingJOption;
+
+private:
+    Q_DISABLE_COPY_MOVE(QRegularExpressionCompiledPattern)
+};
+
 struct QRegularExpressionPrivate : QSharedData
 {
     QRegularExpressionPrivate();
@@ -849,7 +879,6 @@ struct QRegularExpressionPrivate : QSharedData
     void cleanCompiledPattern();
     void compilePattern();
     void getPatternInfo();
-    void optimizePattern();
 
     enum CheckSubjectStringOption {
         CheckSubjectString,
@@ -876,9 +905,12 @@ struct QRegularExpressionPrivate : QSharedData
     // (right after a detach happened).
     mutable QMutex mutex;
 
-    // The PCRE code pointer is reference-counted by the QRegularExpressionPrivate
-    // objects themselves; when the private is copied (i.e. a detach happened)
-    // it is set to nullptr
+    // The compiled pattern is shared with all the other
+    // QRegularExpressionPrivate objects using the same pattern and options,
+    // through the compiled pattern cache; compiledPattern and the members
+    // below are copied out of it. When the private is copied (i.e. a detach
+    // happened) they are all reset.
+    QExplicitlySharedDataPointer<QRegularExpressionCompiledPattern> compiledData;
     pcre2_code_16 *compiledPattern;
     int errorCode;
     int errorOffset;
@@ -968,8 +1000,8 @@ QRegularExpressionPrivate::~QRegularExpressionPrivate()
     \internal
 
     Copies the private, which means copying only the pattern and the pattern
-    options. The compiledPattern pointer is NOT copied (we
-    do not own it any more), and in general all the members set when
+    options. The compiled pattern is NOT copied, and in general all the
+    members set when
     compiling a pattern are set to default values. isDirty is set back to true
     so that the pattern has to be recompiled again.
 */
@@ -992,7 +1024,7 @@ QRegularExpressionPrivate::QRegularExpressionPrivate(const QRegularExpressionPri
 */
 void QRegularExpressionPrivate::cleanCompiledPattern()
 {
-    pcre2_code_free_16(compiledPattern);
+    compiledData.reset();
     compiledPattern = nullptr;
     errorCode = 0;
     errorOffset = -1;
@@ -1003,28 +1035,27 @@ void QRegularExpressionPrivate::cleanCompiledPattern()
 /*!
     \internal
 */
-void QRegularExpressionPrivate::compilePattern()
+QRegularExpressionCompiledPattern::QRegularExpressionCompiledPattern(const QString &pattern,
+                                                                     QRegularExpression::PatternOptions patternOptions)
+    : code(nullptr),
+      errorCode(0),
+      errorOffset(-1),
+      capturingCount(0),
+      usingCrLfNewlines(false),
+      usingJOption(false)
 {
-    const QMutexLocker lock(&mutex);
-
-    if (!isDirty)
-        return;
-
-    isDirty = false;
-    cleanCompiledPattern();
-
     int options = convertToPcreOptions(patternOptions);
     options |= PCRE2_UTF;
 
     PCRE2_SIZE patternErrorOffset;
-    compiledPattern = pcre2_compile_16(pattern.utf16(),
-                                       pattern.length(),
-                                       options,
-                                       &errorCode,
-                                       &patternErrorOffset,
-                                       nullptr);
-
-    if (!compiledPattern) {
+    code = pcre2_compile_16(pattern.utf16(),
+                            pattern.length(),
+                            options,
+                            &errorCode,
+                            &patternErrorOffset,
+                            nullptr);
+
+    if (!code) {
         errorOffset = static_cast<int>(patternErrorOffset);
         return;
     } else {
@@ -1039,15 +1070,23 @@ void QRegularExpressionPrivate::compilePattern()
 /*!
     \internal
 */
-void QRegularExpressionPrivate::getPatternInfo()
+QRegularExpressionCompiledPattern::~QRegularExpressionCompiledPattern()
 {
-    Q_ASSERT(compiledPattern);
+    pcre2_code_free_16(code);
+}
+
+/*!
+    \internal
+*/
+void QRegularExpressionCompiledPattern::getPatternInfo()
+{
+    Q_ASSERT(code);
 
-    pcre2_pattern_info_16(compiledPattern, PCRE2_INFO_CAPTURECOUNT, &capturingCount);
+    pcre2_pattern_info_16(code, PCRE2_INFO_CAPTURECOUNT, &capturingCount);
 
     // detect the settings for the newline
     unsigned int patternNewlineSetting;
-    if (pcre2_pattern_info_16(compiledPattern, PCRE2_INFO_NEWLINE, &patternNewlineSetting) != 0) {
+    if (pcre2_pattern_info_16(code, PCRE2_INFO_NEWLINE, &patternNewlineSetting) != 0) {
         // no option was specified in the regexp, grab PCRE build defaults
         pcre2_config_16(PCRE2_CONFIG_NEWLINE, &patternNewlineSetting);
     }
@@ -1057,14 +1096,174 @@ void QRegularExpressionPrivate::getPatternInfo()
             (patternNewlineSetting == PCRE2_NEWLINE_ANYCRLF);
 
     unsigned int hasJOptionChanged;
-    pcre2_pattern_info_16(compiledPattern, PCRE2_INFO_JCHANGED, &hasJOptionChanged);
-    if (Q_UNLIKELY(hasJOptionChanged)) {
+    pcre2_pattern_info_16(code, PCRE2_INFO_JCHANGED, &hasJOptionChanged);
+    usingJOption = hasJOptionChanged;
+}
+
+/*
+    The QRegularExpressionCacheKey struct uniquely identifies a compiled
+    pattern.
+*/
+struct QRegularExpressionCacheKey
+{
+    QString pattern;
+    QRegularExpression::PatternOptions patternOptions;
+};
+
+static bool operator==(const QRegularExpressionCacheKey &key1, const QRegularExpressionCacheKey &key2)
+{
+    return key1.pattern == key2.pattern && key1.patternOptions == key2.patternOptions;
+}
+
+static uint qHash(const QRegularExpressionCacheKey &key, uint seed = 0) noexcept
+{
+    QtPrivate::QHashCombine hash;
+    seed = hash(seed, key.pattern);
+    seed = hash(seed, int(key.patternOptions));
+    return seed;
+}
+
+/*
+    A process-wide cache of the most recently used compiled patterns, so
+    that QRegularExpression objects created over and over again for the same
+    pattern (temporaries, validators...) do not recompile and re-JIT it.
+    Patterns that fail to compile are cached as well, together with their
+    error. The cache only keeps a reference; compiled patterns in use by some
+    QRegularExpression stay alive even after being evicted.
+*/
+struct QRegularExpressionCache
+{
+    typedef QExplicitlySharedDataPointer<QRegularExpressionCompiledPattern> CompiledPatternPointer;
+
+    enum { MaxCachedPatterns = 256 };
+
+    QRegularExpressionCache()
+        : compiledPatterns(MaxCachedPatterns),
+          hits(0),
+          misses(0)
+    {
+    }
+
+    QCache<QRegularExpressionCacheKey, CompiledPatternPointer> compiledPatterns;
+    quint64 hits;
+    quint64 misses;
+};
+
+Q_GLOBAL_STATIC(QRegularExpressionCache, compiledPatternCache)
+static QBasicMutex compiledPatternCacheMutex;
+
+/*!
+    \internal
+
+    Returns the compiled form of \a pattern with the \a patternOptions,
+    taking it from the cache if possible. The compilation itself happens
+    without holding the cache mutex, so that threads compiling different
+    patterns do not wait on each other.
+*/
+static QRegularExpressionCache::CompiledPatternPointer
+compiledPatternFor(const QString &pattern, QRegularExpression::PatternOptions patternOptions)
+{
+    typedef QRegularExpressionCache::CompiledPatternPointer CompiledPatternPointer;
+    const QRegularExpressionCacheKey key = { pattern, patternOptions };
+
+    {
+        const auto locker = qt_scoped_lock(compiledPatternCacheMutex);
+        if (QRegularExpressionCache *c = compiledPatternCache()) {
+            if (const CompiledPatternPointer *cached = c->compiledPatterns.object(key)) {
+                ++c->hits;
+                return *cached;
+            }
+            ++c->misses;
+        }
+    }
+
+    CompiledPatternPointer compiled(new QRegularExpressionCompiledPattern(pattern, patternOptions));
+
+    const auto locker = qt_scoped_lock(compiledPatternCacheMutex);
+    if (QRegularExpressionCache *c = compiledPatternCache()) {
+        // another thread may have compiled the same pattern in the meanwhile
+        if (const CompiledPatternPointer *cached = c->compiledPatterns.object(key))
+            return *cached;
+        c->compiledPatterns.insert(key, new CompiledPatternPointer(compiled));
+    }
+    return compiled;
+}
+
+/*!
+    \internal
+
+    Retrieves the statistics of the compiled pattern cache: the number of
+    lookups that found (\a hits) or did not find (\a misses) the pattern,
+    and the number of patterns currently in the cache (\a size).
+
+    The statistics are only meant for the autotests; they are not exposed
+    in any other way.
+*/
+Q_AUTOTEST_EXPORT void qt_qregularexpression_cacheStatistics(quint64 *hits, quint64 *misses, int *size)
+{
+    const auto locker = qt_scoped_lock(compiledPatternCacheMutex);
+    const QRegularExpressionCache *c = compiledPatternCache();
+    *hits = c ? c->hits : 0;
+    *misses = c ? c->misses : 0;
+    *size = c ? c->compiledPatterns.size() : 0;
+}
+
+/*!
+    \internal
+
+    Empties the compiled pattern cache and resets its statistics.
+*/
+Q_AUTOTEST_EXPORT void qt_qregularexpression_clearCache()
+{
+    const auto locker = qt_scoped_lock(compiledPatternCacheMutex);
+    if (QRegularExpressionCache *c = compiledPatternCache()) {
+        c->compiledPatterns.clear();
+        c->hits = 0;
+        c->misses = 0;
+    }
+}
+
+/*!
+    \internal
+*/
+void QRegularExpressionPrivate::compilePattern()
+{
+    const QMutexLocker lock(&mutex);
+
+    if (!isDirty)
+        return;
+
+    isDirty = false;
+    cleanCompiledPattern();
+
+    compiledData = compiledPatternFor(pattern, patternOptions);
+    compiledPattern = compiledData->code;
+
+    if (!compiledPattern) {
+        errorCode = compiledData->errorCode;
+        errorOffset = compiledData->errorOffset;
+        return;
+    }
+
+    getPatternInfo();
+}
+
+/*!
+    \internal
+*/
+void QRegularExpressionPrivate::getPatternInfo()
+{
+    Q_ASSERT(compiledPattern);
+
+    capturingCount = compiledData->capturingCount;
+    usingCrLfNewlines = compiledData->usingCrLfNewlines;
+
+    if (Q_UNLIKELY(compiledData->usingJOption)) {
         qWarning("QRegularExpressionPrivate::getPatternInfo(): the pattern '%ls'\n    is using the (?J) option; duplicate capturing group names are not supported by Qt",
                  qUtf16Printable(pattern));
     }
 }
 
-
 /*
     Simple "smartpointer" wrapper around a pcre2_jit_stack_16, to be used with
     QThreadStorage.
@@ -1133,19 +1332,19 @@ static bool isJitEnabled()
     The purpose of the function is to call pcre2_jit_compile_16, which
     JIT-compiles the pattern.
 
-    It gets called when a pattern is recompiled by us (in compilePattern()),
-    under mutex protection.
+    It gets called when a pattern is compiled, before the compiled pattern
+    is published in the cache.
 */
-void QRegularExpressionPrivate::optimizePattern()
+void QRegularExpressionCompiledPattern::optimizePattern()
 {
-    Q_ASSERT(compiledPattern);
+    Q_ASSERT(code);
 
     static const bool enableJit = isJitEnabled();
 
     if (!enableJit)
         return;
 
-    pcre2_jit_compile_16(compiledPattern, PCRE2_JIT_COMPLETE | PCRE2_JIT_PARTIAL_SOFT | PCRE2_JIT_PARTIAL_HARD);
+    pcre2_jit_compile_16(code, PCRE2_JIT_COMPLETE | PCRE2_JIT_PARTIAL_SOFT | PCRE2_JIT_PARTIAL_HARD);
 }
 
 /*!
@@ -260,6 +260,41 @@ inline RetType UnrollTailLoop<0>::exec(Number, RetType returnIfExited, Functor1,
 }
 #endif
 
+#if defined(__ARM_NEON__) && defined(Q_PROCESSOR_ARM_64)
+// Like the vaddv-based kernels, the ones using these helpers are only built
+// for AArch64.
+
+// NEON has no equivalent of PMOVMSKB, so we narrow the result of a 16-bit
+// comparison to 8 bits per character and extract it as a 64-bit integer. The
+// index of the first character that compared true is the number of trailing
+// zero bits divided by 8.
+static inline quint64 neonMovemask16(uint16x8_t result)
+{
+    return vget_lane_u64(vreinterpret_u64_u8(vmovn_u16(result)), 0);
+}
+
+// Returns 0x20 for each US-ASCII letter in [first, first + 26) and zero for
+// everything else. XOR'ing with the result converts the letters to the
+// opposite case.
+static inline uint16x8_t neonAsciiCaseFlip(uint16x8_t data, ushort first)
+{
+    const uint16x8_t isLetter = vcltq_u16(vsubq_u16(data, vdupq_n_u16(first)), vdupq_n_u16(26));
+    return vandq_u16(isLetter, vdupq_n_u16(0x20));
+}
+
+// Returns true if the characters in \a a and \a b are all US-ASCII and they
+// are equal after case folding.
+static inline bool neonAsciiFoldEqual(uint16x8_t a, uint16x8_t b)
+{
+    const uint16x8_t nonAscii = vandq_u16(vorrq_u16(a, b), vdupq_n_u16(0xff80));
+    a = veorq_u16(a, neonAsciiCaseFlip(a, 'A'));
+    b = veorq_u16(b, neonAsciiCaseFlip(b, 'A'));
+    const uint16x8_t difference = vorrq_u16(veorq_u16(a, b), nonAscii);
+    // saturating narrowing keeps non-zero characters non-zero
+    return vget_lane_u64(vreinterpret_u64_u8(vqmovn_u16(difference)), 0) == 0;
+}
+#endif
+
 /*!
  * \internal
  *
@@ -465,6 +500,29 @@ static Q_ALWAYS_INLINE __m128i mm_load8_zero_extend(const void *ptr)
     return _mm_unpacklo_epi8(data, _mm_setzero_si128());
 #  endif
 }
+
+// Returns 0x20 for each US-ASCII letter in [first, first + 26) and zero for
+// everything else. XOR'ing with the result converts the letters to the
+// opposite case.
+static inline __m128i mm_asciiCaseFlip(__m128i data, ushort first)
+{
+    // SSE2 has no unsigned comparison, but characters above 0x7fff are
+    // negative and thus never in range
+    const __m128i aboveFirst = _mm_cmpgt_epi16(data, _mm_set1_epi16(short(first - 1)));
+    const __m128i belowLast = _mm_cmplt_epi16(data, _mm_set1_epi16(short(first + 26)));
+    return _mm_and_si128(_mm_and_si128(aboveFirst, belowLast), _mm_set1_epi16(0x20));
+}
+
+// Returns true if the characters in \a a and \a b are all US-ASCII and they
+// are equal after case folding.
+static inline bool mm_asciiFoldEqual(__m128i a, __m128i b)
+{
+    const __m128i nonAscii = _mm_and_si128(_mm_or_si128(a, b), _mm_set1_epi16(short(0xff80)));
+    a = _mm_xor_si128(a, mm_asciiCaseFlip(a, 'A'));
+    b = _mm_xor_si128(b, mm_asciiCaseFlip(b, 'A'));
+    const __m128i difference = _mm_or_si128(_mm_xor_si128(a, b), nonAscii);
+    return _mm_movemask_epi8(_mm_cmpeq_epi16(difference, _mm_setzero_si128())) == 0xffff;
+}
 #endif
 
 // Note: ptr on output may be off by one and point to a preceding US-ASCII
@@ -603,8 +661,8 @@ void qt_from_latin1(ushort *dst, const char *str, size_t size) noexcept
 {
     /* SIMD:
      * Unpacking with SSE has been shown to improve performance on recent CPUs
-     * The same method gives no improvement with NEON. On Aarch64, clang will do the vectorization
-     * itself in exactly the same way as one would do it with intrinsics.
+     * Clang will do the vectorization for NEON itself, but GCC does not at -O2,
+     * so we use the same method with intrinsics there.
      */
 #if defined(__SSE2__)
     const char *e = str + size;
@@ -645,6 +703,24 @@ void qt_from_latin1(ushort *dst, const char *str, size_t size) noexcept
 #  if !defined(__OPTIMIZE_SIZE__)
     return UnrollTailLoop<7>::exec(int(size), [=](int i) { dst[i] = (uchar)str[i]; });
 #  endif
+#elif defined(__ARM_NEON__) && defined(Q_PROCESSOR_ARM_64)
+    // we're going to read str[0..15] (16 bytes)
+    for ( ; size >= 16; size -= 16, str += 16, dst += 16) {
+        const uint8x16_t chunk = vld1q_u8(reinterpret_cast<const uint8_t *>(str));
+
+        // zero extend each half and store
+        vst1q_u16(dst, vmovl_u8(vget_low_u8(chunk)));
+        vst1q_u16(dst + 8, vmovl_u8(vget_high_u8(chunk)));
+    }
+
+    // we're going to read str[0..7] (8 bytes)
+    if (size >= 8) {
+        const uint8x8_t chunk = vld1_u8(reinterpret_cast<const uint8_t *>(str));
+        vst1q_u16(dst, vmovl_u8(chunk));
+        size -= 8;
+        str += 8;
+        dst += 8;
+    }
 #endif
 #if defined(__mips_dsp)
     if (size > 20)
@@ -778,27 +854,39 @@ static void qt_to_latin1_internal(uchar *dst, const ushort *src, qsizetype lengt
 #elif defined(__ARM_NEON__)
     // Refer to the documentation of the SSE2 implementation
     // this use eactly the same method as for SSE except:
-    // 1) neon has unsigned comparison
-    // 2) packing is done to 64 bits (8 x 8bits component).
-    if (length >= 16) {
-        const int chunkCount = length >> 3; // divided by 8
-        const uint16x8_t questionMark = vdupq_n_u16('?'); // set
-        const uint16x8_t thresholdMask = vdupq_n_u16(0xff); // set
-        for (int i = 0; i < chunkCount; ++i) {
-            uint16x8_t chunk = vld1q_u16((uint16_t *)src); // load
-            src += 8;
-
-            if (Checked) {
-                const uint16x8_t offLimitMask = vcgtq_u16(chunk, thresholdMask); // chunk > thresholdMask
-                const uint16x8_t offLimitQuestionMark = vandq_u16(offLimitMask, questionMark); // offLimitMask & questionMark
-                const uint16x8_t correctBytes = vbicq_u16(chunk, offLimitMask); // !offLimitMask & chunk
-                chunk = vorrq_u16(correctBytes, offLimitQuestionMark); // correctBytes | offLimitQuestionMark
-            }
-            const uint8x8_t result = vmovn_u16(chunk); // narrowing move->packing
-            vst1_u8(dst, result); // store
-            dst += 8;
+    // 1) neon has unsigned comparison and a bitwise select
+    // 2) packing is done with narrowing moves (8 x 8bits component each).
+    const uint16x8_t questionMark = vdupq_n_u16('?'); // set
+    const uint16x8_t thresholdMask = vdupq_n_u16(0xff); // set
+
+    auto mergeQuestionMarks = [=](uint16x8_t chunk) {
+        const uint16x8_t offLimitMask = vcgtq_u16(chunk, thresholdMask); // chunk > thresholdMask
+        return vbslq_u16(offLimitMask, questionMark, chunk); // offLimitMask ? questionMark : chunk
+    };
+
+    // we're going to write to dst[0..15] (16 bytes)
+    for ( ; length >= 16; length -= 16, src += 16, dst += 16) {
+        uint16x8_t chunk1 = vld1q_u16(src); // load
+        uint16x8_t chunk2 = vld1q_u16(src + 8); // load
+        if (Checked) {
+            chunk1 = mergeQuestionMarks(chunk1);
+            chunk2 = mergeQuestionMarks(chunk2);
         }
-        length = length % 8;
+
+        // narrowing move->packing
+        const uint8x16_t result = vcombine_u8(vmovn_u16(chunk1), vmovn_u16(chunk2));
+        vst1q_u8(dst, result); // store
+    }
+
+    // we're going to write to dst[0..7] (8 bytes)
+    if (length >= 8) {
+        uint16x8_t chunk = vld1q_u16(src);
+        if (Checked)
+            chunk = mergeQuestionMarks(chunk);
+        vst1_u8(dst, vmovn_u16(chunk));
+        length -= 8;
+        src += 8;
+        dst += 8;
     }
 #endif
 #if defined(__mips_dsp)
@@ -837,14 +925,39 @@ static int ucstricmp(const QChar *a, const QChar *ae, const QChar *b, const QCha
     uint alast = 0;
     uint blast = 0;
     while (a < e) {
-//         qDebug() << Qt::hex << alast << blast;
-//         qDebug() << Qt::hex << "*a=" << *a << "alast=" << alast << "folded=" << foldCase (*a, alast);
-//         qDebug() << Qt::hex << "*b=" << *b << "blast=" << blast << "folded=" << foldCase (*b, blast);
-        int diff = foldCase(a->unicode(), alast) - foldCase(b->unicode(), blast);
-        if ((diff))
-            return diff;
-        ++a;
-        ++b;
+#if defined(__SSE2__) || (defined(__ARM_NEON__) && defined(Q_PROCESSOR_ARM_64))
+        // compare 8 characters at a time while they are US-ASCII
+        if (e - a >= 8) {
+#  if defined(__SSE2__)
+            const __m128i a_data = _mm_loadu_si128(reinterpret_cast<const __m128i *>(a));
+            const __m128i b_data = _mm_loadu_si128(reinterpret_cast<const __m128i *>(b));
+            const bool equal = mm_asciiFoldEqual(a_data, b_data);
+#  else
+            const uint16x8_t a_data = vld1q_u16(reinterpret_cast<const uint16_t *>(a));
+            const uint16x8_t b_data = vld1q_u16(reinterpret_cast<const uint16_t *>(b));
+            const bool equal = neonAsciiFoldEqual(a_data, b_data);
+#  endif
+            if (equal) {
+                // no surrogates in US-ASCII, so no need to remember the last characters
+                a += 8;
+                b += 8;
+                alast = blast = 0;
+                continue;
+            }
+        }
+        // use the Unicode tables for the next 8 characters
+        const QChar *blockEnd = e - a >= 8 ? a + 8 : e;
+#else
+        const QChar *blockEnd = e;
+#endif
+        for ( ; a < blockEnd; ++a, ++b) {
+//             qDebug() << Qt::hex << alast << blast;
+//             qDebug() << Qt::hex << "*a=" << *a << "alast=" << alast << "folded=" << foldCase (*a, alast);
+//             qDebug() << Qt::hex << "*b=" << *b << "blast=" << blast << "folded=" << foldCase (*b, blast);
+            int diff = foldCase(a->unicode(), alast) - foldCase(b->unicode(), blast);
+            if ((diff))
+                return diff;
+        }
     }
     if (a == ae) {
         if (b == be)
@@ -862,11 +975,34 @@ static int ucstricmp(const QChar *a, const QChar *ae, const char *b, const char
         e = a + (be - b);
 
     while (a < e) {
-        int diff = foldCase(a->unicode()) - foldCase(uchar(*b));
-        if ((diff))
-            return diff;
-        ++a;
-        ++b;
+#if defined(__SSE2__) || (defined(__ARM_NEON__) && defined(Q_PROCESSOR_ARM_64))
+        // compare 8 characters at a time while they are US-ASCII
+        if (e - a >= 8) {
+#  if defined(__SSE2__)
+            const __m128i a_data = _mm_loadu_si128(reinterpret_cast<const __m128i *>(a));
+            const __m128i b_data = mm_load8_zero_extend(b);
+            const bool equal = mm_asciiFoldEqual(a_data, b_data);
+#  else
+            const uint16x8_t a_data = vld1q_u16(reinterpret_cast<const uint16_t *>(a));
+            const uint16x8_t b_data = vmovl_u8(vld1_u8(reinterpret_cast<const uint8_t *>(b)));
+            const bool equal = neonAsciiFoldEqual(a_data, b_data);
+#  endif
+            if (equal) {
+                a += 8;
+                b += 8;
+                continue;
+            }
+        }
+        // use the Unicode tables for the next 8 characters
+        const QChar *blockEnd = e - a >= 8 ? a + 8 : e;
+#else
+        const QChar *blockEnd = e;
+#endif
+        for ( ; a < blockEnd; ++a, ++b) {
+            int diff = foldCase(a->unicode()) - foldCase(uchar(*b));
+            if ((diff))
+                return diff;
+        }
     }
     if (a == ae) {
         if (b == be)
@@ -1143,6 +1279,20 @@ static int ucstrncmp(const QChar *a, const uchar *c, size_t l)
     const auto lambda = [=](size_t i) { return uc[i] - ushort(c[i]); };
     return UnrollTailLoop<MaxTailLength>::exec(e - uc, 0, lambda, lambda);
 #  endif
+#elif defined(__ARM_NEON__) && defined(Q_PROCESSOR_ARM_64)
+    // we're going to read uc[0..7] (16 bytes) and c[0..7] (8 bytes)
+    for ( ; e - uc > 7; uc += 8, c += 8) {
+        // expand Latin 1 data via zero extension
+        uint16x8_t ldata = vmovl_u8(vld1_u8(c));
+        uint16x8_t ucdata = vld1q_u16(uc);
+
+        quint64 mask = ~neonMovemask16(vceqq_u16(ucdata, ldata));
+        if (mask) {
+            // found a different character
+            uint idx = qCountTrailingZeroBits(mask) / 8;
+            return uc[idx] - c[idx];
+        }
+    }
 #endif
 
     while (uc < e) {
@@ -6630,6 +6780,76 @@ QString QString::rightJustified(int width, QChar fill, bool truncate) const
 */
 
 namespace QUnicodeTables {
+#if defined(__SSE2__) || (defined(__ARM_NEON__) && defined(Q_PROCESSOR_ARM_64))
+// The US-ASCII letters that change case: for upper case, the lower case
+// letters, and vice-versa. Case folding is the same as lower case for US-ASCII.
+static inline ushort firstAsciiCaseLetter(QUnicodeTables::Case which)
+{
+    return which == QUnicodeTables::UpperCase ? 'a' : 'A';
+}
+
+/*
+    \internal
+    Returns a pointer to the first block of 8 characters in [\a p, \a e) that
+    contains a character that isn't US-ASCII or that changes case under \a
+    which. If there is none, returns a pointer to the last, incomplete block.
+*/
+Q_NEVER_INLINE
+static const QChar *skipAsciiCaseInvariant(const QChar *p, const QChar *e, QUnicodeTables::Case which)
+{
+    const ushort first = firstAsciiCaseLetter(which);
+    for ( ; e - p >= 8; p += 8) {
+#  if defined(__SSE2__)
+        const __m128i data = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+        const __m128i nonAscii = _mm_and_si128(data, _mm_set1_epi16(short(0xff80)));
+        const __m128i changes = _mm_or_si128(nonAscii, mm_asciiCaseFlip(data, first));
+        if (_mm_movemask_epi8(_mm_cmpeq_epi16(changes, _mm_setzero_si128())) != 0xffff)
+            break;
+#  else
+        const uint16x8_t data = vld1q_u16(reinterpret_cast<const uint16_t *>(p));
+        const uint16x8_t nonAscii = vandq_u16(data, vdupq_n_u16(0xff80));
+        const uint16x8_t changes = vorrq_u16(nonAscii, neonAsciiCaseFlip(data, first));
+        // saturating narrowing keeps non-zero characters non-zero
+        if (vget_lane_u64(vreinterpret_u64_u8(vqmovn_u16(changes)), 0))
+            break;
+#  endif
+    }
+    return p;
+}
+
+/*
+    \internal
+    Converts blocks of 8 US-ASCII characters from \a src to \a dst, which
+    may be the same, stopping at the first block that contains other
+    characters. Reads at most \a len characters and returns the number of
+    characters converted.
+*/
+Q_NEVER_INLINE
+static qsizetype convertAsciiCase(QChar *dst, const QChar *src, qsizetype len, QUnicodeTables::Case which)
+{
+    const ushort first = firstAsciiCaseLetter(which);
+    qsizetype i = 0;
+    for ( ; len - i >= 8; i += 8) {
+#  if defined(__SSE2__)
+        __m128i data = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+        const __m128i nonAscii = _mm_and_si128(data, _mm_set1_epi16(short(0xff80)));
+        if (_mm_movemask_epi8(_mm_cmpeq_epi16(nonAscii, _mm_setzero_si128())) != 0xffff)
+            break;
+        data = _mm_xor_si128(data, mm_asciiCaseFlip(data, first));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), data);
+#  else
+        uint16x8_t data = vld1q_u16(reinterpret_cast<const uint16_t *>(src + i));
+        const uint16x8_t nonAscii = vandq_u16(data, vdupq_n_u16(0xff80));
+        if (vget_lane_u64(vreinterpret_u64_u8(vqmovn_u16(nonAscii)), 0))
+            break;
+        data = veorq_u16(data, neonAsciiCaseFlip(data, first));
+        vst1q_u16(reinterpret_cast<uint16_t *>(dst + i), data);
+#  endif
+    }
+    return i;
+}
+#endif
+
 /*
     \internal
     Converts the \a str string starting from the position pointed to by the \a
@@ -6695,6 +6915,17 @@ static QString detachAndConvertCase(T &str, QStringIterator it, QUnicodeTables::
         } else {
             *pp++ = QChar(uc + caseDiff);
         }
+
+#if defined(__SSE2__) || (defined(__ARM_NEON__) && defined(Q_PROCESSOR_ARM_64))
+        if (uc < 0x80 && it.hasNext()) {
+            // convert the US-ASCII text that follows in blocks; the
+            // unconverted characters are still in s, after pp
+            const QChar *src = it.position();
+            qsizetype converted = convertAsciiCase(pp, src, s.constEnd() - pp, which);
+            pp += converted;
+            it.setPosition(src + converted);
+        }
+#endif
     } while (it.hasNext());
 
     return s;
@@ -6711,12 +6942,20 @@ static QString convertCase(T &str, QUnicodeTables::Case which)
         --e;
 
     QStringIterator it(p, e);
+#if defined(__SSE2__) || (defined(__ARM_NEON__) && defined(Q_PROCESSOR_ARM_64))
+    it.setPosition(skipAsciiCaseInvariant(p, e, which));
+#endif
     while (it.hasNext()) {
         uint uc = it.nextUnchecked();
         if (qGetProp(uc)->cases[which].diff) {
             it.recedeUnchecked();
             return detachAndConvertCase(str, it, which);
         }
+#if defined(__SSE2__) || (defined(__ARM_NEON__) && defined(Q_PROCESSOR_ARM_64))
+        // skip the US-ASCII text that follows in blocks
+        if (uc < 0x80)
+            it.setPosition(skipAsciiCaseInvariant(it.position(), e, which));
+#endif
     }
     return std::move(str);
 }
@@ -45,8 +45,18 @@
 #include <QtCore/qfutureinterface.h>
 #include <QtCore/qstring.h>
 
+#include <type_traits>
+
 QT_REQUIRE_CONFIG(future);
 
+// Continuations need C++17
+#if defined(__cpp_if_constexpr) && __cpp_if_constexpr >= 201606 \
+    && defined(__cpp_lib_is_invocable) && __cpp_lib_is_invocable >= 201703 \
+    && defined(__cpp_lib_void_t) && __cpp_lib_void_t >= 201411
+#  define QFUTURE_HAS_CONTINUATIONS
+#  include <QtCore/qfuture_impl.h>
+#endif
+
 QT_BEGIN_NAMESPACE
 
 
@@ -195,6 +205,19 @@ public:
     const_iterator end() const { return const_iterator(this, -1); }
     const_iterator constEnd() const { return const_iterator(this, -1); }
 
+#ifdef QFUTURE_HAS_CONTINUATIONS
+    template <typename Function>
+    QFuture<QtPrivate::ContinuationResult<T, std::decay_t<Function>>> then(Function &&function);
+    template <typename Function>
+    QFuture<QtPrivate::ContinuationResult<T, std::decay_t<Function>>> then(QtFuture::Launch policy, Function &&function);
+    template <typename Function>
+    QFuture<QtPrivate::ContinuationResult<T, std::decay_t<Function>>> then(QThreadPool *pool, Function &&function);
+    template <typename Function>
+    QFuture<T> onFailed(Function &&handler);
+    template <typename Function>
+    QFuture<T> onCanceled(Function &&handler);
+#endif
+
 private:
     friend class QFutureWatcher<T>;
 
@@ -222,6 +245,46 @@ inline QFuture<T> QFutureInterface<T>::future()
     return QFuture<T>(this);
 }
 
+#ifdef QFUTURE_HAS_CONTINUATIONS
+template <typename T>
+template <typename Function>
+QFuture<QtPrivate::ContinuationResult<T, std::decay_t<Function>>> QFuture<T>::then(Function &&function)
+{
+    return then(QtFuture::Launch::Sync, std::forward<Function>(function));
+}
+
+template <typename T>
+template <typename Function>
+QFuture<QtPrivate::ContinuationResult<T, std::decay_t<Function>>>
+QFuture<T>::then(QtFuture::Launch policy, Function &&function)
+{
+    return then(QtPrivate::continuationPool(policy), std::forward<Function>(function));
+}
+
+template <typename T>
+template <typename Function>
+QFuture<QtPrivate::ContinuationResult<T, std::decay_t<Function>>>
+QFuture<T>::then(QThreadPool *pool, Function &&function)
+{
+    using R = QtPrivate::ContinuationResult<T, std::decay_t<Function>>;
+    return QtPrivate::then<R>(d, pool, std::forward<Function>(function));
+}
+
+template <typename T>
+template <typename Function>
+QFuture<T> QFuture<T>::onFailed(Function &&handler)
+{
+    return QtPrivate::onFailed(d, std::forward<Function>(handler));
+}
+
+template <typename T>
+template <typename Function>
+QFuture<T> QFuture<T>::onCanceled(Function &&handler)
+{
+    return QtPrivate::onCanceled(d, std::forward<Function>(handler));
+}
+#endif // QFUTURE_HAS_CONTINUATIONS
+
 Q_DECLARE_SEQUENTIAL_ITERATOR(Future)
 
 template <>
@@ -272,6 +335,37 @@ public:
     QString progressText() const { return d.progressText(); }
     void waitForFinished() { d.waitForFinished(); }
 
+#ifdef QFUTURE_HAS_CONTINUATIONS
+    template <typename Function>
+    QFuture<QtPrivate::ContinuationResult<void, std::decay_t<Function>>> then(Function &&function)
+    {
+        return then(QtFuture::Launch::Sync, std::forward<Function>(function));
+    }
+    template <typename Function>
+    QFuture<QtPrivate::ContinuationResult<void, std::decay_t<Function>>>
+    then(QtFuture::Launch policy, Function &&function)
+    {
+        return then(QtPrivate::continuationPool(policy), std::forward<Function>(function));
+    }
+    template <typename Function>
+    QFuture<QtPrivate::ContinuationResult<void, std::decay_t<Function>>>
+    then(QThreadPool *pool, Function &&function)
+    {
+        using R = QtPrivate::ContinuationResult<void, std::decay_t<Function>>;
+        return QtPrivate::then<R>(QFutureInterface<void>(d), pool, std::forward<Function>(function));
+    }
+    template <typename Function>
+    QFuture<void> onFailed(Function &&handler)
+    {
+        return QtPrivate::onFailed(QFutureInterface<void>(d), std::forward<Function>(handler));
+    }
+    template <typename Function>
+    QFuture<void> onCanceled(Function &&handler)
+    {
+        return QtPrivate::onCanceled(QFutureInterface<void>(d), std::forward<Function>(handler));
+    }
+#endif
+
 private:
     friend class QFutureWatcher<void>;
 
@@ -0,0 +1,288 @@
+/****************************************************************************
+**
+** Copyright (C) 2020 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtCore module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef QFUTURE_H
+#  error "Do not include qfuture_impl.h directly, include qfuture.h instead"
+#endif
+
+#if 0
+#pragma qt_sync_skip_header_check
+#pragma qt_sync_stop_processing
+#endif
+
+#include <QtCore/qthreadpool.h>
+
+#include <functional>
+#include <type_traits>
+#include <utility>
+
+QT_BEGIN_NAMESPACE
+
+template <typename T>
+class QFuture;
+
+namespace QtFuture {
+
+enum class Launch {
+    Sync,
+    Async
+};
+
+} // namespace QtFuture
+
+namespace QtPrivate {
+
+// A continuation of a QFuture<T> takes the result of the future, nothing
+// for QFuture<void>, or the future itself; the latter also gets called
+// when the future was canceled or failed.
+template <typename T, typename Function>
+constexpr bool continuationTakesFuture()
+{
+    if constexpr (std::is_void_v<T>)
+        return !std::is_invocable_v<Function &>;
+    else
+        return !std::is_invocable_v<Function &, T>;
+}
+
+template <typename T, typename Function>
+decltype(auto) invokeContinuation(Function &function, const QFuture<T> &future)
+{
+    if constexpr (continuationTakesFuture<T, Function>())
+        return std::invoke(function, future);
+    else if constexpr (std::is_void_v<T>)
+        return std::invoke(function);
+    else
+        return std::invoke(function, future.result());
+}
+
+template <typename T, typename Function>
+using ContinuationResult = std::decay_t<decltype(invokeContinuation<T>(std::declval<Function &>(),
+                                                                        std::declval<const QFuture<T> &>()))>;
+
+// The exception type a failure handler takes, or void if it takes none
+template <typename Function, typename = void>
+struct FailureHandlerArgument
+{
+    using Type = void;
+};
+
+template <typename Function>
+struct FailureHandlerArgument<Function, std::void_t<decltype(&Function::operator())>>
+    : FailureHandlerArgument<decltype(&Function::operator())>
+{
+};
+
+template <typename Result, typename Class, typename Arg>
+struct FailureHandlerArgument<Result (Class::*)(Arg) const> { using Type = std::decay_t<Arg>; };
+template <typename Result, typename Class, typename Arg>
+struct FailureHandlerArgument<Result (Class::*)(Arg)> { using Type = std::decay_t<Arg>; };
+template <typename Result, typename Arg>
+struct FailureHandlerArgument<Result (*)(Arg)> { using Type = std::decay_t<Arg>; };
+template <typename Result, typename Arg>
+struct FailureHandlerArgument<Result (&)(Arg)> { using Type = std::decay_t<Arg>; };
+template <typename Result, typename Arg>
+struct FailureHandlerArgument<Result (Arg)> { using Type = std::decay_t<Arg>; };
+
+// Reports the outcome of call(), result or exception, and finishes promise
+template <typename R, typename Call>
+void reportCall(QFutureInterface<R> &promise, Call &&call)
+{
+#ifndef QT_NO_EXCEPTIONS
+    try {
+#endif
+        if constexpr (std::is_void_v<R>)
+            call();
+        else
+            promise.reportResult(call());
+#ifndef QT_NO_EXCEPTIONS
+    } catch (QException &e) {
+        promise.reportException(e);
+    } catch (...) {
+        promise.reportException(QUnhandledException());
+    }
+#endif
+    promise.reportFinished();
+}
+
+template <typename T>
+bool hasException(QFutureInterface<T> &future)
+{
+#ifndef QT_NO_EXCEPTIONS
+    return future.exceptionStore().hasException();
+#else
+    Q_UNUSED(future);
+    return false;
+#endif
+}
+
+// Passes the exception or the cancellation of parent on to promise
+template <typename T, typename R>
+void propagateFailure(QFutureInterface<T> &parent, QFutureInterface<R> &promise)
+{
+#ifndef QT_NO_EXCEPTIONS
+    if (hasException(parent))
+        promise.reportException(*parent.exceptionStore().exception().exception());
+    else
+#endif
+        promise.reportCanceled();
+    promise.reportFinished();
+}
+
+// Passes the whole outcome of parent on to promise
+template <typename T>
+void propagateOutcome(QFutureInterface<T> &parent, QFutureInterface<T> &promise)
+{
+    if (parent.isCanceled()) {
+        propagateFailure(parent, promise);
+        return;
+    }
+    if constexpr (!std::is_void_v<T>) {
+        const QList<T> results = parent.results();
+        if (!results.isEmpty())
+            promise.reportResults(results.toVector());
+    }
+    promise.reportFinished();
+}
+
+template <typename T, typename Function, typename R>
+void runContinuation(Function &function, QFutureInterface<T> parent, QFutureInterface<R> promise)
+{
+    if (promise.isCanceled()) {
+        // canceled before the parent finished
+        promise.reportFinished();
+        return;
+    }
+    if constexpr (!continuationTakesFuture<T, Function>()) {
+        if (parent.isCanceled()) {
+            propagateFailure(parent, promise);
+            return;
+        }
+    }
+    reportCall(promise, [&] { return invokeContinuation<T>(function, parent.future()); });
+}
+
+template <typename T, typename Function>
+void runFailureHandler(Function &function, QFutureInterface<T> parent, QFutureInterface<T> promise)
+{
+    if (!hasException(parent)) {
+        propagateOutcome(parent, promise);
+        return;
+    }
+#ifndef QT_NO_EXCEPTIONS
+    using Exception = typename FailureHandlerArgument<Function>::Type;
+    if constexpr (std::is_void_v<Exception>) {
+        reportCall(promise, [&] { return std::invoke(function); });
+    } else {
+        try {
+            parent.exceptionStore().throwPossibleException();
+        } catch (const Exception &e) {
+            reportCall(promise, [&] { return std::invoke(function, e); });
+            return;
+        } catch (...) {
+        }
+        propagateFailure(parent, promise);
+    }
+#endif
+}
+
+template <typename T, typename Function>
+void runCancelHandler(Function &function, QFutureInterface<T> parent, QFutureInterface<T> promise)
+{
+    if (parent.isCanceled() && !hasException(parent))
+        reportCall(promise, [&] { return std::invoke(function); });
+    else
+        propagateOutcome(parent, promise);
+}
+
+// Makes run(function, ...) get called once parentInterface finishes, on
+// the finishing thread or in pool, and returns the future of its outcome
+template <typename R, typename T, typename Function>
+QFuture<R> attachContinuation(QFutureInterface<T> parentInterface, QThreadPool *pool, Function function,
+                              void (*run)(Function &, QFutureInterface<T>, QFutureInterface<R>))
+{
+    QFutureInterface<R> promise;
+    promise.reportStarted();
+    QFuture<R> future = promise.future();
+
+    parentInterface.setContinuation(
+        [function = std::move(function), promise, pool, run](const QFutureInterfaceBase &parentData) mutable {
+            QFutureInterface<T> parent(parentData);
+            if (!pool) {
+                run(function, parent, promise);
+                return;
+            }
+            pool->start([function = std::move(function), parent, promise, run]() mutable {
+                run(function, parent, promise);
+            });
+        });
+    return future;
+}
+
+template <typename R, typename T, typename Function>
+QFuture<R> then(QFutureInterface<T> parentInterface, QThreadPool *pool, Function &&function)
+{
+    using F = std::decay_t<Function>;
+    return attachContinuation<R, T, F>(parentInterface, pool, std::forward<Function>(function),
+                                       &runContinuation<T, F, R>);
+}
+
+template <typename T, typename Function>
+QFuture<T> onFailed(QFutureInterface<T> parentInterface, Function &&function)
+{
+    using F = std::decay_t<Function>;
+    return attachContinuation<T, T, F>(parentInterface, nullptr, std::forward<Function>(function),
+                                       &runFailureHandler<T, F>);
+}
+
+template <typename T, typename Function>
+QFuture<T> onCanceled(QFutureInterface<T> parentInterface, Function &&function)
+{
+    using F = std::decay_t<Function>;
+    return attachContinuation<T, T, F>(parentInterface, nullptr, std::forward<Function>(function),
+                                       &runCancelHandler<T, F>);
+}
+
+inline QThreadPool *continuationPool(QtFuture::Launch policy)
+{
+    return policy == QtFuture::Launch::Async ? QThreadPool::globalInstance() : nullptr;
+}
+
+} // namespace QtPrivate
+
+QT_END_NAMESPACE
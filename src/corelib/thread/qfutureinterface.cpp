@@ -290,6 +290,26 @@ void QFutureInterfaceBase::reportFinished()
         switch_from_to(d->state, Running, Finished);
         d->waitCondition.wakeAll();
         d->sendCallOut(QFutureCallOutEvent(QFutureCallOutEvent::Finished));
+        locker.unlock();
+        d->runContinuation(*this);
+    }
+}
+
+/*!
+    \internal
+
+    Sets \a func to be called with this future once it finishes, on the
+    thread that finishes it. If the future has already finished, \a func
+    is called right away. Continuations run in the order they were set.
+*/
+void QFutureInterfaceBase::setContinuation(std::function<void(const QFutureInterfaceBase &)> func)
+{
+    QMutexLocker locker(&d->continuationMutex);
+    if (isFinished()) {
+        locker.unlock();
+        func(*this);
+    } else {
+        d->continuations.append(std::move(func));
     }
 }
 
@@ -476,6 +496,16 @@ QFutureInterfaceBasePrivate::QFutureInterfaceBasePrivate(QFutureInterfaceBase::S
     progressTime.invalidate();
 }
 
+void QFutureInterfaceBasePrivate::runContinuation(const QFutureInterfaceBase &future)
+{
+    QMutexLocker locker(&continuationMutex);
+    const auto funcs = std::move(continuations);
+    continuations.clear();
+    locker.unlock();
+    for (const auto &func : funcs)
+        func(future);
+}
+
 int QFutureInterfaceBasePrivate::internal_resultCount() const
 {
     return m_results.count(); // ### subtract canceled results.
@@ -45,6 +45,7 @@
 #include <QtCore/qexception.h>
 #include <QtCore/qresultstore.h>
 
+#include <functional>
 #include <mutex>
 
 QT_REQUIRE_CONFIG(future);
@@ -119,6 +120,8 @@ public:
     void waitForResult(int resultIndex);
     void waitForResume();
 
+    void setContinuation(std::function<void(const QFutureInterfaceBase &)> func);
+
     QMutex *mutex() const;
     QMutex &mutex(int) const;
     QtPrivate::ExceptionStore &exceptionStore();
@@ -158,6 +161,11 @@ public:
     {
         refT();
     }
+    explicit QFutureInterface(const QFutureInterfaceBase &dd)
+        : QFutureInterfaceBase(dd)
+    {
+        refT();
+    }
     ~QFutureInterface()
     {
         if (!derefT())
@@ -284,6 +292,9 @@ public:
     explicit QFutureInterface<void>(State initialState = NoState)
         : QFutureInterfaceBase(initialState)
     { }
+    explicit QFutureInterface<void>(const QFutureInterfaceBase &dd)
+        : QFutureInterfaceBase(dd)
+    { }
 
     static QFutureInterface<void> canceledResult()
     { return QFutureInterface(State(Started | Finished | Canceled)); }
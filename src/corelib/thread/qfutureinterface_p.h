@@ -55,6 +55,7 @@
 #include <QtCore/qelapsedtimer.h>
 #include <QtCore/qcoreevent.h>
 #include <QtCore/qlist.h>
+#include <QtCore/qvector.h>
 #include <QtCore/qwaitcondition.h>
 #include <QtCore/qrunnable.h>
 #include <QtCore/qthreadpool.h>
@@ -175,6 +176,11 @@ public:
     QRunnable *runnable;
     QThreadPool *m_pool;
 
+    // run once the future finishes; guarded by their own mutex, as they run
+    // without m_mutex locked
+    QMutex continuationMutex;
+    QVector<std::function<void(const QFutureInterfaceBase &)>> continuations;
+
     inline QThreadPool *pool() const
     { return m_pool ? m_pool : QThreadPool::globalInstance(); }
 
@@ -191,6 +197,7 @@ public:
     void disconnectOutputInterface(QFutureCallOutInterface *iface);
 
     void setState(QFutureInterfaceBase::State state);
+    void runContinuation(const QFutureInterfaceBase &future);
 };
 
 QT_END_NAMESPACE
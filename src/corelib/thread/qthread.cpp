@@ -53,6 +53,51 @@
 
 QT_BEGIN_NAMESPACE
 
+/*
+  QPostEventList
+*/
+
+bool QPostEventList::takeQueuedEvents()
+{
+    QueuedEvent *node = queuedEvents.fetchAndStoreAcquire(nullptr);
+    if (!node)
+        return false;
+
+    // the stack has the most recently posted event on top
+    QueuedEvent *ordered = nullptr;
+    while (node) {
+        QueuedEvent *next = node->next;
+        node->next = ordered;
+        ordered = node;
+        node = next;
+    }
+
+    bool added = false;
+    while (ordered) {
+        QueuedEvent *next = ordered->next;
+        QObjectPrivate *receiver = QObjectPrivate::get(ordered->event.receiver);
+        // stable while we hold the mutex, as moveToThread() locks it too
+        QThreadData *data = receiver->threadData.loadAcquire();
+        if (&data->postEventList == this) {
+            ++receiver->postedEvents;
+            addEvent(ordered->event);
+            delete ordered;
+            added = true;
+        } else {
+            // posted while the receiver was moving to another thread; pass
+            // it on without taking the other list's mutex
+            ordered->next = nullptr;
+            if (data->postEventList.queueEvent(ordered)) {
+                QAbstractEventDispatcher *dispatcher = data->eventDispatcher.loadAcquire();
+                if (dispatcher)
+                    dispatcher->wakeUp();
+            }
+        }
+        ordered = next;
+    }
+    return added;
+}
+
 /*
   QThreadData
 */
@@ -93,6 +138,7 @@ QThreadData::~QThreadData()
     thread.storeRelease(nullptr);
     delete t;
 
+    postEventList.takeQueuedEvents();
     for (int i = 0; i < postEventList.size(); ++i) {
         const QPostEvent &pe = postEventList.at(i);
         if (pe.event) {
@@ -167,7 +213,9 @@ QThreadPrivate::QThreadPrivate(QThreadData *d)
     : QObjectPrivate(), running(false), finished(false),
       isInFinish(false), interruptionRequested(false),
       exited(false), returnCode(-1),
-      stackSize(0), priority(QThread::InheritPriority), data(d)
+      stackSize(0), priority(QThread::InheritPriority),
+      schedulingPolicy(QThread::InheritSchedulingPolicy), niceValue(0), niceValueSet(false),
+      numaNode(-1), data(d)
 {
 
 // INTEGRITY doesn't support self-extending stack. The default stack size for
@@ -519,6 +567,168 @@ uint QThread::stackSize() const
     return d->stackSize;
 }
 
+/*!
+    \enum QThread::SchedulingPolicy
+    \since 5.15.1
+
+    This enum type indicates the scheduling class the operating system
+    should use for the thread. It is only honored on Linux, where it maps
+    to the \c SCHED_* policies of \c{sched_setscheduler(2)}.
+
+    \value InheritSchedulingPolicy  leave the scheduling class unchanged,
+                                    which is the one of the creating thread
+                                    (the default)
+    \value NormalSchedulingPolicy   \c SCHED_OTHER, the default time-sharing class
+    \value BatchSchedulingPolicy    \c SCHED_BATCH, for CPU-bound, non-interactive work
+    \value IdleSchedulingPolicy     \c SCHED_IDLE, only runs when the CPU is otherwise idle
+    \value FifoSchedulingPolicy     \c SCHED_FIFO, real-time first-in, first-out
+    \value RoundRobinSchedulingPolicy \c SCHED_RR, real-time round-robin
+
+    For the real-time policies the static priority is derived from the
+    thread's priority(); for the other ones, setNiceValue() tunes the
+    share of CPU time the thread gets. The real-time policies usually
+    require elevated privileges.
+
+    \sa setSchedulingPolicy(), setNiceValue()
+*/
+
+/*!
+    \since 5.15.1
+
+    Sets the scheduling class of the thread to \a policy. If the thread is
+    running, the policy is changed immediately; otherwise it is applied
+    when the thread starts.
+
+    Setting InheritSchedulingPolicy on a running thread leaves its current
+    policy in place.
+
+    \sa schedulingPolicy(), setNiceValue()
+*/
+void QThread::setSchedulingPolicy(SchedulingPolicy policy)
+{
+    Q_D(QThread);
+    QMutexLocker locker(&d->mutex);
+    d->schedulingPolicy = policy;
+    if (d->running && policy != InheritSchedulingPolicy)
+        d->applySchedulingPolicy();
+}
+
+/*!
+    \since 5.15.1
+
+    Returns the scheduling class set with setSchedulingPolicy().
+*/
+QThread::SchedulingPolicy QThread::schedulingPolicy() const
+{
+    Q_D(const QThread);
+    QMutexLocker locker(&d->mutex);
+    return d->schedulingPolicy;
+}
+
+/*!
+    \since 5.15.1
+
+    Sets the nice value of the thread to \a niceValue, which ranges from
+    -20 (most favorable) to 19 (least favorable). It only has an effect on
+    Linux, and only for the normal and batch scheduling policies. Lowering
+    the value below the current one usually requires elevated privileges.
+
+    If the thread is running, the value is changed immediately; otherwise
+    it is applied when the thread starts.
+
+    \sa niceValue(), setSchedulingPolicy()
+*/
+void QThread::setNiceValue(int niceValue)
+{
+    Q_D(QThread);
+    QMutexLocker locker(&d->mutex);
+    d->niceValue = qBound(-20, niceValue, 19);
+    d->niceValueSet = true;
+    if (d->running)
+        d->applySchedulingPolicy();
+}
+
+/*!
+    \since 5.15.1
+
+    Returns the nice value set with setNiceValue(), or 0 if none was set.
+*/
+int QThread::niceValue() const
+{
+    Q_D(const QThread);
+    QMutexLocker locker(&d->mutex);
+    return d->niceValue;
+}
+
+/*!
+    \since 5.15.1
+
+    Restricts the thread to run on the logical CPUs listed in \a cpus,
+    numbered as by the operating system. An empty list lifts the
+    restriction. If a NUMA node is set as well, the thread runs on the
+    CPUs that are both in \a cpus and on that node.
+
+    If the thread is running, its affinity is changed immediately;
+    otherwise it is applied when the thread starts. This function only has
+    an effect on Linux.
+
+    \sa cpuAffinity(), setNumaNode()
+*/
+void QThread::setCpuAffinity(const QVector<int> &cpus)
+{
+    Q_D(QThread);
+    QMutexLocker locker(&d->mutex);
+    d->cpuAffinity = cpus;
+    if (d->running)
+        d->applyCpuAffinity();
+}
+
+/*!
+    \since 5.15.1
+
+    Returns the CPUs set with setCpuAffinity().
+*/
+QVector<int> QThread::cpuAffinity() const
+{
+    Q_D(const QThread);
+    QMutexLocker locker(&d->mutex);
+    return d->cpuAffinity;
+}
+
+/*!
+    \since 5.15.1
+
+    Restricts the thread to the CPUs of the NUMA node \a node, so that it
+    runs close to the memory allocated from that node. A negative value
+    lifts the restriction.
+
+    If the thread is running, its affinity is changed immediately;
+    otherwise it is applied when the thread starts. This function only has
+    an effect on Linux.
+
+    \sa numaNode(), setCpuAffinity()
+*/
+void QThread::setNumaNode(int node)
+{
+    Q_D(QThread);
+    QMutexLocker locker(&d->mutex);
+    d->numaNode = qMax(-1, node);
+    if (d->running)
+        d->applyCpuAffinity();
+}
+
+/*!
+    \since 5.15.1
+
+    Returns the NUMA node set with setNumaNode(), or -1 if none was set.
+*/
+int QThread::numaNode() const
+{
+    Q_D(const QThread);
+    QMutexLocker locker(&d->mutex);
+    return d->numaNode;
+}
+
 /*!
     Enters the event loop and waits until exit() is called, returning the value
     that was passed to exit(). The value returned is 0 if exit() is called via
@@ -950,6 +1160,46 @@ uint QThread::stackSize() const
     return 0;
 }
 
+void QThread::setSchedulingPolicy(SchedulingPolicy policy)
+{
+    Q_UNUSED(policy);
+}
+
+QThread::SchedulingPolicy QThread::schedulingPolicy() const
+{
+    return InheritSchedulingPolicy;
+}
+
+void QThread::setNiceValue(int niceValue)
+{
+    Q_UNUSED(niceValue);
+}
+
+int QThread::niceValue() const
+{
+    return 0;
+}
+
+void QThread::setCpuAffinity(const QVector<int> &cpus)
+{
+    Q_UNUSED(cpus);
+}
+
+QVector<int> QThread::cpuAffinity() const
+{
+    return QVector<int>();
+}
+
+void QThread::setNumaNode(int node)
+{
+    Q_UNUSED(node);
+}
+
+int QThread::numaNode() const
+{
+    return -1;
+}
+
 #endif // QT_CONFIG(thread)
 
 /*!
@@ -43,6 +43,7 @@
 
 #include <QtCore/qobject.h>
 #include <QtCore/qdeadlinetimer.h>
+#include <QtCore/qvector.h>
 
 // For QThread::create. The configure-time test just checks for the availability
 // of std::future and std::async; for the C++17 codepath we perform some extra
@@ -103,6 +104,27 @@ public:
     void setStackSize(uint stackSize);
     uint stackSize() const;
 
+    enum SchedulingPolicy {
+        InheritSchedulingPolicy,
+        NormalSchedulingPolicy,
+        BatchSchedulingPolicy,
+        IdleSchedulingPolicy,
+        FifoSchedulingPolicy,
+        RoundRobinSchedulingPolicy
+    };
+
+    void setSchedulingPolicy(SchedulingPolicy policy);
+    SchedulingPolicy schedulingPolicy() const;
+
+    void setNiceValue(int niceValue);
+    int niceValue() const;
+
+    void setCpuAffinity(const QVector<int> &cpus);
+    QVector<int> cpuAffinity() const;
+
+    void setNumaNode(int node);
+    int numaNode() const;
+
     void exit(int retcode = 0);
 
     QAbstractEventDispatcher *eventDispatcher() const;
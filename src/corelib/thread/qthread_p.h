@@ -117,10 +117,36 @@ public:
 
     QMutex mutex;
 
+    // Queued calls posted with the default priority do not need the mutex:
+    // postEvent() pushes them onto this lock-free stack, and whoever holds
+    // the mutex moves them into the list in the order they were posted.
+    struct QueuedEvent
+    {
+        QPostEvent event;
+        QueuedEvent *next;
+    };
+    QAtomicPointer<QueuedEvent> queuedEvents;
+
     inline QPostEventList()
         : QVector<QPostEvent>(), recursion(0), startOffset(0), insertionOffset(0)
     { }
 
+    // returns true if the queue was empty, i.e. the receiving thread needs a wake up
+    bool queueEvent(QueuedEvent *node)
+    {
+        QueuedEvent *head = queuedEvents.loadRelaxed();
+        do {
+            node->next = head;
+        } while (!queuedEvents.testAndSetRelease(head, node, head));
+        return !head;
+    }
+    bool hasQueuedEvents() const
+    { return queuedEvents.loadRelaxed() != nullptr; }
+    // must be called with the mutex locked; returns true if any events were
+    // added to the list. Events for receivers that have moved to another
+    // thread are queued there instead.
+    bool takeQueuedEvents();
+
     void addEvent(const QPostEvent &ev) {
         int priority = ev.priority;
         if (isEmpty() ||
@@ -161,6 +187,10 @@ public:
     ~QThreadPrivate();
 
     void setPriority(QThread::Priority prio);
+    // Caller must lock the mutex
+    void applyCpuAffinity();
+    void applySchedulingPolicy();
+    static QVector<int> effectiveCpuAffinity(const QVector<int> &cpus, int numaNode);
 
     mutable QMutex mutex;
     QAtomicInt quitLockRef;
@@ -176,6 +206,12 @@ public:
     uint stackSize;
     QThread::Priority priority;
 
+    QThread::SchedulingPolicy schedulingPolicy;
+    int niceValue;
+    bool niceValueSet;
+    int numaNode;
+    QVector<int> cpuAffinity;
+
     static QThread *threadForId(int id);
 
 #ifdef Q_OS_UNIX
@@ -184,6 +220,11 @@ public:
     static void *start(void *arg);
     static void finish(void *);
 
+#ifdef Q_OS_LINUX
+    // the kernel's id of the thread while it runs, needed for setpriority()
+    pid_t kernelThreadId = 0;
+#endif
+
 #endif // Q_OS_UNIX
 
 #ifdef Q_OS_WIN
@@ -270,7 +311,7 @@ public:
     bool canWaitLocked()
     {
         QMutexLocker locker(&postEventList.mutex);
-        return canWait;
+        return canWait && !postEventList.hasQueuedEvents();
     }
 
     // This class provides per-thread (by way of being a QThreadData
@@ -87,6 +87,12 @@
 #include <sys/prctl.h>
 #endif
 
+#if defined(Q_OS_LINUX) && !defined(Q_OS_ANDROID) && !defined(QT_LINUXBASE)
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#define QT_HAS_THREAD_SCHEDULING_POLICY
+#endif
+
 #if defined(Q_OS_LINUX) && !defined(SCHED_IDLE)
 // from linux/sched.h
 # define SCHED_IDLE    5
@@ -253,6 +259,7 @@ QAbstractEventDispatcher *QThreadPrivate::createEventDispatcher(QThreadData *dat
 #elif !defined(QT_NO_GLIB)
     const bool isQtMainThread = data->thread.loadAcquire() == QCoreApplicationPrivate::mainThread();
     if (qEnvironmentVariableIsEmpty("QT_NO_GLIB")
+        && qEnvironmentVariableIntValue("QT_EVENT_DISPATCHER_EPOLL") <= 0
         && (isQtMainThread || qEnvironmentVariableIsEmpty("QT_NO_THREADED_GLIB"))
         && QEventDispatcherGlib::versionSupported())
         return new QEventDispatcherGlib;
@@ -303,6 +310,15 @@ void *QThreadPrivate::start(void *arg)
             data->threadId.storeRelaxed(to_HANDLE(pthread_self()));
             set_thread_data(data);
 
+            QThreadPrivate *d = thr->d_func();
+#ifdef Q_OS_LINUX
+            d->kernelThreadId = pid_t(syscall(SYS_gettid));
+#endif
+            if (!d->cpuAffinity.isEmpty() || d->numaNode >= 0)
+                d->applyCpuAffinity();
+            if (d->schedulingPolicy != QThread::InheritSchedulingPolicy || d->niceValueSet)
+                d->applySchedulingPolicy();
+
             data->ref();
             data->quitNow = thr->d_func()->exited;
         }
@@ -363,6 +379,9 @@ void QThreadPrivate::finish(void *arg)
 
         d->isInFinish = true;
         d->priority = QThread::InheritPriority;
+#ifdef Q_OS_LINUX
+        d->kernelThreadId = 0;
+#endif
         void *data = &d->data->tls;
         locker.unlock();
         emit thr->finished(QThread::QPrivateSignal());
@@ -817,6 +836,166 @@ void QThreadPrivate::setPriority(QThread::Priority threadPriority)
 #endif
 }
 
+
+#ifdef QT_HAS_THREAD_SCHEDULING_POLICY
+// Parses a list like "0-3,8,10-11", as found in sysfs
+static QVector<int> parseCpuList(const char *list)
+{
+    QVector<int> cpus;
+    const char *p = list;
+    while (*p >= '0' && *p <= '9') {
+        char *end;
+        const int first = int(strtol(p, &end, 10));
+        int last = first;
+        if (*end == '-')
+            last = int(strtol(end + 1, &end, 10));
+        for (int cpu = first; cpu <= last; ++cpu)
+            cpus.append(cpu);
+        p = (*end == ',') ? end + 1 : end;
+    }
+    return cpus;
+}
+
+static QVector<int> numaNodeCpus(int node)
+{
+    char path[64];
+    qsnprintf(path, sizeof(path), "/sys/devices/system/node/node%d/cpulist", node);
+    const int fd = qt_safe_open(path, O_RDONLY);
+    if (fd == -1)
+        return QVector<int>();
+    char buffer[4096];
+    const qint64 size = qt_safe_read(fd, buffer, sizeof(buffer) - 1);
+    qt_safe_close(fd);
+    if (size <= 0)
+        return QVector<int>();
+    buffer[size] = '\0';
+    return parseCpuList(buffer);
+}
+#endif
+
+/*
+    Returns the CPUs a thread restricted to \a cpus and \a numaNode may run
+    on. With no restriction, these are the CPUs available to the process.
+*/
+QVector<int> QThreadPrivate::effectiveCpuAffinity(const QVector<int> &cpus, int numaNode)
+{
+#ifdef QT_HAS_THREAD_SCHEDULING_POLICY
+    QVector<int> allowed;
+    if (numaNode >= 0) {
+        allowed = numaNodeCpus(numaNode);
+    } else {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        if (sched_getaffinity(getpid(), sizeof(set), &set) == 0) {
+            for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+                if (CPU_ISSET(cpu, &set))
+                    allowed.append(cpu);
+            }
+        }
+    }
+    if (cpus.isEmpty())
+        return allowed;
+
+    QVector<int> result;
+    for (int cpu : cpus) {
+        if (cpu >= 0 && cpu < CPU_SETSIZE && (numaNode < 0 || allowed.contains(cpu))
+                && !result.contains(cpu)) {
+            result.append(cpu);
+        }
+    }
+    return result;
+#else
+    return numaNode < 0 ? cpus : QVector<int>();
+#endif
+}
+
+// Caller must lock the mutex
+void QThreadPrivate::applyCpuAffinity()
+{
+#ifdef QT_HAS_THREAD_SCHEDULING_POLICY
+    const pthread_t thread = from_HANDLE<pthread_t>(data->threadId.loadRelaxed());
+    if (!thread)
+        return; // the thread applies it itself once it starts
+
+    const QVector<int> cpus = effectiveCpuAffinity(cpuAffinity, numaNode);
+    if (cpus.isEmpty()) {
+        qWarning("QThread: Cannot set CPU affinity, no CPU matches the requested CPUs and NUMA node");
+        return;
+    }
+
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int cpu : cpus)
+        CPU_SET(cpu, &set);
+    if (int code = pthread_setaffinity_np(thread, sizeof(set), &set))
+        qErrnoWarning(code, "QThread: Cannot set CPU affinity");
+#else
+    if (!cpuAffinity.isEmpty() || numaNode >= 0)
+        qWarning("QThread: CPU affinity is not supported on this platform");
+#endif
+}
+
+// Caller must lock the mutex
+void QThreadPrivate::applySchedulingPolicy()
+{
+#ifdef QT_HAS_THREAD_SCHEDULING_POLICY
+    const pthread_t thread = from_HANDLE<pthread_t>(data->threadId.loadRelaxed());
+    if (!thread)
+        return; // the thread applies it itself once it starts
+
+    if (schedulingPolicy != QThread::InheritSchedulingPolicy) {
+        int sched_policy = SCHED_OTHER;
+        switch (schedulingPolicy) {
+        case QThread::InheritSchedulingPolicy:
+        case QThread::NormalSchedulingPolicy:
+            break;
+        case QThread::BatchSchedulingPolicy:
+            sched_policy = SCHED_BATCH;
+            break;
+        case QThread::IdleSchedulingPolicy:
+            sched_policy = SCHED_IDLE;
+            break;
+        case QThread::FifoSchedulingPolicy:
+            sched_policy = SCHED_FIFO;
+            break;
+        case QThread::RoundRobinSchedulingPolicy:
+            sched_policy = SCHED_RR;
+            break;
+        }
+
+        sched_param param;
+        param.sched_priority = 0;
+        if (sched_policy == SCHED_FIFO || sched_policy == SCHED_RR) {
+            // the real-time policies have a static priority, derive it
+            // from the thread's; calculateUnixPriority() would switch
+            // IdlePriority to SCHED_IDLE
+            int threadPriority = priority & 0xffff;
+            if (threadPriority == QThread::InheritPriority)
+                threadPriority = QThread::NormalPriority;
+            else if (threadPriority == QThread::IdlePriority)
+                threadPriority = QThread::LowestPriority;
+            if (!calculateUnixPriority(threadPriority, &sched_policy, &param.sched_priority)) {
+                qWarning("QThread: Cannot determine scheduler priority range");
+                return;
+            }
+        }
+
+        if (int code = pthread_setschedparam(thread, sched_policy, &param))
+            qErrnoWarning(code, "QThread: Cannot set scheduling policy");
+    }
+
+    // kernelThreadId is only known once the thread runs, which then
+    // applies the nice value itself
+    if (niceValueSet && kernelThreadId) {
+        if (setpriority(PRIO_PROCESS, id_t(kernelThreadId), niceValue) != 0)
+            qErrnoWarning("QThread: Cannot set nice value");
+    }
+#else
+    if (schedulingPolicy != QThread::InheritSchedulingPolicy || niceValueSet)
+        qWarning("QThread: Scheduling policies are not supported on this platform");
+#endif
+}
+
 #endif // QT_CONFIG(thread)
 
 QT_END_NAMESPACE
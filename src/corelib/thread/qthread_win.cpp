@@ -724,6 +724,25 @@ void QThreadPrivate::setPriority(QThread::Priority threadPriority)
     }
 }
 
+QVector<int> QThreadPrivate::effectiveCpuAffinity(const QVector<int> &cpus, int numaNode)
+{
+    return numaNode < 0 ? cpus : QVector<int>();
+}
+
+// Caller must lock the mutex
+void QThreadPrivate::applyCpuAffinity()
+{
+    if (!cpuAffinity.isEmpty() || numaNode >= 0)
+        qWarning("QThread: CPU affinity is not supported on this platform");
+}
+
+// Caller must lock the mutex
+void QThreadPrivate::applySchedulingPolicy()
+{
+    if (schedulingPolicy != QThread::InheritSchedulingPolicy || niceValueSet)
+        qWarning("QThread: Scheduling policies are not supported on this platform");
+}
+
 #endif // QT_CONFIG(thread)
 
 QT_END_NAMESPACE
@@ -39,6 +39,7 @@
 
 #include "qthreadpool.h"
 #include "qthreadpool_p.h"
+#include "qthread_p.h"
 #include "qdeadlinetimer.h"
 #include "qcoreapplication.h"
 
@@ -60,20 +61,53 @@ public:
     QWaitCondition runnableReady;
     QThreadPoolPrivate *manager;
     QRunnable *runnable;
+    int shard;
 };
 
 /*
     QThreadPool private class.
 */
 
+// the pool thread running on the current thread, if any
+static thread_local QThreadPoolThread *currentPoolThread = nullptr;
+
+#ifdef QT_BUILD_INTERNAL
+// Lets autotests use several shards on machines with a single CPU
+Q_AUTOTEST_EXPORT int qt_threadpool_shard_count = 0;
+#endif
+
+static int defaultShardCount()
+{
+#ifdef QT_BUILD_INTERNAL
+    if (Q_UNLIKELY(qt_threadpool_shard_count))
+        return qt_threadpool_shard_count;
+#endif
+    return qBound(1, QThread::idealThreadCount(), 64);
+}
+
 
 /*!
     \internal
 */
 QThreadPoolThread::QThreadPoolThread(QThreadPoolPrivate *manager)
-    :manager(manager), runnable(nullptr)
+    :manager(manager), runnable(nullptr),
+     shard(manager->allThreads.count() % manager->shardCount)
 {
     setStackSize(manager->stackSize);
+    if (manager->threadSchedulingPolicy != QThread::InheritSchedulingPolicy)
+        setSchedulingPolicy(manager->threadSchedulingPolicy);
+    if (manager->threadNiceValueSet)
+        setNiceValue(manager->threadNiceValue);
+    if (manager->threadPinning) {
+        // spread the threads over the allowed CPUs, one CPU each
+        const QVector<int> cpus = QThreadPrivate::effectiveCpuAffinity(manager->threadCpuAffinity,
+                                                                       manager->threadNumaNode);
+        if (!cpus.isEmpty())
+            setCpuAffinity(QVector<int>{ cpus.at(manager->allThreads.count() % cpus.size()) });
+    } else {
+        setCpuAffinity(manager->threadCpuAffinity);
+        setNumaNode(manager->threadNumaNode);
+    }
 }
 
 /*
@@ -81,6 +115,7 @@ QThreadPoolThread::QThreadPoolThread(QThreadPoolPrivate *manager)
 */
 void QThreadPoolThread::run()
 {
+    currentPoolThread = this;
     QMutexLocker locker(&manager->mutex);
     for(;;) {
         QRunnable *r = runnable;
@@ -88,47 +123,46 @@ void QThreadPoolThread::run()
 
         do {
             if (r) {
-                const bool del = r->autoDelete();
-                Q_ASSERT(!del || r->ref == 1);
+                locker.unlock();
+                do {
+                    const bool del = r->autoDelete();
+                    Q_ASSERT(!del || r->ref == 1);
 
 
-                // run the task
-                locker.unlock();
+                    // run the task
 #ifndef QT_NO_EXCEPTIONS
-                try {
+                    try {
 #endif
-                    r->run();
+                        r->run();
 #ifndef QT_NO_EXCEPTIONS
-                } catch (...) {
-                    qWarning("Qt Concurrent has caught an exception thrown from a worker thread.\n"
-                             "This is not supported, exceptions thrown in worker threads must be\n"
-                             "caught before control returns to Qt Concurrent.");
-                    registerThreadInactive();
-                    throw;
-                }
+                    } catch (...) {
+                        qWarning("Qt Concurrent has caught an exception thrown from a worker thread.\n"
+                                 "This is not supported, exceptions thrown in worker threads must be\n"
+                                 "caught before control returns to Qt Concurrent.");
+                        registerThreadInactive();
+                        throw;
+                    }
 #endif
 
-                if (del)
-                    delete r;
+                    if (del)
+                        delete r;
+
+                    // tasks of the default priority can be taken without the
+                    // mutex, unless there are more important ones waiting
+                } while (!manager->highPriorityTaskCount.loadAcquire()
+                         && !manager->checkThreadCount.loadAcquire()
+                         && (r = manager->takeShardedTask(shard)));
                 locker.relock();
             }
 
             // if too many threads are active, expire this thread
             if (manager->tooManyThreadsActive())
                 break;
+            manager->checkThreadCount.storeRelaxed(0);
 
-            if (manager->queue.isEmpty()) {
-                r = nullptr;
+            r = manager->takeNextTask(shard);
+            if (!r)
                 break;
-            }
-
-            QueuePage *page = manager->queue.first();
-            r = page->pop();
-
-            if (page->isFinished()) {
-                manager->queue.removeFirst();
-                delete page;
-            }
         } while (true);
 
         // if too many threads are active, expire this thread
@@ -165,6 +199,8 @@ void QThreadPoolThread::registerThreadInactive()
     \internal
 */
 QThreadPoolPrivate:: QThreadPoolPrivate()
+    : shardCount(defaultShardCount()),
+      shards(new QueueShard[shardCount])
 { }
 
 bool QThreadPoolPrivate::tryStart(QRunnable *task)
@@ -195,7 +231,7 @@ bool QThreadPoolPrivate::tryStart(QRunnable *task)
         ++activeThreads;
 
         thread->runnable = task;
-        thread->start();
+        thread->start(threadPriority);
         return true;
     }
 
@@ -212,6 +248,24 @@ inline bool comparePriority(int priority, const QueuePage *p)
 void QThreadPoolPrivate::enqueueTask(QRunnable *runnable, int priority)
 {
     Q_ASSERT(runnable != nullptr);
+    if (priority == 0) {
+        // keep tasks queued by a pool thread with that thread, spread the
+        // ones from other threads evenly
+        int shard;
+        if (currentPoolThread && currentPoolThread->manager == this) {
+            shard = currentPoolThread->shard;
+        } else {
+            shard = nextShard;
+            nextShard = (nextShard + 1) % shardCount;
+        }
+        QMutexLocker locker(&shards[shard].mutex);
+        shards[shard].tasks.enqueue(runnable);
+        shardedTaskCount.ref();
+        return;
+    }
+
+    if (priority > 0)
+        highPriorityTaskCount.ref();
     for (QueuePage *page : qAsConst(queue)) {
         if (page->priority() == priority && !page->isFull()) {
             page->push(runnable);
@@ -230,21 +284,79 @@ int QThreadPoolPrivate::activeThreadCount() const
             + reservedThreads);
 }
 
-void QThreadPoolPrivate::tryToStartMoreThreads()
+/*!
+    \internal
+
+    Takes the first task of queue, which must not be empty. Must be called
+    with mutex locked.
+*/
+QRunnable *QThreadPoolPrivate::takeQueuedTask()
 {
-    // try to push tasks on the queue to any available threads
-    while (!queue.isEmpty()) {
-        QueuePage *page = queue.first();
-        if (!tryStart(page->first()))
-            break;
+    QueuePage *page = queue.first();
+    if (page->priority() > 0)
+        highPriorityTaskCount.deref();
+    QRunnable *runnable = page->pop();
+
+    if (page->isFinished()) {
+        queue.removeFirst();
+        delete page;
+    }
+    return runnable;
+}
 
-        page->pop();
+/*!
+    \internal
 
-        if (page->isFinished()) {
-            queue.removeFirst();
-            delete page;
+    Takes a task of the default priority, preferably from \a shard, or
+    returns \nullptr if there is none. Doesn't need mutex to be locked.
+*/
+QRunnable *QThreadPoolPrivate::takeShardedTask(int shard)
+{
+    if (!shardedTaskCount.loadAcquire())
+        return nullptr;
+    for (int i = 0; i < shardCount; ++i) {
+        QueueShard &candidate = shards[(shard + i) % shardCount];
+        QMutexLocker locker(&candidate.mutex);
+        if (!candidate.tasks.isEmpty()) {
+            shardedTaskCount.deref();
+            return candidate.tasks.dequeue();
         }
     }
+    return nullptr;
+}
+
+/*!
+    \internal
+
+    Takes the task that should run next, in priority order, or returns
+    \nullptr if there is none. Must be called with mutex locked.
+*/
+QRunnable *QThreadPoolPrivate::takeNextTask(int shard)
+{
+    if (!queue.isEmpty() && queue.first()->priority() > 0)
+        return takeQueuedTask();
+    if (QRunnable *runnable = takeShardedTask(shard))
+        return runnable;
+    if (!queue.isEmpty())
+        return takeQueuedTask();
+    return nullptr;
+}
+
+bool QThreadPoolPrivate::hasQueuedTasks() const
+{
+    return !queue.isEmpty() || shardedTaskCount.loadAcquire() != 0;
+}
+
+void QThreadPoolPrivate::tryToStartMoreThreads()
+{
+    // try to push tasks on the queue to any available threads
+    while (hasQueuedTasks() && (allThreads.isEmpty() || activeThreadCount() < maxThreadCount)) {
+        QRunnable *runnable = takeNextTask(0);
+        if (!runnable)
+            break;
+        // can't fail, we checked the thread count above
+        tryStart(runnable);
+    }
 }
 
 bool QThreadPoolPrivate::tooManyThreadsActive() const
@@ -266,7 +378,7 @@ void QThreadPoolPrivate::startThread(QRunnable *runnable)
     ++activeThreads;
 
     thread->runnable = runnable;
-    thread.take()->start();
+    thread.take()->start(threadPriority);
 }
 
 /*!
@@ -301,10 +413,10 @@ void QThreadPoolPrivate::reset()
 */
 bool QThreadPoolPrivate::waitForDone(const QDeadlineTimer &timer)
 {
-    while (!(queue.isEmpty() && activeThreads == 0) && !timer.hasExpired())
+    while (!(!hasQueuedTasks() && activeThreads == 0) && !timer.hasExpired())
         noActiveThreads.wait(&mutex, timer);
 
-    return queue.isEmpty() && activeThreads == 0;
+    return !hasQueuedTasks() && activeThreads == 0;
 }
 
 bool QThreadPoolPrivate::waitForDone(int msecs)
@@ -317,9 +429,9 @@ bool QThreadPoolPrivate::waitForDone(int msecs)
         reset();
         // More threads can be started during reset(), in that case continue
         // waiting if we still have time left.
-    } while ((!queue.isEmpty() || activeThreads) && !timer.hasExpired());
+    } while ((hasQueuedTasks() || activeThreads) && !timer.hasExpired());
 
-    return queue.isEmpty() && activeThreads == 0;
+    return !hasQueuedTasks() && activeThreads == 0;
 }
 
 void QThreadPoolPrivate::clear()
@@ -338,6 +450,24 @@ void QThreadPoolPrivate::clear()
     }
     qDeleteAll(queue);
     queue.clear();
+    highPriorityTaskCount.storeRelaxed(0);
+
+    for (int i = 0; i < shardCount; ++i) {
+        QQueue<QRunnable *> tasks;
+        {
+            QMutexLocker shardLocker(&shards[i].mutex);
+            tasks.swap(shards[i].tasks);
+            shardedTaskCount.fetchAndSubRelaxed(tasks.size());
+        }
+        for (QRunnable *r : qAsConst(tasks)) {
+            if (r->autoDelete()) {
+                Q_ASSERT(r->ref == 1);
+                locker.unlock();
+                delete r;
+                locker.relock();
+            }
+        }
+    }
 }
 
 /*!
@@ -365,21 +495,34 @@ bool QThreadPool::tryTake(QRunnable *runnable)
         return false;
 
     QMutexLocker locker(&d->mutex);
+    bool found = false;
     for (QueuePage *page : qAsConst(d->queue)) {
         if (page->tryTake(runnable)) {
+            if (page->priority() > 0)
+                d->highPriorityTaskCount.deref();
             if (page->isFinished()) {
                 d->queue.removeOne(page);
                 delete page;
             }
-            if (runnable->autoDelete()) {
-                Q_ASSERT(runnable->ref == 1);
-                --runnable->ref; // undo ++ref in start()
-            }
-            return true;
+            found = true;
+            break;
         }
     }
+    for (int i = 0; !found && i < d->shardCount; ++i) {
+        QMutexLocker shardLocker(&d->shards[i].mutex);
+        if (d->shards[i].tasks.removeOne(runnable)) {
+            d->shardedTaskCount.deref();
+            found = true;
+        }
+    }
+    if (!found)
+        return false;
 
-    return false;
+    if (runnable->autoDelete()) {
+        Q_ASSERT(runnable->ref == 1);
+        --runnable->ref; // undo ++ref in start()
+    }
+    return true;
 }
 
     /*!
@@ -657,6 +800,7 @@ void QThreadPool::setMaxThreadCount(int maxThreadCount)
         return;
 
     d->maxThreadCount = maxThreadCount;
+    d->checkThreadCount.storeRelease(1);
     d->tryToStartMoreThreads();
 }
 
@@ -694,6 +838,7 @@ void QThreadPool::reserveThread()
     Q_D(QThreadPool);
     QMutexLocker locker(&d->mutex);
     ++d->reservedThreads;
+    d->checkThreadCount.storeRelease(1);
 }
 
 /*! \property QThreadPool::stackSize
@@ -722,6 +867,187 @@ uint QThreadPool::stackSize() const
     return d->stackSize;
 }
 
+/*!
+    \since 5.15.1
+
+    Sets the priority the thread pool starts new worker threads with to
+    \a priority. The default, QThread::InheritPriority, makes them inherit
+    the priority of the thread that creates them.
+
+    Like all the thread policies of the pool, the value is only used when
+    the thread pool creates new threads. Changing it has no effect for
+    already created or running threads.
+
+    \sa threadPriority(), QThread::start()
+*/
+void QThreadPool::setThreadPriority(QThread::Priority priority)
+{
+    Q_D(QThreadPool);
+    QMutexLocker locker(&d->mutex);
+    d->threadPriority = priority;
+}
+
+/*!
+    \since 5.15.1
+
+    Returns the priority new worker threads are started with.
+
+    \sa setThreadPriority()
+*/
+QThread::Priority QThreadPool::threadPriority() const
+{
+    Q_D(const QThreadPool);
+    QMutexLocker locker(&d->mutex);
+    return d->threadPriority;
+}
+
+/*!
+    \since 5.15.1
+
+    Sets the scheduling class of new worker threads to \a policy.
+
+    \sa threadSchedulingPolicy(), QThread::setSchedulingPolicy()
+*/
+void QThreadPool::setThreadSchedulingPolicy(QThread::SchedulingPolicy policy)
+{
+    Q_D(QThreadPool);
+    QMutexLocker locker(&d->mutex);
+    d->threadSchedulingPolicy = policy;
+}
+
+/*!
+    \since 5.15.1
+
+    Returns the scheduling class of new worker threads.
+
+    \sa setThreadSchedulingPolicy()
+*/
+QThread::SchedulingPolicy QThreadPool::threadSchedulingPolicy() const
+{
+    Q_D(const QThreadPool);
+    QMutexLocker locker(&d->mutex);
+    return d->threadSchedulingPolicy;
+}
+
+/*!
+    \since 5.15.1
+
+    Sets the nice value of new worker threads to \a niceValue.
+
+    \sa threadNiceValue(), QThread::setNiceValue()
+*/
+void QThreadPool::setThreadNiceValue(int niceValue)
+{
+    Q_D(QThreadPool);
+    QMutexLocker locker(&d->mutex);
+    d->threadNiceValue = qBound(-20, niceValue, 19);
+    d->threadNiceValueSet = true;
+}
+
+/*!
+    \since 5.15.1
+
+    Returns the nice value of new worker threads, or 0 if none was set.
+
+    \sa setThreadNiceValue()
+*/
+int QThreadPool::threadNiceValue() const
+{
+    Q_D(const QThreadPool);
+    QMutexLocker locker(&d->mutex);
+    return d->threadNiceValue;
+}
+
+/*!
+    \since 5.15.1
+
+    Restricts new worker threads to the CPUs listed in \a cpus. An empty
+    list lifts the restriction.
+
+    \sa threadCpuAffinity(), setThreadPinning(), QThread::setCpuAffinity()
+*/
+void QThreadPool::setThreadCpuAffinity(const QVector<int> &cpus)
+{
+    Q_D(QThreadPool);
+    QMutexLocker locker(&d->mutex);
+    d->threadCpuAffinity = cpus;
+}
+
+/*!
+    \since 5.15.1
+
+    Returns the CPUs new worker threads are restricted to.
+
+    \sa setThreadCpuAffinity()
+*/
+QVector<int> QThreadPool::threadCpuAffinity() const
+{
+    Q_D(const QThreadPool);
+    QMutexLocker locker(&d->mutex);
+    return d->threadCpuAffinity;
+}
+
+/*!
+    \since 5.15.1
+
+    Restricts new worker threads to the CPUs of the NUMA node \a node. A
+    negative value lifts the restriction.
+
+    \sa threadNumaNode(), QThread::setNumaNode()
+*/
+void QThreadPool::setThreadNumaNode(int node)
+{
+    Q_D(QThreadPool);
+    QMutexLocker locker(&d->mutex);
+    d->threadNumaNode = qMax(-1, node);
+}
+
+/*!
+    \since 5.15.1
+
+    Returns the NUMA node new worker threads are restricted to, or -1.
+
+    \sa setThreadNumaNode()
+*/
+int QThreadPool::threadNumaNode() const
+{
+    Q_D(const QThreadPool);
+    QMutexLocker locker(&d->mutex);
+    return d->threadNumaNode;
+}
+
+/*!
+    \since 5.15.1
+
+    If \a enabled is true, each new worker thread is pinned to a single CPU
+    out of the ones allowed by threadCpuAffinity() and threadNumaNode(),
+    going round-robin over them as threads are created. This keeps a
+    thread's working set in the caches of one CPU, at the price of the
+    scheduler no longer being able to move threads to idle CPUs.
+
+    \sa threadPinning(), setThreadCpuAffinity()
+*/
+void QThreadPool::setThreadPinning(bool enabled)
+{
+    Q_D(QThreadPool);
+    QMutexLocker locker(&d->mutex);
+    d->threadPinning = enabled;
+}
+
+/*!
+    \since 5.15.1
+
+    Returns whether new worker threads are pinned to single CPUs.
+
+    \sa setThreadPinning()
+*/
+bool QThreadPool::threadPinning() const
+{
+    Q_D(const QThreadPool);
+    QMutexLocker locker(&d->mutex);
+    return d->threadPinning;
+}
+
 /*!
     Releases a thread previously reserved by a call to reserveThread().
 
@@ -86,6 +86,24 @@ public:
     void setStackSize(uint stackSize);
     uint stackSize() const;
 
+    void setThreadPriority(QThread::Priority priority);
+    QThread::Priority threadPriority() const;
+
+    void setThreadSchedulingPolicy(QThread::SchedulingPolicy policy);
+    QThread::SchedulingPolicy threadSchedulingPolicy() const;
+
+    void setThreadNiceValue(int niceValue);
+    int threadNiceValue() const;
+
+    void setThreadCpuAffinity(const QVector<int> &cpus);
+    QVector<int> threadCpuAffinity() const;
+
+    void setThreadNumaNode(int node);
+    int threadNumaNode() const;
+
+    void setThreadPinning(bool enabled);
+    bool threadPinning() const;
+
     void reserveThread();
     void releaseThread();
 
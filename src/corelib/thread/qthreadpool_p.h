@@ -59,6 +59,8 @@
 #include "QtCore/qqueue.h"
 #include "private/qobject_p.h"
 
+#include <memory>
+
 QT_REQUIRE_CONFIG(thread);
 
 QT_BEGIN_NAMESPACE
@@ -146,6 +148,14 @@ private:
     QRunnable *m_entries[MaxPageSize];
 };
 
+// A queue of tasks of the default priority. Each pool thread takes tasks
+// from its own queue first, and steals from the others when it runs dry.
+struct alignas(64) QueueShard
+{
+    QMutex mutex;
+    QQueue<QRunnable *> tasks;
+};
+
 class QThreadPoolThread;
 class Q_CORE_EXPORT QThreadPoolPrivate : public QObjectPrivate
 {
@@ -159,6 +169,11 @@ public:
     void enqueueTask(QRunnable *task, int priority = 0);
     int activeThreadCount() const;
 
+    QRunnable *takeQueuedTask();
+    QRunnable *takeShardedTask(int shard);
+    QRunnable *takeNextTask(int shard);
+    bool hasQueuedTasks() const;
+
     void tryToStartMoreThreads();
     bool tooManyThreadsActive() const;
 
@@ -177,11 +192,32 @@ public:
     QVector<QueuePage*> queue;
     QWaitCondition noActiveThreads;
 
+    // tasks of the default priority don't go into queue, but into shards,
+    // which pool threads access without locking mutex
+    const int shardCount;
+    std::unique_ptr<QueueShard[]> shards;
+    QAtomicInt shardedTaskCount;
+    int nextShard = 0;
+    // tasks in queue that take precedence over the ones in shards
+    QAtomicInt highPriorityTaskCount;
+    // set when the pool might have too many threads, which pool threads
+    // can only find out with mutex locked
+    QAtomicInt checkThreadCount;
+
     int expiryTimeout = 30000;
     int maxThreadCount = QThread::idealThreadCount();
     int reservedThreads = 0;
     int activeThreads = 0;
     uint stackSize = 0;
+
+    // applied to the threads the pool creates
+    QThread::Priority threadPriority = QThread::InheritPriority;
+    QThread::SchedulingPolicy threadSchedulingPolicy = QThread::InheritSchedulingPolicy;
+    int threadNiceValue = 0;
+    bool threadNiceValueSet = false;
+    QVector<int> threadCpuAffinity;
+    int threadNumaNode = -1;
+    bool threadPinning = false;
 };
 
 QT_END_NAMESPACE
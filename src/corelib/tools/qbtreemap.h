@@ -0,0 +1,890 @@
+/****************************************************************************
+**
+** Copyright (C) 2020 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtCore module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef QBTREEMAP_H
+#define QBTREEMAP_H
+
+#include <QtCore/qcontainerfwd.h>
+#include <QtCore/qglobal.h>
+#include <QtCore/qlist.h>
+#include <QtCore/qshareddata.h>
+
+#include <algorithm>
+#include <initializer_list>
+#include <iterator>
+#include <map>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+QT_BEGIN_NAMESPACE
+
+
+template <class Key, class T>
+class QBTreeMap
+{
+    // A B+ tree: internal nodes only hold separator keys, all items live in
+    // the leaves, which are linked to each other in key order.
+    enum {
+        LeafCapacity = (sizeof(Key) + sizeof(T)) * 64 <= 512 ? 64
+                     : (sizeof(Key) + sizeof(T)) * 8 >= 512 ? 8
+                     : (512 / (sizeof(Key) + sizeof(T))) & ~1,
+        InternalCapacity = 32 // separator keys; one child more than that
+    };
+
+    struct Node
+    {
+        explicit Node(bool isLeaf) noexcept : count(0), leaf(isLeaf) { }
+        int count;
+        bool leaf;
+    };
+
+    template <typename V, int Capacity>
+    struct Storage
+    {
+        typename std::aligned_storage<sizeof(V), alignof(V)>::type data[Capacity];
+        V *ptr() noexcept { return reinterpret_cast<V *>(data); }
+        const V *ptr() const noexcept { return reinterpret_cast<const V *>(data); }
+    };
+
+    struct Leaf : Node
+    {
+        Leaf() noexcept : Node(true), prev(nullptr), next(nullptr) { }
+        Key *keys() noexcept { return keyStorage.ptr(); }
+        const Key *keys() const noexcept { return keyStorage.ptr(); }
+        T *values() noexcept { return valueStorage.ptr(); }
+        const T *values() const noexcept { return valueStorage.ptr(); }
+
+        Leaf *prev;
+        Leaf *next;
+        Storage<Key, LeafCapacity> keyStorage;
+        Storage<T, LeafCapacity> valueStorage;
+    };
+
+    struct Internal : Node
+    {
+        Internal() noexcept : Node(false) { }
+        Key *keys() noexcept { return keyStorage.ptr(); }
+        const Key *keys() const noexcept { return keyStorage.ptr(); }
+
+        // children[i] holds the keys in [keys[i - 1], keys[i])
+        Node *children[InternalCapacity + 1];
+        Storage<Key, InternalCapacity> keyStorage;
+    };
+
+    struct Data : public QSharedData
+    {
+        Data() noexcept : root(nullptr), first(nullptr), last(nullptr), size(0) { }
+        Data(const Data &other)
+            : QSharedData(), root(nullptr), first(nullptr), last(nullptr), size(other.size)
+        {
+            if (other.root)
+                root = cloneNode(other.root, &last);
+            first = leftmostLeaf(root);
+        }
+        ~Data() { destroyNode(root); }
+
+        Node *root;
+        Leaf *first;
+        Leaf *last;
+        int size;
+
+    private:
+        Data &operator=(const Data &) = delete;
+    };
+
+public:
+    inline QBTreeMap() noexcept { }
+    QBTreeMap(std::initializer_list<std::pair<Key, T> > list)
+    {
+        for (typename std::initializer_list<std::pair<Key, T> >::const_iterator it = list.begin(); it != list.end(); ++it)
+            insert(it->first, it->second);
+    }
+    explicit QBTreeMap(const std::map<Key, T> &other)
+    { *this = fromSortedRange(other.begin(), other.end()); }
+    QBTreeMap(const QBTreeMap &other) noexcept : d(other.d) { }
+    QBTreeMap(QBTreeMap &&other) noexcept : d(std::move(other.d)) { }
+    ~QBTreeMap() { }
+
+    QBTreeMap &operator=(const QBTreeMap &other) noexcept { d = other.d; return *this; }
+    QBTreeMap &operator=(QBTreeMap &&other) noexcept { d.swap(other.d); return *this; }
+    inline void swap(QBTreeMap &other) noexcept { d.swap(other.d); }
+
+    template <typename InputIterator>
+    static QBTreeMap fromSortedRange(InputIterator first, InputIterator last);
+    std::map<Key, T> toStdMap() const;
+
+    bool operator==(const QBTreeMap &other) const;
+    inline bool operator!=(const QBTreeMap &other) const { return !(*this == other); }
+
+    inline int size() const noexcept { return d ? d->size : 0; }
+    inline int count() const noexcept { return size(); }
+    inline bool isEmpty() const noexcept { return size() == 0; }
+
+    inline void detach() { if (d) d.detach(); else d = new Data; }
+    inline bool isDetached() const noexcept { return !d || d->ref.loadRelaxed() == 1; }
+    inline bool isSharedWith(const QBTreeMap &other) const noexcept { return d == other.d; }
+
+    void clear() { d.reset(); }
+
+    int remove(const Key &key);
+    T take(const Key &key);
+
+    bool contains(const Key &key) const { return findLeaf(key).first != nullptr; }
+    const Key key(const T &value, const Key &defaultKey = Key()) const;
+    const T value(const Key &key, const T &defaultValue = T()) const;
+    T &operator[](const Key &key);
+    const T operator[](const Key &key) const { return value(key); }
+
+    QList<Key> keys() const;
+    QList<T> values() const;
+
+    class const_iterator;
+
+    class iterator
+    {
+        friend class QBTreeMap;
+        friend class const_iterator;
+
+        Leaf *l;
+        int i;
+
+        iterator(Leaf *leaf, int index) noexcept : l(leaf), i(index) { }
+
+    public:
+        typedef std::bidirectional_iterator_tag iterator_category;
+        typedef qptrdiff difference_type;
+        typedef T value_type;
+        typedef T *pointer;
+        typedef T &reference;
+
+        constexpr iterator() noexcept : l(nullptr), i(0) { }
+
+        inline const Key &key() const noexcept { return l->keys()[i]; }
+        inline T &value() const noexcept { return l->values()[i]; }
+        inline T &operator*() const noexcept { return l->values()[i]; }
+        inline T *operator->() const noexcept { return &l->values()[i]; }
+        inline bool operator==(const iterator &o) const noexcept { return l == o.l && i == o.i; }
+        inline bool operator!=(const iterator &o) const noexcept { return !(*this == o); }
+        inline bool operator==(const const_iterator &o) const noexcept { return l == o.l && i == o.i; }
+        inline bool operator!=(const const_iterator &o) const noexcept { return !(*this == o); }
+
+        inline iterator &operator++() noexcept { stepForward(l, i); return *this; }
+        inline iterator operator++(int) noexcept { iterator r = *this; stepForward(l, i); return r; }
+        inline iterator &operator--() noexcept { stepBack(l, i); return *this; }
+        inline iterator operator--(int) noexcept { iterator r = *this; stepBack(l, i); return r; }
+    };
+    friend class iterator;
+
+    class const_iterator
+    {
+        friend class QBTreeMap;
+        friend class iterator;
+
+        const Leaf *l;
+        int i;
+
+        const_iterator(const Leaf *leaf, int index) noexcept : l(leaf), i(index) { }
+
+    public:
+        typedef std::bidirectional_iterator_tag iterator_category;
+        typedef qptrdiff difference_type;
+        typedef T value_type;
+        typedef const T *pointer;
+        typedef const T &reference;
+
+        constexpr const_iterator() noexcept : l(nullptr), i(0) { }
+        inline const_iterator(const iterator &o) noexcept : l(o.l), i(o.i) { }
+
+        inline const Key &key() const noexcept { return l->keys()[i]; }
+        inline const T &value() const noexcept { return l->values()[i]; }
+        inline const T &operator*() const noexcept { return l->values()[i]; }
+        inline const T *operator->() const noexcept { return &l->values()[i]; }
+        inline bool operator==(const const_iterator &o) const noexcept { return l == o.l && i == o.i; }
+        inline bool operator!=(const const_iterator &o) const noexcept { return !(*this == o); }
+
+        inline const_iterator &operator++() noexcept { stepForward(l, i); return *this; }
+        inline const_iterator operator++(int) noexcept { const_iterator r = *this; stepForward(l, i); return r; }
+        inline const_iterator &operator--() noexcept { stepBack(l, i); return *this; }
+        inline const_iterator operator--(int) noexcept { const_iterator r = *this; stepBack(l, i); return r; }
+    };
+    friend class const_iterator;
+
+    inline iterator begin() { detach(); return iterator(d->first, 0); }
+    inline const_iterator begin() const noexcept { return constBegin(); }
+    inline const_iterator cbegin() const noexcept { return constBegin(); }
+    inline const_iterator constBegin() const noexcept { return d ? const_iterator(d->first, 0) : const_iterator(); }
+    inline iterator end() { detach(); return iterator(d->last, d->last ? d->last->count : 0); }
+    inline const_iterator end() const noexcept { return constEnd(); }
+    inline const_iterator cend() const noexcept { return constEnd(); }
+    inline const_iterator constEnd() const noexcept
+    { return d && d->last ? const_iterator(d->last, d->last->count) : const_iterator(); }
+
+    const Key &firstKey() const { Q_ASSERT(!isEmpty()); return constBegin().key(); }
+    const Key &lastKey() const { Q_ASSERT(!isEmpty()); return (--constEnd()).key(); }
+    T &first() { Q_ASSERT(!isEmpty()); return *begin(); }
+    const T &first() const { Q_ASSERT(!isEmpty()); return *constBegin(); }
+    T &last() { Q_ASSERT(!isEmpty()); return *(--end()); }
+    const T &last() const { Q_ASSERT(!isEmpty()); return *(--constEnd()); }
+
+    iterator erase(iterator it);
+    iterator find(const Key &key);
+    const_iterator find(const Key &key) const { return constFind(key); }
+    const_iterator constFind(const Key &key) const;
+    iterator lowerBound(const Key &key);
+    const_iterator lowerBound(const Key &key) const;
+    iterator upperBound(const Key &key);
+    const_iterator upperBound(const Key &key) const;
+    iterator insert(const Key &key, const T &value);
+
+    // STL compatibility
+    typedef Key key_type;
+    typedef T mapped_type;
+    typedef qptrdiff difference_type;
+    typedef int size_type;
+    inline bool empty() const noexcept { return isEmpty(); }
+
+private:
+    template <typename L>
+    static void stepForward(L *&leaf, int &index) noexcept
+    {
+        if (++index == leaf->count && leaf->next) {
+            leaf = leaf->next;
+            index = 0;
+        }
+    }
+    template <typename L>
+    static void stepBack(L *&leaf, int &index) noexcept
+    {
+        if (index == 0) {
+            leaf = leaf->prev;
+            index = leaf->count;
+        }
+        --index;
+    }
+
+    // Helpers for the arrays in the nodes, whose elements past count are
+    // not constructed
+    template <typename V, typename A>
+    static void insertAt(V *array, int count, int pos, A &&value)
+    {
+        if (pos == count) {
+            new (array + pos) V(std::forward<A>(value));
+            return;
+        }
+        new (array + count) V(std::move(array[count - 1]));
+        for (int j = count - 1; j > pos; --j)
+            array[j] = std::move(array[j - 1]);
+        array[pos] = std::forward<A>(value);
+    }
+    template <typename V>
+    static void removeAt(V *array, int count, int pos)
+    {
+        for (int j = pos; j < count - 1; ++j)
+            array[j] = std::move(array[j + 1]);
+        array[count - 1].~V();
+    }
+    // moves n elements into uninitialized memory
+    template <typename V>
+    static void moveConstruct(V *to, V *from, int n)
+    {
+        for (int j = 0; j < n; ++j) {
+            new (to + j) V(std::move(from[j]));
+            from[j].~V();
+        }
+    }
+    template <typename V>
+    static void destroyRange(V *array, int n) noexcept
+    {
+        if (!std::is_trivially_destructible<V>::value) {
+            for (int j = 0; j < n; ++j)
+                array[j].~V();
+        }
+    }
+
+    static Node *cloneNode(const Node *node, Leaf **lastLeaf);
+    static void destroyNode(Node *node) noexcept;
+    static Leaf *leftmostLeaf(Node *node) noexcept
+    {
+        while (node && !node->leaf)
+            node = static_cast<Internal *>(node)->children[0];
+        return static_cast<Leaf *>(node);
+    }
+    static int childIndex(const Internal *node, const Key &key)
+    { return int(std::upper_bound(node->keys(), node->keys() + node->count, key) - node->keys()); }
+
+    // the leaf that would contain key, and the index of the first key in
+    // it that is not less than key
+    std::pair<Leaf *, int> lowerBoundInLeaf(const Key &key) const;
+    std::pair<Leaf *, int> findLeaf(const Key &key) const;
+
+    void splitChild(Internal *parent, int index);
+    bool removeFrom(Node *node, const Key &key);
+    void rebalanceChild(Internal *parent, int index);
+
+    QExplicitlySharedDataPointer<Data> d;
+};
+
+template <class Key, class T>
+typename QBTreeMap<Key, T>::Node *QBTreeMap<Key, T>::cloneNode(const Node *node, Leaf **lastLeaf)
+{
+    if (node->leaf) {
+        const Leaf *leaf = static_cast<const Leaf *>(node);
+        Leaf *copy = new Leaf;
+        for (int j = 0; j < leaf->count; ++j) {
+            new (copy->keys() + j) Key(leaf->keys()[j]);
+            new (copy->values() + j) T(leaf->values()[j]);
+            copy->count = j + 1;
+        }
+        // leaves are cloned in order, so link to the previous one
+        copy->prev = *lastLeaf;
+        if (*lastLeaf)
+            (*lastLeaf)->next = copy;
+        *lastLeaf = copy;
+        return copy;
+    }
+    const Internal *internal = static_cast<const Internal *>(node);
+    Internal *copy = new Internal;
+    copy->children[0] = cloneNode(internal->children[0], lastLeaf);
+    for (int j = 0; j < internal->count; ++j) {
+        new (copy->keys() + j) Key(internal->keys()[j]);
+        copy->children[j + 1] = cloneNode(internal->children[j + 1], lastLeaf);
+        copy->count = j + 1;
+    }
+    return copy;
+}
+
+template <class Key, class T>
+void QBTreeMap<Key, T>::destroyNode(Node *node) noexcept
+{
+    if (!node)
+        return;
+    if (node->leaf) {
+        Leaf *leaf = static_cast<Leaf *>(node);
+        destroyRange(leaf->keys(), leaf->count);
+        destroyRange(leaf->values(), leaf->count);
+        delete leaf;
+        return;
+    }
+    Internal *internal = static_cast<Internal *>(node);
+    for (int j = 0; j <= internal->count; ++j)
+        destroyNode(internal->children[j]);
+    destroyRange(internal->keys(), internal->count);
+    delete internal;
+}
+
+template <class Key, class T>
+template <typename InputIterator>
+QBTreeMap<Key, T> QBTreeMap<Key, T>::fromSortedRange(InputIterator first, InputIterator last)
+{
+    // Fills the leaves from left to right, then builds each level of
+    // internal nodes on top of the previous one. Nodes are filled to three
+    // quarters, leaving room for later insertions.
+    QBTreeMap map;
+    if (first == last)
+        return map;
+    map.d = new Data;
+    Data *d = map.d.data();
+
+    const int leafFill = LeafCapacity - LeafCapacity / 4;
+    QList<Node *> level;
+    QList<Key> separators; // first key of each node in level
+    Leaf *leaf = nullptr;
+    for (; first != last; ++first) {
+        if (leaf && leaf->count && !(leaf->keys()[leaf->count - 1] < first->first)) {
+            Q_ASSERT_X(!(first->first < leaf->keys()[leaf->count - 1]),
+                       "QBTreeMap::fromSortedRange", "The range is not sorted");
+            leaf->values()[leaf->count - 1] = first->second; // same key: the last one wins
+            continue;
+        }
+        if (!leaf || leaf->count == leafFill) {
+            Leaf *next = new Leaf;
+            next->prev = leaf;
+            if (leaf)
+                leaf->next = next;
+            else
+                d->first = next;
+            leaf = next;
+            level.append(leaf);
+            separators.append(first->first);
+        }
+        new (leaf->keys() + leaf->count) Key(first->first);
+        new (leaf->values() + leaf->count) T(first->second);
+        ++leaf->count;
+        ++d->size;
+    }
+    d->last = leaf;
+
+    const int internalFill = InternalCapacity - InternalCapacity / 4;
+    while (level.size() > 1) {
+        QList<Node *> parents;
+        QList<Key> parentSeparators;
+        int j = 0;
+        while (j < level.size()) {
+            // don't leave a last node with a single child
+            int children = qMin(internalFill + 1, level.size() - j);
+            if (level.size() - j - children == 1)
+                --children;
+            Internal *node = new Internal;
+            node->children[0] = level.at(j);
+            for (int c = 1; c < children; ++c) {
+                new (node->keys() + c - 1) Key(separators.at(j + c));
+                node->children[c] = level.at(j + c);
+                node->count = c;
+            }
+            parents.append(node);
+            parentSeparators.append(separators.at(j));
+            j += children;
+        }
+        level.swap(parents);
+        separators.swap(parentSeparators);
+    }
+    d->root = level.first();
+    return map;
+}
+
+template <class Key, class T>
+std::map<Key, T> QBTreeMap<Key, T>::toStdMap() const
+{
+    std::map<Key, T> map;
+    for (const_iterator it = constBegin(); it != constEnd(); ++it)
+        map.insert(map.end(), std::pair<const Key, T>(it.key(), it.value()));
+    return map;
+}
+
+template <class Key, class T>
+bool QBTreeMap<Key, T>::operator==(const QBTreeMap &other) const
+{
+    if (size() != other.size())
+        return false;
+    if (d == other.d)
+        return true;
+    const_iterator it1 = constBegin();
+    const_iterator it2 = other.constBegin();
+    while (it1 != constEnd()) {
+        if (!(it1.value() == it2.value()) || it1.key() < it2.key() || it2.key() < it1.key())
+            return false;
+        ++it1;
+        ++it2;
+    }
+    return true;
+}
+
+template <class Key, class T>
+std::pair<typename QBTreeMap<Key, T>::Leaf *, int> QBTreeMap<Key, T>::lowerBoundInLeaf(const Key &key) const
+{
+    Node *node = d ? d->root : nullptr;
+    if (!node)
+        return std::make_pair(static_cast<Leaf *>(nullptr), 0);
+    while (!node->leaf) {
+        const Internal *internal = static_cast<const Internal *>(node);
+        node = internal->children[childIndex(internal, key)];
+    }
+    Leaf *leaf = static_cast<Leaf *>(node);
+    return std::make_pair(leaf, int(std::lower_bound(leaf->keys(), leaf->keys() + leaf->count, key) - leaf->keys()));
+}
+
+template <class Key, class T>
+std::pair<typename QBTreeMap<Key, T>::Leaf *, int> QBTreeMap<Key, T>::findLeaf(const Key &key) const
+{
+    const std::pair<Leaf *, int> pos = lowerBoundInLeaf(key);
+    if (!pos.first || pos.second == pos.first->count || key < pos.first->keys()[pos.second])
+        return std::make_pair(static_cast<Leaf *>(nullptr), 0);
+    return pos;
+}
+
+template <class Key, class T>
+typename QBTreeMap<Key, T>::const_iterator QBTreeMap<Key, T>::constFind(const Key &key) const
+{
+    const std::pair<Leaf *, int> pos = findLeaf(key);
+    return pos.first ? const_iterator(pos.first, pos.second) : constEnd();
+}
+
+template <class Key, class T>
+typename QBTreeMap<Key, T>::iterator QBTreeMap<Key, T>::find(const Key &key)
+{
+    detach();
+    const std::pair<Leaf *, int> pos = findLeaf(key);
+    return pos.first ? iterator(pos.first, pos.second) : end();
+}
+
+template <class Key, class T>
+typename QBTreeMap<Key, T>::const_iterator QBTreeMap<Key, T>::lowerBound(const Key &key) const
+{
+    std::pair<Leaf *, int> pos = lowerBoundInLeaf(key);
+    if (!pos.first)
+        return constEnd();
+    // the key may be past the last key of its leaf
+    if (pos.second == pos.first->count && pos.first->next)
+        return const_iterator(pos.first->next, 0);
+    return const_iterator(pos.first, pos.second);
+}
+
+template <class Key, class T>
+typename QBTreeMap<Key, T>::iterator QBTreeMap<Key, T>::lowerBound(const Key &key)
+{
+    detach();
+    const const_iterator it = qAsConst(*this).lowerBound(key);
+    return iterator(const_cast<Leaf *>(it.l), it.i);
+}
+
+template <class Key, class T>
+typename QBTreeMap<Key, T>::const_iterator QBTreeMap<Key, T>::upperBound(const Key &key) const
+{
+    const_iterator it = lowerBound(key);
+    if (it != constEnd() && !(key < it.key()))
+        ++it;
+    return it;
+}
+
+template <class Key, class T>
+typename QBTreeMap<Key, T>::iterator QBTreeMap<Key, T>::upperBound(const Key &key)
+{
+    detach();
+    const const_iterator it = qAsConst(*this).upperBound(key);
+    return iterator(const_cast<Leaf *>(it.l), it.i);
+}
+
+template <class Key, class T>
+const T QBTreeMap<Key, T>::value(const Key &key, const T &defaultValue) const
+{
+    const std::pair<Leaf *, int> pos = findLeaf(key);
+    return pos.first ? pos.first->values()[pos.second] : defaultValue;
+}
+
+template <class Key, class T>
+const Key QBTreeMap<Key, T>::key(const T &value, const Key &defaultKey) const
+{
+    for (const_iterator it = constBegin(); it != constEnd(); ++it) {
+        if (it.value() == value)
+            return it.key();
+    }
+    return defaultKey;
+}
+
+template <class Key, class T>
+T &QBTreeMap<Key, T>::operator[](const Key &key)
+{
+    detach();
+    const std::pair<Leaf *, int> pos = findLeaf(key);
+    if (pos.first)
+        return pos.first->values()[pos.second];
+    return *insert(key, T());
+}
+
+// Splits the full child at index of parent, which is not full, in two
+template <class Key, class T>
+void QBTreeMap<Key, T>::splitChild(Internal *parent, int index)
+{
+    Node *child = parent->children[index];
+    Node *right;
+    if (child->leaf) {
+        Leaf *leaf = static_cast<Leaf *>(child);
+        Leaf *newLeaf = new Leaf;
+        const int keep = leaf->count / 2;
+        moveConstruct(newLeaf->keys(), leaf->keys() + keep, leaf->count - keep);
+        moveConstruct(newLeaf->values(), leaf->values() + keep, leaf->count - keep);
+        newLeaf->count = leaf->count - keep;
+        leaf->count = keep;
+
+        newLeaf->prev = leaf;
+        newLeaf->next = leaf->next;
+        if (leaf->next)
+            leaf->next->prev = newLeaf;
+        else
+            d->last = newLeaf;
+        leaf->next = newLeaf;
+
+        insertAt(parent->keys(), parent->count, index, newLeaf->keys()[0]);
+        right = newLeaf;
+    } else {
+        // the middle key moves up into the parent
+        Internal *internal = static_cast<Internal *>(child);
+        Internal *newInternal = new Internal;
+        const int middle = internal->count / 2;
+        const int moved = internal->count - middle - 1;
+        moveConstruct(newInternal->keys(), internal->keys() + middle + 1, moved);
+        for (int j = 0; j <= moved; ++j)
+            newInternal->children[j] = internal->children[middle + 1 + j];
+        newInternal->count = moved;
+
+        insertAt(parent->keys(), parent->count, index, std::move(internal->keys()[middle]));
+        internal->keys()[middle].~Key();
+        internal->count = middle;
+        right = newInternal;
+    }
+    for (int j = parent->count; j > index; --j)
+        parent->children[j + 1] = parent->children[j];
+    parent->children[index + 1] = right;
+    ++parent->count;
+}
+
+template <class Key, class T>
+typename QBTreeMap<Key, T>::iterator QBTreeMap<Key, T>::insert(const Key &key, const T &value)
+{
+    detach();
+    const std::pair<Leaf *, int> found = findLeaf(key);
+    if (found.first) {
+        found.first->values()[found.second] = value;
+        return iterator(found.first, found.second);
+    }
+
+    if (!d->root) {
+        Leaf *leaf = new Leaf;
+        d->root = d->first = d->last = leaf;
+    } else if (d->root->count == (d->root->leaf ? int(LeafCapacity) : int(InternalCapacity))) {
+        Internal *root = new Internal;
+        root->children[0] = d->root;
+        d->root = root;
+        splitChild(root, 0);
+    }
+
+    // Full nodes are split on the way down, so there is always room for
+    // the key that a split moves up.
+    Node *node = d->root;
+    while (!node->leaf) {
+        Internal *internal = static_cast<Internal *>(node);
+        int index = childIndex(internal, key);
+        Node *child = internal->children[index];
+        if (child->count == (child->leaf ? int(LeafCapacity) : int(InternalCapacity))) {
+            splitChild(internal, index);
+            if (!(key < internal->keys()[index]))
+                ++index;
+        }
+        node = internal->children[index];
+    }
+
+    Leaf *leaf = static_cast<Leaf *>(node);
+    const int pos = int(std::lower_bound(leaf->keys(), leaf->keys() + leaf->count, key) - leaf->keys());
+    insertAt(leaf->keys(), leaf->count, pos, key);
+    insertAt(leaf->values(), leaf->count, pos, value);
+    ++leaf->count;
+    ++d->size;
+    return iterator(leaf, pos);
+}
+
+// Fixes up the child at index of parent after it became too small, by
+// merging it with a sibling or, if they don't fit into one node, moving
+// one item over from the sibling.
+template <class Key, class T>
+void QBTreeMap<Key, T>::rebalanceChild(Internal *parent, int index)
+{
+    // work on the pair (left, right) = children (index - 1, index) or (index, index + 1)
+    const int leftIndex = index > 0 ? index - 1 : index;
+    Node *left = parent->children[leftIndex];
+    Node *right = parent->children[leftIndex + 1];
+    const bool childIsLeft = leftIndex == index;
+
+    if (left->leaf) {
+        Leaf *l = static_cast<Leaf *>(left);
+        Leaf *r = static_cast<Leaf *>(right);
+        if (l->count + r->count <= LeafCapacity) {
+            moveConstruct(l->keys() + l->count, r->keys(), r->count);
+            moveConstruct(l->values() + l->count, r->values(), r->count);
+            l->count += r->count;
+            r->count = 0;
+            l->next = r->next;
+            if (r->next)
+                r->next->prev = l;
+            else
+                d->last = l;
+            delete r;
+        } else {
+            if (childIsLeft) {
+                // move the first item of right to the end of left
+                insertAt(l->keys(), l->count, l->count, std::move(r->keys()[0]));
+                insertAt(l->values(), l->count, l->count, std::move(r->values()[0]));
+                ++l->count;
+                removeAt(r->keys(), r->count, 0);
+                removeAt(r->values(), r->count, 0);
+                --r->count;
+            } else {
+                // move the last item of left to the front of right
+                insertAt(r->keys(), r->count, 0, std::move(l->keys()[l->count - 1]));
+                insertAt(r->values(), r->count, 0, std::move(l->values()[l->count - 1]));
+                ++r->count;
+                --l->count;
+                l->keys()[l->count].~Key();
+                l->values()[l->count].~T();
+            }
+            parent->keys()[leftIndex] = r->keys()[0];
+            return;
+        }
+    } else {
+        Internal *l = static_cast<Internal *>(left);
+        Internal *r = static_cast<Internal *>(right);
+        if (l->count + r->count + 1 <= InternalCapacity) {
+            // the separator comes down between the keys of left and right
+            new (l->keys() + l->count) Key(std::move(parent->keys()[leftIndex]));
+            moveConstruct(l->keys() + l->count + 1, r->keys(), r->count);
+            for (int j = 0; j <= r->count; ++j)
+                l->children[l->count + 1 + j] = r->children[j];
+            l->count += r->count + 1;
+            r->count = 0;
+            delete r;
+        } else {
+            if (childIsLeft) {
+                new (l->keys() + l->count) Key(std::move(parent->keys()[leftIndex]));
+                l->children[l->count + 1] = r->children[0];
+                ++l->count;
+                parent->keys()[leftIndex] = std::move(r->keys()[0]);
+                removeAt(r->keys(), r->count, 0);
+                for (int j = 0; j < r->count; ++j)
+                    r->children[j] = r->children[j + 1];
+                --r->count;
+            } else {
+                insertAt(r->keys(), r->count, 0, std::move(parent->keys()[leftIndex]));
+                for (int j = r->count + 1; j > 0; --j)
+                    r->children[j] = r->children[j - 1];
+                r->children[0] = l->children[l->count];
+                ++r->count;
+                --l->count;
+                parent->keys()[leftIndex] = std::move(l->keys()[l->count]);
+                l->keys()[l->count].~Key();
+            }
+            return;
+        }
+    }
+
+    // right was merged into left: drop the separator and the child
+    removeAt(parent->keys(), parent->count, leftIndex);
+    for (int j = leftIndex + 1; j < parent->count; ++j)
+        parent->children[j] = parent->children[j + 1];
+    --parent->count;
+}
+
+// Returns whether node became less than half full
+template <class Key, class T>
+bool QBTreeMap<Key, T>::removeFrom(Node *node, const Key &key)
+{
+    if (node->leaf) {
+        Leaf *leaf = static_cast<Leaf *>(node);
+        const int pos = int(std::lower_bound(leaf->keys(), leaf->keys() + leaf->count, key) - leaf->keys());
+        Q_ASSERT(pos < leaf->count);
+        removeAt(leaf->keys(), leaf->count, pos);
+        removeAt(leaf->values(), leaf->count, pos);
+        --leaf->count;
+        return leaf->count < LeafCapacity / 2;
+    }
+    Internal *internal = static_cast<Internal *>(node);
+    const int index = childIndex(internal, key);
+    if (removeFrom(internal->children[index], key) && internal->count > 0)
+        rebalanceChild(internal, index);
+    return internal->count < InternalCapacity / 2;
+}
+
+template <class Key, class T>
+int QBTreeMap<Key, T>::remove(const Key &key)
+{
+    if (!contains(key))
+        return 0;
+    detach();
+    if (d->size == 1) {
+        d.reset();
+        return 1;
+    }
+    removeFrom(d->root, key);
+    --d->size;
+    // an internal root that is left with one child is not needed anymore
+    while (!d->root->leaf && d->root->count == 0) {
+        Internal *root = static_cast<Internal *>(d->root);
+        d->root = root->children[0];
+        delete root;
+    }
+    return 1;
+}
+
+template <class Key, class T>
+T QBTreeMap<Key, T>::take(const Key &key)
+{
+    const std::pair<Leaf *, int> pos = findLeaf(key);
+    if (!pos.first)
+        return T();
+    T t = isDetached() ? std::move(pos.first->values()[pos.second]) : pos.first->values()[pos.second];
+    remove(key);
+    return t;
+}
+
+template <class Key, class T>
+typename QBTreeMap<Key, T>::iterator QBTreeMap<Key, T>::erase(iterator it)
+{
+    Q_ASSERT_X(isDetached(), "QBTreeMap::erase", "The map must not be shared while erasing through an iterator");
+    if (it == end())
+        return it;
+    // removing may merge nodes, so look the next item up by its key
+    iterator next = it;
+    ++next;
+    if (next == end()) {
+        remove(Key(it.key()));
+        return end();
+    }
+    const Key nextKey = next.key();
+    remove(Key(it.key()));
+    return find(nextKey);
+}
+
+template <class Key, class T>
+QList<Key> QBTreeMap<Key, T>::keys() const
+{
+    QList<Key> res;
+    res.reserve(size());
+    for (const_iterator it = constBegin(); it != constEnd(); ++it)
+        res.append(it.key());
+    return res;
+}
+
+template <class Key, class T>
+QList<T> QBTreeMap<Key, T>::values() const
+{
+    QList<T> res;
+    res.reserve(size());
+    for (const_iterator it = constBegin(); it != constEnd(); ++it)
+        res.append(it.value());
+    return res;
+}
+
+template <class Key, class T>
+inline void swap(QBTreeMap<Key, T> &value1, QBTreeMap<Key, T> &value2) noexcept
+{
+    value1.swap(value2);
+}
+
+QT_END_NAMESPACE
+
+#endif // QBTREEMAP_H
@@ -45,7 +45,9 @@
 QT_BEGIN_NAMESPACE
 
 
+template <class Key, class T> class QBTreeMap;
 template <class Key, class T> class QCache;
+template <class Key, class T> class QFlatHash;
 template <class Key, class T> class QHash;
 #if !defined(QT_NO_LINKED_LIST) && QT_DEPRECATED_SINCE(5, 15)
 template <class T> class QLinkedList;
@@ -0,0 +1,627 @@
+/****************************************************************************
+**
+** Copyright (C) 2020 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtCore module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef QFLATHASH_H
+#define QFLATHASH_H
+
+#include <QtCore/qcontainerfwd.h>
+#include <QtCore/qglobal.h>
+#include <QtCore/qalgorithms.h>
+#include <QtCore/qhashfunctions.h>
+#include <QtCore/qlist.h>
+
+#include <cstddef>
+#include <initializer_list>
+#include <iterator>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <string.h>
+
+#if defined(__SSE2__)
+#  include <emmintrin.h>
+#endif
+
+QT_BEGIN_NAMESPACE
+
+
+namespace QtPrivate {
+
+// Each slot of a QFlatHash has a control byte. A full slot stores the low
+// seven bits of the hash of its key there; empty and deleted slots have the
+// high bit set.
+enum : qint8 {
+    FlatHashEmpty = -128,
+    FlatHashDeleted = -2
+};
+
+// A group of consecutive control bytes that are probed at once. The match
+// functions return a mask with one bit set for each matching byte, with
+// bit (index << Shift) belonging to the byte at index.
+struct QFlatHashGroup
+{
+#if defined(__SSE2__)
+    enum { Width = 16, Shift = 0 };
+
+    explicit QFlatHashGroup(const qint8 *ctrl) noexcept
+        : bytes(_mm_loadu_si128(reinterpret_cast<const __m128i *>(ctrl)))
+    { }
+
+    quint64 match(qint8 h2) const noexcept
+    { return quint64(uint(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(h2), bytes)))); }
+    quint64 matchEmpty() const noexcept
+    { return match(FlatHashEmpty); }
+    quint64 matchEmptyOrDeleted() const noexcept
+    { return quint64(uint(_mm_movemask_epi8(bytes))); }
+
+    __m128i bytes;
+#else
+    // Portable version, testing eight bytes at once in a 64-bit word
+    enum { Width = 8, Shift = 3 };
+
+    explicit QFlatHashGroup(const qint8 *ctrl) noexcept
+        : bytes(0)
+    {
+        // little-endian load, compilers turn this into a single one
+        for (int i = Width - 1; i >= 0; --i)
+            bytes = (bytes << 8) | quint8(ctrl[i]);
+    }
+
+    // May report a byte next to a real match as matching, which is fine
+    // as the caller compares the keys anyway.
+    quint64 match(qint8 h2) const noexcept
+    {
+        const quint64 x = bytes ^ (lsbs() * quint8(h2));
+        return (x - lsbs()) & ~x & msbs();
+    }
+    quint64 matchEmpty() const noexcept
+    { return bytes & ~(bytes << 6) & msbs(); }
+    quint64 matchEmptyOrDeleted() const noexcept
+    { return bytes & msbs(); }
+
+    static constexpr quint64 lsbs() noexcept { return Q_UINT64_C(0x0101010101010101); }
+    static constexpr quint64 msbs() noexcept { return Q_UINT64_C(0x8080808080808080); }
+
+    quint64 bytes;
+#endif
+
+    static int lowestIndex(quint64 mask) noexcept
+    { return int(qCountTrailingZeroBits(mask) >> Shift); }
+};
+
+} // namespace QtPrivate
+
+template <class Key, class T>
+class QFlatHash
+{
+    typedef QtPrivate::QFlatHashGroup Group;
+
+    struct Node
+    {
+        Node(const Key &k, const T &v) : key(k), value(v) { }
+        Node(Key &&k, T &&v) : key(std::move(k)), value(std::move(v)) { }
+
+        Key key;
+        T value;
+    };
+    Q_STATIC_ASSERT_X(alignof(Node) <= alignof(std::max_align_t), "QFlatHash does not support over-aligned types");
+
+public:
+    QFlatHash() noexcept
+        : m_ctrl(nullptr), m_nodes(nullptr), m_capacity(0), m_size(0), m_growthLeft(0),
+          m_seed(uint(qGlobalQHashSeed()))
+    { }
+    QFlatHash(std::initializer_list<std::pair<Key, T> > list)
+        : QFlatHash()
+    {
+        reserve(int(list.size()));
+        for (typename std::initializer_list<std::pair<Key, T> >::const_iterator it = list.begin(); it != list.end(); ++it)
+            insert(it->first, it->second);
+    }
+    QFlatHash(const QFlatHash &other);
+    QFlatHash(QFlatHash &&other) noexcept
+        : m_ctrl(other.m_ctrl), m_nodes(other.m_nodes), m_capacity(other.m_capacity),
+          m_size(other.m_size), m_growthLeft(other.m_growthLeft), m_seed(other.m_seed)
+    {
+        other.m_ctrl = nullptr;
+        other.m_nodes = nullptr;
+        other.m_capacity = other.m_size = other.m_growthLeft = 0;
+    }
+    ~QFlatHash() { freeTable(); }
+
+    QFlatHash &operator=(const QFlatHash &other)
+    {
+        if (this != &other) {
+            QFlatHash copy(other);
+            swap(copy);
+        }
+        return *this;
+    }
+    QFlatHash &operator=(QFlatHash &&other) noexcept
+    {
+        QFlatHash moved(std::move(other));
+        swap(moved);
+        return *this;
+    }
+
+    void swap(QFlatHash &other) noexcept
+    {
+        qSwap(m_ctrl, other.m_ctrl);
+        qSwap(m_nodes, other.m_nodes);
+        qSwap(m_capacity, other.m_capacity);
+        qSwap(m_size, other.m_size);
+        qSwap(m_growthLeft, other.m_growthLeft);
+        qSwap(m_seed, other.m_seed);
+    }
+
+    bool operator==(const QFlatHash &other) const;
+    bool operator!=(const QFlatHash &other) const { return !(*this == other); }
+
+    inline int size() const noexcept { return m_size; }
+    inline int count() const noexcept { return m_size; }
+    inline bool isEmpty() const noexcept { return m_size == 0; }
+    inline int capacity() const noexcept { return m_capacity; }
+
+    void reserve(int size);
+    void squeeze() { rehash(capacityFor(m_size)); }
+    void clear() { QFlatHash().swap(*this); }
+
+    inline bool contains(const Key &key) const { return findIndex(key) >= 0; }
+    T value(const Key &key) const;
+    T value(const Key &key, const T &defaultValue) const;
+    T &operator[](const Key &key);
+    const T operator[](const Key &key) const { return value(key); }
+    QList<Key> keys() const;
+    QList<T> values() const;
+
+    int remove(const Key &key);
+    T take(const Key &key);
+
+    class const_iterator;
+
+    class iterator
+    {
+        friend class QFlatHash;
+        friend class const_iterator;
+
+        QFlatHash *h;
+        int i;
+
+        iterator(QFlatHash *hash, int index) noexcept : h(hash), i(index) { }
+
+    public:
+        typedef std::forward_iterator_tag iterator_category;
+        typedef qptrdiff difference_type;
+        typedef T value_type;
+        typedef T *pointer;
+        typedef T &reference;
+
+        constexpr iterator() noexcept : h(nullptr), i(0) { }
+
+        inline const Key &key() const noexcept { return h->m_nodes[i].key; }
+        inline T &value() const noexcept { return h->m_nodes[i].value; }
+        inline T &operator*() const noexcept { return h->m_nodes[i].value; }
+        inline T *operator->() const noexcept { return &h->m_nodes[i].value; }
+        inline bool operator==(const iterator &o) const noexcept { return i == o.i; }
+        inline bool operator!=(const iterator &o) const noexcept { return i != o.i; }
+        inline bool operator==(const const_iterator &o) const noexcept { return i == o.i; }
+        inline bool operator!=(const const_iterator &o) const noexcept { return i != o.i; }
+
+        inline iterator &operator++() noexcept { i = h->nextIndex(i); return *this; }
+        inline iterator operator++(int) noexcept { iterator r = *this; i = h->nextIndex(i); return r; }
+    };
+    friend class iterator;
+
+    class const_iterator
+    {
+        friend class QFlatHash;
+        friend class iterator;
+
+        const QFlatHash *h;
+        int i;
+
+        const_iterator(const QFlatHash *hash, int index) noexcept : h(hash), i(index) { }
+
+    public:
+        typedef std::forward_iterator_tag iterator_category;
+        typedef qptrdiff difference_type;
+        typedef T value_type;
+        typedef const T *pointer;
+        typedef const T &reference;
+
+        constexpr const_iterator() noexcept : h(nullptr), i(0) { }
+        inline const_iterator(const iterator &o) noexcept : h(o.h), i(o.i) { }
+
+        inline const Key &key() const noexcept { return h->m_nodes[i].key; }
+        inline const T &value() const noexcept { return h->m_nodes[i].value; }
+        inline const T &operator*() const noexcept { return h->m_nodes[i].value; }
+        inline const T *operator->() const noexcept { return &h->m_nodes[i].value; }
+        inline bool operator==(const const_iterator &o) const noexcept { return i == o.i; }
+        inline bool operator!=(const const_iterator &o) const noexcept { return i != o.i; }
+
+        inline const_iterator &operator++() noexcept { i = h->nextIndex(i); return *this; }
+        inline const_iterator operator++(int) noexcept { const_iterator r = *this; i = h->nextIndex(i); return r; }
+    };
+    friend class const_iterator;
+
+    inline iterator begin() noexcept { return iterator(this, nextIndex(-1)); }
+    inline const_iterator begin() const noexcept { return const_iterator(this, nextIndex(-1)); }
+    inline const_iterator cbegin() const noexcept { return const_iterator(this, nextIndex(-1)); }
+    inline const_iterator constBegin() const noexcept { return const_iterator(this, nextIndex(-1)); }
+    inline iterator end() noexcept { return iterator(this, m_capacity); }
+    inline const_iterator end() const noexcept { return const_iterator(this, m_capacity); }
+    inline const_iterator cend() const noexcept { return const_iterator(this, m_capacity); }
+    inline const_iterator constEnd() const noexcept { return const_iterator(this, m_capacity); }
+
+    iterator erase(const_iterator it);
+    iterator find(const Key &key);
+    const_iterator find(const Key &key) const { return constFind(key); }
+    const_iterator constFind(const Key &key) const;
+    iterator insert(const Key &key, const T &value);
+
+    // STL compatibility
+    typedef Key key_type;
+    typedef T mapped_type;
+    typedef qptrdiff difference_type;
+    typedef int size_type;
+
+    inline bool empty() const noexcept { return isEmpty(); }
+
+private:
+    // qHash() of integers and pointers keeps their low bits, so keys with
+    // a common stride would all start probing in the same few groups. The
+    // hash value is mixed first: the control byte takes its top seven bits,
+    // the first group bits further down.
+    size_t hashOf(const Key &key) const { return size_t(qHash(key, m_seed)); }
+    static quint64 mix(size_t hash) noexcept
+    { return quint64(hash) * Q_UINT64_C(0x9e3779b97f4a7c15); }
+    static qint8 h2(size_t hash) noexcept
+    { return qint8(mix(hash) >> 57); }
+    size_t firstGroup(size_t hash) const noexcept
+    { return size_t(mix(hash) >> 25) & (size_t(m_capacity / Group::Width) - 1); }
+    static int maxLoad(int capacity) noexcept { return capacity - capacity / 8; }
+    static int capacityFor(int size) noexcept
+    {
+        if (size <= 0)
+            return 0;
+        int capacity = Group::Width;
+        while (maxLoad(capacity) < size)
+            capacity *= 2;
+        return capacity;
+    }
+
+    int findIndex(const Key &key) const;
+    int findFreeIndex(size_t hash) const noexcept;
+    int nextIndex(int index) const noexcept
+    {
+        for (++index; index < m_capacity; ++index) {
+            if (m_ctrl[index] >= 0)
+                break;
+        }
+        return index;
+    }
+    template <typename K, typename V>
+    int insertNew(K &&key, V &&value, size_t hash);
+    void eraseIndex(int index);
+    void rehash(int capacity);
+    void freeTable() noexcept;
+
+    static size_t nodesOffset(int capacity) noexcept
+    { return (size_t(capacity) + alignof(Node) - 1) & ~(alignof(Node) - 1); }
+
+    qint8 *m_ctrl;
+    Node *m_nodes;
+    int m_capacity;
+    int m_size;
+    int m_growthLeft; // insertions left before the table has to grow
+    uint m_seed;
+};
+
+template <class Key, class T>
+QFlatHash<Key, T>::QFlatHash(const QFlatHash &other)
+    : m_ctrl(nullptr), m_nodes(nullptr), m_capacity(0), m_size(0), m_growthLeft(0),
+      m_seed(other.m_seed)
+{
+    // Same seed and capacity: every node keeps its index, and deleted
+    // slots must be kept too as lookups probe past them
+    if (!other.m_capacity)
+        return;
+    rehash(other.m_capacity);
+    for (int i = 0; i < other.m_capacity; ++i) {
+        if (other.m_ctrl[i] >= 0) {
+            new (m_nodes + i) Node(other.m_nodes[i]);
+            ++m_size;
+        }
+        m_ctrl[i] = other.m_ctrl[i];
+    }
+    m_growthLeft = other.m_growthLeft;
+}
+
+template <class Key, class T>
+void QFlatHash<Key, T>::freeTable() noexcept
+{
+    if (!m_capacity)
+        return;
+    if (!std::is_trivially_destructible<Node>::value) {
+        for (int i = 0; i < m_capacity; ++i) {
+            if (m_ctrl[i] >= 0)
+                m_nodes[i].~Node();
+        }
+    }
+    ::operator delete(m_ctrl);
+    m_ctrl = nullptr;
+    m_nodes = nullptr;
+    m_capacity = m_size = m_growthLeft = 0;
+}
+
+template <class Key, class T>
+void QFlatHash<Key, T>::rehash(int capacity)
+{
+    Q_ASSERT(capacity == 0 || maxLoad(capacity) >= m_size);
+    qint8 *oldCtrl = m_ctrl;
+    Node *oldNodes = m_nodes;
+    const int oldCapacity = m_capacity;
+
+    if (capacity) {
+        m_ctrl = static_cast<qint8 *>(::operator new(nodesOffset(capacity) + size_t(capacity) * sizeof(Node)));
+        m_nodes = reinterpret_cast<Node *>(m_ctrl + nodesOffset(capacity));
+        memset(m_ctrl, QtPrivate::FlatHashEmpty, size_t(capacity));
+    } else {
+        m_ctrl = nullptr;
+        m_nodes = nullptr;
+    }
+    m_capacity = capacity;
+    m_growthLeft = maxLoad(capacity) - m_size;
+
+    for (int i = 0; i < oldCapacity; ++i) {
+        if (oldCtrl[i] < 0)
+            continue;
+        const size_t hash = hashOf(oldNodes[i].key);
+        const int index = findFreeIndex(hash);
+        new (m_nodes + index) Node(std::move(oldNodes[i]));
+        m_ctrl[index] = h2(hash);
+        oldNodes[i].~Node();
+    }
+    if (oldCapacity)
+        ::operator delete(oldCtrl);
+}
+
+template <class Key, class T>
+void QFlatHash<Key, T>::reserve(int size)
+{
+    const int capacity = capacityFor(size);
+    if (capacity > m_capacity)
+        rehash(capacity);
+}
+
+template <class Key, class T>
+int QFlatHash<Key, T>::findIndex(const Key &key) const
+{
+    if (!m_size)
+        return -1;
+    const size_t hash = hashOf(key);
+    const qint8 tag = h2(hash);
+    const size_t groupMask = size_t(m_capacity / Group::Width) - 1;
+    size_t group = firstGroup(hash);
+    for (size_t step = 1; ; ++step) {
+        const int base = int(group) * Group::Width;
+        const Group g(m_ctrl + base);
+        for (quint64 match = g.match(tag); match; match &= match - 1) {
+            const int index = base + Group::lowestIndex(match);
+            if (m_nodes[index].key == key)
+                return index;
+        }
+        if (g.matchEmpty())
+            return -1;
+        group = (group + step) & groupMask; // triangular probing visits every group
+    }
+}
+
+template <class Key, class T>
+int QFlatHash<Key, T>::findFreeIndex(size_t hash) const noexcept
+{
+    const size_t groupMask = size_t(m_capacity / Group::Width) - 1;
+    size_t group = firstGroup(hash);
+    for (size_t step = 1; ; ++step) {
+        const int base = int(group) * Group::Width;
+        const quint64 free = Group(m_ctrl + base).matchEmptyOrDeleted();
+        if (free)
+            return base + Group::lowestIndex(free);
+        group = (group + step) & groupMask;
+    }
+}
+
+template <class Key, class T>
+template <typename K, typename V>
+int QFlatHash<Key, T>::insertNew(K &&key, V &&value, size_t hash)
+{
+    if (!m_growthLeft) {
+        // key and value may live in this table
+        Key k(std::forward<K>(key));
+        T v(std::forward<V>(value));
+        // reuse the table if most of the used up room is deleted slots
+        rehash(m_size < maxLoad(m_capacity) / 2 ? m_capacity : qMax(capacityFor(m_size + 1), m_capacity * 2));
+        return insertNew(std::move(k), std::move(v), hash);
+    }
+    const int index = findFreeIndex(hash);
+    new (m_nodes + index) Node(std::forward<K>(key), std::forward<V>(value));
+    if (m_ctrl[index] == QtPrivate::FlatHashEmpty)
+        --m_growthLeft;
+    m_ctrl[index] = h2(hash);
+    ++m_size;
+    return index;
+}
+
+template <class Key, class T>
+void QFlatHash<Key, T>::eraseIndex(int index)
+{
+    m_nodes[index].~Node();
+    --m_size;
+    // A lookup stops at the first group with an empty slot, so if this
+    // group has one, no lookup passes through it and the slot can be
+    // made empty again rather than deleted.
+    const int base = index - index % Group::Width;
+    if (Group(m_ctrl + base).matchEmpty()) {
+        m_ctrl[index] = QtPrivate::FlatHashEmpty;
+        ++m_growthLeft;
+    } else {
+        m_ctrl[index] = QtPrivate::FlatHashDeleted;
+    }
+}
+
+template <class Key, class T>
+typename QFlatHash<Key, T>::iterator QFlatHash<Key, T>::insert(const Key &key, const T &value)
+{
+    const int index = findIndex(key);
+    if (index >= 0) {
+        m_nodes[index].value = value;
+        return iterator(this, index);
+    }
+    return iterator(this, insertNew(key, value, hashOf(key)));
+}
+
+template <class Key, class T>
+T &QFlatHash<Key, T>::operator[](const Key &key)
+{
+    int index = findIndex(key);
+    if (index < 0)
+        index = insertNew(key, T(), hashOf(key));
+    return m_nodes[index].value;
+}
+
+template <class Key, class T>
+T QFlatHash<Key, T>::value(const Key &key) const
+{
+    const int index = findIndex(key);
+    return index >= 0 ? m_nodes[index].value : T();
+}
+
+template <class Key, class T>
+T QFlatHash<Key, T>::value(const Key &key, const T &defaultValue) const
+{
+    const int index = findIndex(key);
+    return index >= 0 ? m_nodes[index].value : defaultValue;
+}
+
+template <class Key, class T>
+typename QFlatHash<Key, T>::iterator QFlatHash<Key, T>::find(const Key &key)
+{
+    const int index = findIndex(key);
+    return iterator(this, index >= 0 ? index : m_capacity);
+}
+
+template <class Key, class T>
+typename QFlatHash<Key, T>::const_iterator QFlatHash<Key, T>::constFind(const Key &key) const
+{
+    const int index = findIndex(key);
+    return const_iterator(this, index >= 0 ? index : m_capacity);
+}
+
+template <class Key, class T>
+int QFlatHash<Key, T>::remove(const Key &key)
+{
+    const int index = findIndex(key);
+    if (index < 0)
+        return 0;
+    eraseIndex(index);
+    return 1;
+}
+
+template <class Key, class T>
+T QFlatHash<Key, T>::take(const Key &key)
+{
+    const int index = findIndex(key);
+    if (index < 0)
+        return T();
+    T t = std::move(m_nodes[index].value);
+    eraseIndex(index);
+    return t;
+}
+
+template <class Key, class T>
+typename QFlatHash<Key, T>::iterator QFlatHash<Key, T>::erase(const_iterator it)
+{
+    Q_ASSERT_X(it.h == this && it.i < m_capacity && m_ctrl[it.i] >= 0,
+               "QFlatHash::erase", "The specified iterator argument 'it' is invalid");
+    eraseIndex(it.i);
+    return iterator(this, nextIndex(it.i));
+}
+
+template <class Key, class T>
+QList<Key> QFlatHash<Key, T>::keys() const
+{
+    QList<Key> res;
+    res.reserve(m_size);
+    for (const_iterator it = constBegin(); it != constEnd(); ++it)
+        res.append(it.key());
+    return res;
+}
+
+template <class Key, class T>
+QList<T> QFlatHash<Key, T>::values() const
+{
+    QList<T> res;
+    res.reserve(m_size);
+    for (const_iterator it = constBegin(); it != constEnd(); ++it)
+        res.append(it.value());
+    return res;
+}
+
+template <class Key, class T>
+bool QFlatHash<Key, T>::operator==(const QFlatHash &other) const
+{
+    if (m_size != other.m_size)
+        return false;
+    for (const_iterator it = constBegin(); it != constEnd(); ++it) {
+        const int index = other.findIndex(it.key());
+        if (index < 0 || !(other.m_nodes[index].value == it.value()))
+            return false;
+    }
+    return true;
+}
+
+template <class Key, class T>
+inline void swap(QFlatHash<Key, T> &value1, QFlatHash<Key, T> &value2) noexcept
+{
+    value1.swap(value2);
+}
+
+QT_END_NAMESPACE
+
+#endif // QFLATHASH_H
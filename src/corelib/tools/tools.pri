@@ -8,11 +8,13 @@ HEADERS +=  \
         tools/qarraydataops.h \
         tools/qarraydatapointer.h \
         tools/qbitarray.h \
+        tools/qbtreemap.h \
         tools/qcache.h \
         tools/qcontainerfwd.h \
         tools/qcontainertools_impl.h \
         tools/qcryptographichash.h \
         tools/qduplicatetracker_p.h \
+        tools/qflathash.h \
         tools/qfreelist_p.h \
         tools/qhash.h \
         tools/qhashfunctions.h \
@@ -45,6 +45,7 @@
 #include <private/qimage_p.h>
 
 #include <qendian.h>
+#include <qvarlengtharray.h>
 #if QT_CONFIG(thread)
 #include <qsemaphore.h>
 #include <qthreadpool.h>
@@ -1600,6 +1601,173 @@ void dither_to_Mono(QImageData *dst, const QImageData *src,
     }
 }
 
+// Quantizes count Grayscale8 pixels to the levels 0 to max, adding the matching
+// threshold before dividing by 255. Thresholds of 127 round to the nearest
+// level, a dither pattern in 0-254 gives an ordered dither. A threshold of 255
+// would lift black to the first level.
+static inline void quantizeGray8(uchar *levels, const uchar *src, int count, uint max,
+                                 const quint16 *thresholds)
+{
+    int i = 0;
+#if defined(__SSE2__)
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i one = _mm_set1_epi16(1);
+    const __m128i vmax = _mm_set1_epi16(max);
+    const __m128i t0 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(thresholds));
+    const __m128i t1 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(thresholds + 8));
+    for (; i < count - 15; i += 16) {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+        __m128i lo = _mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(v, zero), vmax), t0);
+        __m128i hi = _mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(v, zero), vmax), t1);
+        // x / 255, exact for x < 65279
+        lo = _mm_add_epi16(lo, one);
+        hi = _mm_add_epi16(hi, one);
+        lo = _mm_srli_epi16(_mm_add_epi16(lo, _mm_srli_epi16(lo, 8)), 8);
+        hi = _mm_srli_epi16(_mm_add_epi16(hi, _mm_srli_epi16(hi, 8)), 8);
+        lo = _mm_min_epi16(lo, vmax);
+        hi = _mm_min_epi16(hi, vmax);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(levels + i), _mm_packus_epi16(lo, hi));
+    }
+#elif defined(__ARM_NEON__)
+    const uint16x8_t one = vdupq_n_u16(1);
+    const uint16x8_t vmax = vdupq_n_u16(max);
+    const uint8x8_t vmax8 = vdup_n_u8(max);
+    const uint16x8_t t0 = vld1q_u16(thresholds);
+    const uint16x8_t t1 = vld1q_u16(thresholds + 8);
+    for (; i < count - 15; i += 16) {
+        const uint8x16_t v = vld1q_u8(src + i);
+        uint16x8_t lo = vaddq_u16(vmlal_u8(t0, vget_low_u8(v), vmax8), one);
+        uint16x8_t hi = vaddq_u16(vmlal_u8(t1, vget_high_u8(v), vmax8), one);
+        lo = vminq_u16(vshrq_n_u16(vsraq_n_u16(lo, lo, 8), 8), vmax);
+        hi = vminq_u16(vshrq_n_u16(vsraq_n_u16(hi, hi, 8), 8), vmax);
+        vst1q_u8(levels + i, vcombine_u8(vmovn_u16(lo), vmovn_u16(hi)));
+    }
+#endif
+    for (; i < count; ++i)
+        levels[i] = qMin((src[i] * max + thresholds[i & 15]) / 255, max);
+}
+
+// Packs count levels of depth bits into bytes, the first pixel in the most
+// significant bits.
+static inline void packGrayLevels(uchar *dst, const uchar *levels, int count, int depth)
+{
+    int i = 0;
+    if (depth == 8) {
+        memcpy(dst, levels, count);
+        return;
+    }
+#if defined(__SSE2__)
+    if (depth == 4) {
+        const __m128i lowBytes = _mm_set1_epi16(0x00ff);
+        for (; i < count - 15; i += 16) {
+            const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(levels + i));
+            __m128i packed = _mm_or_si128(_mm_slli_epi16(_mm_and_si128(v, lowBytes), 4),
+                                          _mm_srli_epi16(v, 8));
+            _mm_storel_epi64(reinterpret_cast<__m128i *>(dst), _mm_packus_epi16(packed, packed));
+            dst += 8;
+        }
+    } else if (depth == 1) {
+        for (; i < count - 15; i += 16) {
+            const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(levels + i));
+            const uint bits = _mm_movemask_epi8(_mm_slli_epi16(v, 7));
+            *dst++ = bitflip[bits & 0xff];
+            *dst++ = bitflip[bits >> 8];
+        }
+    }
+#elif defined(__ARM_NEON__)
+    if (depth == 4) {
+        for (; i < count - 15; i += 16) {
+            const uint8x8x2_t v = vuzp_u8(vld1_u8(levels + i), vld1_u8(levels + i + 8));
+            vst1_u8(dst, vorr_u8(vshl_n_u8(v.val[0], 4), v.val[1]));
+            dst += 8;
+        }
+    }
+#endif
+    const int perByte = 8 / depth;
+    for (; i < count; i += perByte) {
+        uint byte = 0;
+        for (int j = 0; j < perByte; ++j)
+            byte = (byte << depth) | (i + j < count ? levels[i + j] : 0);
+        *dst++ = byte;
+    }
+}
+
+/*
+    Converts width x height pixels of Grayscale8 data at src to gray levels of
+    depth bits at dst, as used by e-paper and monochrome displays. Depths of 1,
+    2, 4 and 8 are supported; pixels of less than 8 bits are packed with the
+    first pixel in the most significant bits, and level 0 is black.
+
+    x and y give the position of the first pixel in the image, so that the
+    ordered dither pattern stays in place when only parts of the image are
+    converted. For depths below 8, x must be a multiple of 8 / depth, as dst
+    points at the byte holding that pixel.
+
+    The dither mode is taken from the Qt::Dither_Mask part of flags. Ordered
+    and threshold dithering are vectorized, diffuse (Floyd-Steinberg) dithering
+    carries the error along each line and cannot be.
+*/
+Q_GUI_EXPORT void qt_dither_grayscale8(uchar *dst, qsizetype dbpl, const uchar *src, qsizetype sbpl,
+                          int x, int y, int width, int height, int depth,
+                          Qt::ImageConversionFlags flags)
+{
+    Q_ASSERT(depth == 1 || depth == 2 || depth == 4 || depth == 8);
+    Q_ASSERT(depth == 8 || (x * depth) % 8 == 0);
+    if (width <= 0 || height <= 0)
+        return;
+
+    const uint max = (1 << depth) - 1;
+    QVarLengthArray<uchar, 2048> levels(width);
+
+    if (depth == 8 || (flags & Qt::Dither_Mask) != Qt::DiffuseDither) {
+        const bool ordered = depth < 8 && (flags & Qt::Dither_Mask) == Qt::OrderedDither;
+        // One row of the pattern, repeated so that it can be loaded from any phase
+        quint16 thresholds[32];
+        for (int i = 0; i < 32; ++i)
+            thresholds[i] = ordered ? 0 : 127;
+        for (int j = 0; j < height; ++j) {
+            if (ordered) {
+                // qt_bayer_matrix runs from 1 to 255, scale it to 0-254
+                const uint *bayer = qt_bayer_matrix[(y + j) & 15];
+                for (int i = 0; i < 16; ++i)
+                    thresholds[i] = thresholds[i + 16] = bayer[i] * 255 / 256;
+            }
+            quantizeGray8(levels.data(), src, width, max, thresholds + (x & 15));
+            packGrayLevels(dst, levels.data(), width, depth);
+            src += sbpl;
+            dst += dbpl;
+        }
+        return;
+    }
+
+    // Floyd-Steinberg, with the same weights as dither_to_Mono()
+    QVarLengthArray<int, 4096> errors(2 * (width + 2));
+    int *line1 = errors.data() + 1;
+    int *line2 = errors.data() + width + 3;
+    memset(errors.data(), 0, errors.size() * sizeof(int));
+    for (int j = 0; j < height; ++j) {
+        for (int i = 0; i < width; ++i) {
+            const int value = src[i] + line1[i];
+            const int level = qBound(0, (value * int(max) + 127) / 255, int(max));
+            levels[i] = level;
+            const int err = value - level * 255 / int(max);
+            const int e7 = ((err * 7) + 8) >> 4;
+            const int e5 = ((err * 5) + 8) >> 4;
+            const int e3 = ((err * 3) + 8) >> 4;
+            const int e1 = err - (e7 + e5 + e3);
+            line1[i + 1] += e7;
+            line2[i - 1] += e3;
+            line2[i] += e5;
+            line2[i + 1] += e1;
+        }
+        packGrayLevels(dst, levels.data(), width, depth);
+        qSwap(line1, line2);
+        memset(line2 - 1, 0, (width + 2) * sizeof(int));
+        src += sbpl;
+        dst += dbpl;
+    }
+}
+
 static void convert_X_to_Mono(QImageData *dst, const QImageData *src, Qt::ImageConversionFlags flags)
 {
     dither_to_Mono(dst, src, flags, false);
@@ -163,6 +163,9 @@ void convert_generic_to_rgb64(QImageData *dest, const QImageData *src, Qt::Image
 bool convert_generic_inplace(QImageData *data, QImage::Format dst_format, Qt::ImageConversionFlags);
 
 void dither_to_Mono(QImageData *dst, const QImageData *src, Qt::ImageConversionFlags flags, bool fromalpha);
+Q_GUI_EXPORT void qt_dither_grayscale8(uchar *dst, qsizetype dbpl, const uchar *src, qsizetype sbpl,
+                                       int x, int y, int width, int height, int depth,
+                                       Qt::ImageConversionFlags flags);
 
 const uchar *qt_get_bitflip_array();
 Q_GUI_EXPORT void qGamma_correct_back_to_linear_cs(QImage *image);
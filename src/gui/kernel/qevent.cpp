@@ -2452,6 +2452,44 @@ Qt::MouseButtons QTabletEvent::buttons() const
     return static_cast<QTabletEventPrivate *>(mExtra)->buttonState;
 }
 
+/*!
+    \class QTabletEvent::HistoricalSample
+    \inmodule QtGui
+    \since 5.15.1
+
+    \brief The HistoricalSample struct holds a tablet sample that was
+    coalesced into a later QTabletEvent.
+
+    The members have the same meaning as the QTabletEvent accessors of the
+    same name; \c timestamp is the time at which the device reported the
+    sample.
+
+    \sa QTabletEvent::history()
+*/
+
+/*!
+    \since 5.15.1
+
+    Returns the samples that were reported by the device since the previous
+    tablet event, but that have been coalesced into this event, ordered from
+    oldest to newest. The sample reported by this event itself is not part of
+    the history.
+
+    Motion events of the same device are only coalesced when the application
+    is not keeping up with the device, and when both
+    Qt::AA_CompressHighFrequencyEvents and Qt::AA_CompressTabletEvents are
+    set. This is currently supported by the linuxfb platform plugin only.
+    Applications that draw strokes should process the history before
+    the current position of the event, to get the full resolution of the
+    device.
+
+    \sa QTouchEvent::TouchPoint::history()
+*/
+QVector<QTabletEvent::HistoricalSample> QTabletEvent::history() const
+{
+    return static_cast<QTabletEventPrivate *>(mExtra)->history;
+}
+
 /*!
     \fn TabletDevices QTabletEvent::device() const
 
@@ -4772,6 +4810,26 @@ QVector<QPointF> QTouchEvent::TouchPoint::rawScreenPositions() const
     return d->rawScreenPositions;
 }
 
+/*!
+  \since 5.15.1
+  Returns the earlier positions of this touch point that have been coalesced
+  into this event, ordered from oldest to newest. The current state of the
+  touch point is not part of the history.
+
+  Touch updates of the same device are only coalesced when the application
+  is not keeping up with the device, Qt::AA_CompressHighFrequencyEvents is
+  set, and the platform plugin supports it (currently linuxfb). The
+  historical touch points carry the positions, pressure, rotation and
+  ellipse diameters reported by the device; pos() is relative to the same
+  receiver as the current position.
+
+  \sa QTabletEvent::history()
+  */
+QVector<QTouchEvent::TouchPoint> QTouchEvent::TouchPoint::history() const
+{
+    return d->history;
+}
+
 /*! \internal */
 void QTouchEvent::TouchPoint::setId(int id)
 {
@@ -4968,6 +5026,14 @@ void QTouchEvent::TouchPoint::setRawScreenPositions(const QVector<QPointF> &posi
     d->rawScreenPositions = positions;
 }
 
+/*! \internal */
+void QTouchEvent::TouchPoint::setHistory(const QVector<TouchPoint> &history)
+{
+    if (d->ref.loadRelaxed() != 1)
+        d = d->detach();
+    d->history = history;
+}
+
 /*!
     \internal
 */
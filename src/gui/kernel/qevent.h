@@ -327,6 +327,19 @@ public:
     Qt::MouseButton button() const;
     Qt::MouseButtons buttons() const;
 
+    struct HistoricalSample {
+        QPointF pos;
+        QPointF globalPos;
+        qreal pressure;
+        qreal tangentialPressure;
+        qreal rotation;
+        int xTilt;
+        int yTilt;
+        int z;
+        ulong timestamp;
+    };
+    QVector<HistoricalSample> history() const;
+
 protected:
     QPointF mPos, mGPos;
     int mDev, mPointerType, mXT, mYT, mZ;
@@ -336,7 +349,10 @@ protected:
     // QTabletEventPrivate for extra storage.
     // ### Qt 6: QPointingEvent will have Buttons, QTabletEvent will inherit
     void *mExtra;
+
+    friend class QTabletEventPrivate;
 };
+Q_DECLARE_TYPEINFO(QTabletEvent::HistoricalSample, Q_PRIMITIVE_TYPE);
 #endif // QT_CONFIG(tabletevent)
 
 #ifndef QT_NO_GESTURES
@@ -957,6 +973,7 @@ public:
         QVector2D velocity() const;
         InfoFlags flags() const;
         QVector<QPointF> rawScreenPositions() const;
+        QVector<TouchPoint> history() const;
 
         // internal
         void setId(int id);
@@ -980,6 +997,7 @@ public:
         void setVelocity(const QVector2D &v);
         void setFlags(InfoFlags flags);
         void setRawScreenPositions(const QVector<QPointF> &positions);
+        void setHistory(const QVector<TouchPoint> &history);
 
     private:
         QTouchEventTouchPointPrivate *d;
@@ -71,6 +71,15 @@ public:
           stationaryWithModifiedProperty(false)
     { }
 
+    // Moves the local positions of the history along with pos, after the
+    // touch point has been mapped to a new receiver.
+    inline void updateHistoryPositions()
+    {
+        const QPointF offset = pos - screenPos;
+        for (QTouchEvent::TouchPoint &point : history)
+            point.setPos(point.screenPos() + offset);
+    }
+
     inline QTouchEventTouchPointPrivate *detach()
     {
         QTouchEventTouchPointPrivate *d = new QTouchEventTouchPointPrivate(*this);
@@ -94,6 +103,7 @@ public:
     QTouchEvent::TouchPoint::InfoFlags flags;
     bool stationaryWithModifiedProperty : 1;
     QVector<QPointF> rawScreenPositions;
+    QVector<QTouchEvent::TouchPoint> history;
 };
 
 #if QT_CONFIG(tabletevent)
@@ -105,8 +115,23 @@ public:
           buttonState(buttons)
     { }
 
+    static QTabletEventPrivate *get(QTabletEvent *ev)
+    { return static_cast<QTabletEventPrivate *>(ev->mExtra); }
+
+    // The local positions of the samples are derived from the local position
+    // of ev, so that they stay relative to whatever ev is delivered to.
+    static void setHistory(QTabletEvent *ev, const QVector<QTabletEvent::HistoricalSample> &history)
+    {
+        QVector<QTabletEvent::HistoricalSample> &h = get(ev)->history;
+        h = history;
+        const QPointF offset = ev->posF() - ev->globalPosF();
+        for (QTabletEvent::HistoricalSample &sample : h)
+            sample.pos = sample.globalPos + offset;
+    }
+
     Qt::MouseButton b;
     Qt::MouseButtons buttonState;
+    QVector<QTabletEvent::HistoricalSample> history;
 };
 #endif // QT_CONFIG(tabletevent)
 
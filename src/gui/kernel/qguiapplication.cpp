@@ -2710,6 +2710,8 @@ void QGuiApplicationPrivate::processTabletEvent(QWindowSystemInterfacePrivate::T
                              e->modifiers, e->uid, button, e->buttons);
     tabletEvent.setAccepted(false);
     tabletEvent.setTimestamp(e->timestamp);
+    if (!e->history.isEmpty())
+        QTabletEventPrivate::setHistory(&tabletEvent, e->history);
     QGuiApplication::sendSpontaneousEvent(window, &tabletEvent);
     pointData.state = e->buttons;
     if (!tabletEvent.isAccepted()
@@ -3039,6 +3041,8 @@ void QGuiApplicationPrivate::processTouchEvent(QWindowSystemInterfacePrivate::To
             const QPointF delta = screenPos - screenPos.toPoint();
 
             touchPoint.d->pos = w->mapFromGlobal(screenPos.toPoint()) + delta;
+            if (!touchPoint.d->history.isEmpty())
+                touchPoint.d->updateHistoryPositions();
             if (touchPoint.state() == Qt::TouchPointPressed) {
                 // touchPoint is actually a reference to one that is stored in activeTouchPoints,
                 // and we are now going to store the startPos and lastPos there, for the benefit
@@ -40,6 +40,8 @@
 #include "qinputdevicemanager_p.h"
 #include "qinputdevicemanager_p_p.h"
 
+#include <QtCore/qmutex.h>
+
 QT_BEGIN_NAMESPACE
 
 /*!
@@ -115,4 +117,54 @@ void QInputDeviceManager::setKeyboardModifiers(Qt::KeyboardModifiers mods)
     d->keyboardModifiers = mods;
 }
 
+/*!
+    \class QInkOverlay
+    \internal
+
+    \brief QInkOverlay is implemented by platform plugins able to draw a preview of
+    pen strokes straight to the screen.
+
+    tabletSample() is called from the thread of the tablet input handler for
+    every sample, before the corresponding event is even queued for the GUI
+    thread, so that drawing the preview does not wait for the event loop.
+*/
+
+QInkOverlay::~QInkOverlay()
+{
+}
+
+// Not tied to the QInputDeviceManager instance, which input handler threads
+// must not access, especially during application shutdown.
+static QBasicMutex inkOverlayMutex;
+static QBasicAtomicPointer<QInkOverlay> inkOverlay = Q_BASIC_ATOMIC_INITIALIZER(nullptr);
+
+/*!
+    Sets the \a overlay that receives tablet samples reported through
+    handleInkSample(), or unsets it when \a overlay is null.
+
+    Once this function returns, the previous overlay is guaranteed not to
+    be called anymore.
+*/
+void QInputDeviceManager::setInkOverlay(QInkOverlay *overlay)
+{
+    QMutexLocker locker(&inkOverlayMutex);
+    inkOverlay.storeRelaxed(overlay);
+}
+
+/*!
+    Passes a tablet sample at \a globalPos, \a down telling whether the pen
+    touches the surface, to the ink overlay, if any.
+
+    Tablet input handlers are expected to call this from their own thread for
+    every sample they report.
+*/
+void QInputDeviceManager::handleInkSample(const QPointF &globalPos, bool down)
+{
+    if (!inkOverlay.loadRelaxed())
+        return;
+    QMutexLocker locker(&inkOverlayMutex);
+    if (QInkOverlay *overlay = inkOverlay.loadRelaxed())
+        overlay->tabletSample(globalPos, down);
+}
+
 QT_END_NAMESPACE
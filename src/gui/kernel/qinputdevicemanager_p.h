@@ -53,11 +53,20 @@
 
 #include <QtGui/private/qtguiglobal_p.h>
 #include <QtCore/qobject.h>
+#include <QtCore/qpoint.h>
 
 QT_BEGIN_NAMESPACE
 
 class QInputDeviceManagerPrivate;
 
+class Q_GUI_EXPORT QInkOverlay
+{
+public:
+    virtual ~QInkOverlay();
+
+    virtual void tabletSample(const QPointF &globalPos, bool down) = 0;
+};
+
 class Q_GUI_EXPORT QInputDeviceManager : public QObject
 {
     Q_OBJECT
@@ -83,6 +92,9 @@ public:
     Qt::KeyboardModifiers keyboardModifiers() const;
     void setKeyboardModifiers(Qt::KeyboardModifiers mods);
 
+    static void setInkOverlay(QInkOverlay *overlay);
+    static void handleInkSample(const QPointF &globalPos, bool down);
+
 signals:
     void deviceListChanged(QInputDeviceManager::DeviceType type);
     void cursorPositionChangeRequested(const QPoint &pos);
@@ -60,6 +60,9 @@ QT_BEGIN_NAMESPACE
 QElapsedTimer QWindowSystemInterfacePrivate::eventTime;
 bool QWindowSystemInterfacePrivate::synchronousWindowSystemEvents = false;
 bool QWindowSystemInterfacePrivate::platformFiltersEvents = false;
+// set by platform plugins whose input handlers post every sample of the
+// device, and which therefore want queued tablet and touch moves coalesced
+bool QWindowSystemInterfacePrivate::platformCoalescesInputEvents = false;
 bool QWindowSystemInterfacePrivate::TabletEvent::platformSynthesizesMouse = true;
 QWaitCondition QWindowSystemInterfacePrivate::eventsFlushed;
 QMutex QWindowSystemInterfacePrivate::flushEventMutex;
@@ -82,7 +85,11 @@ extern QPointer<QWindow> qt_last_mouse_receiver;
 template<>
 bool QWindowSystemInterfacePrivate::handleWindowSystemEvent<QWindowSystemInterface::AsynchronousDelivery>(WindowSystemEvent *ev)
 {
-    windowSystemEventQueue.append(ev);
+    if ((ev->type == Tablet || ev->type == Touch) && platformCoalescesInputEvents
+            && QCoreApplication::testAttribute(Qt::AA_CompressHighFrequencyEvents))
+        windowSystemEventQueue.appendOrCoalesce(ev);
+    else
+        windowSystemEventQueue.append(ev);
     if (QAbstractEventDispatcher *dispatcher = QGuiApplicationPrivate::qt_qpa_core_dispatcher())
         dispatcher->wakeUp();
     return true;
@@ -172,6 +179,78 @@ void QWindowSystemInterfacePrivate::removeWindowSystemEvent(WindowSystemEvent *e
     windowSystemEventQueue.remove(event);
 }
 
+/*
+    Coalesces the tablet or touch motion event \a ev with the \a queued event
+    at the end of the window system event queue, if both are motion events of
+    the same device.
+
+    The state of \a queued is appended to the history of \a ev as the most
+    recent historical sample, and \a ev replaces \a queued in the queue. This
+    keeps the Gui thread from falling behind devices that report at a higher
+    rate than the application can handle, without losing any samples.
+
+    Called with the event queue locked.
+*/
+bool QWindowSystemInterfacePrivate::coalesce(WindowSystemEvent *queued, WindowSystemEvent *ev)
+{
+    if (queued->type != ev->type || queued->flags != ev->flags)
+        return false;
+    const InputEvent *q = static_cast<const InputEvent *>(queued);
+    const InputEvent *e = static_cast<const InputEvent *>(ev);
+    if (q->window != e->window || q->modifiers != e->modifiers)
+        return false;
+
+    switch (ev->type) {
+#if QT_CONFIG(tabletevent)
+    case Tablet: {
+        if (!QCoreApplication::testAttribute(Qt::AA_CompressTabletEvents))
+            return false;
+        TabletEvent *qt = static_cast<TabletEvent *>(queued);
+        TabletEvent *et = static_cast<TabletEvent *>(ev);
+        if (!qt->motion || !et->motion || qt->uid != et->uid || qt->device != et->device
+                || qt->pointerType != et->pointerType || qt->buttons != et->buttons)
+            return false;
+        et->history = std::move(qt->history);
+        et->history.append({ qt->local, qt->global, qt->pressure, qt->tangentialPressure,
+                             qt->rotation, qt->xTilt, qt->yTilt, qt->z, qt->timestamp });
+        return true;
+    }
+#endif
+    case Touch: {
+        TouchEvent *qt = static_cast<TouchEvent *>(queued);
+        TouchEvent *et = static_cast<TouchEvent *>(ev);
+        if (qt->touchType != QEvent::TouchUpdate || et->touchType != QEvent::TouchUpdate
+                || qt->device != et->device || qt->points.size() != et->points.size())
+            return false;
+        // Only moves can be coalesced, presses and releases must be delivered
+        // in their own event. Both events also have to report the same points.
+        const Qt::TouchPointStates motionStates = Qt::TouchPointMoved | Qt::TouchPointStationary;
+        for (int i = 0; i < et->points.size(); ++i) {
+            const QTouchEvent::TouchPoint &qp = qt->points.at(i);
+            const QTouchEvent::TouchPoint &ep = et->points.at(i);
+            if (qp.id() != ep.id() || !(qp.state() & motionStates) || !(ep.state() & motionStates))
+                return false;
+        }
+        for (int i = 0; i < et->points.size(); ++i) {
+            QTouchEvent::TouchPoint previous = qt->points.at(i);
+            QVector<QTouchEvent::TouchPoint> history = previous.history();
+            previous.setHistory(QVector<QTouchEvent::TouchPoint>());
+            history.append(previous);
+            QTouchEvent::TouchPoint &point = et->points[i];
+            // A point that did not move since the queued event still moved
+            // as far as the Gui thread is concerned.
+            if (previous.state() == Qt::TouchPointMoved)
+                point.setState(Qt::TouchPointMoved);
+            point.setHistory(history);
+        }
+        return true;
+    }
+    default:
+        break;
+    }
+    return false;
+}
+
 void QWindowSystemInterfacePrivate::installWindowSystemEventHandler(QWindowSystemEventHandler *handler)
 {
     if (!eventHandler)
@@ -973,6 +1052,26 @@ void QWindowSystemInterfacePrivate::TabletEvent::setPlatformSynthesizesMouse(boo
     platformSynthesizesMouse = v;
 }
 
+// map from tablet tool id to the buttons of its last event, to tell moves
+// apart from presses and releases when coalescing; only kept on platforms
+// that coalesce input, see platformCoalescesInputEvents
+static QBasicMutex tabletButtonsMutex;
+typedef QHash<qint64, Qt::MouseButtons> TabletButtonsMap;
+Q_GLOBAL_STATIC(TabletButtonsMap, g_tabletButtons)
+
+static bool updateTabletButtons(qint64 uid, Qt::MouseButtons buttons)
+{
+    const auto locker = qt_scoped_lock(tabletButtonsMutex);
+    auto it = g_tabletButtons->find(uid);
+    if (it == g_tabletButtons->end()) {
+        g_tabletButtons->insert(uid, buttons);
+        return false;
+    }
+    const bool motion = it.value() == buttons;
+    it.value() = buttons;
+    return motion;
+}
+
 bool QWindowSystemInterface::handleTabletEvent(QWindow *window, ulong timestamp, const QPointF &local, const QPointF &global,
                                                int device, int pointerType, Qt::MouseButtons buttons, qreal pressure, int xTilt, int yTilt,
                                                qreal tangentialPressure, qreal rotation, int z, qint64 uid,
@@ -984,6 +1083,8 @@ bool QWindowSystemInterface::handleTabletEvent(QWindow *window, ulong timestamp,
                                                        QHighDpi::fromNativePixels(global, window),
                                                        device, pointerType, buttons, pressure,
                                                        xTilt, yTilt, tangentialPressure, rotation, z, uid, modifiers);
+    if (QWindowSystemInterfacePrivate::platformCoalescesInputEvents)
+        e->motion = updateTabletButtons(uid, buttons);
     return QWindowSystemInterfacePrivate::handleWindowSystemEvent(e);
 }
 
@@ -1032,6 +1133,11 @@ void QWindowSystemInterface::handleTabletEnterProximityEvent(int device, int poi
 
 bool QWindowSystemInterface::handleTabletLeaveProximityEvent(ulong timestamp, int device, int pointerType, qint64 uid)
 {
+    if (QWindowSystemInterfacePrivate::platformCoalescesInputEvents) {
+        // the tool is gone, its next event starts afresh
+        const auto locker = qt_scoped_lock(tabletButtonsMutex);
+        g_tabletButtons->remove(uid);
+    }
     QWindowSystemInterfacePrivate::TabletLeaveProximityEvent *e =
             new QWindowSystemInterfacePrivate::TabletLeaveProximityEvent(timestamp, device, pointerType, uid);
     return QWindowSystemInterfacePrivate::handleWindowSystemEvent(e);
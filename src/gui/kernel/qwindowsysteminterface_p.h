@@ -379,7 +379,7 @@ public:
             : InputEvent(w, time, Tablet, mods),
               buttons(b), local(local), global(global), device(device), pointerType(pointerType),
               pressure(pressure), xTilt(xTilt), yTilt(yTilt), tangentialPressure(tpressure),
-              rotation(rotation), z(z), uid(uid) { }
+              rotation(rotation), z(z), uid(uid), motion(false) { }
         Qt::MouseButtons buttons;
         QPointF local;
         QPointF global;
@@ -392,6 +392,10 @@ public:
         qreal rotation;
         int z;
         qint64 uid;
+        bool motion; // same buttons as the previous event of this tool
+#if QT_CONFIG(tabletevent)
+        QVector<QTabletEvent::HistoricalSample> history;
+#endif
         static bool platformSynthesizesMouse;
     };
 
@@ -486,6 +490,16 @@ public:
         }
         void append(WindowSystemEvent *e)
         { const QMutexLocker locker(&mutex); impl.append(e); }
+        void appendOrCoalesce(WindowSystemEvent *e)
+        {
+            const QMutexLocker locker(&mutex);
+            if (!impl.isEmpty() && QWindowSystemInterfacePrivate::coalesce(impl.last(), e)) {
+                delete impl.last();
+                impl.last() = e;
+            } else {
+                impl.append(e);
+            }
+        }
         int count() const
         { const QMutexLocker locker(&mutex); return impl.count(); }
         WindowSystemEvent *peekAtFirstOfType(EventType t) const
@@ -519,6 +533,7 @@ public:
     static WindowSystemEvent *getNonUserInputWindowSystemEvent();
     static WindowSystemEvent *peekWindowSystemEvent(EventType t);
     static void removeWindowSystemEvent(WindowSystemEvent *event);
+    static bool coalesce(WindowSystemEvent *queued, WindowSystemEvent *ev);
     template<typename Delivery = QWindowSystemInterface::DefaultDelivery>
     static bool handleWindowSystemEvent(WindowSystemEvent *ev);
 
@@ -526,6 +541,7 @@ public:
     static QElapsedTimer eventTime;
     static bool synchronousWindowSystemEvents;
     static bool platformFiltersEvents;
+    static bool platformCoalescesInputEvents;
 
     static QWaitCondition eventsFlushed;
     static QMutex flushEventMutex;
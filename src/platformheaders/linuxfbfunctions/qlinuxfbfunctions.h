@@ -42,16 +42,50 @@
 
 #include <QtCore/QByteArray>
 #include <QtGui/QGuiApplication>
+#include <QtGui/QRegion>
+#include <QtGui/QWindow>
 
 QT_BEGIN_NAMESPACE
 
 class QLinuxFbFunctions
 {
 public:
+    enum UpdateMode {
+        UpdateModeAuto,
+        UpdateModeFast,
+        UpdateModeGrayscale,
+        UpdateModeFull
+    };
+
+    struct FrameStatistics {
+        quint64 frameCount;
+        quint64 flipCount;
+        quint64 missedVBlankCount;
+        qint64 lastComposeTime;
+        qint64 lastOutputTime;
+        qint64 lastFlipLatency;
+        qint64 maxFlipLatency;
+        qint64 lastDirtyArea;
+        qint64 totalComposeTime;
+        qint64 totalOutputTime;
+        qint64 totalFlipLatency;
+        qint64 totalDirtyArea;
+    };
+
     typedef void (*LoadKeymapType)(const QString &filename);
     typedef void (*SwitchLangType)();
+    typedef void (*SetUpdateModeType)(QWindow *window, const QRegion &region, UpdateMode mode);
+    typedef void (*WaitForUpdatesType)();
+    typedef void (*SetFastInkAreaType)(QWindow *window, const QRegion &area, qreal penWidth);
+    typedef FrameStatistics (*FrameStatisticsType)();
+    typedef void (*ResetFrameStatisticsType)();
     static QByteArray loadKeymapTypeIdentifier() { return QByteArrayLiteral("LinuxFbLoadKeymap"); }
     static QByteArray switchLangTypeIdentifier() { return QByteArrayLiteral("LinuxFbSwitchLang"); }
+    static QByteArray setUpdateModeTypeIdentifier() { return QByteArrayLiteral("LinuxFbSetUpdateMode"); }
+    static QByteArray waitForUpdatesTypeIdentifier() { return QByteArrayLiteral("LinuxFbWaitForUpdates"); }
+    static QByteArray setFastInkAreaTypeIdentifier() { return QByteArrayLiteral("LinuxFbSetFastInkArea"); }
+    static QByteArray frameStatisticsTypeIdentifier() { return QByteArrayLiteral("LinuxFbFrameStatistics"); }
+    static QByteArray resetFrameStatisticsTypeIdentifier() { return QByteArrayLiteral("LinuxFbResetFrameStatistics"); }
 
     static void loadKeymap(const QString &filename)
     {
@@ -66,6 +100,47 @@ public:
         if (func)
             func();
     }
+
+    static void setUpdateMode(QWindow *window, const QRegion &region, UpdateMode mode)
+    {
+        SetUpdateModeType func = reinterpret_cast<SetUpdateModeType>(QGuiApplication::platformFunction(setUpdateModeTypeIdentifier()));
+        if (func)
+            func(window, region, mode);
+    }
+
+    static void setWindowUpdateMode(QWindow *window, UpdateMode mode)
+    {
+        window->setProperty("_q_platform_fbUpdateMode", int(mode));
+    }
+
+    static void waitForUpdates()
+    {
+        WaitForUpdatesType func = reinterpret_cast<WaitForUpdatesType>(QGuiApplication::platformFunction(waitForUpdatesTypeIdentifier()));
+        if (func)
+            func();
+    }
+
+    static void setFastInkArea(QWindow *window, const QRegion &area, qreal penWidth = 2)
+    {
+        SetFastInkAreaType func = reinterpret_cast<SetFastInkAreaType>(QGuiApplication::platformFunction(setFastInkAreaTypeIdentifier()));
+        if (func)
+            func(window, area, penWidth);
+    }
+
+    static FrameStatistics frameStatistics()
+    {
+        FrameStatisticsType func = reinterpret_cast<FrameStatisticsType>(QGuiApplication::platformFunction(frameStatisticsTypeIdentifier()));
+        if (func)
+            return func();
+        return FrameStatistics();
+    }
+
+    static void resetFrameStatistics()
+    {
+        ResetFrameStatisticsType func = reinterpret_cast<ResetFrameStatisticsType>(QGuiApplication::platformFunction(resetFrameStatisticsTypeIdentifier()));
+        if (func)
+            func();
+    }
 };
 
 
@@ -46,7 +46,9 @@ QT_BEGIN_NAMESPACE
 class QAbstractEventDispatcher *QtGenericUnixDispatcher::createUnixEventDispatcher()
 {
 #if !defined(QT_NO_GLIB) && !defined(Q_OS_WIN)
-    if (qEnvironmentVariableIsEmpty("QT_NO_GLIB") && QEventDispatcherGlib::versionSupported())
+    // QUnixEventDispatcherQPA can use epoll
+    if (qEnvironmentVariableIsEmpty("QT_NO_GLIB") && QEventDispatcherGlib::versionSupported()
+        && qEnvironmentVariableIntValue("QT_EVENT_DISPATCHER_EPOLL") <= 0)
         return new QPAEventDispatcherGlib();
     else
 #endif
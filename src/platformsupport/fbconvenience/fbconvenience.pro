@@ -12,6 +12,7 @@ SOURCES += \
     qfbbackingstore.cpp \
     qfbwindow.cpp \
     qfbcursor.cpp \
+    qfbinkoverlay.cpp \
     qfbvthandler.cpp
 
 HEADERS += \
@@ -19,6 +20,10 @@ HEADERS += \
     qfbbackingstore_p.h \
     qfbwindow_p.h \
     qfbcursor_p.h \
+    qfbinkoverlay_p.h \
     qfbvthandler_p.h
 
+TRACEPOINT_PROVIDER = $$PWD/qtfbsupport.tracepoints
+CONFIG += qt_tracepoints
+
 load(qt_module)
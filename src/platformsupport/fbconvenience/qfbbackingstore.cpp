@@ -48,7 +48,7 @@
 QT_BEGIN_NAMESPACE
 
 QFbBackingStore::QFbBackingStore(QWindow *window)
-    : QPlatformBackingStore(window)
+    : QPlatformBackingStore(window), mScanout(nullptr), mScanoutMutex(nullptr), mScanoutLocked(false)
 {
     if (window->handle())
         (static_cast<QFbWindow *>(window->handle()))->setBackingStore(this);
@@ -58,6 +58,9 @@ QFbBackingStore::QFbBackingStore(QWindow *window)
 
 QFbBackingStore::~QFbBackingStore()
 {
+    // A frame being composed on the compositor thread may still refer to us
+    if (QPlatformWindow *handle = window()->handle())
+        static_cast<QFbWindow *>(handle)->platformScreen()->waitForCompositor();
 }
 
 void QFbBackingStore::flush(QWindow *window, const QRegion &region, const QPoint &offset)
@@ -72,8 +75,12 @@ void QFbBackingStore::resize(const QSize &size, const QRegion &staticContents)
 {
     Q_UNUSED(staticContents);
 
-    if (mImage.size() != size)
-        mImage = QImage(size, window()->screen()->handle()->format());
+    if (mImage.size() != size) {
+        const QImage image(size, window()->screen()->handle()->format());
+        lock();
+        mImage = image;
+        unlock();
+    }
 }
 
 const QImage QFbBackingStore::image()
@@ -97,9 +104,45 @@ void QFbBackingStore::unlock()
     mImageMutex.unlock();
 }
 
+// Makes the backing store paint straight into the memory wrapped by scanout,
+// which must match the size and format of the current image, carrying the
+// current content over. Writing to that memory is then done while holding
+// scanoutMutex.
+void QFbBackingStore::beginDirectScanout(const QImage &scanout, QMutex *scanoutMutex)
+{
+    lock();
+    const QMutexLocker scanoutLocker(scanoutMutex);
+    // Wrap the memory in an image of our own: painting into an image whose
+    // data is shared would detach it instead of writing to the scanout.
+    QImage image(const_cast<uchar *>(scanout.constBits()), scanout.width(), scanout.height(),
+                 scanout.bytesPerLine(), scanout.format());
+    const int bytesPerLine = qMin(image.bytesPerLine(), mImage.bytesPerLine());
+    for (int y = 0; y < image.height(); ++y)
+        memcpy(image.scanLine(y), mImage.constScanLine(y), bytesPerLine);
+    mImage = image;
+    mScanout = mImage.constBits();
+    mScanoutMutex = scanoutMutex;
+    unlock();
+}
+
+void QFbBackingStore::endDirectScanout()
+{
+    lock();
+    if (isDirectScanout()) {
+        const QMutexLocker scanoutLocker(mScanoutMutex);
+        mImage = mImage.copy();
+    }
+    mScanout = nullptr;
+    mScanoutMutex = nullptr;
+    unlock();
+}
+
 void QFbBackingStore::beginPaint(const QRegion &region)
 {
     lock();
+    mScanoutLocked = isDirectScanout();
+    if (mScanoutLocked)
+        mScanoutMutex->lock();
 
     if (mImage.hasAlphaChannel()) {
         QPainter p(&mImage);
@@ -111,6 +154,9 @@ void QFbBackingStore::beginPaint(const QRegion &region)
 
 void QFbBackingStore::endPaint()
 {
+    if (mScanoutLocked)
+        mScanoutMutex->unlock();
+    mScanoutLocked = false;
     unlock();
 }
 
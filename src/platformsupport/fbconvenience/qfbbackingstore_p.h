@@ -77,6 +77,10 @@ public:
     void lock();
     void unlock();
 
+    void beginDirectScanout(const QImage &scanout, QMutex *scanoutMutex);
+    void endDirectScanout();
+    bool isDirectScanout() const { return mScanout && mImage.constBits() == mScanout; }
+
     void beginPaint(const QRegion &) override;
     void endPaint() override;
 
@@ -85,6 +89,9 @@ protected:
 
     QImage mImage;
     QMutex mImageMutex;
+    const uchar *mScanout;
+    QMutex *mScanoutMutex;
+    bool mScanoutLocked;
 };
 
 QT_END_NAMESPACE
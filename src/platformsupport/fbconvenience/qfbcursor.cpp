@@ -122,6 +122,17 @@ void QFbCursor::pointerEvent(const QMouseEvent &e)
 }
 
 QRect QFbCursor::drawCursor(QPainter & painter)
+{
+    QImage image;
+    const QRect rect = takeCursorImage(&image);
+    if (!rect.isNull())
+        painter.drawImage(rect, image);
+    return rect;
+}
+
+// Updates the state as drawCursor() does, but leaves the drawing of image at
+// the returned rectangle to the caller, e.g. to a compositor thread.
+QRect QFbCursor::takeCursorImage(QImage *image)
 {
     if (!mVisible)
         return QRect();
@@ -137,7 +148,7 @@ QRect QFbCursor::drawCursor(QPainter & painter)
         return QRect();
 
     mPrevRect = mCurrentRect;
-    painter.drawImage(mPrevRect, *mCursorImage->image());
+    *image = *mCursorImage->image();
     mOnScreen = true;
     return mPrevRect;
 }
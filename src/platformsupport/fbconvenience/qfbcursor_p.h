@@ -85,6 +85,7 @@ public:
     // output methods
     QRect dirtyRect();
     virtual QRect drawCursor(QPainter &painter);
+    QRect takeCursorImage(QImage *image);
 
     // input methods
     void pointerEvent(const QMouseEvent &event) override;
@@ -95,13 +96,16 @@ public:
 #endif
 
     virtual void setDirty();
+    virtual bool isVisible() const { return mVisible; }
     virtual bool isDirty() const { return mDirty; }
     virtual bool isOnScreen() const { return mOnScreen; }
     virtual QRect lastPainted() const { return mPrevRect; }
+    // Whether the compositor draws the cursor into the screen image
+    virtual bool isSoftwareCursor() const { return true; }
 
-    void updateMouseStatus();
+    virtual void updateMouseStatus();
 
-private:
+protected:
     void setCursor(const uchar *data, const uchar *mask, int width, int height, int hotX, int hotY);
     void setCursor(Qt::CursorShape shape);
     void setCursor(const QImage &image, int hotx, int hoty);
@@ -0,0 +1,111 @@
+/****************************************************************************
+**
+** Copyright (C) 2020 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the plugins of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "qfbinkoverlay_p.h"
+#include "qfbscreen_p.h"
+
+#include <QtGui/QPainter>
+#include <QtCore/QMutexLocker>
+#include <QtCore/qmath.h>
+
+QT_BEGIN_NAMESPACE
+
+// Draws a preview of pen strokes straight into the memory being scanned out,
+// from the thread of the tablet input handler. The application is expected to
+// draw the actual stroke soon after; once the pen is lifted the area of the
+// preview is recomposed to replace it with what the application drew.
+
+QFbInkOverlay::QFbInkOverlay(QFbScreen *screen)
+    : mScreen(screen),
+      mPenWidth(1),
+      mLastDown(false)
+{
+}
+
+// Called on the GUI thread, while the overlay is not installed.
+void QFbInkOverlay::setArea(const QRegion &area, qreal penWidth)
+{
+    mArea = area.translated(-mScreen->geometry().topLeft()) & QRect(QPoint(0, 0), mScreen->geometry().size());
+    mPenWidth = penWidth;
+    mLastDown = false;
+
+    // Wrap the scanout memory in images of our own, painting into a shared
+    // image would detach it.
+    mTargets.clear();
+    const QVector<QImage> buffers = mScreen->scanoutBuffers();
+    for (const QImage &buffer : buffers) {
+        mTargets.append(QImage(const_cast<uchar *>(buffer.constBits()), buffer.width(), buffer.height(),
+                               buffer.bytesPerLine(), buffer.format()));
+    }
+}
+
+void QFbInkOverlay::tabletSample(const QPointF &globalPos, bool down)
+{
+    const QPointF pos = globalPos - mScreen->geometry().topLeft();
+    if (down && mLastDown) {
+        const int margin = qCeil(mPenWidth / 2) + 1;
+        const QRect segment = QRectF(mLastPos, pos).normalized().toAlignedRect()
+                                  .adjusted(-margin, -margin, margin, margin);
+        const QRegion clip = mArea & segment;
+        if (!clip.isEmpty()) {
+            // The compositor and windows scanned out directly write into the
+            // same memory from other threads
+            const QMutexLocker locker(mScreen->scanoutMutex());
+            for (QImage &target : mTargets) {
+                QPainter painter(&target);
+                painter.setClipRegion(clip);
+                painter.setPen(QPen(Qt::black, mPenWidth, Qt::SolidLine, Qt::RoundCap));
+                painter.drawLine(mLastPos, pos);
+            }
+            mScreen->scanoutUpdated(clip.boundingRect());
+            mStrokeBounds |= clip.boundingRect();
+        }
+    } else if (!down && mLastDown && !mStrokeBounds.isEmpty()) {
+        QFbScreen *screen = mScreen;
+        const QRect bounds = mStrokeBounds.translated(mScreen->geometry().topLeft());
+        QMetaObject::invokeMethod(screen, [screen, bounds] { screen->setDirty(bounds); },
+                                  Qt::QueuedConnection);
+        mStrokeBounds = QRect();
+    }
+
+    mLastDown = down;
+    mLastPos = pos;
+}
+
+QT_END_NAMESPACE
@@ -45,23 +45,123 @@
 #include <QtGui/QPainter>
 #include <QtCore/QCoreApplication>
 #include <qpa/qwindowsysteminterface.h>
+#include <QtGui/private/qimage_p.h>
 
 #include <QtCore/QDebug>
 #include <QtCore/QElapsedTimer>
+#include <QtCore/QLoggingCategory>
+#include <QtCore/QThread>
+#include <QtCore/QWaitCondition>
+
+#include <qtfb_support_private_tracepoints_p.h>
 
 QT_BEGIN_NAMESPACE
 
+Q_LOGGING_CATEGORY(lcFbStats, "qt.qpa.fb.stats")
+
+// Composes the frames prepared by the screen on the GUI thread, and outputs
+// them through doRedraw(), one frame at a time. Output that blocks, like
+// waiting for a page flip, then no longer holds up the GUI thread.
+class QFbCompositorThread : public QThread
+{
+public:
+    explicit QFbCompositorThread(QFbScreen *screen)
+        : mScreen(screen), mBusy(false), mUpdateWhenDone(false), mQuit(false)
+    {
+        setObjectName(QStringLiteral("QFbCompositor"));
+    }
+
+    // Returns whether the screen may prepare a new frame. If not, the
+    // previous one is still being composed and the screen receives an
+    // update request once that is done.
+    bool isIdle()
+    {
+        QMutexLocker locker(&mMutex);
+        if (mBusy)
+            mUpdateWhenDone = true;
+        return !mBusy;
+    }
+
+    // Hands over the frame prepared in mScreen->mFrame
+    void post()
+    {
+        QMutexLocker locker(&mMutex);
+        mBusy = true;
+        mWake.wakeOne();
+    }
+
+    void waitForIdle()
+    {
+        QMutexLocker locker(&mMutex);
+        while (mBusy)
+            mIdle.wait(&mMutex);
+    }
+
+    void stop()
+    {
+        {
+            QMutexLocker locker(&mMutex);
+            mQuit = true;
+            mWake.wakeOne();
+        }
+        wait();
+    }
+
+protected:
+    void run() override
+    {
+        QMutexLocker locker(&mMutex);
+        for (;;) {
+            while (!mBusy && !mQuit)
+                mWake.wait(&mMutex);
+            if (mQuit)
+                break;
+            locker.unlock();
+            const bool frameShown = mScreen->redraw();
+            locker.relock();
+            mBusy = false;
+            mIdle.wakeAll();
+            if (mScreen->flags().testFlag(QFbScreen::SyncsToVBlank)) {
+                QFbScreen *screen = mScreen;
+                QMetaObject::invokeMethod(screen, [screen, frameShown] {
+                    screen->deliverUpdateRequests(frameShown);
+                }, Qt::QueuedConnection);
+            }
+            if (mUpdateWhenDone) {
+                mUpdateWhenDone = false;
+                QCoreApplication::postEvent(mScreen, new QEvent(QEvent::UpdateRequest));
+            }
+        }
+    }
+
+private:
+    QFbScreen *mScreen;
+    QMutex mMutex;
+    QWaitCondition mWake;
+    QWaitCondition mIdle;
+    bool mBusy;
+    bool mUpdateWhenDone;
+    bool mQuit;
+};
+
 QFbScreen::QFbScreen()
     : mUpdatePending(false),
       mCursor(0),
       mDepth(16),
       mFormat(QImage::Format_RGB16),
-      mPainter(nullptr)
+      mDitherFlags(Qt::OrderedDither),
+      mPainter(nullptr),
+      mCompositorThread(nullptr),
+      mComposeTime(0),
+      mComposedArea(0),
+      mDirectScanoutEnabled(false),
+      mDirectScanoutWindow(nullptr)
 {
 }
 
 QFbScreen::~QFbScreen()
 {
+    setCompositorThreadEnabled(false);
     delete mPainter;
 }
 
@@ -74,7 +174,17 @@ void QFbScreen::initializeCompositor()
 bool QFbScreen::event(QEvent *event)
 {
     if (event->type() == QEvent::UpdateRequest) {
-        doRedraw();
+        if (mCompositorThread) {
+            // While a frame is being composed the update stays pending
+            if (!mCompositorThread->isIdle())
+                return true;
+            if (prepareFrame())
+                mCompositorThread->post();
+        } else {
+            const bool frameShown = redraw();
+            if (flags().testFlag(SyncsToVBlank))
+                deliverUpdateRequests(frameShown);
+        }
         mUpdatePending = false;
         return true;
     }
@@ -105,6 +215,13 @@ void QFbScreen::addWindow(QFbWindow *window)
 
 void QFbScreen::removeWindow(QFbWindow *window)
 {
+    // The window's backing store may go away after this
+    waitForCompositor();
+    if (window == mDirectScanoutWindow) {
+        if (QFbBackingStore *backingStore = window->backingStore())
+            backingStore->endDirectScanout();
+        mDirectScanoutWindow = nullptr;
+    }
     mWindowStack.removeOne(window);
     setDirty(window->geometry());
     QWindow *w = topWindow();
@@ -175,6 +292,129 @@ void QFbScreen::scheduleUpdate()
     }
 }
 
+// Holds back the update request of window until the next frame, which will
+// contain what the window paints before returning to the event loop, is on the
+// display. Only for screens that sync to the vertical blank.
+void QFbScreen::scheduleUpdateRequest(QFbWindow *window)
+{
+    QWindow *w = window->window();
+    if (!mUpdateRequests.contains(w))
+        mUpdateRequests.append(w);
+    scheduleUpdate();
+}
+
+void QFbScreen::deliverUpdateRequests(bool frameShown)
+{
+    const QVector<QPointer<QWindow>> requests = std::move(mUpdateRequests);
+    mUpdateRequests.clear();
+    for (const QPointer<QWindow> &w : requests) {
+        QPlatformWindow *handle = w ? w->handle() : nullptr;
+        if (!handle || !handle->hasPendingUpdateRequest())
+            continue;
+        // Without a frame there was nothing to wait for, do not spin: use
+        // the timer for windows requesting updates without painting.
+        if (frameShown)
+            handle->deliverUpdateRequest();
+        else
+            handle->QPlatformWindow::requestUpdate();
+    }
+}
+
+// Requests region, in global coordinates, to be refreshed with mode the next
+// time it is redrawn. Where requests overlap the highest quality mode wins.
+void QFbScreen::setUpdateMode(const QRegion &region, UpdateMode mode)
+{
+    if (mode <= UpdateModeAuto || mode > UpdateModeFull || !flags().testFlag(SupportsUpdateModes))
+        return;
+    const QPoint screenOffset = mGeometry.topLeft();
+    const QMutexLocker locker(&mUpdateModeMutex);
+    mUpdateModeRegions[mode] += region.intersected(mGeometry).translated(-screenOffset);
+}
+
+// Splits region, in screen coordinates, according to the update modes
+// requested for it, and forgets about these requests. Parts without any
+// request are reported as UpdateModeAuto.
+QVector<QPair<QFbScreen::UpdateMode, QRegion> > QFbScreen::takeUpdateModes(const QRegion &region)
+{
+    QRegion modeRegions[UpdateModeFull + 1];
+    QRegion remaining = region;
+    const QMutexLocker locker(&mUpdateModeMutex);
+    for (int mode = UpdateModeFull; mode > UpdateModeAuto; --mode) {
+        if (mUpdateModeRegions[mode].isEmpty())
+            continue;
+        modeRegions[mode] = remaining.intersected(mUpdateModeRegions[mode]);
+        mUpdateModeRegions[mode] -= region;
+        remaining -= modeRegions[mode];
+    }
+    modeRegions[UpdateModeAuto] = remaining;
+
+    QVector<QPair<UpdateMode, QRegion> > updates;
+    for (int mode = UpdateModeAuto; mode <= UpdateModeFull; ++mode) {
+        if (!modeRegions[mode].isEmpty())
+            updates.append(qMakePair(UpdateMode(mode), modeRegions[mode]));
+    }
+    return updates;
+}
+
+// When enabled, a single visible window covering the whole screen paints
+// directly into the memory returned by scanoutImage(), skipping composition.
+// The screen falls back to compositing as soon as this no longer holds.
+void QFbScreen::setDirectScanoutEnabled(bool enabled)
+{
+    if (mDirectScanoutEnabled == enabled)
+        return;
+    mDirectScanoutEnabled = enabled;
+    setDirty(mGeometry);
+}
+
+void QFbScreen::updateDirectScanout()
+{
+    QFbWindow *candidate = nullptr;
+    // A window scanned out directly leaves no room for a cursor drawn by the
+    // compositor, one shown on a hardware plane is fine.
+    if (mDirectScanoutEnabled
+        && (!mCursor || !mCursor->isVisible() || !mCursor->isSoftwareCursor())) {
+        for (QFbWindow *fbw : qAsConst(mWindowStack)) {
+            if (!fbw->window()->isVisible())
+                continue;
+            if (candidate) {
+                candidate = nullptr;
+                break;
+            }
+            candidate = fbw;
+        }
+    }
+    QFbBackingStore *backingStore = candidate ? candidate->backingStore() : nullptr;
+    if (!backingStore || candidate->geometry() != mGeometry
+        || backingStore->image().size() != mGeometry.size()) {
+        candidate = nullptr;
+    }
+
+    const QRect screenRect = mGeometry.translated(-mGeometry.topLeft());
+    if (mDirectScanoutWindow) {
+        QFbBackingStore *current = mDirectScanoutWindow->backingStore();
+        if (candidate == mDirectScanoutWindow && current && current->isDirectScanout())
+            return;
+        if (current)
+            current->endDirectScanout();
+        mDirectScanoutWindow = nullptr;
+        // mScreenImage went stale while the window was scanned out
+        mRepaintRegion += screenRect;
+    }
+
+    if (!candidate)
+        return;
+
+    const QImage scanout = scanoutImage();
+    if (scanout.isNull() || scanout.size() != mGeometry.size()
+        || scanout.format() != backingStore->image().format()) {
+        return;
+    }
+    backingStore->beginDirectScanout(scanout, &mScanoutMutex);
+    mDirectScanoutWindow = candidate;
+    mRepaintRegion += screenRect;
+}
+
 void QFbScreen::setPhysicalSize(const QSize &size)
 {
     mPhysicalSize = size;
@@ -182,6 +422,7 @@ void QFbScreen::setPhysicalSize(const QSize &size)
 
 void QFbScreen::setGeometry(const QRect &rect)
 {
+    waitForCompositor();
     delete mPainter;
     mPainter = nullptr;
     mGeometry = rect;
@@ -195,55 +436,273 @@ bool QFbScreen::initialize()
     return true;
 }
 
+// Composes the windows into mScreenImage, and returns the region that changed.
+// Subclasses output that region from their reimplementation. With the
+// compositor thread enabled this runs on that thread, for frames prepared on
+// the GUI thread.
 QRegion QFbScreen::doRedraw()
+{
+    if (!mCompositorThread && !prepareFrame())
+        return QRegion();
+    return composeFrame();
+}
+
+// Takes what composing the next frame needs from the windows and the cursor,
+// which live on the GUI thread. Returns false if there is nothing to redraw.
+bool QFbScreen::prepareFrame()
 {
     const QPoint screenOffset = mGeometry.topLeft();
+    Frame &frame = mFrame;
 
-    QRegion touchedRegion;
     if (mCursor && mCursor->isDirty() && mCursor->isOnScreen()) {
         const QRect lastCursor = mCursor->dirtyRect();
         mRepaintRegion += lastCursor;
     }
     if (mRepaintRegion.isEmpty() && (!mCursor || !mCursor->isDirty()))
-        return touchedRegion;
-
-    if (!mPainter)
-        mPainter = new QPainter(&mScreenImage);
+        return false;
 
     const QRect screenRect = mGeometry.translated(-screenOffset);
-    for (QRect rect : mRepaintRegion) {
-        rect = rect.intersected(screenRect);
-        if (rect.isEmpty())
+
+    updateDirectScanout();
+    if (mDirectScanoutWindow) {
+        // The window renders straight into the scanout memory, there is
+        // nothing to compose.
+        frame.directScanout = true;
+        frame.repaint = mRepaintRegion.intersected(screenRect);
+        mRepaintRegion = QRegion();
+        return true;
+    }
+
+    // Windows are blitted with CompositionMode_Source, so the topmost window
+    // covering a pixel fully determines it. Hand each window only the part of
+    // the repaint region not already covered by the windows above it, so that
+    // every pixel is written exactly once.
+    QVector<QRect> layerRects;
+    frame.layers.reserve(mWindowStack.size());
+    layerRects.reserve(mWindowStack.size());
+    for (QFbWindow *fbw : qAsConst(mWindowStack)) {
+        QFbBackingStore *backingStore = fbw->backingStore();
+        if (!backingStore || !fbw->window()->isVisible())
             continue;
+        const QRect windowRect = fbw->geometry().translated(-screenOffset);
+        backingStore->lock();
+        const QSize imageSize = backingStore->image().size();
+        backingStore->unlock();
+        frame.layers.append({ backingStore, windowRect.topLeft(), QRegion() });
+        layerRects.append(windowRect.intersected(QRect(windowRect.topLeft(), imageSize)));
+    }
 
-        mPainter->setCompositionMode(QPainter::CompositionMode_Source);
-        mPainter->fillRect(rect, mScreenImage.hasAlphaChannel() ? Qt::transparent : Qt::black);
+    const QVector<QRegion> layerRegions = occlusionCull(mRepaintRegion.intersected(screenRect),
+                                                        layerRects, &frame.uncovered);
+    for (int i = 0; i < frame.layers.size(); ++i)
+        frame.layers[i].region = layerRegions.at(i);
 
-        for (int layerIndex = mWindowStack.size() - 1; layerIndex != -1; layerIndex--) {
-            if (!mWindowStack[layerIndex]->window()->isVisible())
-                continue;
+    if (mCursor && (mCursor->isDirty() || mRepaintRegion.intersects(mCursor->lastPainted())))
+        frame.cursorRect = mCursor->takeCursorImage(&frame.cursorImage);
+    frame.repaint = mRepaintRegion;
+    mRepaintRegion = QRegion();
 
-            const QRect windowRect = mWindowStack[layerIndex]->geometry().translated(-screenOffset);
-            const QRect windowIntersect = rect.translated(-windowRect.left(), -windowRect.top());
-            QFbBackingStore *backingStore = mWindowStack[layerIndex]->backingStore();
-            if (backingStore) {
-                backingStore->lock();
-                mPainter->drawImage(rect, backingStore->image(), windowIntersect);
-                backingStore->unlock();
-            }
+    return true;
+}
+
+// Composes the frame taken by prepareFrame() into mScreenImage, and returns
+// the region that changed.
+QRegion QFbScreen::composeFrame()
+{
+    Q_TRACE_SCOPE(QFbScreen_composeFrame);
+    QElapsedTimer timer;
+    timer.start();
+
+    Frame frame;
+    qSwap(frame, mFrame);
+
+    QRegion touchedRegion;
+    qint64 composedArea = 0;
+    if (frame.directScanout)
+        return frame.repaint;
+
+    if (!mPainter)
+        mPainter = new QPainter(&mScreenImage);
+
+    mPainter->setCompositionMode(QPainter::CompositionMode_Source);
+    for (const Layer &layer : qAsConst(frame.layers)) {
+        if (layer.region.isEmpty())
+            continue;
+        // Painting on the GUI thread holds the lock too, so the image cannot
+        // change, nor be replaced, while it is being blitted.
+        layer.backingStore->lock();
+        const QImage image = layer.backingStore->image();
+        for (const QRect &rect : layer.region) {
+            mPainter->drawImage(rect, image, rect.translated(-layer.offset));
+            composedArea += qint64(rect.width()) * rect.height();
         }
+        layer.backingStore->unlock();
     }
 
-    if (mCursor && (mCursor->isDirty() || mRepaintRegion.intersects(mCursor->lastPainted()))) {
+    for (const QRect &rect : frame.uncovered) {
+        mPainter->fillRect(rect, mScreenImage.hasAlphaChannel() ? Qt::transparent : Qt::black);
+        composedArea += qint64(rect.width()) * rect.height();
+    }
+
+    if (!frame.cursorRect.isNull()) {
         mPainter->setCompositionMode(QPainter::CompositionMode_SourceOver);
-        touchedRegion += mCursor->drawCursor(*mPainter);
+        mPainter->drawImage(frame.cursorRect, frame.cursorImage);
+        touchedRegion += frame.cursorRect;
+        composedArea += qint64(frame.cursorRect.width()) * frame.cursorRect.height();
     }
-    touchedRegion += mRepaintRegion;
-    mRepaintRegion = QRegion();
+    touchedRegion += frame.repaint;
 
+    mComposeTime = timer.nsecsElapsed();
+    mComposedArea = composedArea;
     return touchedRegion;
 }
 
+// Outputs a frame through doRedraw() and accounts for it. Returns false if
+// there was nothing to output.
+bool QFbScreen::redraw()
+{
+    QElapsedTimer timer;
+    timer.start();
+    mComposeTime = 0;
+    mComposedArea = 0;
+    QRegion region;
+    {
+        Q_TRACE_SCOPE(QFbScreen_doRedraw);
+        region = doRedraw();
+    }
+    if (region.isEmpty())
+        return false;
+
+    const qint64 outputTime = timer.nsecsElapsed() - mComposeTime;
+    qint64 dirtyArea = 0;
+    for (const QRect &rect : region)
+        dirtyArea += qint64(rect.width()) * rect.height();
+    Q_TRACE(QFbScreen_frameDone, mComposeTime, outputTime, dirtyArea);
+
+    QMutexLocker locker(&mStatisticsMutex);
+    ++mStatistics.frameCount;
+    mStatistics.lastComposeTime = mComposeTime;
+    mStatistics.lastOutputTime = outputTime;
+    mStatistics.lastDirtyArea = dirtyArea;
+    mStatistics.lastComposedArea = mComposedArea;
+    mStatistics.totalComposeTime += mComposeTime;
+    mStatistics.totalOutputTime += outputTime;
+    mStatistics.totalDirtyArea += dirtyArea;
+    mStatistics.totalComposedArea += mComposedArea;
+    const FrameStatistics statistics = mStatistics;
+    locker.unlock();
+
+    qCDebug(lcFbStats, "frame %llu: %lld pixels, composed in %lld us, output in %lld us, "
+                       "last flip after %lld us, %llu vblanks missed",
+            statistics.frameCount, dirtyArea, mComposeTime / 1000, outputTime / 1000,
+            statistics.lastFlipLatency / 1000, statistics.missedVBlankCount);
+    return true;
+}
+
+// For screens that sync to the vertical blank: flips.count page flips
+// completed since the last call.
+void QFbScreen::recordFlips(const FlipStatistics &flips)
+{
+    Q_TRACE(QFbScreen_flipsDone, flips.count, flips.lastLatency, flips.maxLatency, flips.missedVBlanks);
+    const QMutexLocker locker(&mStatisticsMutex);
+    mStatistics.flipCount += flips.count;
+    mStatistics.missedVBlankCount += flips.missedVBlanks;
+    mStatistics.lastFlipLatency = flips.lastLatency;
+    mStatistics.maxFlipLatency = qMax(mStatistics.maxFlipLatency, flips.maxLatency);
+    mStatistics.totalFlipLatency += flips.totalLatency;
+}
+
+// May be called from any thread
+QFbScreen::FrameStatistics QFbScreen::frameStatistics() const
+{
+    const QMutexLocker locker(&mStatisticsMutex);
+    return mStatistics;
+}
+
+void QFbScreen::resetFrameStatistics()
+{
+    const QMutexLocker locker(&mStatisticsMutex);
+    mStatistics = FrameStatistics();
+}
+
+// Moves composition and output to a thread of their own. Subclasses that
+// enable it must disable it again in their destructor, before releasing
+// anything their doRedraw() uses.
+void QFbScreen::setCompositorThreadEnabled(bool enabled)
+{
+    if (enabled == (mCompositorThread != nullptr))
+        return;
+    if (enabled) {
+        mCompositorThread = new QFbCompositorThread(this);
+        mCompositorThread->start();
+    } else {
+        mCompositorThread->waitForIdle();
+        mCompositorThread->stop();
+        delete mCompositorThread;
+        mCompositorThread = nullptr;
+    }
+}
+
+// Blocks until the frame being composed, if any, has been output. Needed
+// before changing anything a frame in progress may use.
+void QFbScreen::waitForCompositor() const
+{
+    if (mCompositorThread)
+        mCompositorThread->waitForIdle();
+}
+
+// Splits region between layers, given from top to bottom, so that each point
+// ends up in at most one of the returned regions: the one of the topmost layer
+// covering it. What no layer covers is stored in uncovered.
+QVector<QRegion> QFbScreen::occlusionCull(const QRegion &region, const QVector<QRect> &layers,
+                                          QRegion *uncovered)
+{
+    QVector<QRegion> result(layers.size());
+    QRegion remaining = region;
+    for (int i = 0; i < layers.size() && !remaining.isEmpty(); ++i) {
+        const QRect &layer = layers.at(i);
+        if (layer.isEmpty() || !remaining.intersects(layer))
+            continue;
+        result[i] = remaining.intersected(layer);
+        remaining -= layer;
+    }
+    if (uncovered)
+        *uncovered = remaining;
+    return result;
+}
+
+// Writes region of the screen image to dst as gray pixels of depth bits,
+// packed with the leftmost pixel in the most significant bits. Rectangles are
+// widened to whole bytes; the screen image holds the pixels next to them too.
+// Level 0 is black, unless inverted is true, for displays where it is white.
+void QFbScreen::ditherToPackedGrayscale(const QRegion &region, uchar *dst, qsizetype bytesPerLine,
+                                        int depth, bool inverted) const
+{
+    Q_ASSERT(mScreenImage.format() == QImage::Format_Grayscale8);
+    const int pixelsPerByte = 8 / depth;
+    const QRect screenRect(QPoint(0, 0), mScreenImage.size());
+    for (const QRect &r : region) {
+        const QRect rect = r.intersected(screenRect);
+        if (rect.isEmpty())
+            continue;
+        const int left = rect.left() - rect.left() % pixelsPerByte;
+        const int right = qMin(rect.right() + pixelsPerByte - 1 - rect.right() % pixelsPerByte,
+                               screenRect.right());
+        uchar *first = dst + rect.top() * bytesPerLine + left * depth / 8;
+        qt_dither_grayscale8(first, bytesPerLine,
+                             mScreenImage.constScanLine(rect.top()) + left, mScreenImage.bytesPerLine(),
+                             left, rect.top(), right - left + 1, rect.height(), depth, mDitherFlags);
+        if (inverted) {
+            const int bytes = ((right - left + 1) * depth + 7) / 8;
+            for (int y = 0; y < rect.height(); ++y) {
+                uchar *line = first + y * bytesPerLine;
+                for (int i = 0; i < bytes; ++i)
+                    line[i] = ~line[i];
+            }
+        }
+    }
+}
+
 QFbWindow *QFbScreen::windowForId(WId wid) const
 {
     for (int i = 0; i < mWindowStack.count(); ++i) {
@@ -253,6 +712,33 @@ QFbWindow *QFbScreen::windowForId(WId wid) const
     return nullptr;
 }
 
+// Implements grabWindow() for screens whose contents are in screenImage
+QPixmap QFbScreen::grabScreenImage(const QImage &screenImage, WId wid,
+                                   int x, int y, int width, int height) const
+{
+    if (!wid) {
+        if (width < 0)
+            width = screenImage.width() - x;
+        if (height < 0)
+            height = screenImage.height() - y;
+        return QPixmap::fromImage(screenImage).copy(x, y, width, height);
+    }
+
+    QFbWindow *window = windowForId(wid);
+    if (window) {
+        const QRect geom = window->geometry();
+        if (width < 0)
+            width = geom.width() - x;
+        if (height < 0)
+            height = geom.height() - y;
+        QRect rect(geom.topLeft() + QPoint(x, y), QSize(width, height));
+        rect &= window->geometry();
+        return QPixmap::fromImage(screenImage).copy(rect);
+    }
+
+    return QPixmap();
+}
+
 QFbScreen::Flags QFbScreen::flags() const
 {
     return { };
@@ -54,6 +54,13 @@
 #include <qpa/qplatformscreen.h>
 #include <QtCore/QTimer>
 #include <QtCore/QSize>
+#include <QtCore/QVector>
+#include <QtCore/QPair>
+#include <QtCore/QMutex>
+#include <QtCore/QPointer>
+#include <QtGui/QRegion>
+#include <QtGui/QImage>
+#include <QtGui/QWindow>
 #include "qfbcursor_p.h"
 
 QT_BEGIN_NAMESPACE
@@ -62,6 +69,7 @@ class QFbWindow;
 class QFbCursor;
 class QPainter;
 class QFbBackingStore;
+class QFbCompositorThread;
 
 class QFbScreen : public QObject, public QPlatformScreen
 {
@@ -69,10 +77,54 @@ class QFbScreen : public QObject, public QPlatformScreen
 
 public:
     enum Flag {
-        DontForceFirstWindowToFullScreen = 0x01
+        DontForceFirstWindowToFullScreen = 0x01,
+        SupportsUpdateModes = 0x02,
+        // doRedraw() blocks on the display, e.g. on page flips, so update
+        // requests of windows are paced by it. It need not wait for its own
+        // frame: with triple buffering it returns once the previous frame was
+        // shown, and its own frame is still queued.
+        SyncsToVBlank = 0x04
     };
     Q_DECLARE_FLAGS(Flags, Flag)
 
+    // Refresh modes of e-paper panels, by increasing quality
+    enum UpdateMode {
+        UpdateModeAuto,
+        UpdateModeFast,
+        UpdateModeGrayscale,
+        UpdateModeFull
+    };
+
+    // Times are in nanoseconds, areas in pixels. The composed area counts
+    // every pixel written into the screen image, overdraw included. Flips
+    // are only counted by screens that sync to the vertical blank.
+    struct FrameStatistics {
+        quint64 frameCount = 0;
+        quint64 flipCount = 0;
+        quint64 missedVBlankCount = 0;
+        qint64 lastComposeTime = 0;
+        qint64 lastOutputTime = 0;
+        qint64 lastFlipLatency = 0;
+        qint64 maxFlipLatency = 0;
+        qint64 lastDirtyArea = 0;
+        qint64 lastComposedArea = 0;
+        qint64 totalComposeTime = 0;
+        qint64 totalOutputTime = 0;
+        qint64 totalFlipLatency = 0;
+        qint64 totalDirtyArea = 0;
+        qint64 totalComposedArea = 0;
+    };
+
+    // Page flips completed since they were last recorded, with their
+    // latency from being queued to being shown
+    struct FlipStatistics {
+        int count = 0;
+        int missedVBlanks = 0;
+        qint64 lastLatency = 0;
+        qint64 totalLatency = 0;
+        qint64 maxLatency = 0;
+    };
+
     QFbScreen();
     ~QFbScreen();
 
@@ -99,6 +151,32 @@ public:
     void addPendingBackingStore(QFbBackingStore *bs) { mPendingBackingStores << bs; }
 
     void scheduleUpdate();
+    void scheduleUpdateRequest(QFbWindow *window);
+
+    void setUpdateMode(const QRegion &region, UpdateMode mode);
+    virtual void waitForUpdates() {}
+
+    // Buffers that may be displayed, and notification of changes made to
+    // them behind the compositor's back, e.g. by QFbInkOverlay
+    virtual QVector<QImage> scanoutBuffers() const { return QVector<QImage>(); }
+    virtual void scanoutUpdated(const QRect &rect) { Q_UNUSED(rect); }
+    // Held while writing into the scanout buffers or changing which one is
+    // shown. scanoutUpdated() is called with it held.
+    QMutex *scanoutMutex() const { return &mScanoutMutex; }
+
+    void setCompositorThreadEnabled(bool enabled);
+    bool isCompositorThreadEnabled() const { return mCompositorThread != nullptr; }
+    void waitForCompositor() const;
+
+    FrameStatistics frameStatistics() const;
+    void resetFrameStatistics();
+
+    void setDirectScanoutEnabled(bool enabled);
+    bool isDirectScanoutEnabled() const { return mDirectScanoutEnabled; }
+    bool isDirectScanoutActive() const { return mDirectScanoutWindow != nullptr; }
+
+    static QVector<QRegion> occlusionCull(const QRegion &region, const QVector<QRect> &layers,
+                                          QRegion *uncovered = nullptr);
 
 public slots:
     virtual void setDirty(const QRect &rect);
@@ -107,11 +185,22 @@ public slots:
 
 protected:
     virtual QRegion doRedraw();
+    virtual QImage scanoutImage() { return QImage(); }
+    QVector<QPair<UpdateMode, QRegion> > takeUpdateModes(const QRegion &region);
 
     void initializeCompositor();
     bool event(QEvent *event) override;
 
+    // For gray framebuffers of less than 8 bits per pixel, which have no
+    // QImage format: composite in Grayscale8 and dither when blitting.
+    void ditherToPackedGrayscale(const QRegion &region, uchar *dst, qsizetype bytesPerLine,
+                                 int depth, bool inverted = false) const;
+
     QFbWindow *windowForId(WId wid) const;
+    QPixmap grabScreenImage(const QImage &screenImage, WId wid,
+                            int x, int y, int width, int height) const;
+
+    void recordFlips(const FlipStatistics &flips);
 
     QList<QFbWindow *> mWindowStack;
     QRegion mRepaintRegion;
@@ -123,12 +212,47 @@ protected:
     QImage::Format mFormat;
     QSizeF mPhysicalSize;
     QImage mScreenImage;
+    Qt::ImageConversionFlags mDitherFlags;
 
 private:
+    // What composing a frame needs to know about the windows and the cursor
+    struct Layer {
+        QFbBackingStore *backingStore;
+        QPoint offset;
+        QRegion region;
+    };
+    struct Frame {
+        QVector<Layer> layers;
+        QRegion uncovered;
+        QRegion repaint;
+        QImage cursorImage;
+        QRect cursorRect;
+        bool directScanout = false;
+    };
+
+    bool prepareFrame();
+    QRegion composeFrame();
+    bool redraw();
+    void deliverUpdateRequests(bool frameShown);
+    void updateDirectScanout();
+
     QPainter *mPainter;
+    Frame mFrame;
+    QFbCompositorThread *mCompositorThread;
+    QMutex mUpdateModeMutex;
+    QVector<QPointer<QWindow>> mUpdateRequests;
+    qint64 mComposeTime;
+    qint64 mComposedArea;
+    FrameStatistics mStatistics;
+    mutable QMutex mStatisticsMutex;
+    mutable QMutex mScanoutMutex;
     QList<QFbBackingStore*> mPendingBackingStores;
+    bool mDirectScanoutEnabled;
+    QFbWindow *mDirectScanoutWindow;
+    QRegion mUpdateModeRegions[UpdateModeFull + 1];
 
     friend class QFbWindow;
+    friend class QFbCompositorThread;
 };
 
 Q_DECLARE_OPERATORS_FOR_FLAGS(QFbScreen::Flags)
@@ -40,6 +40,7 @@
 #include "qfbwindow_p.h"
 #include "qfbscreen_p.h"
 
+#include <QtCore/QVariant>
 #include <QtGui/QScreen>
 #include <qpa/qwindowsysteminterface.h>
 
@@ -135,6 +136,15 @@ void QFbWindow::lower()
     QWindowSystemInterface::handleExposeEvent(window(), QRect(QPoint(0, 0), geometry().size()));
 }
 
+void QFbWindow::requestUpdate()
+{
+    QFbScreen *fbScreen = platformScreen();
+    if (fbScreen->flags().testFlag(QFbScreen::SyncsToVBlank))
+        fbScreen->scheduleUpdateRequest(this);
+    else
+        QPlatformWindow::requestUpdate();
+}
+
 void QFbWindow::repaint(const QRegion &region)
 {
     const QRect currentGeometry = geometry();
@@ -146,6 +156,11 @@ void QFbWindow::repaint(const QRegion &region)
     if (oldGeometryLocal != currentGeometry)
         platformScreen()->setDirty(oldGeometryLocal);
     platformScreen()->setDirty(dirtyRegion);
+
+    // Windows may ask for all their updates to use a given e-paper refresh mode
+    const QVariant updateMode = window()->property("_q_platform_fbUpdateMode");
+    if (updateMode.isValid())
+        platformScreen()->setUpdateMode(dirtyRegion, QFbScreen::UpdateMode(updateMode.toInt()));
 }
 
 QT_END_NAMESPACE
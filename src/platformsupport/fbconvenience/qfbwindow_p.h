@@ -82,6 +82,7 @@ public:
     QFbScreen *platformScreen() const;
 
     virtual void repaint(const QRegion&);
+    void requestUpdate() override;
 
     void propagateSizeHints() override { }
     bool setKeyboardGrabEnabled(bool) override { return false; }
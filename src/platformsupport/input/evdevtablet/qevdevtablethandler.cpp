@@ -45,6 +45,7 @@
 #include <QLoggingCategory>
 #include <QtCore/private/qcore_unix_p.h>
 #include <qpa/qwindowsysteminterface.h>
+#include <QtGui/private/qinputdevicemanager_p.h>
 #ifdef Q_OS_FREEBSD
 #include <dev/evdev/input.h>
 #else
@@ -149,6 +150,8 @@ void QEvdevTabletData::report()
     qreal pressure = pressureRange ? (state.p - minValues.p) / qreal(pressureRange) : qreal(1);
 
     if (state.down || state.lastReportDown) {
+        // Let the ink overlay draw before the event even reaches the GUI thread
+        QInputDeviceManager::handleInkSample(globalPos, state.down);
         QWindowSystemInterface::handleTabletEvent(0, QPointF(), globalPos,
                                                   QTabletEvent::Stylus, pointer,
                                                   state.down ? Qt::LeftButton : Qt::NoButton,
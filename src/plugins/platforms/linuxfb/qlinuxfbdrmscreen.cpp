@@ -43,23 +43,33 @@
 // Multiscreen: QWindow-QScreen(-output) association. Needs some reorg (device cannot be owned by screen)
 // Find card via devicediscovery like in eglfs_kms.
 // Mode restore like QEglFSKmsInterruptHandler.
-// grabWindow
 
 #include "qlinuxfbdrmscreen.h"
 #include <QLoggingCategory>
 #include <QGuiApplication>
 #include <QPainter>
+#include <QMouseEvent>
+#include <QVarLengthArray>
 #include <QtFbSupport/private/qfbcursor_p.h>
 #include <QtFbSupport/private/qfbwindow_p.h>
 #include <QtKmsSupport/private/qkmsdevice_p.h>
 #include <QtCore/private/qcore_unix_p.h>
 #include <sys/mman.h>
+#include <time.h>
+
+#ifndef DRM_CAP_CURSOR_WIDTH
+#define DRM_CAP_CURSOR_WIDTH 0x8
+#endif
+
+#ifndef DRM_CAP_CURSOR_HEIGHT
+#define DRM_CAP_CURSOR_HEIGHT 0x9
+#endif
 
 QT_BEGIN_NAMESPACE
 
 Q_LOGGING_CATEGORY(qLcFbDrm, "qt.qpa.fb")
 
-static const int BUFFER_COUNT = 2;
+static const int MAX_BUFFER_COUNT = 3;
 
 class QLinuxFbDevice : public QKmsDevice
 {
@@ -75,19 +85,29 @@ public:
     };
 
     struct Output {
-        Output() : backFb(0), flipped(false) { }
+        Output() : backFb(0), frontFb(0), pendingFb(0), flipPending(false),
+                   flipQueuedTime(0), flipQueuedSequence(0), flipQueuedSequenceValid(false) { }
         QKmsOutput kmsOutput;
-        Framebuffer fb[BUFFER_COUNT];
-        QRegion dirty[BUFFER_COUNT];
+        Framebuffer fb[MAX_BUFFER_COUNT];
+        QRegion dirty[MAX_BUFFER_COUNT];
         int backFb;
-        bool flipped;
+        int frontFb;
+        int pendingFb;
+        bool flipPending;
+        // Of the pending flip, in nanoseconds on CLOCK_MONOTONIC, and the
+        // vertical blank counter of the CRTC when it was queued
+        qint64 flipQueuedTime;
+        uint32_t flipQueuedSequence;
+        bool flipQueuedSequenceValid;
+        // Of the flips completed since takeFlipStatistics()
+        QFbScreen::FlipStatistics flips;
         QSize currentRes() const {
             const drmModeModeInfo &modeInfo(kmsOutput.modes[kmsOutput.mode]);
             return QSize(modeInfo.hdisplay, modeInfo.vdisplay);
         }
     };
 
-    QLinuxFbDevice(QKmsScreenConfig *screenConfig);
+    QLinuxFbDevice(QKmsScreenConfig *screenConfig, QMutex *scanoutMutex);
 
     bool open() override;
     void close() override;
@@ -97,7 +117,11 @@ public:
     void setMode();
 
     void swapBuffers(Output *output);
+    void waitForFlip(Output *output);
+    bool takeFlipStatistics(Output *output, QFbScreen::FlipStatistics *flips);
+    void markFrontDirty(Output *output, const QRegion &region);
 
+    int bufferCount() const { return m_bufferCount; }
     int outputCount() const { return m_outputs.count(); }
     Output *output(int idx) { return &m_outputs[idx]; }
 
@@ -116,11 +140,23 @@ private:
                                 unsigned int tv_sec, unsigned int tv_usec, void *user_data);
 
     QVector<Output> m_outputs;
+    int m_bufferCount;
+    QMutex *m_scanoutMutex;
 };
 
-QLinuxFbDevice::QLinuxFbDevice(QKmsScreenConfig *screenConfig)
-    : QKmsDevice(screenConfig, QStringLiteral("/dev/dri/card0"))
+QLinuxFbDevice::QLinuxFbDevice(QKmsScreenConfig *screenConfig, QMutex *scanoutMutex)
+    : QKmsDevice(screenConfig, QStringLiteral("/dev/dri/card0")),
+      m_bufferCount(2),
+      m_scanoutMutex(scanoutMutex)
 {
+    // With three buffers the next frame can be drawn while the previous one
+    // waits for the vertical blank, at the cost of one frame of latency:
+    // update requests are then delivered once a frame is queued, and it is
+    // the next redraw that waits for that frame to be shown.
+    bool ok = false;
+    const int bufferCount = qEnvironmentVariableIntValue("QT_QPA_FB_DRM_BUFFER_COUNT", &ok);
+    if (ok)
+        m_bufferCount = qBound(2, bufferCount, MAX_BUFFER_COUNT);
 }
 
 bool QLinuxFbDevice::open()
@@ -296,12 +332,13 @@ bool QLinuxFbDevice::createFramebuffer(QLinuxFbDevice::Output *output, int buffe
 void QLinuxFbDevice::createFramebuffers()
 {
     for (Output &output : m_outputs) {
-        for (int i = 0; i < BUFFER_COUNT; ++i) {
+        for (int i = 0; i < m_bufferCount; ++i) {
             if (!createFramebuffer(&output, i))
                 return;
         }
         output.backFb = 0;
-        output.flipped = false;
+        output.frontFb = 0;
+        output.flipPending = false;
     }
 }
 
@@ -325,7 +362,8 @@ void QLinuxFbDevice::destroyFramebuffer(QLinuxFbDevice::Output *output, int buff
 void QLinuxFbDevice::destroyFramebuffers()
 {
     for (Output &output : m_outputs) {
-        for (int i = 0; i < BUFFER_COUNT; ++i)
+        waitForFlip(&output);
+        for (int i = 0; i < m_bufferCount; ++i)
             destroyFramebuffer(&output, i);
     }
 }
@@ -350,24 +388,71 @@ void QLinuxFbDevice::pageFlipHandler(int fd, unsigned int sequence,
                                      void *user_data)
 {
     Q_UNUSED(fd);
-    Q_UNUSED(sequence);
-    Q_UNUSED(tv_sec);
-    Q_UNUSED(tv_usec);
 
+    // frontFb is updated by waitForFlip(), under the scanout mutex
     Output *output = static_cast<Output *>(user_data);
-    output->backFb = (output->backFb + 1) % BUFFER_COUNT;
+    output->flipPending = false;
+
+    const qint64 flipTime = qint64(tv_sec) * 1000000000 + qint64(tv_usec) * 1000;
+    const qint64 latency = qMax<qint64>(0, flipTime - output->flipQueuedTime);
+    QFbScreen::FlipStatistics &flips(output->flips);
+    ++flips.count;
+    flips.lastLatency = latency;
+    flips.totalLatency += latency;
+    flips.maxLatency = qMax(flips.maxLatency, latency);
+
+    // A flip completes at the first vertical blank after it was queued, at
+    // any later one the display showed the previous frame again.
+    if (output->flipQueuedSequenceValid)
+        flips.missedVBlanks += qMax(0, int(sequence - output->flipQueuedSequence) - 1);
 }
 
+// Queues the back buffer to be shown at the next vertical blank, and moves on
+// to the next buffer. Returns once that one may be drawn to.
 void QLinuxFbDevice::swapBuffers(Output *output)
 {
+    // Only one flip can be queued at a time
+    waitForFlip(output);
+
     Framebuffer &fb(output->fb[output->backFb]);
     if (drmModePageFlip(fd(), output->kmsOutput.crtc_id, fb.fb, DRM_MODE_PAGE_FLIP_EVENT, output) == -1) {
         qErrnoWarning(errno, "Page flip failed");
         return;
     }
 
-    const int fbIdx = output->backFb;
-    while (output->backFb == fbIdx) {
+    timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    output->flipQueuedTime = qint64(now.tv_sec) * 1000000000 + now.tv_nsec;
+
+    // Read the vertical blank counter without waiting. Reading it after
+    // queueing the flip errs on the side of not counting a missed blank when
+    // one happens in between.
+    drmVBlank vblank;
+    memset(&vblank, 0, sizeof(vblank));
+    uint crtcSelector = 0;
+    if (output->kmsOutput.crtc_index == 1)
+        crtcSelector = DRM_VBLANK_SECONDARY;
+    else if (output->kmsOutput.crtc_index > 1)
+        crtcSelector = (output->kmsOutput.crtc_index << DRM_VBLANK_HIGH_CRTC_SHIFT) & DRM_VBLANK_HIGH_CRTC_MASK;
+    vblank.request.type = drmVBlankSeqType(DRM_VBLANK_RELATIVE | crtcSelector);
+    vblank.request.sequence = 0;
+    output->flipQueuedSequenceValid = drmWaitVBlank(fd(), &vblank) == 0;
+    output->flipQueuedSequence = vblank.reply.sequence;
+    output->flipPending = true;
+    output->pendingFb = output->backFb;
+    output->backFb = (output->backFb + 1) % m_bufferCount;
+
+    // With double buffering the next buffer is on screen until the flip
+    if (output->backFb == output->frontFb)
+        waitForFlip(output);
+}
+
+void QLinuxFbDevice::waitForFlip(Output *output)
+{
+    if (!output->flipPending)
+        return;
+
+    while (output->flipPending) {
         drmEventContext drmEvent;
         memset(&drmEvent, 0, sizeof(drmEvent));
         drmEvent.version = 2;
@@ -377,6 +462,224 @@ void QLinuxFbDevice::swapBuffers(Output *output)
         // and calls back pageFlipHandler once the flip completes.
         drmHandleEvent(fd(), &drmEvent);
     }
+
+    const QMutexLocker locker(m_scanoutMutex);
+    output->frontFb = output->pendingFb;
+}
+
+// Returns what was measured of the flips completed since the last call
+bool QLinuxFbDevice::takeFlipStatistics(Output *output, QFbScreen::FlipStatistics *flips)
+{
+    if (output->flips.count == 0)
+        return false;
+    *flips = output->flips;
+    output->flips = QFbScreen::FlipStatistics();
+    return true;
+}
+
+// Tells drivers which need it (e.g. ones with manual update displays) that
+// region was modified in the buffer currently being scanned out. Called with
+// the scanout mutex held, or from the thread flipping the buffers.
+void QLinuxFbDevice::markFrontDirty(Output *output, const QRegion &region)
+{
+    QVarLengthArray<drmModeClip, 16> clips;
+    for (const QRect &rect : region) {
+        const drmModeClip clip = {
+            quint16(rect.left()), quint16(rect.top()),
+            quint16(rect.right() + 1), quint16(rect.bottom() + 1)
+        };
+        clips.append(clip);
+    }
+
+    const Framebuffer &fb(output->fb[output->frontFb]);
+    const int ret = drmModeDirtyFB(fd(), fb.fb, clips.data(), clips.size());
+    if (ret != 0 && ret != -ENOSYS)
+        qErrnoWarning(-ret, "Failed to mark FB dirty");
+}
+
+// Shows the cursor on the cursor plane of the CRTC, so that moving it costs
+// no composition. Software rendering is left to the base class.
+class QLinuxFbDrmCursor : public QFbCursor
+{
+public:
+    QLinuxFbDrmCursor(QFbScreen *screen, QLinuxFbDevice *device, uint32_t crtcId);
+    ~QLinuxFbDrmCursor();
+
+    bool initialize();
+
+    // Nothing for the compositor to draw
+    QRect drawCursor(QPainter &) override { return QRect(); }
+    void setDirty() override { }
+    bool isDirty() const override { return false; }
+    bool isOnScreen() const override { return false; }
+    bool isSoftwareCursor() const override { return false; }
+
+    void pointerEvent(const QMouseEvent &event) override;
+    void setPos(const QPoint &pos) override;
+#ifndef QT_NO_CURSOR
+    void changeCursor(QCursor *windowCursor, QWindow *window) override;
+#endif
+    void updateMouseStatus() override;
+
+private:
+    void updateImage();
+    void updatePlane();
+    void move();
+
+    QLinuxFbDevice *m_device;
+    uint32_t m_crtcId;
+    QLinuxFbDevice::Framebuffer m_buffer;
+    QPoint m_hotspot;
+    bool m_shown;
+};
+
+QLinuxFbDrmCursor::QLinuxFbDrmCursor(QFbScreen *screen, QLinuxFbDevice *device, uint32_t crtcId)
+    : QFbCursor(screen),
+      m_device(device),
+      m_crtcId(crtcId),
+      m_shown(false)
+{
+}
+
+QLinuxFbDrmCursor::~QLinuxFbDrmCursor()
+{
+    if (m_shown)
+        drmModeSetCursor(m_device->fd(), m_crtcId, 0, 0, 0);
+    if (m_buffer.p != MAP_FAILED)
+        munmap(m_buffer.p, m_buffer.size);
+    if (m_buffer.handle) {
+        drm_mode_destroy_dumb dreq = { m_buffer.handle };
+        if (drmIoctl(m_device->fd(), DRM_IOCTL_MODE_DESTROY_DUMB, &dreq) == -1)
+            qErrnoWarning(errno, "Failed to destroy cursor buffer %u", m_buffer.handle);
+    }
+}
+
+// Returns false if the cursor plane cannot be used
+bool QLinuxFbDrmCursor::initialize()
+{
+    // 64x64 is the old standard size, query the real one
+    uint64_t width = 64;
+    uint64_t height = 64;
+    drmGetCap(m_device->fd(), DRM_CAP_CURSOR_WIDTH, &width);
+    drmGetCap(m_device->fd(), DRM_CAP_CURSOR_HEIGHT, &height);
+
+    drm_mode_create_dumb creq = {
+        uint32_t(height),
+        uint32_t(width),
+        32,
+        0, 0, 0, 0
+    };
+    if (drmIoctl(m_device->fd(), DRM_IOCTL_MODE_CREATE_DUMB, &creq) == -1) {
+        qErrnoWarning(errno, "Failed to create cursor buffer");
+        return false;
+    }
+    m_buffer.handle = creq.handle;
+    m_buffer.pitch = creq.pitch;
+    m_buffer.size = creq.size;
+
+    drm_mode_map_dumb mreq = {
+        m_buffer.handle,
+        0, 0
+    };
+    if (drmIoctl(m_device->fd(), DRM_IOCTL_MODE_MAP_DUMB, &mreq) == -1) {
+        qErrnoWarning(errno, "Failed to map cursor buffer");
+        return false;
+    }
+    m_buffer.p = mmap(0, m_buffer.size, PROT_READ | PROT_WRITE, MAP_SHARED, m_device->fd(), mreq.offset);
+    if (m_buffer.p == MAP_FAILED) {
+        qErrnoWarning(errno, "Failed to mmap cursor buffer");
+        return false;
+    }
+    m_buffer.wrapper = QImage(static_cast<uchar *>(m_buffer.p), width, height, m_buffer.pitch,
+                              QImage::Format_ARGB32);
+
+    // Probe the plane with an empty cursor, drivers without one fail here
+    m_buffer.wrapper.fill(Qt::transparent);
+    if (drmModeSetCursor(m_device->fd(), m_crtcId, m_buffer.handle, width, height) != 0) {
+        qCDebug(qLcFbDrm, "No hardware cursor, drawing the cursor in software");
+        return false;
+    }
+    m_shown = true;
+
+    qCDebug(qLcFbDrm, "Using a %ux%u hardware cursor", uint(width), uint(height));
+    updateImage();
+    updateMouseStatus();
+    return true;
+}
+
+void QLinuxFbDrmCursor::updateImage()
+{
+    if (!mCursorImage)
+        return;
+
+    const QImage *image = mCursorImage->image();
+    if (image->width() > m_buffer.wrapper.width() || image->height() > m_buffer.wrapper.height())
+        qWarning("Cursor larger than %dx%d, cursor will be clipped.",
+                 m_buffer.wrapper.width(), m_buffer.wrapper.height());
+
+    m_buffer.wrapper.fill(Qt::transparent);
+    QPainter painter(&m_buffer.wrapper);
+    painter.setCompositionMode(QPainter::CompositionMode_Source);
+    painter.drawImage(0, 0, *image);
+    painter.end();
+
+    m_hotspot = mCursorImage->hotspot();
+    move();
+}
+
+void QLinuxFbDrmCursor::updatePlane()
+{
+    if (mVisible == m_shown)
+        return;
+
+    const int ret = mVisible
+            ? drmModeSetCursor(m_device->fd(), m_crtcId, m_buffer.handle,
+                               m_buffer.wrapper.width(), m_buffer.wrapper.height())
+            : drmModeSetCursor(m_device->fd(), m_crtcId, 0, 0, 0);
+    if (ret != 0)
+        qWarning("Could not %s cursor: %d", mVisible ? "show" : "hide", ret);
+    else
+        m_shown = mVisible;
+    move();
+}
+
+void QLinuxFbDrmCursor::move()
+{
+    if (!m_shown)
+        return;
+
+    const QPoint topLeft = pos() - mScreen->geometry().topLeft() - m_hotspot;
+    const int ret = drmModeMoveCursor(m_device->fd(), m_crtcId, topLeft.x(), topLeft.y());
+    if (ret != 0)
+        qWarning("Failed to move cursor: %d", ret);
+}
+
+void QLinuxFbDrmCursor::pointerEvent(const QMouseEvent &event)
+{
+    QFbCursor::pointerEvent(event);
+    if (event.type() == QEvent::MouseMove)
+        move();
+}
+
+void QLinuxFbDrmCursor::setPos(const QPoint &pos)
+{
+    QFbCursor::setPos(pos);
+    move();
+}
+
+#ifndef QT_NO_CURSOR
+void QLinuxFbDrmCursor::changeCursor(QCursor *windowCursor, QWindow *window)
+{
+    QFbCursor::changeCursor(windowCursor, window);
+    if (mVisible)
+        updateImage();
+}
+#endif
+
+void QLinuxFbDrmCursor::updateMouseStatus()
+{
+    mVisible = mDeviceListener ? mDeviceListener->hasMouse() : false;
+    updatePlane();
 }
 
 QLinuxFbDrmScreen::QLinuxFbDrmScreen(const QStringList &args)
@@ -388,6 +691,12 @@ QLinuxFbDrmScreen::QLinuxFbDrmScreen(const QStringList &args)
 
 QLinuxFbDrmScreen::~QLinuxFbDrmScreen()
 {
+    setCompositorThreadEnabled(false);
+
+    // The hardware cursor owns a buffer of the device
+    delete mCursor;
+    mCursor = nullptr;
+
     if (m_device) {
         m_device->destroyFramebuffers();
         m_device->close();
@@ -399,7 +708,7 @@ QLinuxFbDrmScreen::~QLinuxFbDrmScreen()
 bool QLinuxFbDrmScreen::initialize()
 {
     m_screenConfig = new QKmsScreenConfig;
-    m_device = new QLinuxFbDevice(m_screenConfig);
+    m_device = new QLinuxFbDevice(m_screenConfig, scanoutMutex());
     if (!m_device->open())
         return false;
 
@@ -420,7 +729,15 @@ bool QLinuxFbDrmScreen::initialize()
 
     QFbScreen::initializeCompositor();
 
-    mCursor = new QFbCursor(this);
+    if (m_screenConfig->hwCursor()) {
+        QLinuxFbDrmCursor *cursor = new QLinuxFbDrmCursor(this, m_device, output->kmsOutput.crtc_id);
+        if (cursor->initialize())
+            mCursor = cursor;
+        else
+            delete cursor;
+    }
+    if (!mCursor)
+        mCursor = new QFbCursor(this);
 
     return true;
 }
@@ -433,12 +750,18 @@ QRegion QLinuxFbDrmScreen::doRedraw()
 
     QLinuxFbDevice::Output *output(m_device->output(0));
 
-    for (int i = 0; i < BUFFER_COUNT; ++i)
+    if (isDirectScanoutActive()) {
+        m_device->markFrontDirty(output, dirty);
+        return dirty;
+    }
+
+    for (int i = 0; i < m_device->bufferCount(); ++i)
         output->dirty[i] += dirty;
 
     if (output->fb[output->backFb].wrapper.isNull())
         return dirty;
 
+    QMutexLocker locker(scanoutMutex());
     QPainter pntr(&output->fb[output->backFb].wrapper);
     // Image has alpha but no need for blending at this stage.
     // Do not waste time with the default SourceOver.
@@ -446,23 +769,59 @@ QRegion QLinuxFbDrmScreen::doRedraw()
     for (const QRect &rect : qAsConst(output->dirty[output->backFb]))
         pntr.drawImage(rect, mScreenImage, rect);
     pntr.end();
+    locker.unlock();
 
     output->dirty[output->backFb] = QRegion();
 
     m_device->swapBuffers(output);
 
+    FlipStatistics flips;
+    if (m_device->takeFlipStatistics(output, &flips))
+        recordFlips(flips);
+
     return dirty;
 }
 
-QPixmap QLinuxFbDrmScreen::grabWindow(WId wid, int x, int y, int width, int height) const
+QFbScreen::Flags QLinuxFbDrmScreen::flags() const
 {
-    Q_UNUSED(wid);
-    Q_UNUSED(x);
-    Q_UNUSED(y);
-    Q_UNUSED(width);
-    Q_UNUSED(height);
+    return SyncsToVBlank;
+}
 
-    return QPixmap();
+QImage QLinuxFbDrmScreen::scanoutImage()
+{
+    // Direct scanout renders into the buffer being shown, no more flipping
+    // happens until the screen falls back to composing.
+    QLinuxFbDevice::Output *output(m_device->output(0));
+    m_device->waitForFlip(output);
+    return output->fb[output->frontFb].wrapper;
+}
+
+QVector<QImage> QLinuxFbDrmScreen::scanoutBuffers() const
+{
+    QVector<QImage> buffers;
+    QLinuxFbDevice::Output *output(m_device->output(0));
+    for (int i = 0; i < m_device->bufferCount(); ++i)
+        buffers.append(output->fb[i].wrapper);
+    return buffers;
+}
+
+void QLinuxFbDrmScreen::scanoutUpdated(const QRect &rect)
+{
+    m_device->markFrontDirty(m_device->output(0), rect);
+}
+
+QPixmap QLinuxFbDrmScreen::grabWindow(WId wid, int x, int y, int width, int height) const
+{
+    waitForCompositor();
+
+    // mScreenImage is not updated while a window is scanned out, the window
+    // paints straight into the buffer being shown.
+    if (isDirectScanoutActive()) {
+        QLinuxFbDevice::Output *output(m_device->output(0));
+        const QMutexLocker locker(scanoutMutex());
+        return grabScreenImage(output->fb[output->frontFb].wrapper, wid, x, y, width, height);
+    }
+    return grabScreenImage(mScreenImage, wid, x, y, width, height);
 }
 
 QT_END_NAMESPACE
@@ -56,8 +56,15 @@ public:
 
     bool initialize() override;
     QRegion doRedraw() override;
+    Flags flags() const override;
     QPixmap grabWindow(WId wid, int x, int y, int width, int height) const override;
 
+    QVector<QImage> scanoutBuffers() const override;
+    void scanoutUpdated(const QRect &rect) override;
+
+protected:
+    QImage scanoutImage() override;
+
 private:
     QKmsScreenConfig *m_screenConfig;
     QLinuxFbDevice *m_device;
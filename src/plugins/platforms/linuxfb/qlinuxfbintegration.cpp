@@ -51,10 +51,12 @@
 #include <QtFbSupport/private/qfbbackingstore_p.h>
 #include <QtFbSupport/private/qfbwindow_p.h>
 #include <QtFbSupport/private/qfbcursor_p.h>
+#include <QtFbSupport/private/qfbinkoverlay_p.h>
 
 #include <QtGui/private/qguiapplication_p.h>
 #include <qpa/qplatforminputcontextfactory_p.h>
 #include <qpa/qwindowsysteminterface.h>
+#include <qpa/qwindowsysteminterface_p.h>
 
 #if QT_CONFIG(libinput)
 #include <QtInputSupport/private/qlibinputhandler_p.h>
@@ -86,10 +88,20 @@ QLinuxFbIntegration::QLinuxFbIntegration(const QStringList &paramList)
 #endif
     if (!m_primaryScreen)
         m_primaryScreen = new QLinuxFbScreen(paramList);
+
+    m_primaryScreen->setDirectScanoutEnabled(qEnvironmentVariableIntValue("QT_QPA_FB_DIRECT_SCANOUT") != 0);
+    m_primaryScreen->setCompositorThreadEnabled(qEnvironmentVariableIntValue("QT_QPA_FB_COMPOSITOR_THREAD") != 0);
+
+    // The evdev handlers report every sample of the device; with
+    // AA_CompressHighFrequencyEvents set, let the moves that the application
+    // cannot keep up with pile up as history.
+    QWindowSystemInterfacePrivate::platformCoalescesInputEvents = true;
 }
 
 QLinuxFbIntegration::~QLinuxFbIntegration()
 {
+    if (m_inkOverlay)
+        QInputDeviceManager::setInkOverlay(nullptr);
     QWindowSystemInterface::handleScreenRemoved(m_primaryScreen);
 }
 
@@ -186,9 +198,17 @@ QFunctionPointer QLinuxFbIntegration::platformFunction(const QByteArray &functio
         return QFunctionPointer(loadKeymapStatic);
     else if (function == QLinuxFbFunctions::switchLangTypeIdentifier())
         return QFunctionPointer(switchLangStatic);
-#else
-    Q_UNUSED(function)
 #endif
+    if (function == QLinuxFbFunctions::setUpdateModeTypeIdentifier())
+        return QFunctionPointer(setUpdateModeStatic);
+    else if (function == QLinuxFbFunctions::waitForUpdatesTypeIdentifier())
+        return QFunctionPointer(waitForUpdatesStatic);
+    else if (function == QLinuxFbFunctions::setFastInkAreaTypeIdentifier())
+        return QFunctionPointer(setFastInkAreaStatic);
+    else if (function == QLinuxFbFunctions::frameStatisticsTypeIdentifier())
+        return QFunctionPointer(frameStatisticsStatic);
+    else if (function == QLinuxFbFunctions::resetFrameStatisticsTypeIdentifier())
+        return QFunctionPointer(resetFrameStatisticsStatic);
 
     return 0;
 }
@@ -217,4 +237,64 @@ void QLinuxFbIntegration::switchLangStatic()
 #endif
 }
 
+Q_STATIC_ASSERT(int(QLinuxFbFunctions::UpdateModeFull) == int(QFbScreen::UpdateModeFull));
+
+void QLinuxFbIntegration::setUpdateModeStatic(QWindow *window, const QRegion &region,
+                                              QLinuxFbFunctions::UpdateMode mode)
+{
+    QFbWindow *fbWindow = static_cast<QFbWindow *>(window->handle());
+    if (!fbWindow)
+        return;
+    fbWindow->platformScreen()->setUpdateMode(region.translated(fbWindow->geometry().topLeft()),
+                                              QFbScreen::UpdateMode(mode));
+}
+
+void QLinuxFbIntegration::waitForUpdatesStatic()
+{
+    QLinuxFbIntegration *self = static_cast<QLinuxFbIntegration *>(QGuiApplicationPrivate::platformIntegration());
+    self->m_primaryScreen->waitForUpdates();
+}
+
+void QLinuxFbIntegration::setFastInkAreaStatic(QWindow *window, const QRegion &area, qreal penWidth)
+{
+    QLinuxFbIntegration *self = static_cast<QLinuxFbIntegration *>(QGuiApplicationPrivate::platformIntegration());
+    // Uninstall first, the tablet thread must not see the overlay change under its feet
+    QInputDeviceManager::setInkOverlay(nullptr);
+
+    QFbWindow *fbWindow = static_cast<QFbWindow *>(window->handle());
+    if (!fbWindow || area.isEmpty())
+        return;
+
+    if (!self->m_inkOverlay)
+        self->m_inkOverlay.reset(new QFbInkOverlay(self->m_primaryScreen));
+    self->m_inkOverlay->setArea(area.translated(fbWindow->geometry().topLeft()), penWidth);
+    QInputDeviceManager::setInkOverlay(self->m_inkOverlay.data());
+}
+
+QLinuxFbFunctions::FrameStatistics QLinuxFbIntegration::frameStatisticsStatic()
+{
+    QLinuxFbIntegration *self = static_cast<QLinuxFbIntegration *>(QGuiApplicationPrivate::platformIntegration());
+    const QFbScreen::FrameStatistics s = self->m_primaryScreen->frameStatistics();
+    QLinuxFbFunctions::FrameStatistics stats;
+    stats.frameCount = s.frameCount;
+    stats.flipCount = s.flipCount;
+    stats.missedVBlankCount = s.missedVBlankCount;
+    stats.lastComposeTime = s.lastComposeTime;
+    stats.lastOutputTime = s.lastOutputTime;
+    stats.lastFlipLatency = s.lastFlipLatency;
+    stats.maxFlipLatency = s.maxFlipLatency;
+    stats.lastDirtyArea = s.lastDirtyArea;
+    stats.totalComposeTime = s.totalComposeTime;
+    stats.totalOutputTime = s.totalOutputTime;
+    stats.totalFlipLatency = s.totalFlipLatency;
+    stats.totalDirtyArea = s.totalDirtyArea;
+    return stats;
+}
+
+void QLinuxFbIntegration::resetFrameStatisticsStatic()
+{
+    QLinuxFbIntegration *self = static_cast<QLinuxFbIntegration *>(QGuiApplicationPrivate::platformIntegration());
+    self->m_primaryScreen->resetFrameStatistics();
+}
+
 QT_END_NAMESPACE
@@ -42,11 +42,13 @@
 
 #include <qpa/qplatformintegration.h>
 #include <qpa/qplatformnativeinterface.h>
+#include <QtPlatformHeaders/qlinuxfbfunctions.h>
 
 QT_BEGIN_NAMESPACE
 
 class QAbstractEventDispatcher;
 class QFbScreen;
+class QFbInkOverlay;
 class QFbVtHandler;
 class QEvdevKeyboardManager;
 
@@ -78,12 +80,19 @@ private:
     void createInputHandlers();
     static void loadKeymapStatic(const QString &filename);
     static void switchLangStatic();
+    static void setUpdateModeStatic(QWindow *window, const QRegion &region,
+                                    QLinuxFbFunctions::UpdateMode mode);
+    static void waitForUpdatesStatic();
+    static void setFastInkAreaStatic(QWindow *window, const QRegion &area, qreal penWidth);
+    static QLinuxFbFunctions::FrameStatistics frameStatisticsStatic();
+    static void resetFrameStatisticsStatic();
 
     QFbScreen *m_primaryScreen;
     QPlatformInputContext *m_inputContext;
     QScopedPointer<QPlatformFontDatabase> m_fontDb;
     QScopedPointer<QPlatformServices> m_services;
     QScopedPointer<QFbVtHandler> m_vtHandler;
+    QScopedPointer<QFbInkOverlay> m_inkOverlay;
 
     QEvdevKeyboardManager *m_kbdMgr;
 };
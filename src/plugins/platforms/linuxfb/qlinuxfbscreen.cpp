@@ -63,6 +63,23 @@
 
 #include <linux/fb.h>
 
+// The i.MX EPDC (e-paper display controller) interface is not part of the
+// mainline kernel headers, and its structures differ between vendor
+// kernels: take them from the kernel the plugin is built for.
+#if QT_HAS_INCLUDE(<linux/mxcfb.h>)
+#include <linux/mxcfb.h>
+#endif
+
+#ifdef MXCFB_SEND_UPDATE
+// Older versions of the header only define the automatic waveform mode
+#ifndef WAVEFORM_MODE_DU
+#define WAVEFORM_MODE_DU 0x1
+#endif
+#ifndef WAVEFORM_MODE_GC16
+#define WAVEFORM_MODE_GC16 0x2
+#endif
+#endif
+
 QT_BEGIN_NAMESPACE
 
 static int openFramebufferDevice(const QString &dev)
@@ -234,9 +251,16 @@ static QImage::Format determineFormat(const fb_var_screeninfo &info, int depth)
         break;
     }
     case 8:
+        if (info.grayscale)
+            format = QImage::Format_Grayscale8;
         break;
+    case 4:
+    case 2:
     case 1:
-        format = QImage::Format_Mono; //###: LSB???
+        // There is no matching QImage format. Composite in Grayscale8 and
+        // dither to the packed pixels when blitting, see doRedraw().
+        if (info.grayscale || depth == 1)
+            format = QImage::Format_Grayscale8;
         break;
     default:
         break;
@@ -245,6 +269,19 @@ static QImage::Format determineFormat(const fb_var_screeninfo &info, int depth)
     return format;
 }
 
+// The controller refreshes one rectangle per update. Merge the region into
+// its bounding rectangle unless that refreshes many pixels that did not change.
+static QVector<QRect> coalescedUpdateRects(const QRegion &region)
+{
+    const QRect bounds = region.boundingRect();
+    qint64 area = 0;
+    for (const QRect &rect : region)
+        area += qint64(rect.width()) * rect.height();
+    if (region.rectCount() == 1 || qint64(bounds.width()) * bounds.height() <= 2 * area)
+        return QVector<QRect>() << bounds;
+    return QVector<QRect>(region.begin(), region.end());
+}
+
 static int openTtyDevice(const QString &device)
 {
     const char *const devs[] = { "/dev/tty0", "/dev/tty", "/dev/console", 0 };
@@ -287,13 +324,15 @@ static void blankScreen(int fd, bool on)
 }
 
 QLinuxFbScreen::QLinuxFbScreen(const QStringList &args)
-    : mArgs(args), mFbFd(-1), mTtyFd(-1), mBlitter(0)
+    : mArgs(args), mFbFd(-1), mTtyFd(-1), mBlitter(0), mPackedDepth(0), mPackedInverted(false), mEpdc(false), mUpdateMarker(0)
 {
     mMmap.data = 0;
 }
 
 QLinuxFbScreen::~QLinuxFbScreen()
 {
+    setCompositorThreadEnabled(false);
+
     if (mFbFd != -1) {
         if (mMmap.data)
             munmap(mMmap.data - mMmap.offset, mMmap.size);
@@ -313,6 +352,7 @@ bool QLinuxFbScreen::initialize()
     QRegularExpression mmSizeRx(QLatin1String("mmsize=(\\d+)x(\\d+)"));
     QRegularExpression sizeRx(QLatin1String("size=(\\d+)x(\\d+)"));
     QRegularExpression offsetRx(QLatin1String("offset=(\\d+)x(\\d+)"));
+    QRegularExpression ditherRx(QLatin1String("dither=(ordered|diffuse|threshold)"));
 
     QString fbDevice, ttyDevice;
     QSize userMmSize;
@@ -334,6 +374,10 @@ bool QLinuxFbScreen::initialize()
             ttyDevice = match.captured(1);
         else if (arg.contains(fbRx, &match))
             fbDevice = match.captured(1);
+        else if (arg.contains(ditherRx, &match))
+            mDitherFlags = match.captured(1) == QLatin1String("diffuse") ? Qt::DiffuseDither
+                         : match.captured(1) == QLatin1String("threshold") ? Qt::ThresholdDither
+                         : Qt::OrderedDither;
     }
 
     if (fbDevice.isEmpty()) {
@@ -369,6 +413,9 @@ bool QLinuxFbScreen::initialize()
         return false;
     }
 
+#ifdef MXCFB_SEND_UPDATE
+    mEpdc = qstrncmp(finfo.id, "mxc_epdc", 8) == 0;
+#endif
     mDepth = determineDepth(vinfo);
     mBytesPerLine = finfo.line_length;
     QRect geometry = determineGeometry(vinfo, userGeometry);
@@ -384,11 +431,18 @@ bool QLinuxFbScreen::initialize()
         return false;
     }
 
+    mFbOffset = geometry.topLeft();
     mMmap.offset = geometry.y() * mBytesPerLine + geometry.x() * mDepth / 8;
     mMmap.data = data + mMmap.offset;
 
     QFbScreen::initializeCompositor();
-    mFbScreenImage = QImage(mMmap.data, geometry.width(), geometry.height(), mBytesPerLine, mFormat);
+    if (mDepth < 8 && mFormat == QImage::Format_Grayscale8) {
+        mPackedDepth = mDepth;
+        // monochrome panels where a set bit is black
+        mPackedInverted = finfo.visual == FB_VISUAL_MONO01;
+    } else {
+        mFbScreenImage = QImage(mMmap.data, geometry.width(), geometry.height(), mBytesPerLine, mFormat);
+    }
 
     mCursor = new QFbCursor(this);
 
@@ -409,41 +463,120 @@ QRegion QLinuxFbScreen::doRedraw()
     if (touched.isEmpty())
         return touched;
 
-    if (!mBlitter)
-        mBlitter = new QPainter(&mFbScreenImage);
+    if (mPackedDepth) {
+        ditherToPackedGrayscale(touched, mMmap.data, mBytesPerLine, mPackedDepth, mPackedInverted);
+    } else if (!isDirectScanoutActive()) {
+        if (!mBlitter)
+            mBlitter = new QPainter(&mFbScreenImage);
 
-    mBlitter->setCompositionMode(QPainter::CompositionMode_Source);
-    for (const QRect &rect : touched)
-        mBlitter->drawImage(rect, mScreenImage, rect);
+        const QMutexLocker locker(scanoutMutex());
+        mBlitter->setCompositionMode(QPainter::CompositionMode_Source);
+        for (const QRect &rect : touched)
+            mBlitter->drawImage(rect, mScreenImage, rect);
+    }
+
+    if (mEpdc)
+        sendUpdates(touched);
 
     return touched;
 }
 
-// grabWindow() grabs "from the screen" not from the backingstores.
-// In linuxfb's case it will also include the mouse cursor.
-QPixmap QLinuxFbScreen::grabWindow(WId wid, int x, int y, int width, int height) const
+QFbScreen::Flags QLinuxFbScreen::flags() const
+{
+    return mEpdc ? SupportsUpdateModes : Flags();
+}
+
+// Submits the refresh of region to the e-paper controller, without waiting
+// for it to complete, split into one update per requested refresh mode.
+void QLinuxFbScreen::sendUpdates(const QRegion &region)
 {
-    if (!wid) {
-        if (width < 0)
-            width = mFbScreenImage.width() - x;
-        if (height < 0)
-            height = mFbScreenImage.height() - y;
-        return QPixmap::fromImage(mFbScreenImage).copy(x, y, width, height);
+    const auto updates = takeUpdateModes(region);
+    for (const auto &update : updates) {
+        for (const QRect &rect : coalescedUpdateRects(update.second))
+            sendUpdate(rect, update.first);
     }
+}
 
-    QFbWindow *window = windowForId(wid);
-    if (window) {
-        const QRect geom = window->geometry();
-        if (width < 0)
-            width = geom.width() - x;
-        if (height < 0)
-            height = geom.height() - y;
-        QRect rect(geom.topLeft() + QPoint(x, y), QSize(width, height));
-        rect &= window->geometry();
-        return QPixmap::fromImage(mFbScreenImage).copy(rect);
+// May be called from other threads, see scanoutUpdated().
+void QLinuxFbScreen::sendUpdate(const QRect &rect, UpdateMode mode)
+{
+#ifdef MXCFB_SEND_UPDATE
+    mxcfb_update_data data;
+    memset(&data, 0, sizeof(data));
+    data.update_mode = UPDATE_MODE_PARTIAL;
+    data.temp = TEMP_USE_AMBIENT;
+    switch (mode) {
+    case UpdateModeAuto:
+        data.waveform_mode = WAVEFORM_MODE_AUTO;
+        break;
+    case UpdateModeFast:
+        data.waveform_mode = WAVEFORM_MODE_DU;
+        break;
+    case UpdateModeGrayscale:
+        data.waveform_mode = WAVEFORM_MODE_GC16;
+        break;
+    case UpdateModeFull:
+        data.waveform_mode = WAVEFORM_MODE_GC16;
+        data.update_mode = UPDATE_MODE_FULL;
+        break;
     }
 
-    return QPixmap();
+    // 0 is not a valid marker
+    quint32 marker = mUpdateMarker.fetchAndAddRelaxed(1) + 1;
+    if (marker == 0)
+        marker = mUpdateMarker.fetchAndAddRelaxed(1) + 1;
+    data.update_region.top = rect.top() + mFbOffset.y();
+    data.update_region.left = rect.left() + mFbOffset.x();
+    data.update_region.width = rect.width();
+    data.update_region.height = rect.height();
+    data.update_marker = marker;
+    if (ioctl(mFbFd, MXCFB_SEND_UPDATE, &data) == -1)
+        qErrnoWarning(errno, "Failed to send e-paper update");
+#else
+    Q_UNUSED(rect);
+    Q_UNUSED(mode);
+#endif
+}
+
+QVector<QImage> QLinuxFbScreen::scanoutBuffers() const
+{
+    // Packed pixels cannot be painted on
+    if (mPackedDepth)
+        return QVector<QImage>();
+    return QVector<QImage>() << mFbScreenImage;
+}
+
+void QLinuxFbScreen::scanoutUpdated(const QRect &rect)
+{
+    if (mEpdc)
+        sendUpdate(rect, UpdateModeFast);
+}
+
+// Blocks until the controller completed all updates sent so far.
+void QLinuxFbScreen::waitForUpdates()
+{
+    const quint32 lastMarker = mUpdateMarker.loadRelaxed();
+    if (!mEpdc || lastMarker == 0)
+        return;
+
+#ifdef MXCFB_SEND_UPDATE
+    mxcfb_update_marker_data marker;
+    memset(&marker, 0, sizeof(marker));
+    marker.update_marker = lastMarker;
+    if (ioctl(mFbFd, MXCFB_WAIT_FOR_UPDATE_COMPLETE, &marker) == -1)
+        qErrnoWarning(errno, "Failed to wait for e-paper update %u", lastMarker);
+#endif
+}
+
+// grabWindow() grabs "from the screen" not from the backingstores.
+// In linuxfb's case it will also include the mouse cursor.
+QPixmap QLinuxFbScreen::grabWindow(WId wid, int x, int y, int width, int height) const
+{
+    waitForCompositor();
+
+    // Grab the composited image if the framebuffer's pixels are packed
+    const QImage &screenImage = mPackedDepth ? mScreenImage : mFbScreenImage;
+    return grabScreenImage(screenImage, wid, x, y, width, height);
 }
 
 QT_END_NAMESPACE
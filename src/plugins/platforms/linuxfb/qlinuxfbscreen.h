@@ -41,6 +41,7 @@
 #define QLINUXFBSCREEN_H
 
 #include <QtFbSupport/private/qfbscreen_p.h>
+#include <QtCore/QAtomicInteger>
 
 QT_BEGIN_NAMESPACE
 
@@ -60,7 +61,19 @@ public:
 
     QRegion doRedraw() override;
 
+    Flags flags() const override;
+    void waitForUpdates() override;
+
+    QVector<QImage> scanoutBuffers() const override;
+    void scanoutUpdated(const QRect &rect) override;
+
+protected:
+    QImage scanoutImage() override { return mFbScreenImage; }
+
 private:
+    void sendUpdates(const QRegion &region);
+    void sendUpdate(const QRect &rect, UpdateMode mode);
+
     QStringList mArgs;
     int mFbFd;
     int mTtyFd;
@@ -75,6 +88,12 @@ private:
     } mMmap;
 
     QPainter *mBlitter;
+    int mPackedDepth;
+    bool mPackedInverted;
+
+    QPoint mFbOffset;
+    bool mEpdc;
+    QAtomicInteger<quint32> mUpdateMarker;
 };
 
 QT_END_NAMESPACE
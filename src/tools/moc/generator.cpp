@@ -1528,9 +1528,10 @@ void Generator::generateSignal(FunctionDef *def,int index)
 
     Q_ASSERT(!def->normalizedType.isEmpty());
     if (def->arguments.isEmpty() && def->normalizedType == "void" && !def->isPrivateSignal) {
-        fprintf(out, ")%s\n{\n"
-                "    QMetaObject::activate(%s, &staticMetaObject, %d, nullptr);\n"
-                "}\n", constQualifier, thisPtr.constData(), index);
+        fprintf(out, ")%s\n{\n", constQualifier);
+        generateSignalOffset();
+        fprintf(out, "    QMetaObject::activate(%s, _signalOffset, %d, nullptr);\n"
+                "}\n", thisPtr.constData(), index);
         return;
     }
 
@@ -1569,12 +1570,21 @@ void Generator::generateSignal(FunctionDef *def,int index)
         else
             fprintf(out, ", const_cast<void*>(reinterpret_cast<const void*>(std::addressof(_t%d)))", i);
     fprintf(out, " };\n");
-    fprintf(out, "    QMetaObject::activate(%s, &staticMetaObject, %d, _a);\n", thisPtr.constData(), index);
+    generateSignalOffset();
+    fprintf(out, "    QMetaObject::activate(%s, _signalOffset, %d, _a);\n", thisPtr.constData(), index);
     if (def->normalizedType != "void")
         fprintf(out, "    return _t0;\n");
     fprintf(out, "}\n");
 }
 
+void Generator::generateSignalOffset()
+{
+    // The offset depends on the number of signals in the superclasses, which
+    // may live in other libraries, so it can't be a compile-time constant.
+    // It doesn't change once the classes are loaded though.
+    fprintf(out, "    static const int _signalOffset = QMetaObject::signalOffset(&staticMetaObject);\n");
+}
+
 static CborError jsonValueToCbor(CborEncoder *parent, const QJsonValue &v);
 static CborError jsonObjectToCbor(CborEncoder *parent, const QJsonObject &o)
 {
@@ -4136,6 +4136,8 @@ bool QApplicationPrivate::updateTouchPointsForWidget(QWidget *widget, QTouchEven
         touchPoint.d->pos = widget->mapFromGlobal(screenPos.toPoint()) + delta;
         touchPoint.d->startPos = widget->mapFromGlobal(touchPoint.startScreenPos().toPoint()) + delta;
         touchPoint.d->lastPos = widget->mapFromGlobal(touchPoint.lastScreenPos().toPoint()) + delta;
+        if (!touchPoint.d->history.isEmpty())
+            touchPoint.d->updateHistoryPositions();
 
         if (touchPoint.state() == Qt::TouchPointPressed)
             containsPress = true;
@@ -52,6 +52,7 @@
 #include <qpa/qplatformwindow.h>
 #include <private/qgesturemanager_p.h>
 #include <private/qhighdpiscaling_p.h>
+#include <private/qevent_p.h>
 
 QT_BEGIN_NAMESPACE
 
@@ -1091,6 +1092,7 @@ void QWidgetWindow::handleTabletEvent(QTabletEvent *event)
                         event->rotation(), event->z(), event->modifiers(), event->uniqueId(), event->button(), event->buttons());
         ev.setTimestamp(event->timestamp());
         ev.setAccepted(false);
+        QTabletEventPrivate::setHistory(&ev, event->history());
         QGuiApplication::forwardEvent(widget, &ev, event);
         event->setAccepted(ev.isAccepted());
     }
@@ -4,6 +4,7 @@ SUBDIRS=\
    qtconcurrentiteratekernel \
    qtconcurrentmap \
    qtconcurrentmedian \
+   qtconcurrentpipeline \
    qtconcurrentrun \
    qtconcurrentthreadengine
 
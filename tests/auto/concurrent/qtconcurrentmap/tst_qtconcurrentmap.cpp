@@ -26,6 +26,7 @@
 **
 ****************************************************************************/
 #include <qtconcurrentmap.h>
+#include <qtconcurrentfilter.h>
 #include <qexception.h>
 
 #include <qdebug.h>
@@ -57,6 +58,7 @@ private slots:
     void stlContainers();
     void qFutureAssignmentLeak();
     void stressTest();
+    void parallelReduceOptions();
     void persistentResultTest();
 public slots:
     void throttling();
@@ -2562,6 +2564,62 @@ void tst_QtConcurrentMap::stressTest()
     }
 }
 
+void appendValue(QVector<int> &result, const int &value)
+{
+    result.append(value);
+}
+
+bool isOdd(const int &value)
+{
+    return value % 2;
+}
+
+void tst_QtConcurrentMap::parallelReduceOptions()
+{
+    const int listSize = 40000;
+    QVector<int> list;
+    for (int i = 0; i < listSize; ++i)
+        list.append(i);
+    const qint64 sum = qint64(listSize - 1) * listSize / 2;
+    QVERIFY(sum < std::numeric_limits<int>::max());
+
+    // make sure there are several ranges and partial results to combine
+    QThreadPool *pool = QThreadPool::globalInstance();
+    const int maxThreadCount = pool->maxThreadCount();
+    pool->setMaxThreadCount(qMax(4, maxThreadCount));
+
+    for (int i = 0; i < 20; ++i) {
+        QCOMPARE(QtConcurrent::blockingMappedReduced(list, echo, add,
+                                                     QtConcurrent::ParallelReduce), int(sum));
+        QCOMPARE(QtConcurrent::blockingMappedReduced(list, echo, add,
+                                                     QtConcurrent::ParallelReduce
+                                                     | QtConcurrent::RangePartitioning), int(sum));
+        QCOMPARE(QtConcurrent::blockingMappedReduced(list.constBegin(), list.constEnd(), echo, add,
+                                                     QtConcurrent::UnorderedReduce
+                                                     | QtConcurrent::RangePartitioning), int(sum));
+        QCOMPARE(QtConcurrent::blockingFilteredReduced(list, isOdd, add,
+                                                       QtConcurrent::ParallelReduce
+                                                       | QtConcurrent::RangePartitioning),
+                 int(sum - qint64(listSize / 2 - 1) * (listSize / 2)));
+    }
+
+    // ranges and OrderedReduce keep the order of the sequence
+    QCOMPARE(QtConcurrent::blockingMappedReduced(list, echo, appendValue,
+                                                 QtConcurrent::OrderedReduce
+                                                 | QtConcurrent::RangePartitioning), list);
+
+    // a reducer that cannot combine partial results falls back to UnorderedReduce
+    QVector<int> unordered = QtConcurrent::blockingMappedReduced(list, echo, appendValue,
+                                                                 QtConcurrent::ParallelReduce);
+    std::sort(unordered.begin(), unordered.end());
+    QCOMPARE(unordered, list);
+    QCOMPARE(QtConcurrent::blockingMappedReduced(list, echo, appendValue,
+                                                 QtConcurrent::ParallelReduce
+                                                 | QtConcurrent::OrderedReduce), list);
+
+    pool->setMaxThreadCount(maxThreadCount);
+}
+
 struct LockedCounter
 {
     LockedCounter(QMutex *mutex, QAtomicInt *ai)
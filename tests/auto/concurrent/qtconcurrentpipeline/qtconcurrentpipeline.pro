@@ -0,0 +1,4 @@
+CONFIG += testcase
+TARGET = tst_qtconcurrentpipeline
+QT = core testlib concurrent
+SOURCES = tst_qtconcurrentpipeline.cpp
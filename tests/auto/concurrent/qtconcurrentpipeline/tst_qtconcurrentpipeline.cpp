@@ -0,0 +1,263 @@
+/****************************************************************************
+**
+** Copyright (C) 2020 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the test suite of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+#include <qtconcurrentpipeline.h>
+#include <qfuture.h>
+#include <QtTest/QtTest>
+
+using namespace QtConcurrent;
+
+class tst_QtConcurrentPipeline: public QObject
+{
+    Q_OBJECT
+private slots:
+    void orderedMap();
+    void unorderedMap();
+    void filter();
+    void backPressure();
+    void cancel();
+    void cancelWaitsForWorkers();
+#ifndef QT_NO_EXCEPTIONS
+    void exceptions();
+#endif
+    void pushBeforeSink();
+};
+
+void tst_QtConcurrentPipeline::orderedMap()
+{
+    QThreadPool pool;
+    pool.setMaxThreadCount(4);
+    Pipeline<int> pipeline(4, &pool);
+    QVector<QString> results;
+    QFuture<void> future = pipeline
+            .map([](int i) {
+                if (i % 3 == 0)
+                    QThread::usleep(200);
+                return i * 2;
+            }, 4)
+            .map([](int i) { return QString::number(i); }, 2)
+            .sink([&results](const QString &s) { results.append(s); });
+
+    for (int i = 0; i < 1000; ++i)
+        QVERIFY(pipeline.push(i));
+    pipeline.close();
+    future.waitForFinished();
+
+    QVERIFY(future.isFinished());
+    QVERIFY(!future.isCanceled());
+    QCOMPARE(results.size(), 1000);
+    for (int i = 0; i < 1000; ++i)
+        QCOMPARE(results.at(i), QString::number(i * 2));
+}
+
+void tst_QtConcurrentPipeline::unorderedMap()
+{
+    QThreadPool pool;
+    Pipeline<int> pipeline(8, &pool);
+    QVector<int> results;
+    QFuture<void> future = pipeline
+            .map([](int i) { return i + 1; }, 3, UnorderedStage)
+            .sink([&results](int i) { results.append(i); });
+
+    for (int i = 0; i < 500; ++i)
+        pipeline.push(i);
+    pipeline.close();
+    future.waitForFinished();
+
+    std::sort(results.begin(), results.end());
+    QCOMPARE(results.size(), 500);
+    for (int i = 0; i < 500; ++i)
+        QCOMPARE(results.at(i), i + 1);
+}
+
+void tst_QtConcurrentPipeline::filter()
+{
+    QThreadPool pool;
+    Pipeline<int> pipeline(4, &pool);
+    QVector<int> results;
+    QFuture<void> future = pipeline
+            .filter([](int i) { return i % 2 == 0; }, 3)
+            .map([](int i) { return i / 2; })
+            .sink([&results](int i) { results.append(i); });
+
+    for (int i = 0; i < 200; ++i)
+        pipeline.push(i);
+    pipeline.close();
+    future.waitForFinished();
+
+    QCOMPARE(results.size(), 100);
+    for (int i = 0; i < 100; ++i)
+        QCOMPARE(results.at(i), i);
+}
+
+void tst_QtConcurrentPipeline::backPressure()
+{
+    const int capacity = 2;
+    QThreadPool pool;
+    QSemaphore release;
+    QAtomicInt started;
+    QAtomicInt inFlight;
+    QAtomicInt maxInFlight;
+
+    Pipeline<int> pipeline(capacity, &pool);
+    QFuture<void> future = pipeline
+            .map([&](int i) {
+                const int n = inFlight.fetchAndAddOrdered(1) + 1;
+                int max = maxInFlight.loadAcquire();
+                while (n > max && !maxInFlight.testAndSetOrdered(max, n, max)) { }
+                return i;
+            })
+            .sink([&](int) {
+                started.ref();
+                release.acquire();
+                inFlight.deref();
+            });
+
+    // The producer must stall once the sink is blocked and the queues
+    // in front of it are full
+    QAtomicInt pushed;
+    QScopedPointer<QThread> producer(QThread::create([&]() {
+        for (int i = 0; i < 100; ++i) {
+            pipeline.push(i);
+            pushed.ref();
+        }
+        pipeline.close();
+    }));
+    producer->start();
+
+    QTRY_COMPARE(started.loadAcquire(), 1);
+    QTest::qWait(50);
+    // one item in the sink, one in the map stage, and capacity items in
+    // each of the two queues
+    QVERIFY(pushed.loadAcquire() <= 2 * capacity + 2);
+
+    release.release(100);
+    future.waitForFinished();
+    QVERIFY(producer->wait());
+    QCOMPARE(pushed.loadAcquire(), 100);
+    QVERIFY(maxInFlight.loadAcquire() <= 2 * capacity + 2);
+}
+
+void tst_QtConcurrentPipeline::cancel()
+{
+    QThreadPool pool;
+    QAtomicInt processed;
+    Pipeline<int> pipeline(4, &pool);
+    QFuture<void> future = pipeline
+            .map([](int i) { QThread::msleep(1); return i; })
+            .sink([&processed](int) { processed.ref(); });
+
+    for (int i = 0; i < 10; ++i)
+        QVERIFY(pipeline.push(i));
+    pipeline.cancel();
+    QVERIFY(!pipeline.push(10));
+    future.waitForFinished();
+
+    QVERIFY(future.isCanceled());
+    QVERIFY(future.isFinished());
+    QVERIFY(processed.loadAcquire() < 11);
+}
+
+void tst_QtConcurrentPipeline::cancelWaitsForWorkers()
+{
+    QThreadPool pool;
+    pool.setMaxThreadCount(2); // the sink must run while the map worker is blocked
+    QSemaphore entered;
+    QSemaphore release;
+    QAtomicInt running;
+    Pipeline<int> pipeline(4, &pool);
+    QFuture<void> future = pipeline
+            .map([&](int i) {
+                running.ref();
+                entered.release();
+                release.acquire();
+                running.deref();
+                return i;
+            })
+            .sink([](int) { });
+
+    QVERIFY(pipeline.push(0));
+    QVERIFY(entered.tryAcquire(1, 10000));
+    pipeline.cancel();
+
+    // the sink stops right away, but the map worker is still running
+    QThread::msleep(100);
+    QVERIFY(!future.isFinished());
+
+    release.release();
+    future.waitForFinished();
+    QVERIFY(future.isCanceled());
+    QCOMPARE(running.loadAcquire(), 0);
+}
+
+#ifndef QT_NO_EXCEPTIONS
+void tst_QtConcurrentPipeline::exceptions()
+{
+    QThreadPool pool;
+    Pipeline<int> pipeline(4, &pool);
+    QFuture<void> future = pipeline
+            .map([](int i) {
+                if (i == 5)
+                    throw QException();
+                return i;
+            }, 2)
+            .sink([](int) { });
+
+    bool stopped = false;
+    for (int i = 0; i < 1000 && !stopped; ++i)
+        stopped = !pipeline.push(i);
+    pipeline.close();
+
+    bool caught = false;
+    try {
+        future.waitForFinished();
+    } catch (const QException &) {
+        caught = true;
+    }
+    QVERIFY(caught);
+    QVERIFY(stopped);
+}
+#endif
+
+void tst_QtConcurrentPipeline::pushBeforeSink()
+{
+    Pipeline<int> pipeline;
+    Pipeline<int> doubled = pipeline.map([](int i) { return i * 2; });
+    QTest::ignoreMessage(QtWarningMsg, "QtConcurrent::Pipeline::push: Call sink() before pushing items");
+    QVERIFY(!pipeline.push(1));
+
+    QAtomicInt sum;
+    QFuture<void> future = doubled.sink([&sum](int i) { sum.fetchAndAddOrdered(i); });
+    QVERIFY(pipeline.push(1));
+    QVERIFY(doubled.push(2));
+    pipeline.close();
+    future.waitForFinished();
+    QCOMPARE(sum.loadAcquire(), 6);
+}
+
+QTEST_MAIN(tst_QtConcurrentPipeline)
+#include "tst_qtconcurrentpipeline.moc"
@@ -61,6 +61,11 @@ private slots:
 
     void nonCharacters_data();
     void nonCharacters();
+
+    void invalidUtf8InLongText_data();
+    void invalidUtf8InLongText();
+    void loneSurrogatesInLongText_data();
+    void loneSurrogatesInLongText();
 };
 
 void tst_Utf8::initTestCase()
@@ -145,6 +150,14 @@ void tst_Utf8::roundTrip_data()
                                     ' ', 0x10FFFD, ' ',
                                     0x20AC, 'd', 'e', 'f', 0 };
     QTest::newRow("utf8_8") << QByteArray(utf8_8) << QString::fromUcs4(utf32_8);
+
+    // long enough for the vectorized code
+    static const char utf8_9[] = "abc\302\240\303\241\316\261\320\266\342\202\254\344\275\240 \360\237\230\200 def";
+    static const uint utf32_9[] = { 'a', 'b', 'c', 0x00A0,
+                                    0x00E1, 0x03B1, 0x0436, 0x20AC,
+                                    0x4F60, ' ', 0x1F600, ' ',
+                                    'd', 'e', 'f', 0 };
+    QTest::newRow("utf8_9") << QByteArray(utf8_9).repeated(8) << QString::fromUcs4(utf32_9).repeated(8);
 }
 
 void tst_Utf8::roundTrip()
@@ -273,5 +286,129 @@ void tst_Utf8::nonCharacters()
         qWarning("System codec reports failure when it shouldn't. Should report bug upstream.");
 }
 
+// Returns size bytes of valid UTF-8 text made of characters of all lengths,
+// so that the vectorized code does not take its US-ASCII shortcuts
+static QByteArray utf8Filler(int size)
+{
+    static const char *const pieces[] = { "\303\251", "x", "\342\202\254", "\360\237\230\200", "\320\266" };
+    QByteArray result;
+    for (int i = 0; result.size() < size; ++i) {
+        const char *piece = pieces[i % 5];
+        if (result.size() + int(strlen(piece)) <= size)
+            result += piece;
+        else
+            result += 'x';
+    }
+    return result;
+}
+
+void tst_Utf8::invalidUtf8InLongText_data()
+{
+    QTest::addColumn<QByteArray>("prefix");
+    QTest::addColumn<QByteArray>("sequence");
+    QTest::addColumn<QByteArray>("suffix");
+
+    static const struct {
+        const char *name;
+        const char *sequence;
+    } sequences[] = {
+        { "overlong-2", "\301\277" },
+        { "overlong-3", "\340\237\277" },
+        { "overlong-4", "\360\217\277\277" },
+        { "surrogate-high", "\355\240\200" },
+        { "surrogate-low", "\355\277\277" },
+        { "above-10ffff", "\364\220\200\200" },
+        { "truncated-2", "\303" },
+        { "truncated-3", "\342\202" },
+        { "truncated-4", "\360\237\230" },
+        { "continuation", "\200" },
+    };
+    // the vectorized code works on blocks of 16 and 32 bytes
+    for (int position : { 15, 16, 31, 32 }) {
+        for (const auto &sequence : sequences) {
+            const QByteArray bad(sequence.sequence);
+            QTest::addRow("%s-at-%d", sequence.name, position)
+                    << utf8Filler(position) << bad << utf8Filler(64 - position - bad.size());
+        }
+    }
+}
+
+void tst_Utf8::invalidUtf8InLongText()
+{
+    QFETCH(QByteArray, prefix);
+    QFETCH(QByteArray, sequence);
+    QFETCH(QByteArray, suffix);
+    QFETCH_GLOBAL(bool, useLocale);
+    if (useLocale)
+        QSKIP("Only the UTF-8 codec is checked");
+
+    // the sequence alone, between two US-ASCII characters, is too short
+    // for the vectorized code
+    QString replaced = QString::fromUtf8("x" + sequence + "x");
+    QVERIFY(replaced.contains(QChar(QChar::ReplacementCharacter)));
+    replaced = replaced.mid(1, replaced.size() - 2);
+    const QString expected = QString::fromUtf8(prefix) + replaced + QString::fromUtf8(suffix);
+
+    const QByteArray utf8 = prefix + sequence + suffix;
+    const QScopedPointer<QTextDecoder> decoder(codec->makeDecoder());
+    QCOMPARE(decoder->toUnicode(utf8), expected);
+    QVERIFY(decoder->hasFailure());
+    QCOMPARE(from8Bit(utf8), expected);
+}
+
+// Returns size characters of text with surrogate pairs and characters that
+// take one to three bytes in UTF-8
+static QString utf16Filler(int size)
+{
+    static const char16_t *const pieces[] = { u"\u00e9", u"x", u"\u20ac", u"\U0001F600", u"\u0436", u"\u4f60" };
+    QString result;
+    for (int i = 0; result.size() < size; ++i) {
+        const QString piece = QString::fromUtf16(pieces[i % 6]);
+        if (result.size() + piece.size() <= size)
+            result += piece;
+        else
+            result += QLatin1Char('x');
+    }
+    return result;
+}
+
+void tst_Utf8::loneSurrogatesInLongText_data()
+{
+    QTest::addColumn<QString>("utf16");
+
+    // the vectorized code works on blocks of 8 and 16 characters
+    for (int position : { 7, 8, 15, 16 }) {
+        QTest::addRow("high-at-%d", position)
+                << utf16Filler(position) + QChar(0xD83D) + utf16Filler(31 - position);
+        QTest::addRow("low-at-%d", position)
+                << utf16Filler(position) + QChar(0xDE00) + utf16Filler(31 - position);
+    }
+}
+
+void tst_Utf8::loneSurrogatesInLongText()
+{
+    QFETCH(QString, utf16);
+    QFETCH_GLOBAL(bool, useLocale);
+    if (useLocale)
+        QSKIP("Only the UTF-8 codec is checked");
+
+    const QScopedPointer<QTextEncoder> encoder(codec->makeEncoder());
+    QByteArray encoded = encoder->fromUnicode(utf16);
+    QVERIFY(encoder->hasFailure());
+
+    // one character at a time, nothing is vectorized
+    const QScopedPointer<QTextEncoder> charEncoder(codec->makeEncoder());
+    QByteArray expected;
+    for (int i = 0; i < utf16.size(); ++i)
+        expected += charEncoder->fromUnicode(utf16.constData() + i, 1);
+    QVERIFY(charEncoder->hasFailure());
+    if (encoded.startsWith(utf8bom))
+        encoded = encoded.mid(int(strlen(utf8bom)));
+    if (expected.startsWith(utf8bom))
+        expected = expected.mid(int(strlen(utf8bom)));
+    QCOMPARE(encoded, expected);
+    QCOMPARE(to8Bit(utf16), expected);
+}
+
 QTEST_MAIN(tst_Utf8)
 #include "tst_utf8.moc"
@@ -532,6 +532,99 @@ void tst_QCoreApplication::deliverInDefinedOrder()
     QObject::connect(&obj, SIGNAL(done()), &app, SLOT(quit()));
     app.exec();
 }
+
+class SequencedEvent : public QEvent
+{
+public:
+    SequencedEvent(int producer, int sequence)
+        : QEvent(QEvent::User), producer(producer), sequence(sequence)
+    { }
+
+    int producer;
+    int sequence;
+};
+
+class SequenceChecker : public QObject
+{
+public:
+    SequenceChecker(int producers, int eventsPerProducer)
+        : next(producers, 0), remaining(producers * eventsPerProducer)
+    { }
+
+    void received(int producer, int sequence)
+    {
+        if (next.at(producer) != sequence)
+            outOfOrder = true;
+        next[producer] = sequence + 1;
+        if (--remaining == 0)
+            QCoreApplication::quit();
+    }
+
+    bool event(QEvent *event) override
+    {
+        if (event->type() != QEvent::User)
+            return QObject::event(event);
+        const SequencedEvent *e = static_cast<SequencedEvent *>(event);
+        received(e->producer, e->sequence);
+        return true;
+    }
+
+    QVector<int> next;
+    int remaining;
+    bool outOfOrder = false;
+};
+
+class SequenceProducer : public QThread
+{
+public:
+    SequenceProducer(SequenceChecker *checker, int producer, int count)
+        : checker(checker), producer(producer), count(count)
+    { }
+
+protected:
+    void run() override
+    {
+        // queued calls skip the post event list mutex, other events don't
+        for (int i = 0; i < count; ++i) {
+            if (i % 3) {
+                SequenceChecker *checker = this->checker;
+                const int producer = this->producer;
+                QMetaObject::invokeMethod(checker, [=]() { checker->received(producer, i); },
+                                          Qt::QueuedConnection);
+            } else {
+                QCoreApplication::postEvent(checker, new SequencedEvent(producer, i));
+            }
+        }
+    }
+
+private:
+    SequenceChecker *checker;
+    int producer;
+    int count;
+};
+
+void tst_QCoreApplication::postEventFromThreadsKeepsOrder()
+{
+    int argc = 1;
+    char *argv[] = { const_cast<char*>(QTest::currentAppName()) };
+    TestApplication app(argc, argv);
+
+    const int producers = 4;
+    const int eventsPerProducer = 3000;
+    SequenceChecker checker(producers, eventsPerProducer);
+
+    std::vector<std::unique_ptr<SequenceProducer>> threads;
+    for (int i = 0; i < producers; ++i) {
+        threads.emplace_back(new SequenceProducer(&checker, i, eventsPerProducer));
+        threads.back()->start();
+    }
+    app.exec();
+    for (const auto &thread : threads)
+        QVERIFY(thread->wait());
+
+    QCOMPARE(checker.remaining, 0);
+    QVERIFY(!checker.outOfOrder);
+}
 #endif // QT_CONFIG(thread)
 
 void tst_QCoreApplication::applicationPid()
@@ -1,4 +1,4 @@
 CONFIG += testcase
 TARGET = tst_qeventdispatcher
 QT = core testlib
-SOURCES += tst_qeventdispatcher.cpp
+SOURCES += $$PWD/tst_qeventdispatcher.cpp
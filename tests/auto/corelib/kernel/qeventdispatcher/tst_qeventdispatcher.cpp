@@ -59,6 +59,8 @@ public:
           eventDispatcher(QAbstractEventDispatcher::instance(thread()))
     { }
 
+    static void initMain();
+
 private slots:
     void initTestCase();
     void registerTimer();
@@ -88,6 +90,13 @@ bool tst_QEventDispatcher::event(QEvent *e)
     return QObject::event(e);
 }
 
+void tst_QEventDispatcher::initMain()
+{
+#ifdef QT_TEST_EVENT_DISPATCHER_EPOLL
+    qputenv("QT_EVENT_DISPATCHER_EPOLL", "1");
+#endif
+}
+
 // drain the system event queue after the test starts to avoid destabilizing the test functions
 void tst_QEventDispatcher::initTestCase()
 {
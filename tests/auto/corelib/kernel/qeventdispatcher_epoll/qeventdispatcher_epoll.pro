@@ -0,0 +1,3 @@
+include(../qeventdispatcher/qeventdispatcher.pro)
+TARGET = tst_qeventdispatcher_epoll
+DEFINES += QT_TEST_EVENT_DISPATCHER_EPOLL tst_QEventDispatcher=tst_QEventDispatcher_Epoll
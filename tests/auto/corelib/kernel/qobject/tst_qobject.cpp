@@ -78,6 +78,8 @@ private slots:
     void thread();
     void thread0();
     void moveToThread();
+    void moveToThreadWhilePosting();
+    void batchQueuedCalls();
     void senderTest();
     void declareInterface();
     void qpointerResetBeforeDestroyedSignal();
@@ -146,6 +148,7 @@ private slots:
     void connectStaticSlotWithObject();
     void disconnectDoesNotLeakFunctor();
     void contextDoesNotLeakFunctor();
+    void deleteContextInFunctor();
     void connectBase();
     void connectWarnings();
     void qmlConnect();
@@ -1905,6 +1908,211 @@ void tst_QObject::moveToThread()
 #endif
 }
 
+class ThreadHopper : public QObject
+{
+public:
+    QThread *threads[2];
+    QAtomicInt received;
+    QAtomicInt receivedInWrongThread;
+
+    void call()
+    {
+        if (QThread::currentThread() != thread())
+            receivedInWrongThread.ref();
+        const int count = received.fetchAndAddRelaxed(1) + 1;
+        if (count % 64 == 0)
+            moveToThread(threads[count / 64 % 2]);
+    }
+};
+
+class HopperFeeder : public QThread
+{
+public:
+    HopperFeeder(ThreadHopper *hopper, int count)
+        : hopper(hopper), count(count)
+    { }
+
+    void run() override
+    {
+        for (int i = 0; i < count; ++i) {
+            QMetaObject::invokeMethod(hopper, [hopper = hopper]() { hopper->call(); },
+                                      Qt::QueuedConnection);
+        }
+    }
+
+private:
+    ThreadHopper *hopper;
+    int count;
+};
+
+void tst_QObject::moveToThreadWhilePosting()
+{
+    // queued calls that race with moveToThread() must still be delivered,
+    // and only in the receiver's new thread
+    MoveToThreadThread first;
+    MoveToThreadThread second;
+    first.start();
+    second.start();
+
+    ThreadHopper hopper;
+    hopper.threads[0] = &first;
+    hopper.threads[1] = &second;
+    hopper.moveToThread(&first);
+
+    const int feeders = 4;
+    const int callsPerFeeder = 2000;
+    std::vector<std::unique_ptr<HopperFeeder>> threads;
+    for (int i = 0; i < feeders; ++i) {
+        threads.emplace_back(new HopperFeeder(&hopper, callsPerFeeder));
+        threads.back()->start();
+    }
+    for (const auto &thread : threads)
+        QVERIFY(thread->wait());
+
+    QTRY_COMPARE_WITH_TIMEOUT(hopper.received.loadRelaxed(), feeders * callsPerFeeder, 30000);
+    QCOMPARE(hopper.receivedInWrongThread.loadRelaxed(), 0);
+
+    first.quit();
+    second.quit();
+    QVERIFY(first.wait());
+    QVERIFY(second.wait());
+}
+
+// Too large to be stored in a QMetaCallEvent with the other arguments
+struct LargeArgument
+{
+    int values[16];
+};
+Q_DECLARE_METATYPE(LargeArgument)
+
+class BatchSender : public QObject
+{
+    Q_OBJECT
+signals:
+    void call(const QString &text, int number);
+    void largeCall(const LargeArgument &argument, int number);
+};
+
+class BatchReceiver : public QObject
+{
+    Q_OBJECT
+public:
+    QStringList texts;
+    QList<int> numbers;
+    QList<QThread *> threads;
+    int wrongSender = 0;
+    int deleteAt = -1;
+    int moveAt = -1;
+    QThread *moveTo = nullptr;
+
+public slots:
+    void slot(const QString &text, int number)
+    {
+        if (!qobject_cast<BatchSender *>(sender()))
+            ++wrongSender;
+        texts << text;
+        numbers << number;
+        threads << QThread::currentThread();
+        if (numbers.size() == deleteAt)
+            delete this;
+        else if (numbers.size() == moveAt)
+            moveToThread(moveTo);
+    }
+
+    void largeSlot(const LargeArgument &argument, int number)
+    {
+        for (int value : argument.values) {
+            if (value != number)
+                ++wrongSender;
+        }
+        slot(QString(), number);
+    }
+
+protected:
+    void customEvent(QEvent *) override
+    {
+        numbers << -1;
+    }
+};
+
+void tst_QObject::batchQueuedCalls()
+{
+    BatchSender sender;
+    QPointer<BatchReceiver> receiver = new BatchReceiver;
+    connect(&sender, &BatchSender::call, receiver.data(), &BatchReceiver::slot, Qt::QueuedConnection);
+    qRegisterMetaType<LargeArgument>();
+    connect(&sender, &BatchSender::largeCall, receiver.data(), &BatchReceiver::largeSlot, Qt::QueuedConnection);
+    QObjectPrivate::get(receiver)->setBatchQueuedCalls(true);
+
+    // the large argument is copied outside of the event
+    LargeArgument large;
+    std::fill(std::begin(large.values), std::end(large.values), 2);
+    emit sender.call(QLatin1String("a"), 1);
+    emit sender.largeCall(large, 2);
+    emit sender.call(QLatin1String("c"), 3);
+    QVERIFY(receiver->numbers.isEmpty());
+    QCoreApplication::processEvents();
+    QCOMPARE(receiver->numbers, QList<int>() << 1 << 2 << 3);
+    QCOMPARE(receiver->texts, QStringList() << "a" << QString() << "c");
+    QCOMPARE(receiver->wrongSender, 0);
+
+    // later calls join the pending batch, ahead of other events
+    receiver->numbers.clear();
+    emit sender.call(QLatin1String("a"), 1);
+    QCoreApplication::postEvent(receiver, new QEvent(QEvent::User));
+    emit sender.call(QLatin1String("b"), 2);
+    QCoreApplication::processEvents();
+    QCOMPARE(receiver->numbers, QList<int>() << 1 << 2 << -1);
+    receiver->numbers = QList<int>() << 1 << 2 << 3;
+
+    // a batch that is removed unseen doesn't swallow later calls
+    emit sender.call(QLatin1String("d"), 4);
+    QCoreApplication::removePostedEvents(receiver, QEvent::MetaCall);
+    emit sender.call(QLatin1String("e"), 5);
+    QCoreApplication::processEvents();
+    QCOMPARE(receiver->numbers, QList<int>() << 1 << 2 << 3 << 5);
+
+    // the receiver may delete itself in the middle of a batch, which drops
+    // the rest of it
+    receiver->deleteAt = 5;
+    emit sender.call(QLatin1String("f"), 6);
+    emit sender.call(QLatin1String("g"), 7);
+    emit sender.largeCall(large, 8);
+    QCoreApplication::processEvents();
+    QVERIFY(receiver.isNull());
+
+    // the rest of the batch follows a receiver moved to another thread
+    receiver = new BatchReceiver;
+    connect(&sender, &BatchSender::call, receiver.data(), &BatchReceiver::slot, Qt::QueuedConnection);
+    QObjectPrivate::get(receiver)->setBatchQueuedCalls(true);
+    QThread thread;
+    thread.start();
+    receiver->moveAt = 1;
+    receiver->moveTo = &thread;
+    emit sender.call(QLatin1String("a"), 1);
+    emit sender.call(QLatin1String("b"), 2);
+    emit sender.call(QLatin1String("c"), 3);
+    QCoreApplication::processEvents();
+    // queued behind the re-posted calls
+    QMetaObject::invokeMethod(receiver, [] {}, Qt::BlockingQueuedConnection);
+    QCOMPARE(receiver->numbers, QList<int>() << 1 << 2 << 3);
+    QCOMPARE(receiver->threads, QList<QThread *>() << QThread::currentThread() << &thread << &thread);
+    QCOMPARE(receiver->wrongSender, 0);
+    receiver->deleteLater();
+    thread.quit();
+    QVERIFY(thread.wait());
+    QVERIFY(receiver.isNull());
+
+    // calls queued to a deleted receiver are dropped with it
+    receiver = new BatchReceiver;
+    connect(&sender, &BatchSender::call, receiver.data(), &BatchReceiver::slot, Qt::QueuedConnection);
+    QObjectPrivate::get(receiver)->setBatchQueuedCalls(true);
+    emit sender.call(QLatin1String("h"), 8);
+    delete receiver;
+    emit sender.call(QLatin1String("i"), 9);
+    QCoreApplication::processEvents();
+}
+
 
 void tst_QObject::property()
 {
@@ -6677,6 +6885,29 @@ void tst_QObject::contextDoesNotLeakFunctor()
     QCOMPARE(countedStructObjectsCount, 0);
 }
 
+void tst_QObject::deleteContextInFunctor()
+{
+    // a functor that deletes its context object stays alive until the
+    // emission is done
+    QCOMPARE(countedStructObjectsCount, 0);
+    {
+        SenderObject obj;
+        ContextObject *context = new ContextObject;
+        CountedStruct s;
+        int countInSlot = -1;
+        connect(&obj, &SenderObject::signal1, context, [s, context, &countInSlot]() {
+            delete context;
+            countInSlot = countedStructObjectsCount;
+        });
+        QCOMPARE(countedStructObjectsCount, 2);
+
+        obj.emitSignal1();
+        QCOMPARE(countInSlot, 2);
+        QCOMPARE(countedStructObjectsCount, 1);
+    }
+    QCOMPARE(countedStructObjectsCount, 0);
+}
+
 class SubSender : public SenderObject {
     Q_OBJECT
 };
@@ -1,8 +1,8 @@
 CONFIG += testcase
 TARGET = tst_qsocketnotifier
 QT = core-private network-private testlib
-SOURCES = tst_qsocketnotifier.cpp
+SOURCES = $$PWD/tst_qsocketnotifier.cpp
 
 requires(qtConfig(private_tests))
 
-include(../../../network/socket/platformsocketengine/platformsocketengine.pri)
+include($$PWD/../../../network/socket/platformsocketengine/platformsocketengine.pri)
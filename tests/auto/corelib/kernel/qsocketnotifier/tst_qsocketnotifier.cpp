@@ -30,6 +30,7 @@
 #include <QtTest/QSignalSpy>
 #include <QtTest/QTestEventLoop>
 
+#include <QtCore/QAbstractEventDispatcher>
 #include <QtCore/QCoreApplication>
 #include <QtCore/QTimer>
 #include <QtCore/QSocketNotifier>
@@ -57,11 +58,15 @@
 class tst_QSocketNotifier : public QObject
 {
     Q_OBJECT
+public:
+    static void initMain();
+
 private slots:
     void unexpectedDisconnection();
     void mixingWithTimers();
 #ifdef Q_OS_UNIX
     void posixSockets();
+    void closedBehindNotifier();
 #endif
     void asyncMultipleDatagram();
     void activationReason_data();
@@ -77,6 +82,13 @@ private:
     QUdpSocket *m_asyncReceiver;
 };
 
+void tst_QSocketNotifier::initMain()
+{
+#ifdef QT_TEST_EVENT_DISPATCHER_EPOLL
+    qputenv("QT_EVENT_DISPATCHER_EPOLL", "1");
+#endif
+}
+
 static QHostAddress makeNonAny(const QHostAddress &address,
                                QHostAddress::SpecialAddress preferForAny = QHostAddress::LocalHost)
 {
@@ -327,6 +339,34 @@ void tst_QSocketNotifier::posixSockets()
     }
     qt_safe_close(posixSocket);
 }
+
+void tst_QSocketNotifier::closedBehindNotifier()
+{
+    int fds[2];
+    QCOMPARE(qt_safe_pipe(fds, O_NONBLOCK), 0);
+    const int otherFd = qt_safe_dup(fds[0]);
+    QVERIFY(otherFd >= 0);
+
+    // Close the descriptor before its notifier goes away, while the pipe
+    // stays open through another one.
+    {
+        QSocketNotifier notifier(fds[0], QSocketNotifier::Read);
+        qt_safe_close(fds[0]);
+    }
+    QCOMPARE(qt_safe_write(fds[1], "x", 1), qint64(1));
+
+    // The dispatcher must not keep waking up for the pipe
+    QAbstractEventDispatcher *dispatcher = QAbstractEventDispatcher::instance();
+    int wakeUps = 0;
+    const QMetaObject::Connection connection =
+            connect(dispatcher, &QAbstractEventDispatcher::awake, [&wakeUps]() { ++wakeUps; });
+    QTestEventLoop::instance().enterLoopMSecs(200);
+    disconnect(connection);
+    QVERIFY2(wakeUps < 50, QByteArray::number(wakeUps));
+
+    qt_safe_close(otherFd);
+    qt_safe_close(fds[1]);
+}
 #endif
 
 void tst_QSocketNotifier::async_readDatagramSlot()
@@ -0,0 +1,3 @@
+include(../qsocketnotifier/qsocketnotifier.pro)
+TARGET = tst_qsocketnotifier_epoll
+DEFINES += QT_TEST_EVENT_DISPATCHER_EPOLL tst_QSocketNotifier=tst_QSocketNotifier_Epoll
@@ -39,11 +39,18 @@
 #include <qtimer.h>
 #include <qthread.h>
 #include <qelapsedtimer.h>
+#include <qscopeguard.h>
+
+#include <numeric>
 
 #if defined Q_OS_UNIX
 #include <unistd.h>
 #endif
 
+#if defined(QT_BUILD_INTERNAL) && defined(Q_OS_UNIX)
+#  include <QtCore/private/qtimerinfo_unix_p.h>
+#endif
+
 class tst_QTimer : public QObject
 {
     Q_OBJECT
@@ -74,6 +81,9 @@ private slots:
     void timerFiresOnlyOncePerProcessEvents();
     void timerIdPersistsAfterThreadExit();
     void cancelLongTimer();
+    void manyTimers();
+    void timerWheelLevels_data();
+    void timerWheelLevels();
     void singleShotStaticFunctionZeroTimeout();
     void recurseOnTimeoutAndStopTimer();
     void singleShotToFunctors();
@@ -684,6 +694,199 @@ void tst_QTimer::cancelLongTimer()
     QVERIFY(!timer.isActive());
 }
 
+class ManyTimersObject : public QObject
+{
+public:
+    struct Timer {
+        int id;
+        int interval;
+        qint64 deadline;
+        qint64 fired;
+    };
+
+    QElapsedTimer clock;
+    QVector<Timer> timers;
+    QVector<int> firingOrder;
+    int pending = 0;
+
+protected:
+    void timerEvent(QTimerEvent *te) override
+    {
+        for (int i = 0; i < timers.size(); ++i) {
+            if (timers.at(i).id != te->timerId())
+                continue;
+            killTimer(te->timerId());
+            timers[i].fired = clock.nsecsElapsed();
+            firingOrder.append(i);
+            --pending;
+            return;
+        }
+        QFAIL("Unexpected timer event");
+    }
+};
+
+void tst_QTimer::manyTimers()
+{
+    ManyTimersObject object;
+    object.clock.start();
+
+    for (int i = 0; i < 1000; ++i) {
+        const int interval = (i * 37) % 400;
+        ManyTimersObject::Timer timer;
+        timer.interval = interval;
+        timer.deadline = object.clock.nsecsElapsed() + interval * qint64(1000000);
+        timer.fired = -1;
+        timer.id = object.startTimer(interval, Qt::PreciseTimer);
+        QVERIFY(timer.id > 0);
+        object.timers.append(timer);
+    }
+
+    // cancel every third timer
+    for (int i = 0; i < object.timers.size(); i += 3) {
+        object.killTimer(object.timers.at(i).id);
+        object.timers[i].id = 0;
+    }
+    object.pending = object.timers.size() - (object.timers.size() + 2) / 3;
+
+    QTRY_COMPARE_WITH_TIMEOUT(object.pending, 0, 5000);
+
+    QHash<int, int> lastFired;
+    for (int index : qAsConst(object.firingOrder)) {
+        const ManyTimersObject::Timer &timer = object.timers.at(index);
+        QVERIFY2(timer.id, "Cancelled timer fired");
+        QVERIFY2(timer.fired >= timer.deadline,
+                 qPrintable(QString::fromLatin1("Timer %1 fired early").arg(index)));
+
+        // timers with the same interval fire in the order they were started
+        QVERIFY(lastFired.value(timer.interval, -1) < index);
+        lastFired.insert(timer.interval, index);
+    }
+}
+
+#if defined(QT_BUILD_INTERNAL) && defined(Q_OS_UNIX)
+QT_BEGIN_NAMESPACE
+extern Q_AUTOTEST_EXPORT timespec (*qt_timerinfo_clock)();
+QT_END_NAMESPACE
+
+static qint64 simulatedTime; // nanoseconds
+
+static timespec simulatedClock()
+{
+    timespec ts;
+    ts.tv_sec = simulatedTime / 1000000000;
+    ts.tv_nsec = simulatedTime % 1000000000;
+    return ts;
+}
+
+class WheelTimersObject : public QObject
+{
+public:
+    explicit WheelTimersObject(QTimerInfoList *list) : list(list) { }
+
+    struct Timer {
+        int id;
+        qint64 deadline;
+        qint64 fired;
+    };
+
+    QTimerInfoList *list;
+    QVector<Timer> timers;
+    QVector<int> firingOrder;
+
+    void start(int interval)
+    {
+        const Timer timer = { timers.size() + 1, simulatedTime + interval * qint64(1000000), -1 };
+        list->registerTimer(timer.id, interval, Qt::PreciseTimer, this);
+        timers.append(timer);
+    }
+
+protected:
+    void timerEvent(QTimerEvent *te) override
+    {
+        const int index = te->timerId() - 1;
+        list->unregisterTimer(te->timerId());
+        timers[index].fired = simulatedTime;
+        firingOrder.append(index);
+    }
+};
+#endif
+
+void tst_QTimer::timerWheelLevels_data()
+{
+    QTest::addColumn<qint64>("step");
+
+    QTest::newRow("to next timer") << qint64(0);
+    QTest::newRow("7 minute steps") << qint64(7 * 60 * 1000);
+    QTest::newRow("1 hour steps") << qint64(60 * 60 * 1000);
+    QTest::newRow("3 day steps") << qint64(3 * 24 * 60 * 60 * 1000);
+}
+
+// Runs timers in every level of the wheel of QTimerInfoList, and beyond it,
+// on a simulated clock: each must fire once at its deadline, in order, after
+// cascading down from wherever it was stored.
+void tst_QTimer::timerWheelLevels()
+{
+#if defined(QT_BUILD_INTERNAL) && defined(Q_OS_UNIX)
+    QFETCH(qint64, step);
+
+    // Levels of 64 slots of 1, 64, 4096, 262144 and 16777216 ms; the wheel
+    // ends at 2^30 ms. Timers are started in no particular order, and around
+    // the level boundaries.
+    static const int intervals[] = {
+        16777217, 0, 300000, 4097, 1073741825, 65, 262143, 20000000, 1, 2000000000,
+        64, 1073741823, 4096, 500000000, 262145, 63, 16777215, 5000, INT_MAX,
+        262144, 1500000000, 4095, 16777216, 1073741824, 300000, 65, 1073741825
+    };
+
+    simulatedTime = 123456 * qint64(1000000000) + 789123456;
+    qt_timerinfo_clock = simulatedClock;
+    const auto resetClock = qScopeGuard([] { qt_timerinfo_clock = nullptr; });
+
+    QTimerInfoList list;
+    WheelTimersObject object(&list);
+    for (int interval : intervals)
+        object.start(interval);
+
+    // A second set, started once the wheel has moved on, lands in different
+    // slots relative to the ones it cascades from
+    const qint64 secondStart = simulatedTime + 300001 * qint64(1000000);
+    bool secondStarted = false;
+
+    timespec wait;
+    while (list.timerWait(wait)) {
+        if (step)
+            simulatedTime += step * 1000000;
+        else
+            simulatedTime += wait.tv_sec * qint64(1000000000) + wait.tv_nsec;
+        list.activateTimers();
+        if (!secondStarted && simulatedTime >= secondStart) {
+            for (int interval : intervals)
+                object.start(interval);
+            secondStarted = true;
+        }
+    }
+    QVERIFY(secondStarted);
+    QCOMPARE(object.firingOrder.size(), object.timers.size());
+
+    QVector<int> expectedOrder(object.timers.size());
+    std::iota(expectedOrder.begin(), expectedOrder.end(), 0);
+    std::stable_sort(expectedOrder.begin(), expectedOrder.end(), [&object](int a, int b) {
+        return object.timers.at(a).deadline < object.timers.at(b).deadline;
+    });
+    QCOMPARE(object.firingOrder, expectedOrder);
+
+    const qint64 latest = qMax(step, qint64(1)) * 1000000;
+    for (const WheelTimersObject::Timer &timer : qAsConst(object.timers)) {
+        QVERIFY2(timer.fired >= timer.deadline,
+                 qPrintable(QString::fromLatin1("Timer %1 fired early").arg(timer.id)));
+        QVERIFY2(timer.fired - timer.deadline <= latest,
+                 qPrintable(QString::fromLatin1("Timer %1 fired late").arg(timer.id)));
+    }
+#else
+    QSKIP("Needs a developer build of Qt on Unix");
+#endif
+}
+
 class TimeoutCounter : public QObject
 {
     Q_OBJECT
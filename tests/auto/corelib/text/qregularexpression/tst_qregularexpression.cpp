@@ -37,6 +37,13 @@
 #include <qregularexpression.h>
 #include <qthread.h>
 
+#ifdef QT_BUILD_INTERNAL
+QT_BEGIN_NAMESPACE
+extern Q_AUTOTEST_EXPORT void qt_qregularexpression_cacheStatistics(quint64 *hits, quint64 *misses, int *size);
+extern Q_AUTOTEST_EXPORT void qt_qregularexpression_clearCache();
+QT_END_NAMESPACE
+#endif
+
 Q_DECLARE_METATYPE(QRegularExpression::PatternOptions)
 Q_DECLARE_METATYPE(QRegularExpression::MatchType)
 Q_DECLARE_METATYPE(QRegularExpression::MatchOptions)
@@ -78,6 +85,9 @@ private slots:
     void QStringAndQStringRefEquivalence();
     void threadSafety_data();
     void threadSafety();
+#ifdef QT_BUILD_INTERNAL
+    void compiledPatternCache();
+#endif
 
     void wildcard_data();
     void wildcard();
@@ -2157,6 +2167,120 @@ void tst_QRegularExpression::threadSafety()
     }
 }
 
+#ifdef QT_BUILD_INTERNAL
+class CompilerThread : public QThread
+{
+public:
+    explicit CompilerThread(const QString &pattern, QObject *parent = nullptr)
+        : QThread(parent),
+          m_pattern(pattern),
+          m_matches(0)
+    {
+    }
+
+    int matches() const { return m_matches; }
+
+private:
+    static const int COMPILE_ITERATIONS = 50;
+
+    void run() override
+    {
+        yieldCurrentThread();
+        for (int i = 0; i < COMPILE_ITERATIONS; ++i) {
+            const QRegularExpression re(m_pattern);
+            if (re.match(QStringLiteral("foo 1234 bar")).captured(1) == QLatin1String("1234"))
+                ++m_matches;
+        }
+    }
+
+    const QString m_pattern;
+    int m_matches;
+};
+
+void tst_QRegularExpression::compiledPatternCache()
+{
+    quint64 hits, misses;
+    int size;
+    qt_qregularexpression_clearCache();
+
+    {
+        // identical patterns are compiled only once
+        const QRegularExpression re1(QStringLiteral("(\\d+)\\s*(?<unit>[a-z]+)"));
+        QVERIFY(re1.isValid());
+        const QRegularExpression re2(QStringLiteral("(\\d+)\\s*(?<unit>[a-z]+)"));
+        QVERIFY(re2.isValid());
+        qt_qregularexpression_cacheStatistics(&hits, &misses, &size);
+        QCOMPARE(hits, quint64(1));
+        QCOMPARE(misses, quint64(1));
+        QCOMPARE(size, 1);
+
+        const QRegularExpressionMatch match = re2.match(QStringLiteral("take 42 km"));
+        QVERIFY(match.hasMatch());
+        QCOMPARE(match.captured(1), QStringLiteral("42"));
+        QCOMPARE(match.captured(QStringLiteral("unit")), QStringLiteral("km"));
+        QCOMPARE(re2.captureCount(), 2);
+        QCOMPARE(re2.namedCaptureGroups(), QStringList() << QString() << QString() << QStringLiteral("unit"));
+
+        // a different set of options is a different compiled pattern
+        const QRegularExpression re3(re1.pattern(), QRegularExpression::CaseInsensitiveOption);
+        QVERIFY(re3.isValid());
+        QVERIFY(re3.match(QStringLiteral("take 42 KM")).hasMatch());
+        QVERIFY(!re2.match(QStringLiteral("take 42 KM")).hasMatch());
+        qt_qregularexpression_cacheStatistics(&hits, &misses, &size);
+        QCOMPARE(hits, quint64(1));
+        QCOMPARE(misses, quint64(2));
+        QCOMPARE(size, 2);
+
+        // the compiled patterns outlive the cache entries
+        qt_qregularexpression_clearCache();
+        QVERIFY(re1.match(QStringLiteral("take 42 km")).hasMatch());
+        QVERIFY(re3.match(QStringLiteral("take 42 KM")).hasMatch());
+    }
+
+    {
+        // failures are cached together with their error
+        const QRegularExpression re1(QStringLiteral("a(b"));
+        QVERIFY(!re1.isValid());
+        const QRegularExpression re2(QStringLiteral("a(b"));
+        QVERIFY(!re2.isValid());
+        QCOMPARE(re2.errorString(), re1.errorString());
+        QCOMPARE(re2.patternErrorOffset(), re1.patternErrorOffset());
+        QVERIFY(re2.patternErrorOffset() >= 0);
+        qt_qregularexpression_cacheStatistics(&hits, &misses, &size);
+        QCOMPARE(hits, quint64(1));
+        QCOMPARE(misses, quint64(1));
+    }
+
+    {
+        // concurrent lookups of the same pattern
+        qt_qregularexpression_clearCache();
+        const QString pattern = QStringLiteral("\\b(\\d{4})\\b");
+        const int threadCount = qMax(QThread::idealThreadCount(), 4);
+
+        QVector<CompilerThread *> threads;
+        for (int i = 0; i < threadCount; ++i) {
+            CompilerThread *thread = new CompilerThread(pattern);
+            thread->start();
+            threads.push_back(thread);
+        }
+
+        int matches = 0;
+        for (int i = 0; i < threadCount; ++i) {
+            threads[i]->wait();
+            matches += threads[i]->matches();
+        }
+        qDeleteAll(threads);
+
+        QCOMPARE(matches, threadCount * 50);
+        qt_qregularexpression_cacheStatistics(&hits, &misses, &size);
+        QCOMPARE(hits + misses, quint64(threadCount * 50));
+        QVERIFY(misses >= 1u);
+        QVERIFY(misses <= quint64(threadCount));
+        QCOMPARE(size, 1);
+    }
+}
+#endif // QT_BUILD_INTERNAL
+
 void tst_QRegularExpression::wildcard_data()
 {
     QTest::addColumn<QString>("pattern");
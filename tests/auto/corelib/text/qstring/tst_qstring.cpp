@@ -463,6 +463,10 @@ private slots:
     void isLower_isUpper_data();
     void isLower_isUpper();
     void toCaseFolded();
+    void caseConversionInBlocks_data();
+    void caseConversionInBlocks();
+    void compareCaseInsensitiveInBlocks_data();
+    void compareCaseInsensitiveInBlocks();
     void rightJustified();
     void leftJustified();
     void mid();
@@ -2155,6 +2159,108 @@ void tst_QString::leftJustified()
     QCOMPARE(a.leftJustified(0,' ',true), QLatin1String(""));
 }
 
+// The vectorized code handles blocks of 8 characters. Put one character
+// that needs the Unicode tables, or one that changes case, at every position
+// of strings that end in the middle of a block or right after one.
+static void addCaseBlockRows()
+{
+    QTest::addColumn<QString>("string");
+    QTest::addColumn<int>("position");
+
+    static const struct {
+        const char *name;
+        ushort ch;
+    } specials[] = {
+        { "upper", 'Q' },
+        { "lower", 'q' },
+        { "latin1", 0x00E9 },   // e with acute, changes case
+        { "nonascii", 0x20AC }, // Euro sign, no case
+        { "kelvin", 0x212A },   // Kelvin sign, lower case is US-ASCII k
+    };
+    static const char filler[] = "aB3zY@[`{-";
+    for (int length : { 7, 8, 9, 16, 17 }) {
+        for (int position = 0; position < length; ++position) {
+            for (const auto &special : specials) {
+                QString string;
+                for (int i = 0; i < length; ++i)
+                    string += QLatin1Char(filler[i % (sizeof(filler) - 1)]);
+                string[position] = QChar(special.ch);
+                QTest::addRow("%s-%d-of-%d", special.name, position, length) << string << position;
+            }
+        }
+    }
+}
+
+void tst_QString::caseConversionInBlocks_data()
+{
+    addCaseBlockRows();
+}
+
+void tst_QString::caseConversionInBlocks()
+{
+    QFETCH(QString, string);
+
+    // none of the characters changes length, so the QChar functions apply
+    QString lower, upper, folded;
+    for (QChar c : qAsConst(string)) {
+        lower += c.toLower();
+        upper += c.toUpper();
+        folded += c.toCaseFolded();
+    }
+    QCOMPARE(string.toLower(), lower);
+    QCOMPARE(string.toUpper(), upper);
+    QCOMPARE(string.toCaseFolded(), folded);
+
+    // converted in place when not shared
+    QString copy = string;
+    copy.detach();
+    QCOMPARE(std::move(copy).toLower(), lower);
+    copy = string;
+    copy.detach();
+    QCOMPARE(std::move(copy).toUpper(), upper);
+    copy = string;
+    copy.detach();
+    QCOMPARE(std::move(copy).toCaseFolded(), folded);
+}
+
+void tst_QString::compareCaseInsensitiveInBlocks_data()
+{
+    addCaseBlockRows();
+}
+
+void tst_QString::compareCaseInsensitiveInBlocks()
+{
+    QFETCH(QString, string);
+    QFETCH(int, position);
+
+    QString folded;
+    for (QChar c : qAsConst(string))
+        folded += c.toCaseFolded();
+    const QString upper = string.toUpper();
+
+    QCOMPARE(QString::compare(string, upper, Qt::CaseInsensitive), 0);
+    QCOMPARE(QString::compare(upper, string, Qt::CaseInsensitive), 0);
+
+    // a difference at the special character's position is found
+    QString other = upper;
+    other[position] = folded.at(position) == QLatin1Char('x') ? QLatin1Char('y') : QLatin1Char('x');
+    QString otherFolded = folded;
+    otherFolded[position] = other.at(position);
+    const int expected = QString::compare(folded, otherFolded) < 0 ? -1 : 1;
+    QCOMPARE(qBound(-1, QString::compare(string, other, Qt::CaseInsensitive), 1), expected);
+    QCOMPARE(qBound(-1, QString::compare(other, string, Qt::CaseInsensitive), 1), -expected);
+
+    // and against Latin-1
+    const QByteArray latin1 = other.toLatin1();
+    if (QString::fromLatin1(latin1) == other) {
+        QCOMPARE(qBound(-1, QString::compare(string, QLatin1String(latin1), Qt::CaseInsensitive), 1),
+                 expected);
+    }
+    const QByteArray upperLatin1 = upper.toLatin1();
+    if (QString::fromLatin1(upperLatin1) == upper)
+        QCOMPARE(QString::compare(string, QLatin1String(upperLatin1), Qt::CaseInsensitive), 0);
+}
+
 void tst_QString::rightJustified()
 {
     QString a;
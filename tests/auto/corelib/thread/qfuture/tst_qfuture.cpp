@@ -94,6 +94,14 @@ private slots:
     void nestedExceptions();
 #endif
     void nonGlobalThreadPool();
+#ifdef QFUTURE_HAS_CONTINUATIONS
+    void continuations();
+    void continuationsInThreadPool();
+    void continuationCancellation();
+#ifndef QT_NO_EXCEPTIONS
+    void continuationFailures();
+#endif
+#endif
 };
 
 void tst_QFuture::resultStore()
@@ -1557,5 +1565,227 @@ void tst_QFuture::nonGlobalThreadPool()
     }
 }
 
+#ifdef QFUTURE_HAS_CONTINUATIONS
+void tst_QFuture::continuations()
+{
+    // continuation attached before the future finishes
+    {
+        QFutureInterface<int> promise;
+        promise.reportStarted();
+        QFuture<QString> future = promise.future()
+                .then([](int value) { return value * 2; })
+                .then([](int value) { return QString::number(value); });
+        QVERIFY(!future.isFinished());
+
+        const int value = 21;
+        promise.reportFinished(&value);
+        QVERIFY(future.isFinished());
+        QCOMPARE(future.result(), QStringLiteral("42"));
+    }
+
+    // continuation attached after the future finished runs right away
+    {
+        QFutureInterface<int> promise;
+        promise.reportStarted();
+        promise.reportResult(1);
+        promise.reportFinished();
+        int seen = 0;
+        QFuture<void> future = promise.future().then([&](int value) { seen = value; });
+        QVERIFY(future.isFinished());
+        QCOMPARE(seen, 1);
+    }
+
+    // void futures, and continuations taking the future itself
+    {
+        QFutureInterface<void> promise;
+        promise.reportStarted();
+        bool ran = false;
+        QFuture<int> future = promise.future()
+                .then([&] { ran = true; })
+                .then([](QFuture<void> parent) { return parent.isFinished() ? 1 : 0; });
+        promise.reportFinished();
+        QVERIFY(ran);
+        QCOMPARE(future.result(), 1);
+    }
+
+    // several continuations of the same future all run, in order
+    {
+        QFutureInterface<int> promise;
+        promise.reportStarted();
+        QVector<int> seen;
+        QFuture<void> first = promise.future().then([&](int value) { seen.append(value); });
+        QFuture<void> second = promise.future().then([&](int value) { seen.append(value + 1); });
+        const int value = 1;
+        promise.reportFinished(&value);
+        QVERIFY(first.isFinished());
+        QVERIFY(second.isFinished());
+        QCOMPARE(seen, QVector<int>({ 1, 2 }));
+    }
+
+    // the continuation runs on the thread finishing the future
+    {
+        QFutureInterface<int> promise;
+        promise.reportStarted();
+        QThread *continuationThread = nullptr;
+        QFuture<void> future = promise.future().then([&](int) {
+            continuationThread = QThread::currentThread();
+        });
+        QScopedPointer<QThread> thread(QThread::create([&] {
+            const int value = 0;
+            promise.reportFinished(&value);
+        }));
+        thread->start();
+        QVERIFY(thread->wait());
+        future.waitForFinished();
+        QCOMPARE(continuationThread, thread.data());
+    }
+}
+
+void tst_QFuture::continuationsInThreadPool()
+{
+    QThreadPool pool;
+    QFutureInterface<int> promise;
+    promise.reportStarted();
+
+    QThread *continuationThread = nullptr;
+    QFuture<int> future = promise.future().then(&pool, [&](int value) {
+        continuationThread = QThread::currentThread();
+        return value + 1;
+    });
+    const int value = 1;
+    promise.reportFinished(&value);
+    QCOMPARE(future.result(), 2);
+    QVERIFY(pool.contains(continuationThread));
+
+    QFuture<int> async = future.then(QtFuture::Launch::Async, [](int value) { return value + 1; });
+    QCOMPARE(async.result(), 3);
+}
+
+void tst_QFuture::continuationCancellation()
+{
+    // cancellation passes down the chain, skipping the continuations
+    {
+        QFutureInterface<int> promise;
+        promise.reportStarted();
+        bool ran = false;
+        QFuture<int> future = promise.future()
+                .then([&](int value) { ran = true; return value; })
+                .then([&](int value) { ran = true; return value; });
+        promise.reportCanceled();
+        promise.reportFinished();
+        QVERIFY(!ran);
+        QVERIFY(future.isFinished());
+        QVERIFY(future.isCanceled());
+    }
+
+    // onCanceled() handles it
+    {
+        QFutureInterface<int> promise;
+        promise.reportStarted();
+        QFuture<int> future = promise.future()
+                .then([](int value) { return value; })
+                .onCanceled([] { return -1; });
+        promise.reportCanceled();
+        promise.reportFinished();
+        QVERIFY(!future.isCanceled());
+        QCOMPARE(future.result(), -1);
+    }
+
+    // onCanceled() passes results through
+    {
+        QFutureInterface<int> promise;
+        promise.reportStarted();
+        QFuture<int> future = promise.future().onCanceled([] { return -1; });
+        const int value = 1;
+        promise.reportFinished(&value);
+        QCOMPARE(future.result(), 1);
+    }
+
+    // canceling the continuation's future before the parent finishes
+    {
+        QFutureInterface<int> promise;
+        promise.reportStarted();
+        bool ran = false;
+        QFuture<void> future = promise.future().then([&](int) { ran = true; });
+        future.cancel();
+        const int value = 1;
+        promise.reportFinished(&value);
+        QVERIFY(!ran);
+        QVERIFY(future.isFinished());
+    }
+}
+
+#ifndef QT_NO_EXCEPTIONS
+void tst_QFuture::continuationFailures()
+{
+    // an exception in a continuation skips the ones after it
+    {
+        QFutureInterface<int> promise;
+        promise.reportStarted();
+        bool ran = false;
+        QFuture<int> future = promise.future()
+                .then([](int) -> int { throw DerivedException(); })
+                .then([&](int value) { ran = true; return value; });
+        const int value = 1;
+        promise.reportFinished(&value);
+        QVERIFY(!ran);
+        QVERIFY(future.isCanceled());
+        QVERIFY_EXCEPTION_THROWN(future.waitForFinished(), DerivedException);
+    }
+
+    // onFailed() handles the exception of the right type
+    {
+        QFutureInterface<int> promise;
+        promise.reportStarted();
+        QFuture<int> future = promise.future()
+                .then([](int) -> int { throw DerivedException(); })
+                .onFailed([](const DerivedException &) { return -1; });
+        const int value = 1;
+        promise.reportFinished(&value);
+        QCOMPARE(future.result(), -1);
+    }
+
+    // other exception types pass through
+    {
+        QFutureInterface<int> promise;
+        promise.reportStarted();
+        bool ran = false;
+        QFuture<int> future = promise.future()
+                .then([](int) -> int { throw std::runtime_error("failure"); })
+                .onFailed([&](const DerivedException &) { ran = true; return -1; })
+                .onFailed([](const QUnhandledException &) { return -2; });
+        const int value = 1;
+        promise.reportFinished(&value);
+        QVERIFY(!ran);
+        QCOMPARE(future.result(), -2);
+    }
+
+    // exceptions reported by the parent, handled by a handler without argument
+    {
+        QFutureInterface<void> promise;
+        promise.reportStarted();
+        bool handled = false;
+        QFuture<void> future = promise.future().onFailed([&] { handled = true; });
+        promise.reportException(QException());
+        promise.reportFinished();
+        QVERIFY(handled);
+        QVERIFY(!future.isCanceled());
+    }
+
+    // continuations taking the future see the failure
+    {
+        QFutureInterface<int> promise;
+        promise.reportStarted();
+        QFuture<bool> future = promise.future().then([](QFuture<int> parent) {
+            return parent.isCanceled();
+        });
+        promise.reportException(QException());
+        promise.reportFinished();
+        QCOMPARE(future.result(), true);
+    }
+}
+#endif // QT_NO_EXCEPTIONS
+#endif // QFUTURE_HAS_CONTINUATIONS
+
 QTEST_MAIN(tst_QFuture)
 #include "tst_qfuture.moc"
@@ -40,6 +40,12 @@
 #ifdef Q_OS_UNIX
 #include <pthread.h>
 #endif
+#if defined(Q_OS_LINUX) && !defined(Q_OS_ANDROID)
+#include <sched.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
 #if defined(Q_OS_WIN)
 #include <windows.h>
 #if defined(Q_OS_WIN32)
@@ -64,6 +70,7 @@ private slots:
     void isRunning();
     void setPriority();
     void setStackSize();
+    void schedulingPolicy();
     void exit();
     void start();
     void terminate();
@@ -408,6 +415,81 @@ void tst_QThread::setStackSize()
     QCOMPARE(thread.stackSize(), 0u);
 }
 
+#if defined(Q_OS_LINUX) && !defined(Q_OS_ANDROID)
+static QVector<int> threadCpus(pthread_t thread)
+{
+    QVector<int> cpus;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (pthread_getaffinity_np(thread, sizeof(set), &set) == 0) {
+        for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+            if (CPU_ISSET(cpu, &set))
+                cpus.append(cpu);
+        }
+    }
+    return cpus;
+}
+
+class SchedulingPolicy_Thread : public QThread
+{
+public:
+    QSemaphore ready;
+    QSemaphore resume;
+    QVector<int> seenCpus;
+    QVector<int> seenCpusAfterChange;
+    int seenPolicy = -1;
+    int seenNiceValue = 0;
+
+    void run() override
+    {
+        seenCpus = threadCpus(pthread_self());
+        seenPolicy = sched_getscheduler(0);
+        seenNiceValue = getpriority(PRIO_PROCESS, id_t(syscall(SYS_gettid)));
+        ready.release();
+        resume.acquire();
+        seenCpusAfterChange = threadCpus(pthread_self());
+    }
+};
+#endif
+
+void tst_QThread::schedulingPolicy()
+{
+    Simple_Thread defaults;
+    QCOMPARE(defaults.schedulingPolicy(), QThread::InheritSchedulingPolicy);
+    QCOMPARE(defaults.niceValue(), 0);
+    QCOMPARE(defaults.cpuAffinity(), QVector<int>());
+    QCOMPARE(defaults.numaNode(), -1);
+
+#if !defined(Q_OS_LINUX) || defined(Q_OS_ANDROID)
+    QSKIP("Scheduling policies are only supported on Linux");
+#else
+    const QVector<int> available = threadCpus(pthread_self());
+    QVERIFY(!available.isEmpty());
+    // raising the nice value never needs privileges
+    const int niceValue = qMin(getpriority(PRIO_PROCESS, 0) + 1, 19);
+
+    SchedulingPolicy_Thread thread;
+    thread.setSchedulingPolicy(QThread::BatchSchedulingPolicy);
+    thread.setNiceValue(niceValue);
+    thread.setCpuAffinity({ available.last() });
+    QCOMPARE(thread.schedulingPolicy(), QThread::BatchSchedulingPolicy);
+    QCOMPARE(thread.niceValue(), niceValue);
+    QCOMPARE(thread.cpuAffinity(), QVector<int>{ available.last() });
+
+    thread.start();
+    QVERIFY(thread.ready.tryAcquire(1, five_minutes));
+    QCOMPARE(thread.seenCpus, QVector<int>{ available.last() });
+    QCOMPARE(thread.seenPolicy, int(SCHED_BATCH));
+    QCOMPARE(thread.seenNiceValue, niceValue);
+
+    // lifting the restriction applies right away to a running thread
+    thread.setCpuAffinity(QVector<int>());
+    thread.resume.release();
+    QVERIFY(thread.wait(five_minutes));
+    QCOMPARE(thread.seenCpusAfterChange, available);
+#endif
+}
+
 void tst_QThread::exit()
 {
     Exit_Thread thread;
@@ -31,10 +31,22 @@
 #include <qthreadpool.h>
 #include <qstring.h>
 #include <qmutex.h>
+#include <qscopeguard.h>
+
+#include <memory>
 
 #ifdef Q_OS_UNIX
 #include <unistd.h>
 #endif
+#if defined(Q_OS_LINUX) && !defined(Q_OS_ANDROID)
+#include <sched.h>
+#endif
+
+#ifdef QT_BUILD_INTERNAL
+QT_BEGIN_NAMESPACE
+extern Q_AUTOTEST_EXPORT int qt_threadpool_shard_count;
+QT_END_NAMESPACE
+#endif
 
 typedef void (*FunctionPointer)();
 
@@ -100,9 +112,14 @@ private slots:
     void waitForDoneTimeout();
     void destroyingWaitsForTasksToFinish();
     void stackSize();
+    void threadPolicies();
+    void threadPriorityAfterExpiry();
     void stressTest();
     void takeAllAndIncreaseMaxThreadCount();
     void waitForDoneAfterTake();
+    void shardStealing();
+    void tryTakeFromShard();
+    void priorityAcrossShards();
 
 private:
     QMutex m_functionTestMutex;
@@ -1195,6 +1212,80 @@ void tst_QThreadPool::stackSize()
     QCOMPARE(threadStackSize, targetStackSize);
 }
 
+void tst_QThreadPool::threadPolicies()
+{
+    QThreadPool threadPool;
+    QCOMPARE(threadPool.threadPriority(), QThread::InheritPriority);
+    QCOMPARE(threadPool.threadSchedulingPolicy(), QThread::InheritSchedulingPolicy);
+    QCOMPARE(threadPool.threadNiceValue(), 0);
+    QCOMPARE(threadPool.threadCpuAffinity(), QVector<int>());
+    QCOMPARE(threadPool.threadNumaNode(), -1);
+    QVERIFY(!threadPool.threadPinning());
+
+    threadPool.setThreadPriority(QThread::LowPriority);
+    threadPool.setThreadSchedulingPolicy(QThread::BatchSchedulingPolicy);
+    threadPool.setThreadPinning(true);
+
+    QThread::Priority priority = QThread::InheritPriority;
+    QThread::SchedulingPolicy policy = QThread::InheritSchedulingPolicy;
+    QVector<int> cpus;
+    int allowedCpuCount = 0;
+    threadPool.start([&]() {
+        priority = QThread::currentThread()->priority();
+        policy = QThread::currentThread()->schedulingPolicy();
+        cpus = QThread::currentThread()->cpuAffinity();
+#if defined(Q_OS_LINUX) && !defined(Q_OS_ANDROID)
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        if (sched_getaffinity(0, sizeof(set), &set) == 0)
+            allowedCpuCount = CPU_COUNT(&set);
+        if (sched_getscheduler(0) != SCHED_BATCH)
+            policy = QThread::InheritSchedulingPolicy;
+#endif
+    });
+    QVERIFY(threadPool.waitForDone(30000)); // 30s timeout
+    QCOMPARE(priority, QThread::LowPriority);
+    QCOMPARE(policy, QThread::BatchSchedulingPolicy);
+#if defined(Q_OS_LINUX) && !defined(Q_OS_ANDROID)
+    // the worker is pinned to exactly one CPU
+    QCOMPARE(cpus.size(), 1);
+    QCOMPARE(allowedCpuCount, 1);
+#else
+    Q_UNUSED(allowedCpuCount);
+#endif
+}
+
+void tst_QThreadPool::threadPriorityAfterExpiry()
+{
+    QThreadPool threadPool;
+    threadPool.setMaxThreadCount(1);
+    threadPool.setExpiryTimeout(100);
+    threadPool.setThreadPriority(QThread::LowPriority);
+
+    QSemaphore ran;
+    QThread *thread = nullptr;
+    QThread::Priority priority = QThread::InheritPriority;
+    const auto task = [&]() {
+        thread = QThread::currentThread();
+        priority = thread->priority();
+        ran.release();
+    };
+
+    threadPool.start(task);
+    QVERIFY(ran.tryAcquire(1, 10000));
+    QCOMPARE(priority, QThread::LowPriority);
+
+    // the expired thread is restarted for the next task
+    QThread *firstThread = thread;
+    QVERIFY(firstThread->wait(10000));
+    priority = QThread::InheritPriority;
+    threadPool.start(task);
+    QVERIFY(ran.tryAcquire(1, 10000));
+    QCOMPARE(thread, firstThread);
+    QCOMPARE(priority, QThread::LowPriority);
+    QVERIFY(threadPool.waitForDone(30000)); // 30s timeout
+}
+
 void tst_QThreadPool::stressTest()
 {
     class Task : public QRunnable
@@ -1359,5 +1450,134 @@ void tst_QThreadPool::waitForDoneAfterTake()
 
 }
 
+// Records the order in which tasks run
+class RecordingTask : public QRunnable
+{
+public:
+    RecordingTask(int id, QMutex &mutex, QVector<int> &order)
+        : id(id), mutex(mutex), order(order)
+    { setAutoDelete(false); }
+    void run() override
+    {
+        QMutexLocker locker(&mutex);
+        order.append(id);
+    }
+
+    const int id;
+    QMutex &mutex;
+    QVector<int> &order;
+};
+
+void tst_QThreadPool::shardStealing()
+{
+#ifdef QT_BUILD_INTERNAL
+    qt_threadpool_shard_count = 4;
+    const auto resetShardCount = qScopeGuard([] { qt_threadpool_shard_count = 0; });
+
+    QThreadPool threadPool;
+    threadPool.setMaxThreadCount(2);
+
+    // the first thread blocks until the second one has queued a task in its
+    // own shard, then has to take that task from the other shard
+    QSemaphore hold;
+    QSemaphore ran;
+    QThread *queuingThread = nullptr;
+    QThread *runningThread = nullptr;
+    bool stolen = false;
+    threadPool.start([&] { hold.acquire(); });
+    threadPool.start([&] {
+        queuingThread = QThread::currentThread();
+        threadPool.start([&] {
+            runningThread = QThread::currentThread();
+            ran.release();
+        });
+        hold.release();
+        stolen = ran.tryAcquire(1, 60000);
+    });
+    QVERIFY(threadPool.waitForDone(60000));
+    QVERIFY(stolen);
+    QVERIFY(runningThread != queuingThread);
+#else
+    QSKIP("This test requires a developer build");
+#endif
+}
+
+void tst_QThreadPool::tryTakeFromShard()
+{
+#ifdef QT_BUILD_INTERNAL
+    qt_threadpool_shard_count = 4;
+    const auto resetShardCount = qScopeGuard([] { qt_threadpool_shard_count = 0; });
+
+    QThreadPool threadPool;
+    threadPool.setMaxThreadCount(1);
+
+    QSemaphore hold;
+    const QSemaphoreReleaser holdReleaser(hold);
+    threadPool.start([&] { hold.acquire(); });
+
+    // tasks of the default priority are spread over all the shards
+    enum { TaskCount = 8 };
+    QMutex mutex;
+    QVector<int> order;
+    std::vector<std::unique_ptr<RecordingTask>> tasks;
+    for (int i = 0; i < TaskCount; ++i) {
+        tasks.emplace_back(new RecordingTask(i, mutex, order));
+        threadPool.start(tasks.back().get());
+    }
+    for (int i = 1; i < TaskCount; i += 2) {
+        QVERIFY(threadPool.tryTake(tasks[i].get()));
+        QVERIFY(!threadPool.tryTake(tasks[i].get()));
+    }
+
+    hold.release();
+    QVERIFY(threadPool.waitForDone(60000));
+    std::sort(order.begin(), order.end());
+    QCOMPARE(order, QVector<int>({ 0, 2, 4, 6 }));
+#else
+    QSKIP("This test requires a developer build");
+#endif
+}
+
+void tst_QThreadPool::priorityAcrossShards()
+{
+#ifdef QT_BUILD_INTERNAL
+    qt_threadpool_shard_count = 4;
+    const auto resetShardCount = qScopeGuard([] { qt_threadpool_shard_count = 0; });
+
+    QThreadPool threadPool;
+    threadPool.setMaxThreadCount(1);
+
+    QSemaphore hold;
+    const QSemaphoreReleaser holdReleaser(hold);
+    threadPool.start([&] { hold.acquire(); });
+
+    // ids 0-1 have a higher priority, 2-9 the default one, 10-11 a lower one
+    QMutex mutex;
+    QVector<int> order;
+    std::vector<std::unique_ptr<RecordingTask>> tasks;
+    for (int i = 0; i < 12; ++i)
+        tasks.emplace_back(new RecordingTask(i, mutex, order));
+    threadPool.start(tasks[10].get(), -1);
+    for (int i = 2; i < 6; ++i)
+        threadPool.start(tasks[i].get());
+    threadPool.start(tasks[0].get(), 1);
+    for (int i = 6; i < 10; ++i)
+        threadPool.start(tasks[i].get());
+    threadPool.start(tasks[11].get(), -1);
+    threadPool.start(tasks[1].get(), 1);
+
+    hold.release();
+    QVERIFY(threadPool.waitForDone(60000));
+    QCOMPARE(order.size(), 12);
+    QCOMPARE(order.mid(0, 2), QVector<int>({ 0, 1 }));
+    QCOMPARE(order.mid(10), QVector<int>({ 10, 11 }));
+    QVector<int> sharded = order.mid(2, 8);
+    std::sort(sharded.begin(), sharded.end());
+    QCOMPARE(sharded, QVector<int>({ 2, 3, 4, 5, 6, 7, 8, 9 }));
+#else
+    QSKIP("This test requires a developer build");
+#endif
+}
+
 QTEST_MAIN(tst_QThreadPool);
 #include "tst_qthreadpool.moc"
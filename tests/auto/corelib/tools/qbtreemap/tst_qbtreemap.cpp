@@ -0,0 +1,362 @@
+/****************************************************************************
+**
+** Copyright (C) 2020 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the test suite of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include <QtTest/QtTest>
+#include <qbtreemap.h>
+#include <qmap.h>
+#include <qstring.h>
+
+#include <map>
+#include <memory>
+
+class tst_QBTreeMap : public QObject
+{
+    Q_OBJECT
+private slots:
+    void insertAndLookup();
+    void iteration();
+    void bounds();
+    void remove();
+    void eraseWhileIterating();
+    void implicitSharing();
+    void fromSortedRange();
+    void stdMap();
+    void nonTrivialTypes();
+    void compareWithQMap();
+};
+
+void tst_QBTreeMap::insertAndLookup()
+{
+    QBTreeMap<int, int> map;
+    QVERIFY(map.isEmpty());
+    QVERIFY(!map.contains(1));
+    QCOMPARE(map.value(1), 0);
+    QCOMPARE(map.value(1, 42), 42);
+    QVERIFY(map.constFind(1) == map.constEnd());
+
+    // descending keys insert at the front of the leaves
+    for (int i = 9999; i >= 0; --i)
+        map.insert(i, i * 3);
+    QCOMPARE(map.size(), 10000);
+    for (int i = 0; i < 10000; ++i) {
+        QVERIFY(map.contains(i));
+        QCOMPARE(map.value(i), i * 3);
+        QCOMPARE(map.find(i).key(), i);
+    }
+    QVERIFY(!map.contains(10000));
+    QVERIFY(!map.contains(-1));
+    QCOMPARE(map.firstKey(), 0);
+    QCOMPARE(map.lastKey(), 9999);
+    QCOMPARE(map.first(), 0);
+    QCOMPARE(map.last(), 9999 * 3);
+
+    QBTreeMap<int, int>::iterator it = map.insert(5, 7);
+    QCOMPARE(it.key(), 5);
+    QCOMPARE(*it, 7);
+    QCOMPARE(map.size(), 10000);
+
+    QBTreeMap<QString, int> strings;
+    strings[QStringLiteral("b")] = 2;
+    ++strings[QStringLiteral("a")];
+    ++strings[QStringLiteral("a")];
+    QCOMPARE(strings.keys(), QList<QString>() << QStringLiteral("a") << QStringLiteral("b"));
+    QCOMPARE(strings.values(), QList<int>() << 2 << 2);
+    QCOMPARE(strings.key(2), QStringLiteral("a"));
+
+    QBTreeMap<int, QString> init { {3, QStringLiteral("c")}, {1, QStringLiteral("a")}, {3, QStringLiteral("d")} };
+    QCOMPARE(init.size(), 2);
+    QCOMPARE(init.value(3), QStringLiteral("d"));
+}
+
+void tst_QBTreeMap::iteration()
+{
+    QBTreeMap<int, int> map;
+    QVERIFY(map.constBegin() == map.constEnd());
+    QVERIFY(map.begin() == map.end());
+
+    QRandomGenerator generator(42);
+    QVector<int> keys;
+    for (int i = 0; i < 5000; ++i) {
+        const int key = int(generator.bounded(100000u));
+        map.insert(key, -key);
+        keys.append(key);
+    }
+    std::sort(keys.begin(), keys.end());
+    keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+    QCOMPARE(map.size(), keys.size());
+
+    int i = 0;
+    for (QBTreeMap<int, int>::const_iterator it = map.constBegin(); it != map.constEnd(); ++it, ++i) {
+        QCOMPARE(it.key(), keys.at(i));
+        QCOMPARE(it.value(), -keys.at(i));
+    }
+    QCOMPARE(i, keys.size());
+
+    QBTreeMap<int, int>::const_iterator it = map.constEnd();
+    for (i = keys.size() - 1; i >= 0; --i)
+        QCOMPARE((--it).key(), keys.at(i));
+    QVERIFY(it == map.constBegin());
+
+    for (QBTreeMap<int, int>::iterator mit = map.begin(); mit != map.end(); ++mit)
+        *mit = 1;
+    QCOMPARE(std::accumulate(map.cbegin(), map.cend(), 0), keys.size());
+}
+
+void tst_QBTreeMap::bounds()
+{
+    QBTreeMap<int, int> map;
+    QVERIFY(map.lowerBound(1) == map.end());
+    for (int i = 0; i < 3000; i += 3)
+        map.insert(i, i);
+
+    QCOMPARE(map.lowerBound(0).key(), 0);
+    QCOMPARE(map.lowerBound(1).key(), 3);
+    QCOMPARE(map.lowerBound(3).key(), 3);
+    QCOMPARE(map.upperBound(3).key(), 6);
+    QCOMPARE(map.upperBound(4).key(), 6);
+    QVERIFY(map.lowerBound(2998) == map.constEnd());
+    QVERIFY(map.upperBound(2997) == map.constEnd());
+    QCOMPARE(map.upperBound(-5).key(), 0);
+
+    // every key, including those at the edges of leaves
+    for (int i = -1; i < 3000; ++i) {
+        const int expected = (i + 2) / 3 * 3;
+        QBTreeMap<int, int>::const_iterator it = qAsConst(map).lowerBound(i);
+        if (expected >= 3000)
+            QVERIFY(it == map.constEnd());
+        else
+            QCOMPARE(it.key(), qMax(expected, 0));
+    }
+
+    // a range
+    int count = 0;
+    for (QBTreeMap<int, int>::const_iterator it = map.constFind(300); it != map.upperBound(600); ++it)
+        ++count;
+    QCOMPARE(count, 101);
+}
+
+void tst_QBTreeMap::remove()
+{
+    QBTreeMap<int, int> map;
+    for (int i = 0; i < 10000; ++i)
+        map.insert(i, i);
+    for (int i = 0; i < 10000; i += 2)
+        QCOMPARE(map.remove(i), 1);
+    QCOMPARE(map.remove(0), 0);
+    QCOMPARE(map.size(), 5000);
+    for (int i = 0; i < 10000; ++i)
+        QCOMPARE(map.contains(i), i % 2 == 1);
+    QCOMPARE(map.keys().first(), 1);
+
+    QCOMPARE(map.take(1), 1);
+    QCOMPARE(map.take(1), 0);
+    QCOMPARE(map.size(), 4999);
+
+    // remove everything, from both ends towards the middle
+    for (int i = 0; i < 5000; ++i) {
+        map.remove(2 * i + 1);
+        map.remove(9999 - 2 * i);
+    }
+    QVERIFY(map.isEmpty());
+    QVERIFY(map.constBegin() == map.constEnd());
+    map.insert(1, 1);
+    QCOMPARE(map.size(), 1);
+
+    map.clear();
+    QVERIFY(map.isEmpty());
+}
+
+void tst_QBTreeMap::eraseWhileIterating()
+{
+    QBTreeMap<int, int> map;
+    for (int i = 0; i < 2000; ++i)
+        map.insert(i, i);
+
+    int visited = 0;
+    QBTreeMap<int, int>::iterator it = map.begin();
+    while (it != map.end()) {
+        QCOMPARE(it.key(), visited);
+        ++visited;
+        if (it.key() % 3 != 1)
+            it = map.erase(it);
+        else
+            ++it;
+    }
+    QCOMPARE(visited, 2000);
+    QCOMPARE(map.size(), 667);
+    int expected = 1;
+    for (QBTreeMap<int, int>::const_iterator cit = map.cbegin(); cit != map.cend(); ++cit, expected += 3)
+        QCOMPARE(cit.key(), expected);
+}
+
+void tst_QBTreeMap::implicitSharing()
+{
+    QBTreeMap<int, QString> map;
+    for (int i = 0; i < 1000; ++i)
+        map.insert(i, QString::number(i));
+
+    QBTreeMap<int, QString> copy = map;
+    QVERIFY(copy.isSharedWith(map));
+    QVERIFY(!map.isDetached());
+    QVERIFY(copy == map);
+
+    copy.insert(1000, QStringLiteral("new"));
+    QVERIFY(!copy.isSharedWith(map));
+    QVERIFY(copy.isDetached());
+    QCOMPARE(map.size(), 1000);
+    QCOMPARE(copy.size(), 1001);
+    QVERIFY(copy != map);
+
+    // the copy has its own, correctly linked, leaves
+    copy.remove(0);
+    QCOMPARE(map.firstKey(), 0);
+    QCOMPARE(copy.firstKey(), 1);
+    QCOMPARE(copy.lastKey(), 1000);
+    QCOMPARE(map.lastKey(), 999);
+    QCOMPARE(copy.keys().size(), 1000);
+
+    QBTreeMap<int, QString> other = map;
+    other[5] = QStringLiteral("changed");
+    QCOMPARE(map.value(5), QStringLiteral("5"));
+    QCOMPARE(other.value(5), QStringLiteral("changed"));
+
+    QBTreeMap<int, QString> taken = map;
+    QCOMPARE(taken.take(7), QStringLiteral("7"));
+    QCOMPARE(map.value(7), QStringLiteral("7"));
+
+    QBTreeMap<int, QString> moved(std::move(other));
+    QCOMPARE(moved.value(5), QStringLiteral("changed"));
+    swap(moved, copy);
+    QCOMPARE(copy.value(5), QStringLiteral("changed"));
+    QCOMPARE(moved.value(1000), QStringLiteral("new"));
+}
+
+void tst_QBTreeMap::fromSortedRange()
+{
+    for (int size : {0, 1, 47, 48, 49, 1000, 100000}) {
+        std::vector<std::pair<int, int> > items;
+        for (int i = 0; i < size; ++i)
+            items.push_back(std::make_pair(i * 2, i));
+        QBTreeMap<int, int> map = QBTreeMap<int, int>::fromSortedRange(items.begin(), items.end());
+        QCOMPARE(map.size(), size);
+        int i = 0;
+        for (QBTreeMap<int, int>::const_iterator it = map.constBegin(); it != map.constEnd(); ++it, ++i) {
+            QCOMPARE(it.key(), i * 2);
+            QCOMPARE(it.value(), i);
+        }
+        QCOMPARE(i, size);
+        for (i = 0; i < size; ++i) {
+            QCOMPARE(map.value(i * 2, -1), i);
+            QVERIFY(!map.contains(i * 2 + 1));
+        }
+
+        // the bulk-loaded tree can be modified like any other
+        for (i = 0; i < size; ++i)
+            map.insert(i * 2 + 1, -i);
+        QCOMPARE(map.size(), 2 * size);
+        for (i = 0; i < size; i += 2)
+            map.remove(i * 2);
+        QCOMPARE(map.size(), 2 * size - (size + 1) / 2);
+        int previous = -1;
+        for (QBTreeMap<int, int>::const_iterator it = map.constBegin(); it != map.constEnd(); ++it) {
+            QVERIFY(it.key() > previous);
+            previous = it.key();
+        }
+    }
+
+    // equal keys: the last one wins
+    std::vector<std::pair<int, int> > items { {1, 1}, {1, 2}, {2, 3} };
+    QBTreeMap<int, int> map = QBTreeMap<int, int>::fromSortedRange(items.begin(), items.end());
+    QCOMPARE(map.size(), 2);
+    QCOMPARE(map.value(1), 2);
+}
+
+void tst_QBTreeMap::stdMap()
+{
+    std::map<int, QString> stdMap;
+    for (int i = 0; i < 500; ++i)
+        stdMap[i * 7 % 500] = QString::number(i);
+    QBTreeMap<int, QString> map(stdMap);
+    QCOMPARE(map.size(), 500);
+    QVERIFY(map.toStdMap() == stdMap);
+}
+
+void tst_QBTreeMap::nonTrivialTypes()
+{
+    std::shared_ptr<int> tracker = std::make_shared<int>(0);
+    {
+        QBTreeMap<QString, std::shared_ptr<int> > map;
+        for (int i = 0; i < 1000; ++i)
+            map.insert(QString::number(i), tracker);
+        QCOMPARE(tracker.use_count(), 1001L);
+        for (int i = 0; i < 500; ++i)
+            map.remove(QString::number(i));
+        QCOMPARE(tracker.use_count(), 501L);
+        QBTreeMap<QString, std::shared_ptr<int> > copy = map;
+        QCOMPARE(tracker.use_count(), 501L);
+        copy.detach();
+        QCOMPARE(tracker.use_count(), 1001L);
+    }
+    QCOMPARE(tracker.use_count(), 1L);
+}
+
+void tst_QBTreeMap::compareWithQMap()
+{
+    // random operations, checked against QMap
+    QBTreeMap<int, int> map;
+    QMap<int, int> reference;
+    QRandomGenerator generator(1234);
+    for (int i = 0; i < 200000; ++i) {
+        const int key = int(generator.bounded(5000u));
+        switch (generator.bounded(5)) {
+        case 0:
+        case 1:
+            map.insert(key, i);
+            reference.insert(key, i);
+            break;
+        case 2:
+        case 3:
+            QCOMPARE(map.remove(key), reference.remove(key));
+            break;
+        case 4: {
+            QBTreeMap<int, int>::const_iterator it = qAsConst(map).lowerBound(key);
+            QMap<int, int>::const_iterator refIt = reference.lowerBound(key);
+            QCOMPARE(it == map.constEnd(), refIt == reference.constEnd());
+            if (refIt != reference.constEnd())
+                QCOMPARE(it.key(), refIt.key());
+            break;
+        }
+        }
+        QCOMPARE(map.size(), reference.size());
+    }
+    QCOMPARE(map.keys(), reference.keys());
+    QCOMPARE(map.values(), reference.values());
+}
+
+QTEST_APPLESS_MAIN(tst_QBTreeMap)
+#include "tst_qbtreemap.moc"
@@ -0,0 +1,352 @@
+/****************************************************************************
+**
+** Copyright (C) 2020 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the test suite of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include <QtTest/QtTest>
+#include <qflathash.h>
+#include <qhash.h>
+#include <qstring.h>
+
+#include <memory>
+
+class tst_QFlatHash : public QObject
+{
+    Q_OBJECT
+private slots:
+    void insertAndLookup();
+    void operatorBracket();
+    void remove();
+    void eraseWhileIterating();
+    void reuseDeletedSlots();
+    void copyAndMove();
+    void reserveAndSqueeze();
+    void nonTrivialTypes();
+    void compareWithQHash();
+    void collisions();
+    void stridedKeys_data();
+    void stridedKeys();
+};
+
+void tst_QFlatHash::insertAndLookup()
+{
+    QFlatHash<int, int> hash;
+    QVERIFY(hash.isEmpty());
+    QCOMPARE(hash.capacity(), 0);
+    QVERIFY(!hash.contains(1));
+    QCOMPARE(hash.value(1), 0);
+    QCOMPARE(hash.value(1, 42), 42);
+    QVERIFY(hash.find(1) == hash.end());
+
+    for (int i = 0; i < 10000; ++i)
+        hash.insert(i, i * 3);
+    QCOMPARE(hash.size(), 10000);
+    QVERIFY(hash.capacity() >= 10000);
+    for (int i = 0; i < 10000; ++i) {
+        QVERIFY(hash.contains(i));
+        QCOMPARE(hash.value(i), i * 3);
+        QCOMPARE(hash.find(i).key(), i);
+        QCOMPARE(*hash.constFind(i), i * 3);
+    }
+    QVERIFY(!hash.contains(10000));
+    QVERIFY(!hash.contains(-1));
+
+    // inserting an existing key replaces the value
+    QFlatHash<int, int>::iterator it = hash.insert(5, 7);
+    QCOMPARE(it.key(), 5);
+    QCOMPARE(it.value(), 7);
+    QCOMPARE(hash.size(), 10000);
+    QCOMPARE(hash.value(5), 7);
+
+    QFlatHash<int, int> init { {1, 2}, {3, 4}, {1, 5} };
+    QCOMPARE(init.size(), 2);
+    QCOMPARE(init.value(1), 5);
+    QCOMPARE(init.value(3), 4);
+}
+
+void tst_QFlatHash::operatorBracket()
+{
+    QFlatHash<QString, int> hash;
+    hash[QStringLiteral("one")] = 1;
+    ++hash[QStringLiteral("one")];
+    ++hash[QStringLiteral("two")];
+    QCOMPARE(hash.size(), 2);
+    QCOMPARE(hash.value(QStringLiteral("one")), 2);
+    QCOMPARE(hash.value(QStringLiteral("two")), 1);
+
+    const QFlatHash<QString, int> &constHash = hash;
+    QCOMPARE(constHash[QStringLiteral("three")], 0);
+    QCOMPARE(hash.size(), 2);
+
+    // the key and value may come from the hash itself while it grows
+    QFlatHash<int, int> ints;
+    ints.insert(0, 1);
+    for (int i = 1; i < 1000; ++i)
+        ints.insert(i, ints[i - 1] + 1);
+    for (int i = 0; i < 1000; ++i)
+        QCOMPARE(ints.value(i), i + 1);
+}
+
+void tst_QFlatHash::remove()
+{
+    QFlatHash<int, int> hash;
+    for (int i = 0; i < 1000; ++i)
+        hash.insert(i, i);
+    for (int i = 0; i < 1000; i += 2)
+        QCOMPARE(hash.remove(i), 1);
+    QCOMPARE(hash.remove(0), 0);
+    QCOMPARE(hash.size(), 500);
+    for (int i = 0; i < 1000; ++i)
+        QCOMPARE(hash.contains(i), i % 2 == 1);
+
+    QCOMPARE(hash.take(1), 1);
+    QCOMPARE(hash.take(1), 0);
+    QCOMPARE(hash.size(), 499);
+
+    hash.clear();
+    QVERIFY(hash.isEmpty());
+    QCOMPARE(hash.capacity(), 0);
+    QVERIFY(hash.begin() == hash.end());
+}
+
+void tst_QFlatHash::eraseWhileIterating()
+{
+    QFlatHash<int, int> hash;
+    for (int i = 0; i < 1000; ++i)
+        hash.insert(i, i);
+
+    int visited = 0;
+    QFlatHash<int, int>::iterator it = hash.begin();
+    while (it != hash.end()) {
+        ++visited;
+        if (it.key() % 3 == 0)
+            it = hash.erase(it);
+        else
+            ++it;
+    }
+    QCOMPARE(visited, 1000);
+    QCOMPARE(hash.size(), 666);
+
+    int sum = 0;
+    int count = 0;
+    for (QFlatHash<int, int>::const_iterator cit = hash.cbegin(); cit != hash.cend(); ++cit) {
+        QVERIFY(cit.key() % 3 != 0);
+        QCOMPARE(cit.key(), cit.value());
+        sum += cit.value();
+        ++count;
+    }
+    QCOMPARE(count, 666);
+    int expected = 0;
+    for (int i = 0; i < 1000; ++i) {
+        if (i % 3)
+            expected += i;
+    }
+    QCOMPARE(sum, expected);
+
+    QList<int> keys = hash.keys();
+    std::sort(keys.begin(), keys.end());
+    QCOMPARE(keys.size(), 666);
+    QCOMPARE(keys.first(), 1);
+    QCOMPARE(keys.last(), 998);
+    QCOMPARE(hash.values().size(), 666);
+}
+
+void tst_QFlatHash::reuseDeletedSlots()
+{
+    // Insert and remove many different keys with a constant number of
+    // items; the table may grow once, but not keep growing
+    QFlatHash<int, int> hash;
+    for (int i = 0; i < 100; ++i)
+        hash.insert(i, i);
+    const int capacity = hash.capacity();
+    for (int i = 100; i < 100000; ++i) {
+        hash.insert(i, i);
+        QCOMPARE(hash.remove(i - 100), 1);
+    }
+    QCOMPARE(hash.size(), 100);
+    QVERIFY(hash.capacity() <= 2 * capacity);
+    for (int i = 100000 - 100; i < 100000; ++i)
+        QCOMPARE(hash.value(i), i);
+}
+
+void tst_QFlatHash::copyAndMove()
+{
+    QFlatHash<int, QString> hash;
+    for (int i = 0; i < 500; ++i)
+        hash.insert(i, QString::number(i));
+    for (int i = 0; i < 500; i += 5)
+        hash.remove(i);
+
+    QFlatHash<int, QString> copy(hash);
+    QCOMPARE(copy.size(), hash.size());
+    QVERIFY(copy == hash);
+    for (int i = 0; i < 500; ++i)
+        QCOMPARE(copy.value(i), i % 5 ? QString::number(i) : QString());
+
+    copy.insert(1, QStringLiteral("changed"));
+    QVERIFY(copy != hash);
+    QCOMPARE(hash.value(1), QStringLiteral("1"));
+
+    QFlatHash<int, QString> assigned;
+    assigned.insert(-1, QStringLiteral("gone"));
+    assigned = hash;
+    QVERIFY(assigned == hash);
+    QVERIFY(!assigned.contains(-1));
+
+    QFlatHash<int, QString> moved(std::move(copy));
+    QVERIFY(copy.isEmpty());
+    QCOMPARE(moved.value(1), QStringLiteral("changed"));
+    copy = std::move(moved);
+    QCOMPARE(copy.value(2), QStringLiteral("2"));
+
+    swap(copy, assigned);
+    QCOMPARE(copy.value(1), QStringLiteral("1"));
+    QCOMPARE(assigned.value(1), QStringLiteral("changed"));
+}
+
+void tst_QFlatHash::reserveAndSqueeze()
+{
+    QFlatHash<int, int> hash;
+    hash.reserve(1000);
+    const int capacity = hash.capacity();
+    QVERIFY(capacity >= 1000);
+    for (int i = 0; i < 1000; ++i)
+        hash.insert(i, i);
+    QCOMPARE(hash.capacity(), capacity);
+
+    for (int i = 10; i < 1000; ++i)
+        hash.remove(i);
+    hash.squeeze();
+    QVERIFY(hash.capacity() < capacity);
+    QCOMPARE(hash.size(), 10);
+    for (int i = 0; i < 10; ++i)
+        QCOMPARE(hash.value(i), i);
+
+    hash.clear();
+    hash.squeeze();
+    QCOMPARE(hash.capacity(), 0);
+}
+
+void tst_QFlatHash::nonTrivialTypes()
+{
+    std::shared_ptr<int> tracker = std::make_shared<int>(0);
+    {
+        QFlatHash<QString, std::shared_ptr<int> > hash;
+        for (int i = 0; i < 1000; ++i)
+            hash.insert(QString::number(i), tracker);
+        QCOMPARE(tracker.use_count(), 1001L);
+        for (int i = 0; i < 500; ++i)
+            hash.remove(QString::number(i));
+        QCOMPARE(tracker.use_count(), 501L);
+        QFlatHash<QString, std::shared_ptr<int> > copy = hash;
+        QCOMPARE(tracker.use_count(), 1001L);
+    }
+    QCOMPARE(tracker.use_count(), 1L);
+}
+
+void tst_QFlatHash::compareWithQHash()
+{
+    // random operations, checked against QHash
+    QFlatHash<uint, uint> flat;
+    QHash<uint, uint> reference;
+    QRandomGenerator generator(1234);
+    for (int i = 0; i < 100000; ++i) {
+        const uint key = generator.bounded(5000u);
+        switch (generator.bounded(4)) {
+        case 0:
+        case 1:
+            flat.insert(key, uint(i));
+            reference.insert(key, uint(i));
+            break;
+        case 2:
+            QCOMPARE(flat.remove(key), reference.remove(key));
+            break;
+        case 3:
+            QCOMPARE(flat.value(key, 42), reference.value(key, 42));
+            break;
+        }
+        QCOMPARE(flat.size(), reference.size());
+    }
+    for (QHash<uint, uint>::const_iterator it = reference.cbegin(); it != reference.cend(); ++it)
+        QCOMPARE(flat.value(it.key()), it.value());
+}
+
+struct BadHashKey
+{
+    int value;
+    bool operator==(const BadHashKey &other) const { return value == other.value; }
+};
+
+uint qHash(const BadHashKey &, uint seed = 0)
+{
+    return seed;
+}
+
+void tst_QFlatHash::collisions()
+{
+    // all keys have the same hash value, so every lookup probes the whole table
+    QFlatHash<BadHashKey, int> hash;
+    for (int i = 0; i < 300; ++i)
+        hash.insert(BadHashKey{i}, i);
+    QCOMPARE(hash.size(), 300);
+    for (int i = 0; i < 300; ++i)
+        QCOMPARE(hash.value(BadHashKey{i}, -1), i);
+    QVERIFY(!hash.contains(BadHashKey{300}));
+    for (int i = 0; i < 300; i += 2)
+        QCOMPARE(hash.remove(BadHashKey{i}), 1);
+    for (int i = 0; i < 300; ++i)
+        QCOMPARE(hash.contains(BadHashKey{i}), i % 2 == 1);
+}
+
+void tst_QFlatHash::stridedKeys_data()
+{
+    QTest::addColumn<int>("stride");
+    QTest::newRow("16") << 16;
+    QTest::newRow("256") << 256;
+    QTest::newRow("4096") << 4096;
+    QTest::newRow("65536") << 65536;
+}
+
+void tst_QFlatHash::stridedKeys()
+{
+    // keys that only differ in their high bits, like aligned addresses
+    QFETCH(int, stride);
+    const int count = 20000;
+    QFlatHash<uint, int> hash;
+    for (int i = 0; i < count; ++i)
+        hash.insert(uint(i) * uint(stride), i);
+    QCOMPARE(hash.size(), count);
+    for (int i = 0; i < count; ++i)
+        QCOMPARE(hash.value(uint(i) * uint(stride), -1), i);
+    QVERIFY(!hash.contains(1));
+    for (int i = 0; i < count; i += 2)
+        QCOMPARE(hash.remove(uint(i) * uint(stride)), 1);
+    for (int i = 0; i < count; ++i)
+        QCOMPARE(hash.contains(uint(i) * uint(stride)), i % 2 == 1);
+}
+
+QTEST_APPLESS_MAIN(tst_QFlatHash)
+#include "tst_qflathash.moc"
@@ -6,12 +6,14 @@ SUBDIRS=\
     qarraydata \
     qarraydata_strictiterators \
     qbitarray \
+    qbtreemap \
     qcache \
     qcommandlineparser \
     qcontiguouscache \
     qcryptographichash \
     qeasingcurve \
     qexplicitlyshareddatapointer \
+    qflathash \
     qfreelist \
     qhash \
     qhash_strictiterators \
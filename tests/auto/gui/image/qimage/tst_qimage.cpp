@@ -222,6 +222,11 @@ private slots:
     void ditherGradient_data();
     void ditherGradient();
 
+    void ditherGrayscale8_data();
+    void ditherGrayscale8();
+    void ditherGrayscale8Solid_data();
+    void ditherGrayscale8Solid();
+
     void reinterpretAsFormat_data();
     void reinterpretAsFormat();
 
@@ -3641,6 +3646,112 @@ void tst_QImage::ditherGradient()
     QVERIFY(observedGradientSteps >= minimumExpectedGradient);
 }
 
+void tst_QImage::ditherGrayscale8_data()
+{
+    QTest::addColumn<int>("depth");
+    QTest::addColumn<int>("flags");
+    QTest::addColumn<int>("minimumExpectedGradient");
+
+    QTest::newRow("1 bit (threshold)") << 1 << int(Qt::ThresholdDither) << 2;
+    QTest::newRow("1 bit (ordered)") << 1 << int(Qt::OrderedDither) << 8;
+    QTest::newRow("1 bit (diffuse)") << 1 << int(Qt::DiffuseDither) << 12;
+    QTest::newRow("2 bit (threshold)") << 2 << int(Qt::ThresholdDither) << 4;
+    QTest::newRow("2 bit (ordered)") << 2 << int(Qt::OrderedDither) << 20;
+    QTest::newRow("4 bit (threshold)") << 4 << int(Qt::ThresholdDither) << 16;
+    QTest::newRow("4 bit (ordered)") << 4 << int(Qt::OrderedDither) << 64;
+    QTest::newRow("4 bit (diffuse)") << 4 << int(Qt::DiffuseDither) << 100;
+    QTest::newRow("8 bit") << 8 << int(Qt::OrderedDither) << 256;
+}
+
+void tst_QImage::ditherGrayscale8()
+{
+    QFETCH(int, depth);
+    QFETCH(int, flags);
+    QFETCH(int, minimumExpectedGradient);
+
+    QImage gray(256, 16, QImage::Format_Grayscale8);
+    for (int y = 0; y < gray.height(); ++y) {
+        for (int x = 0; x < gray.width(); ++x)
+            gray.scanLine(y)[x] = x;
+    }
+
+    const int bpl = gray.width() * depth / 8;
+    QByteArray packed(bpl * gray.height(), 0);
+    qt_dither_grayscale8(reinterpret_cast<uchar *>(packed.data()), bpl, gray.constBits(),
+                         gray.bytesPerLine(), 0, 0, gray.width(), gray.height(), depth,
+                         Qt::ImageConversionFlags(flags));
+
+    const int max = (1 << depth) - 1;
+    auto level = [&](int x, int y) {
+        const uchar byte = packed.at(y * bpl + x * depth / 8);
+        return (byte >> (8 - depth - (x * depth) % 8)) & max;
+    };
+    int observedGradientSteps = 0;
+    int lastTotal = -1;
+    for (int x = 0; x < gray.width(); ++x) {
+        int total = 0;
+        for (int y = 0; y < gray.height(); ++y)
+            total += level(x, y) * 255 / max;
+        if (total > lastTotal) {
+            observedGradientSteps++;
+            lastTotal = total;
+        }
+    }
+    QVERIFY(observedGradientSteps >= minimumExpectedGradient);
+
+    // The ordered pattern stays in place when converting only a part.
+    if (flags != int(Qt::DiffuseDither)) {
+        const int x = 48;
+        const int y = 5;
+        const int partBpl = 32 * depth / 8;
+        QByteArray part(partBpl * 7, 0);
+        qt_dither_grayscale8(reinterpret_cast<uchar *>(part.data()), partBpl,
+                             gray.constScanLine(y) + x, gray.bytesPerLine(), x, y, 32, 7, depth,
+                             Qt::ImageConversionFlags(flags));
+        for (int j = 0; j < 7; ++j)
+            QCOMPARE(part.mid(j * partBpl, partBpl), packed.mid((y + j) * bpl + x * depth / 8, partBpl));
+    }
+}
+
+void tst_QImage::ditherGrayscale8Solid_data()
+{
+    QTest::addColumn<int>("depth");
+    QTest::addColumn<int>("flags");
+    QTest::addColumn<int>("gray");
+
+    const int modes[] = { Qt::ThresholdDither, Qt::OrderedDither, Qt::DiffuseDither };
+    const char *modeNames[] = { "threshold", "ordered", "diffuse" };
+    for (int depth : { 1, 2, 4 }) {
+        for (int i = 0; i < 3; ++i) {
+            for (int gray : { 0, 255 }) {
+                QTest::addRow("%d bit (%s), %s", depth, modeNames[i], gray ? "white" : "black")
+                        << depth << modes[i] << gray;
+            }
+        }
+    }
+}
+
+void tst_QImage::ditherGrayscale8Solid()
+{
+    QFETCH(int, depth);
+    QFETCH(int, flags);
+    QFETCH(int, gray);
+
+    // Black and white are exact levels at every depth, and must not be
+    // speckled by the dither pattern. 40 pixels cover both the vectorized
+    // loops and the tail, and 16 lines the whole pattern.
+    QImage image(40, 16, QImage::Format_Grayscale8);
+    image.fill(QColor(gray, gray, gray));
+
+    const int bpl = image.width() * depth / 8;
+    QByteArray packed(bpl * image.height(), 0x5a);
+    qt_dither_grayscale8(reinterpret_cast<uchar *>(packed.data()), bpl, image.constBits(),
+                         image.bytesPerLine(), 0, 0, image.width(), image.height(), depth,
+                         Qt::ImageConversionFlags(flags));
+
+    QCOMPARE(packed, QByteArray(packed.size(), gray ? char(0xff) : char(0)));
+}
+
 void tst_QImage::reinterpretAsFormat_data()
 {
     QTest::addColumn<QImage::Format>("in_format");
@@ -28,6 +28,7 @@
 
 #include <qrasterwindow.h>
 #include <qpa/qwindowsysteminterface.h>
+#include <qpa/qwindowsysteminterface_p.h>
 #include <qpa/qplatformintegration.h>
 #include <qpa/qplatformwindow.h>
 #include <private/qguiapplication_p.h>
@@ -89,6 +90,8 @@ private slots:
     void windowModality();
     void inputReentrancy();
     void tabletEvents();
+    void tabletEventHistory();
+    void touchEventHistory();
     void windowModality_QTBUG27039();
     void visibility();
     void mask();
@@ -1772,6 +1775,123 @@ void tst_QWindow::tabletEvents()
 #endif
 }
 
+#if QT_CONFIG(tabletevent)
+class TabletHistoryWindow : public QWindow
+{
+public:
+    void tabletEvent(QTabletEvent *ev) override
+    {
+        types << ev->type();
+        for (const QTabletEvent::HistoricalSample &sample : ev->history())
+            positions << sample.pos;
+        positions << ev->posF();
+    }
+
+    QVector<QEvent::Type> types;
+    QVector<QPointF> positions;
+};
+#endif
+
+void tst_QWindow::tabletEventHistory()
+{
+#if QT_CONFIG(tabletevent)
+    const bool compressed = QCoreApplication::testAttribute(Qt::AA_CompressHighFrequencyEvents);
+    const bool compressedTablet = QCoreApplication::testAttribute(Qt::AA_CompressTabletEvents);
+    QCoreApplication::setAttribute(Qt::AA_CompressHighFrequencyEvents);
+    QCoreApplication::setAttribute(Qt::AA_CompressTabletEvents);
+    QWindowSystemInterfacePrivate::platformCoalescesInputEvents = true;
+
+    TabletHistoryWindow window;
+    window.setGeometry(QRect(m_availableTopLeft + QPoint(10, 10), m_testWindowSize));
+
+    // Queue a press and three moves before the Gui thread gets to them; the
+    // moves are coalesced into one event carrying the first two as history.
+    QVector<QPointF> expected;
+    for (int i = 0; i < 4; ++i) {
+        const QPoint local(10 + i, 10 + 2 * i);
+        const QPoint global = window.mapToGlobal(local);
+        QWindowSystemInterface::handleTabletEvent(&window, QHighDpi::toNativeLocalPosition(local, &window),
+                                                  QHighDpi::toNativePixels(global, window.screen()),
+                                                  1, 2, Qt::LeftButton, 0.5, 1, 2, 0.1, 0, 0, 42);
+        expected << local;
+    }
+    QCoreApplication::processEvents();
+
+    QWindowSystemInterfacePrivate::platformCoalescesInputEvents = false;
+    QCoreApplication::setAttribute(Qt::AA_CompressHighFrequencyEvents, compressed);
+    QCoreApplication::setAttribute(Qt::AA_CompressTabletEvents, compressedTablet);
+
+    QCOMPARE(window.types, QVector<QEvent::Type>({ QEvent::TabletPress, QEvent::TabletMove }));
+    QCOMPARE(window.positions.size(), expected.size());
+    for (int i = 0; i < expected.size(); ++i)
+        QCOMPARE(window.positions.at(i).toPoint(), expected.at(i).toPoint());
+
+    QWindowSystemInterface::handleTabletEvent(&window, QPointF(), QPointF(), 1, 2,
+                                              {}, 0, 1, 2, 0.1, 0, 0, 42);
+    QCoreApplication::processEvents();
+#endif
+}
+
+class TouchHistoryWindow : public QWindow
+{
+public:
+    void touchEvent(QTouchEvent *ev) override
+    {
+        ev->accept();
+        types << ev->type();
+        // The ids are remapped by QWindowSystemInterface, but the points keep
+        // the order in which the platform reported them.
+        const QTouchEvent::TouchPoint &point = ev->touchPoints().constFirst();
+        for (const QTouchEvent::TouchPoint &previous : point.history())
+            positions << previous.screenPos();
+        positions << point.screenPos();
+    }
+
+    QVector<QEvent::Type> types;
+    QVector<QPointF> positions;
+};
+
+void tst_QWindow::touchEventHistory()
+{
+    const bool compressed = QCoreApplication::testAttribute(Qt::AA_CompressHighFrequencyEvents);
+    QCoreApplication::setAttribute(Qt::AA_CompressHighFrequencyEvents);
+    QWindowSystemInterfacePrivate::platformCoalescesInputEvents = true;
+
+    TouchHistoryWindow window;
+    window.setTitle(QLatin1String(QTest::currentTestFunction()));
+    window.setGeometry(QRect(m_availableTopLeft + QPoint(80, 80), m_testWindowSize));
+    window.show();
+    QVERIFY(QTest::qWaitForWindowExposed(&window));
+
+    // Queue a press, four moves and a release of point 1 while point 2 is held
+    // still. The moves are coalesced into one update, carrying the first three
+    // as history; the press and the release are delivered on their own.
+    QVector<QPointF> expected;
+    QList<QWindowSystemInterface::TouchPoint> points;
+    QWindowSystemInterface::TouchPoint tp1, tp2;
+    tp1.id = 1;
+    tp2.id = 2;
+    tp2.area = QRectF(QHighDpi::toNativePixels(window.mapToGlobal(QPoint(50, 50)), window.screen()), QSizeF(2, 2));
+    for (int i = 0; i < 6; ++i) {
+        const QPoint global = window.mapToGlobal(QPoint(10 + 3 * i, 10 + i));
+        tp1.area = QRectF(QHighDpi::toNativePixels(QPointF(global), window.screen()) - QPointF(1, 1), QSizeF(2, 2));
+        tp1.state = i == 0 ? Qt::TouchPointPressed : i == 5 ? Qt::TouchPointReleased : Qt::TouchPointMoved;
+        tp2.state = i == 0 ? Qt::TouchPointPressed : i == 5 ? Qt::TouchPointReleased : Qt::TouchPointStationary;
+        points = { tp1, tp2 };
+        QWindowSystemInterface::handleTouchEvent(&window, touchDevice, points);
+        expected << global;
+    }
+    QCoreApplication::processEvents();
+
+    QWindowSystemInterfacePrivate::platformCoalescesInputEvents = false;
+    QCoreApplication::setAttribute(Qt::AA_CompressHighFrequencyEvents, compressed);
+
+    QCOMPARE(window.types, QVector<QEvent::Type>({ QEvent::TouchBegin, QEvent::TouchUpdate, QEvent::TouchEnd }));
+    QCOMPARE(window.positions.size(), expected.size());
+    for (int i = 0; i < expected.size(); ++i)
+        QCOMPARE(window.positions.at(i).toPoint(), expected.at(i).toPoint());
+}
+
 void tst_QWindow::windowModality_QTBUG27039()
 {
     QWindow parent;
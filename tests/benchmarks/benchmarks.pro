@@ -3,6 +3,7 @@ SUBDIRS = \
         corelib \
         sql \
 
+qtHaveModule(concurrent): SUBDIRS += concurrent
 qtHaveModule(dbus): SUBDIRS += dbus
 qtHaveModule(gui): SUBDIRS += gui
 qtHaveModule(network): SUBDIRS += network
@@ -0,0 +1,6 @@
+TEMPLATE = app
+CONFIG += benchmark
+QT = core testlib concurrent
+
+TARGET = tst_bench_qtconcurrentmap
+SOURCES += tst_qtconcurrentmap.cpp
@@ -0,0 +1,141 @@
+/****************************************************************************
+**
+** Copyright (C) 2020 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the test suite of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include <qtest.h>
+#include <QtConcurrent>
+
+Q_DECLARE_METATYPE(QtConcurrent::ReduceOptions)
+
+class tst_QtConcurrentMap : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void mappedReduced_data();
+    void mappedReduced();
+    void filteredReduced_data();
+    void filteredReduced();
+};
+
+static int lowByte(const int &value)
+{
+    return value & 0xff;
+}
+
+static bool isOdd(const int &value)
+{
+    return value & 1;
+}
+
+static void sum(int &result, const int &value)
+{
+    result += value;
+}
+
+static QVector<int> makeInput(int size)
+{
+    QVector<int> input;
+    input.reserve(size);
+    for (int i = 0; i < size; ++i)
+        input.append(i);
+    return input;
+}
+
+static void addOptionRows()
+{
+    QTest::addColumn<int>("size");
+    QTest::addColumn<QtConcurrent::ReduceOptions>("options");
+
+    const QtConcurrent::ReduceOptions defaultOptions(QtConcurrent::UnorderedReduce | QtConcurrent::SequentialReduce);
+    for (int size : {10000, 1000000}) {
+        const QByteArray suffix = "-" + QByteArray::number(size);
+        QTest::newRow(("adaptive" + suffix).constData()) << size << defaultOptions;
+        QTest::newRow(("ranges" + suffix).constData())
+                << size << (defaultOptions | QtConcurrent::RangePartitioning);
+        QTest::newRow(("parallel" + suffix).constData())
+                << size << QtConcurrent::ReduceOptions(QtConcurrent::ParallelReduce);
+        QTest::newRow(("parallel-ranges" + suffix).constData())
+                << size << (QtConcurrent::ParallelReduce | QtConcurrent::RangePartitioning);
+    }
+}
+
+void tst_QtConcurrentMap::mappedReduced_data()
+{
+    addOptionRows();
+}
+
+// A map function that costs almost nothing, so that the overhead of
+// handing out blocks and reducing their results dominates
+void tst_QtConcurrentMap::mappedReduced()
+{
+    QFETCH(int, size);
+    QFETCH(QtConcurrent::ReduceOptions, options);
+    const QVector<int> input = makeInput(size);
+
+    int result = 0;
+    QBENCHMARK {
+        result = QtConcurrent::blockingMappedReduced(input, lowByte, sum, options);
+    }
+
+    int expected = 0;
+    for (int value : input)
+        expected += lowByte(value);
+    QCOMPARE(result, expected);
+}
+
+void tst_QtConcurrentMap::filteredReduced_data()
+{
+    addOptionRows();
+}
+
+void tst_QtConcurrentMap::filteredReduced()
+{
+    QFETCH(int, size);
+    QFETCH(QtConcurrent::ReduceOptions, options);
+    const QVector<int> input = makeInput(size);
+    QVector<int> bytes;
+    bytes.reserve(size);
+    for (int value : input)
+        bytes.append(lowByte(value));
+
+    int result = 0;
+    QBENCHMARK {
+        result = QtConcurrent::blockingFilteredReduced(bytes, isOdd, sum, options);
+    }
+
+    int expected = 0;
+    for (int value : bytes) {
+        if (isOdd(value))
+            expected += value;
+    }
+    QCOMPARE(result, expected);
+}
+
+QTEST_MAIN(tst_QtConcurrentMap)
+
+#include "tst_qtconcurrentmap.moc"
@@ -83,6 +83,26 @@ int EventTester::foo(int bar)
     return bar + 1;
 }
 
+class EventCounter : public QObject
+{
+public:
+    void reset(int expected) { m_count = 0; m_expected = expected; }
+
+protected:
+    bool event(QEvent *e) override
+    {
+        if (e->type() != QEvent::MetaCall && e->type() != QEvent::User)
+            return QObject::event(e);
+        if (++m_count == m_expected)
+            QTestEventLoop::instance().exitLoop();
+        return true;
+    }
+
+private:
+    int m_count;
+    int m_expected;
+};
+
 class EventsBench : public QObject
 {
     Q_OBJECT
@@ -96,6 +116,8 @@ private slots:
     void sendEvent();
     void postEvent_data();
     void postEvent();
+    void postEventFromThreads_data();
+    void postEventFromThreads();
 };
 
 void EventsBench::initTestCase()
@@ -169,6 +191,43 @@ void EventsBench::postEvent()
     }
 }
 
+void EventsBench::postEventFromThreads_data()
+{
+    QTest::addColumn<int>("producers");
+    QTest::addColumn<QEvent::Type>("type");
+
+    // Queued calls go onto the receiving thread's lock-free queue, other
+    // events take the post event list mutex.
+    for (int producers : {1, 2, 4, 8}) {
+        QTest::addRow("%d producers, queued calls", producers) << producers << QEvent::MetaCall;
+        QTest::addRow("%d producers, user events", producers) << producers << QEvent::User;
+    }
+}
+
+void EventsBench::postEventFromThreads()
+{
+    QFETCH(int, producers);
+    QFETCH(QEvent::Type, type);
+    const int eventsPerProducer = 10000;
+
+    EventCounter receiver;
+    QBENCHMARK {
+        receiver.reset(producers * eventsPerProducer);
+        std::vector<std::unique_ptr<QThread>> threads;
+        for (int i = 0; i < producers; ++i) {
+            threads.emplace_back(QThread::create([&receiver, type, eventsPerProducer]() {
+                for (int j = 0; j < eventsPerProducer; ++j)
+                    QCoreApplication::postEvent(&receiver, new QEvent(type));
+            }));
+            threads.back()->start();
+        }
+        QTestEventLoop::instance().enterLoop(60);
+        QVERIFY(!QTestEventLoop::instance().timeout());
+        for (const auto &thread : threads)
+            thread->wait();
+    }
+}
+
 QTEST_MAIN(EventsBench)
 
 #include "main.moc"
@@ -6,8 +6,14 @@ SUBDIRS = \
         qobject \
         qvariant \
         qcoreapplication \
-        qtimer_vs_qmetaobject
+        qtimer_vs_qmetaobject \
+        qeventdispatcher \
+        qtimerinfolist
 
 !qtHaveModule(widgets): SUBDIRS -= \
     qmetaobject \
     qobject
+
+!unix: SUBDIRS -= \
+    qeventdispatcher \
+    qtimerinfolist
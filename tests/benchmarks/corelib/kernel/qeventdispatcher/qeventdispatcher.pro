@@ -0,0 +1,6 @@
+TEMPLATE = app
+CONFIG += benchmark
+QT = core testlib
+
+TARGET = tst_bench_qeventdispatcher
+SOURCES += tst_qeventdispatcher.cpp
@@ -0,0 +1,176 @@
+/****************************************************************************
+**
+** Copyright (C) 2020 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the test suite of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include <QtCore/QCoreApplication>
+#include <QtCore/QSocketNotifier>
+#include <QtTest/QtTest>
+
+#include <fcntl.h>
+#include <sys/resource.h>
+#include <unistd.h>
+
+// Measures the cost of waking up the event dispatcher for one active
+// socket notifier while many idle ones are registered. Run it once with
+// QT_EVENT_DISPATCHER_EPOLL=1 and once with QT_NO_GLIB=1 to compare the
+// epoll and poll backends of QEventDispatcherUNIX.
+
+class tst_QEventDispatcher : public QObject
+{
+    Q_OBJECT
+public:
+    ~tst_QEventDispatcher();
+
+private slots:
+    void initTestCase();
+    void wakeUp_data();
+    void wakeUp();
+    void toggleNotifier_data();
+    void toggleNotifier();
+
+private:
+    void registerIdleNotifiers(int count);
+    void cleanupIdleNotifiers();
+
+    QVector<QSocketNotifier *> idleNotifiers;
+    int idlePipe[2] = { -1, -1 };
+};
+
+tst_QEventDispatcher::~tst_QEventDispatcher()
+{
+    cleanupIdleNotifiers();
+}
+
+void tst_QEventDispatcher::initTestCase()
+{
+    // The largest row needs one descriptor per idle notifier.
+    rlimit limit;
+    if (::getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur < limit.rlim_max) {
+        limit.rlim_cur = limit.rlim_max;
+        ::setrlimit(RLIMIT_NOFILE, &limit);
+    }
+}
+
+void tst_QEventDispatcher::registerIdleNotifiers(int count)
+{
+    rlimit limit;
+    if (::getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur != RLIM_INFINITY
+            && limit.rlim_cur < rlim_t(count + 64))
+        QSKIP("Not enough file descriptors available");
+
+    QVERIFY(::pipe(idlePipe) == 0);
+    // Nothing is ever written to the pipe, so every duplicate of the read
+    // end stays idle for the lifetime of the test.
+    idleNotifiers.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        const int fd = ::fcntl(idlePipe[0], F_DUPFD_CLOEXEC, 0);
+        QVERIFY2(fd != -1, qPrintable(qt_error_string()));
+        idleNotifiers.append(new QSocketNotifier(fd, QSocketNotifier::Read));
+    }
+}
+
+void tst_QEventDispatcher::cleanupIdleNotifiers()
+{
+    for (QSocketNotifier *notifier : qAsConst(idleNotifiers)) {
+        const int fd = int(notifier->socket());
+        delete notifier;
+        ::close(fd);
+    }
+    idleNotifiers.clear();
+    for (int &fd : idlePipe) {
+        if (fd != -1)
+            ::close(fd);
+        fd = -1;
+    }
+}
+
+void tst_QEventDispatcher::wakeUp_data()
+{
+    QTest::addColumn<int>("idleCount");
+
+    QTest::newRow("10") << 10;
+    QTest::newRow("1000") << 1000;
+    QTest::newRow("10000") << 10000;
+}
+
+void tst_QEventDispatcher::wakeUp()
+{
+    QFETCH(int, idleCount);
+
+    registerIdleNotifiers(idleCount);
+
+    int activePipe[2];
+    QVERIFY(::pipe(activePipe) == 0);
+
+    bool activated = false;
+    QSocketNotifier active(activePipe[0], QSocketNotifier::Read);
+    connect(&active, &QSocketNotifier::activated, [&]() {
+        char c;
+        QCOMPARE(::read(activePipe[0], &c, 1), ssize_t(1));
+        activated = true;
+    });
+
+    QBENCHMARK {
+        activated = false;
+        QCOMPARE(::write(activePipe[1], "x", 1), ssize_t(1));
+        while (!activated)
+            QCoreApplication::processEvents(QEventLoop::WaitForMoreEvents);
+    }
+
+    active.setEnabled(false);
+    ::close(activePipe[0]);
+    ::close(activePipe[1]);
+    cleanupIdleNotifiers();
+}
+
+void tst_QEventDispatcher::toggleNotifier_data()
+{
+    wakeUp_data();
+}
+
+void tst_QEventDispatcher::toggleNotifier()
+{
+    QFETCH(int, idleCount);
+
+    registerIdleNotifiers(idleCount);
+    QVERIFY(!idleNotifiers.isEmpty());
+
+    // QAbstractSocket disables and re-enables its notifiers around every
+    // read and write, so registration changes must be cheap as well.
+    QSocketNotifier *notifier = idleNotifiers.last();
+    QBENCHMARK {
+        notifier->setEnabled(false);
+        notifier->setEnabled(true);
+        QCoreApplication::processEvents();
+    }
+
+    cleanupIdleNotifiers();
+}
+
+QTEST_MAIN(tst_QEventDispatcher)
+
+#include "tst_qeventdispatcher.moc"
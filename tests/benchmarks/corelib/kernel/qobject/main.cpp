@@ -31,6 +31,7 @@
 #include "object.h"
 #include <qcoreapplication.h>
 #include <qdatetime.h>
+#include <private/qobject_p.h>
 
 enum {
     CreationDeletionBenckmarkConstant = 34567,
@@ -45,6 +46,8 @@ private slots:
     void signal_slot_benchmark_data();
     void signal_many_receivers();
     void signal_many_receivers_data();
+    void queued_signal_benchmark();
+    void queued_signal_benchmark_data();
     void qproperty_benchmark_data();
     void qproperty_benchmark();
     void dynamic_property_benchmark();
@@ -151,6 +154,31 @@ void QObjectBenchmark::signal_many_receivers()
     }
 }
 
+void QObjectBenchmark::queued_signal_benchmark_data()
+{
+    QTest::addColumn<bool>("batch");
+    QTest::newRow("one event per call") << false;
+    QTest::newRow("batched") << true;
+}
+
+void QObjectBenchmark::queued_signal_benchmark()
+{
+    QFETCH(bool, batch);
+    const QString text = QStringLiteral("text");
+
+    Object sender;
+    Object receiver;
+    QObject::connect(&sender, &Object::signalArgs, &receiver, &Object::slotArgs,
+                     Qt::QueuedConnection);
+    QObjectPrivate::get(&receiver)->setBatchQueuedCalls(batch);
+
+    QBENCHMARK {
+        for (int i = 0; i < 1000; ++i)
+            sender.emitSignalArgs(i, text);
+        QCoreApplication::sendPostedEvents(&receiver, QEvent::MetaCall);
+    }
+}
+
 void QObjectBenchmark::qproperty_benchmark_data()
 {
     QTest::addColumn<QByteArray>("name");
@@ -31,6 +31,8 @@ void Object::emitSignal0()
 { emit signal0(); }
 void Object::emitSignal1()
 { emit signal1(); }
+void Object::emitSignalArgs(int number, const QString &text)
+{ emit signalArgs(number, text); }
 
 
 void Object::slot0()
@@ -53,3 +55,5 @@ void Object::slot8()
 { }
 void Object::slot9()
 { }
+void Object::slotArgs(int, const QString &)
+{ }
@@ -29,6 +29,7 @@
 #define OBJECT_H
 
 #include <qobject.h>
+#include <qstring.h>
 
 class Object : public QObject
 {
@@ -36,6 +37,7 @@ class Object : public QObject
 public:
     void emitSignal0();
     void emitSignal1();
+    void emitSignalArgs(int number, const QString &text);
 signals:
     void signal0();
     void signal1();
@@ -47,6 +49,7 @@ signals:
     void signal7();
     void signal8();
     void signal9();
+    void signalArgs(int number, const QString &text);
 public slots:
     void slot0();
     void slot1();
@@ -58,6 +61,7 @@ public slots:
     void slot7();
     void slot8();
     void slot9();
+    void slotArgs(int number, const QString &text);
 };
 
 #endif // OBJECT_H
@@ -1,6 +1,6 @@
 TEMPLATE = app
 CONFIG += benchmark
-QT += widgets testlib
+QT += widgets testlib core-private
 
 TARGET = tst_bench_qobject
 HEADERS += object.h
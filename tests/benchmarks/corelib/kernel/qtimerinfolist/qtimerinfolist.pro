@@ -0,0 +1,6 @@
+TEMPLATE = app
+CONFIG += benchmark
+QT = core-private testlib
+
+TARGET = tst_bench_qtimerinfolist
+SOURCES += tst_qtimerinfolist.cpp
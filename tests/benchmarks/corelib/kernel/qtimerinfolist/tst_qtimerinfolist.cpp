@@ -0,0 +1,127 @@
+/****************************************************************************
+**
+** Copyright (C) 2020 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the test suite of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#include <QtCore/QObject>
+#include <QtCore/private/qtimerinfo_unix_p.h>
+#include <QtTest/QtTest>
+
+// Measures how long the event dispatcher takes to find out how long it can
+// sleep, with many timers registered that are far from expiring, like the
+// idle timeouts of many connections.
+
+class tst_QTimerInfoList : public QObject
+{
+    Q_OBJECT
+private slots:
+    void timerWait_data();
+    void timerWait();
+    void rearm_data();
+    void rearm();
+};
+
+enum Spread {
+    SameInterval,   // all armed at once with the same timeout
+    SpreadInterval  // timeouts spread over a minute
+};
+Q_DECLARE_METATYPE(Spread)
+
+static void addRows()
+{
+    QTest::addColumn<int>("timerCount");
+    QTest::addColumn<Qt::TimerType>("timerType");
+    QTest::addColumn<Spread>("spread");
+
+    for (int count : { 10, 1000, 100000 }) {
+        QTest::addRow("%d-precise-same", count) << count << Qt::PreciseTimer << SameInterval;
+        QTest::addRow("%d-precise-spread", count) << count << Qt::PreciseTimer << SpreadInterval;
+        QTest::addRow("%d-verycoarse-spread", count) << count << Qt::VeryCoarseTimer << SpreadInterval;
+    }
+}
+
+static int intervalFor(int i, Spread spread)
+{
+    return spread == SameInterval ? 30000 : 30000 + (i * 7919) % 60000;
+}
+
+void tst_QTimerInfoList::timerWait_data()
+{
+    addRows();
+}
+
+void tst_QTimerInfoList::timerWait()
+{
+    QFETCH(int, timerCount);
+    QFETCH(Qt::TimerType, timerType);
+    QFETCH(Spread, spread);
+
+    QObject object;
+    QTimerInfoList list;
+    for (int i = 0; i < timerCount; ++i)
+        list.registerTimer(i + 1, intervalFor(i, spread), timerType, &object);
+
+    timespec wait;
+    QBENCHMARK {
+        QVERIFY(list.timerWait(wait));
+    }
+    QVERIFY(wait.tv_sec > 0);
+}
+
+void tst_QTimerInfoList::rearm_data()
+{
+    addRows();
+}
+
+void tst_QTimerInfoList::rearm()
+{
+    QFETCH(int, timerCount);
+    QFETCH(Qt::TimerType, timerType);
+    QFETCH(Spread, spread);
+
+    QObject object;
+    QTimerInfoList list;
+    for (int i = 0; i < timerCount; ++i)
+        list.registerTimer(i + 1, intervalFor(i, spread), timerType, &object);
+
+    // Re-arm the timers in the order they were started, as connections do
+    // when data arrives on them in turn, and go back to sleep. This re-arms
+    // the earliest timer every time.
+    timespec wait;
+    int i = 0;
+    QBENCHMARK {
+        const int id = i % timerCount + 1;
+        list.unregisterTimer(id);
+        list.registerTimer(id, intervalFor(i, spread), timerType, &object);
+        QVERIFY(list.timerWait(wait));
+        ++i;
+    }
+}
+
+QTEST_MAIN(tst_QTimerInfoList)
+
+#include "tst_qtimerinfolist.moc"
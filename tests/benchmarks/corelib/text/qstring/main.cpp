@@ -49,6 +49,22 @@ private slots:
     void toCaseFolded_data();
     void toCaseFolded();
 
+    void fromUtf8_data();
+    void fromUtf8();
+    void toUtf8_data() { fromUtf8_data(); }
+    void toUtf8();
+
+    void indexOf_data();
+    void indexOf();
+    void compareCaseInsensitive_data();
+    void compareCaseInsensitive();
+    void compareCaseInsensitiveLatin1_data() { compareCaseInsensitive_data(); }
+    void compareCaseInsensitiveLatin1();
+    void fromLatin1_data();
+    void fromLatin1();
+    void toLatin1_data() { fromLatin1_data(); }
+    void toLatin1();
+
 private:
     void section_data_impl(bool includeRegExOnly = true);
     template <typename RX> void section_impl();
@@ -149,6 +165,9 @@ void tst_QString::toUpper_data()
     QTest::newRow("300A+150<10428>") << (upperLatin1 + lowerDeseret);
 
     QTest::newRow("600<FB03> (ligature)") << lowerLigature;
+
+    const QString sentence = QStringLiteral("The Quick Brown Fox Jumps Over The Lazy Dog. ");
+    QTest::newRow("600 mixed-case text") << sentence.repeated(600 / sentence.size() + 1).left(600);
 }
 
 void tst_QString::toUpper()
@@ -188,6 +207,144 @@ void tst_QString::toCaseFolded()
     }
 }
 
+void tst_QString::fromUtf8_data()
+{
+    QTest::addColumn<QByteArray>("utf8");
+
+    // Runs of text in different scripts, as found in multilingual JSON or
+    // XML payloads, repeated to about 4 kB
+    auto addRow = [](const char *name, const char *text) {
+        const QByteArray sample(text);
+        QTest::newRow(name) << sample.repeated(4096 / sample.size() + 1);
+    };
+    addRow("ascii", u8"{\"name\": \"Hello World\", \"id\": 12345, \"tags\": [\"a\", \"b\"]} ");
+    addRow("french", u8"Le c\u0153ur a ses raisons que la raison ne conna\u00eet point. Fa\u00e7ade, na\u00efve, \u00e0 bient\u00f4t. ");
+    addRow("greek", u8"\u039a\u03b1\u03bb\u03b7\u03bc\u03ad\u03c1\u03b1 \u03ba\u03cc\u03c3\u03bc\u03b5, "
+                    u8"\u03c4\u03b9 \u03ba\u03ac\u03bd\u03b5\u03b9\u03c2; ");
+    addRow("cyrillic", u8"\u041f\u0440\u0438\u0432\u0435\u0442, \u043c\u0438\u0440! "
+                       u8"\u041a\u0430\u043a \u0434\u0435\u043b\u0430? ");
+    addRow("arabic", u8"\u0645\u0631\u062d\u0628\u0627 \u0628\u0627\u0644\u0639\u0627\u0644\u0645 "
+                     u8"\u0643\u064a\u0641 \u062d\u0627\u0644\u0643\u061f ");
+    addRow("cjk", u8"\u4f60\u597d\uff0c\u4e16\u754c\u3002\u3053\u3093\u306b\u3061\u306f\u4e16\u754c"
+                  u8"\uc548\ub155\ud558\uc138\uc694\u3002");
+    addRow("mixed", u8"{\"en\": \"Hello\", \"ru\": \"\u041f\u0440\u0438\u0432\u0435\u0442\", "
+                    u8"\"el\": \"\u0393\u03b5\u03b9\u03ac\", \"zh\": \"\u4f60\u597d\", "
+                    u8"\"ja\": \"\u3053\u3093\u306b\u3061\u306f\", \"ar\": \"\u0645\u0631\u062d\u0628\u0627\"} ");
+    addRow("emoji", u8"Nice \U0001F600 work \U0001F44D see you \U0001F44B ");
+}
+
+void tst_QString::fromUtf8()
+{
+    QFETCH(QByteArray, utf8);
+
+    QBENCHMARK {
+        QString s = QString::fromUtf8(utf8);
+        Q_UNUSED(s);
+    }
+}
+
+void tst_QString::toUtf8()
+{
+    QFETCH(QByteArray, utf8);
+    const QString s = QString::fromUtf8(utf8);
+
+    QBENCHMARK {
+        QByteArray ba = s.toUtf8();
+        Q_UNUSED(ba);
+    }
+}
+
+void tst_QString::indexOf_data()
+{
+    QTest::addColumn<QString>("s");
+    QTest::addColumn<QChar>("c");
+
+    const QString text = QString(4095, QLatin1Char('a')) + QLatin1Char('z');
+    QTest::newRow("short") << QStringLiteral("Hello, World") << QChar('W');
+    QTest::newRow("4096-found-at-end") << text << QChar('z');
+    QTest::newRow("4096-not-found") << text << QChar('y');
+    QTest::newRow("4096-non-latin1") << QString(4096, QChar(0x4f60)) << QChar(0x597d);
+}
+
+void tst_QString::indexOf()
+{
+    QFETCH(QString, s);
+    QFETCH(QChar, c);
+
+    QBENCHMARK {
+        int idx = s.indexOf(c);
+        Q_UNUSED(idx);
+    }
+}
+
+void tst_QString::compareCaseInsensitive_data()
+{
+    QTest::addColumn<QString>("lhs");
+    QTest::addColumn<QString>("rhs");
+
+    const QString sentence = QStringLiteral("The Quick Brown Fox Jumps Over The Lazy Dog. ");
+    const QString text = sentence.repeated(4096 / sentence.size() + 1);
+    QTest::newRow("short") << QStringLiteral("Content-Type") << QStringLiteral("content-type");
+    QTest::newRow("4096-equal") << text << text;
+    QTest::newRow("4096-differing-case") << text << text.toUpper();
+    QTest::newRow("4096-differ-at-end") << text << text.left(text.size() - 1).toLower() + QLatin1Char('!');
+    const QString latin1 = QString::fromLatin1("Fa\xe7" "ade, na\xefve, \xe0 bient\xf4t. ").repeated(100);
+    QTest::newRow("latin1-differing-case") << latin1 << latin1.toUpper();
+}
+
+void tst_QString::compareCaseInsensitive()
+{
+    QFETCH(QString, lhs);
+    QFETCH(QString, rhs);
+
+    QBENCHMARK {
+        int result = lhs.compare(rhs, Qt::CaseInsensitive);
+        Q_UNUSED(result);
+    }
+}
+
+void tst_QString::compareCaseInsensitiveLatin1()
+{
+    QFETCH(QString, lhs);
+    QFETCH(QString, rhs);
+    const QByteArray latin1 = rhs.toLatin1();
+
+    QBENCHMARK {
+        int result = lhs.compare(QLatin1String(latin1), Qt::CaseInsensitive);
+        Q_UNUSED(result);
+    }
+}
+
+void tst_QString::fromLatin1_data()
+{
+    QTest::addColumn<QByteArray>("latin1");
+
+    QTest::newRow("short") << QByteArray("Hello, World");
+    QTest::newRow("4096-ascii") << QByteArray(4096, 'a');
+    QTest::newRow("4096-latin1") << QByteArray("Fa\xe7" "ade, na\xefve, \xe0 bient\xf4t. ").repeated(128);
+}
+
+void tst_QString::fromLatin1()
+{
+    QFETCH(QByteArray, latin1);
+
+    QBENCHMARK {
+        QString s = QString::fromLatin1(latin1);
+        Q_UNUSED(s);
+    }
+}
+
+void tst_QString::toLatin1()
+{
+    QFETCH(QByteArray, latin1);
+    const QString s = QString::fromLatin1(latin1);
+
+    QBENCHMARK {
+        QByteArray ba = s.toLatin1();
+        Q_UNUSED(ba);
+    }
+}
+
 QTEST_APPLESS_MAIN(tst_QString)
 
 #include "main.moc"
@@ -40,6 +40,8 @@ public:
 private slots:
     void startRunnables();
     void activeThreadCount();
+    void throughput_data();
+    void throughput();
 };
 
 tst_QThreadPool::tst_QThreadPool()
@@ -75,5 +77,68 @@ void tst_QThreadPool::activeThreadCount()
     }
 }
 
+class CountingRunnable : public QRunnable
+{
+public:
+    CountingRunnable(QAtomicInt *count) : count(count) { }
+    void run() override {
+        count->ref();
+    }
+
+private:
+    QAtomicInt *count;
+};
+
+// starts its share of the tasks from a pool thread
+class SpawningRunnable : public QRunnable
+{
+public:
+    SpawningRunnable(QThreadPool *pool, QAtomicInt *count, int tasks)
+        : pool(pool), count(count), tasks(tasks) { }
+    void run() override {
+        for (int i = 0; i < tasks; ++i)
+            pool->start(new CountingRunnable(count));
+    }
+
+private:
+    QThreadPool *pool;
+    QAtomicInt *count;
+    int tasks;
+};
+
+void tst_QThreadPool::throughput_data()
+{
+    QTest::addColumn<int>("threadCount");
+    QTest::addColumn<bool>("fromPoolThreads");
+    for (int threadCount : {1, 2, 4, 8}) {
+        const QByteArray threads = QByteArray::number(threadCount) + " threads";
+        QTest::newRow(threads + ", started outside") << threadCount << false;
+        QTest::newRow(threads + ", started by pool threads") << threadCount << true;
+    }
+}
+
+void tst_QThreadPool::throughput()
+{
+    QFETCH(int, threadCount);
+    QFETCH(bool, fromPoolThreads);
+    const int taskCount = 20000;
+
+    QThreadPool threadPool;
+    threadPool.setMaxThreadCount(threadCount);
+    QAtomicInt count;
+    QBENCHMARK {
+        count.storeRelaxed(0);
+        if (fromPoolThreads) {
+            for (int i = 0; i < threadCount; ++i)
+                threadPool.start(new SpawningRunnable(&threadPool, &count, taskCount / threadCount));
+        } else {
+            for (int i = 0; i < taskCount; ++i)
+                threadPool.start(new CountingRunnable(&count));
+        }
+        threadPool.waitForDone();
+    }
+    QCOMPARE(count.loadRelaxed(), taskCount / threadCount * threadCount);
+}
+
 QTEST_MAIN(tst_QThreadPool)
 #include "tst_qthreadpool.moc"
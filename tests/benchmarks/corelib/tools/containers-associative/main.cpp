@@ -26,12 +26,20 @@
 **
 ****************************************************************************/
 #include <QString>
+#include <QFlatHash>
+#include <QRandomGenerator>
 
 #include <qtest.h>
 
 class tst_associative_containers : public QObject
 {
     Q_OBJECT
+public:
+    enum Container { Hash, FlatHash, Map };
+    Q_ENUM(Container)
+    enum KeyOrder { Consecutive, Random, Strided };
+    Q_ENUM(KeyOrder)
+
 private slots:
     void insert_data();
     void insert();
@@ -39,43 +47,95 @@ private slots:
     void lookup();
 };
 
+// The keys are 0 .. size - 1, in a random order for Random, or multiplied
+// by 256 for Strided. Consecutive integers are the best case for QHash, as
+// both its hash function and its node allocations then follow the order of
+// the keys. Strided keys share their low bits, like aligned addresses do.
+static QVector<int> makeKeys(int size, tst_associative_containers::KeyOrder order)
+{
+    QVector<int> keys;
+    keys.reserve(size);
+    for (int i = 0; i < size; ++i)
+        keys.append(order == tst_associative_containers::Strided ? i * 256 : i);
+    if (order == tst_associative_containers::Random) {
+        QRandomGenerator generator(size);
+        for (int i = size - 1; i > 0; --i)
+            qSwap(keys[i], keys[generator.bounded(i + 1)]);
+        for (int &key : keys)
+            key = int(uint(key) * 2654435761u); // spread over the whole int range
+    }
+    return keys;
+}
+
 template <typename T>
-void testInsert(int size)
+void testInsert(const QVector<int> &keys)
 {
     T container;
 
     QBENCHMARK {
-        for (int i = 0; i < size; ++i)
-            container.insert(i, i);
+        for (int key : keys)
+            container.insert(key, key);
     }
 }
 
-void tst_associative_containers::insert_data()
+static void addContainerRows()
 {
-    QTest::addColumn<bool>("useHash");
+    QTest::addColumn<tst_associative_containers::Container>("container");
     QTest::addColumn<int>("size");
+    QTest::addColumn<tst_associative_containers::KeyOrder>("order");
+
+    QVector<int> sizes;
+    for (int size = 10; size < 20000; size += 100)
+        sizes << size;
+    sizes << 100000 << 1000000 << 4000000;
 
-    for (int size = 10; size < 20000; size += 100) {
+    for (int size : qAsConst(sizes)) {
 
         const QByteArray sizeString = QByteArray::number(size);
 
-        QTest::newRow(QByteArray("hash--" + sizeString).constData()) << true << size;
-        QTest::newRow(QByteArray("map--" + sizeString).constData()) << false << size;
+        QTest::newRow(QByteArray("hash--" + sizeString).constData())
+                << tst_associative_containers::Hash << size << tst_associative_containers::Consecutive;
+        QTest::newRow(QByteArray("flathash--" + sizeString).constData())
+                << tst_associative_containers::FlatHash << size << tst_associative_containers::Consecutive;
+        if (size < 1000000)
+            QTest::newRow(QByteArray("map--" + sizeString).constData())
+                    << tst_associative_containers::Map << size << tst_associative_containers::Consecutive;
+        if (size >= 100000) {
+            QTest::newRow(QByteArray("hash-random--" + sizeString).constData())
+                    << tst_associative_containers::Hash << size << tst_associative_containers::Random;
+            QTest::newRow(QByteArray("flathash-random--" + sizeString).constData())
+                    << tst_associative_containers::FlatHash << size << tst_associative_containers::Random;
+            QTest::newRow(QByteArray("hash-strided--" + sizeString).constData())
+                    << tst_associative_containers::Hash << size << tst_associative_containers::Strided;
+            QTest::newRow(QByteArray("flathash-strided--" + sizeString).constData())
+                    << tst_associative_containers::FlatHash << size << tst_associative_containers::Strided;
+        }
     }
 }
 
+void tst_associative_containers::insert_data()
+{
+    addContainerRows();
+}
+
 void tst_associative_containers::insert()
 {
-    QFETCH(bool, useHash);
+    QFETCH(Container, container);
     QFETCH(int, size);
-
-    QHash<int, int> testHash;
-    QMap<int, int> testMap;
-
-    if (useHash) {
-        testInsert<QHash<int, int> >(size);
-    } else {
-        testInsert<QMap<int, int> >(size);
+    QFETCH(KeyOrder, order);
+
+    const QVector<int> keys = makeKeys(size, order);
+
+    switch (container) {
+    case Hash:
+        testInsert<QHash<int, int> >(keys);
+        break;
+    case FlatHash:
+        testInsert<QFlatHash<int, int> >(keys);
+        break;
+    case Map:
+        testInsert<QMap<int, int> >(keys);
+        break;
     }
 }
 
@@ -84,44 +144,45 @@ void tst_associative_containers::lookup_data()
 //    setReportType(LineChartReport);
 //    setChartTitle("Time to call value(), with an increasing number of items in the container");
 
-    QTest::addColumn<bool>("useHash");
-    QTest::addColumn<int>("size");
-
-    for (int size = 10; size < 20000; size += 100) {
-
-        const QByteArray sizeString = QByteArray::number(size);
-
-        QTest::newRow(QByteArray("hash--" + sizeString).constData()) << true << size;
-        QTest::newRow(QByteArray("map--" + sizeString).constData()) << false << size;
-    }
+    addContainerRows();
 }
 
 template <typename T>
-void testLookup(int size)
+void testLookup(const QVector<int> &keys)
 {
     T container;
 
-    for (int i = 0; i < size; ++i)
-        container.insert(i, i);
+    for (int key : keys)
+        container.insert(key, 1);
 
-    int val;
+    qint64 sum = 0;
 
     QBENCHMARK {
-        for (int i = 0; i < size; ++i)
-            val = container.value(i);
+        for (int key : keys)
+            sum += container.value(key);
 
     }
+    QVERIFY(sum >= 0);
 }
 
 void tst_associative_containers::lookup()
 {
-    QFETCH(bool, useHash);
+    QFETCH(Container, container);
     QFETCH(int, size);
-
-    if (useHash) {
-        testLookup<QHash<int, int> >(size);
-    } else {
-        testLookup<QMap<int, int> >(size);
+    QFETCH(KeyOrder, order);
+
+    const QVector<int> keys = makeKeys(size, order);
+
+    switch (container) {
+    case Hash:
+        testLookup<QHash<int, int> >(keys);
+        break;
+    case FlatHash:
+        testLookup<QFlatHash<int, int> >(keys);
+        break;
+    case Map:
+        testLookup<QMap<int, int> >(keys);
+        break;
     }
 }
 
@@ -26,17 +26,25 @@
 **
 ****************************************************************************/
 
+#include <QBTreeMap>
 #include <QFile>
 #include <QMap>
+#include <QRandomGenerator>
 #include <QString>
 #include <QTest>
 #include <qdebug.h>
 
+#include <algorithm>
+#include <map>
+
 
 class tst_QMap : public QObject
 {
     Q_OBJECT
 
+public:
+    enum Container { Map, BTreeMap, StdMap };
+
 private slots:
     void insertion_int_int();
     void insertion_int_string();
@@ -61,6 +69,20 @@ private slots:
     void insertion_string_int2_hint();
 
     void insertMap();
+
+    void compareInsertion_data() { compareData(); }
+    void compareInsertion();
+    void compareLookup_data() { compareData(); }
+    void compareLookup();
+    void compareIteration_data() { compareData(); }
+    void compareIteration();
+    void compareRangeScan_data() { compareData(); }
+    void compareRangeScan();
+    void compareBulkLoad_data() { compareData(); }
+    void compareBulkLoad();
+
+private:
+    static void compareData();
 };
 
 
@@ -284,6 +306,259 @@ void tst_QMap::insertMap()
     }
 }
 
+Q_DECLARE_METATYPE(tst_QMap::Container)
+
+void tst_QMap::compareData()
+{
+    QTest::addColumn<Container>("container");
+    QTest::addColumn<int>("size");
+
+    static const struct { Container container; const char *name; } containers[] = {
+        { Map, "QMap" }, { BTreeMap, "QBTreeMap" }, { StdMap, "std::map" }
+    };
+    for (int size : { 1000, 100000, 1000000 }) {
+        for (const auto &c : containers)
+            QTest::addRow("%s:%d", c.name, size) << c.container << size;
+    }
+}
+
+static QVector<int> randomKeys(int size)
+{
+    QVector<int> keys(size);
+    QRandomGenerator generator(size);
+    for (int &key : keys)
+        key = int(generator.bounded(0x7fffffff));
+    return keys;
+}
+
+static QVector<std::pair<int, int>> sortedItems(int size)
+{
+    QVector<std::pair<int, int>> items;
+    items.reserve(size);
+    for (int i = 0; i < size; ++i)
+        items.append(std::make_pair(i * 2, i));
+    return items;
+}
+
+template <typename M>
+static void insertKeys(M &map, const QVector<int> &keys)
+{
+    for (int key : keys)
+        map.insert(key, key);
+}
+
+static void insertKeys(std::map<int, int> &map, const QVector<int> &keys)
+{
+    for (int key : keys)
+        map.insert(std::make_pair(key, key));
+}
+
+template <typename M>
+static int lookupKeys(const M &map, const QVector<int> &keys)
+{
+    int sum = 0;
+    for (int key : keys)
+        sum += map.value(key);
+    return sum;
+}
+
+static int lookupKeys(const std::map<int, int> &map, const QVector<int> &keys)
+{
+    int sum = 0;
+    for (int key : keys) {
+        auto it = map.find(key);
+        if (it != map.end())
+            sum += it->second;
+    }
+    return sum;
+}
+
+template <typename M>
+static int iterate(const M &map)
+{
+    int sum = 0;
+    for (auto it = map.begin(), end = map.end(); it != end; ++it)
+        sum += *it;
+    return sum;
+}
+
+static int iterate(const std::map<int, int> &map)
+{
+    int sum = 0;
+    for (const auto &item : map)
+        sum += item.second;
+    return sum;
+}
+
+// Sums the values of 100 consecutive items, starting at each of the keys
+template <typename M>
+static int rangeScan(const M &map, const QVector<int> &keys)
+{
+    int sum = 0;
+    for (int key : keys) {
+        auto it = map.lowerBound(key);
+        const auto end = map.end();
+        for (int n = 0; n < 100 && it != end; ++n, ++it)
+            sum += *it;
+    }
+    return sum;
+}
+
+static int rangeScan(const std::map<int, int> &map, const QVector<int> &keys)
+{
+    int sum = 0;
+    for (int key : keys) {
+        auto it = map.lower_bound(key);
+        const auto end = map.end();
+        for (int n = 0; n < 100 && it != end; ++n, ++it)
+            sum += it->second;
+    }
+    return sum;
+}
+
+void tst_QMap::compareInsertion()
+{
+    QFETCH(Container, container);
+    QFETCH(int, size);
+
+    const QVector<int> keys = randomKeys(size);
+    switch (container) {
+    case Map:
+        QBENCHMARK { QMap<int, int> map; insertKeys(map, keys); }
+        break;
+    case BTreeMap:
+        QBENCHMARK { QBTreeMap<int, int> map; insertKeys(map, keys); }
+        break;
+    case StdMap:
+        QBENCHMARK { std::map<int, int> map; insertKeys(map, keys); }
+        break;
+    }
+}
+
+void tst_QMap::compareLookup()
+{
+    QFETCH(Container, container);
+    QFETCH(int, size);
+
+    const QVector<int> keys = randomKeys(size);
+    QVector<int> lookups = keys;
+    std::shuffle(lookups.begin(), lookups.end(), QRandomGenerator(size + 1));
+    qint64 sum = 0;
+    switch (container) {
+    case Map: {
+        QMap<int, int> map;
+        insertKeys(map, keys);
+        QBENCHMARK { sum += lookupKeys(map, lookups); }
+        break;
+    }
+    case BTreeMap: {
+        QBTreeMap<int, int> map;
+        insertKeys(map, keys);
+        QBENCHMARK { sum += lookupKeys(map, lookups); }
+        break;
+    }
+    case StdMap: {
+        std::map<int, int> map;
+        insertKeys(map, keys);
+        QBENCHMARK { sum += lookupKeys(map, lookups); }
+        break;
+    }
+    }
+    QVERIFY(sum != 0);
+}
+
+void tst_QMap::compareIteration()
+{
+    QFETCH(Container, container);
+    QFETCH(int, size);
+
+    const QVector<int> keys = randomKeys(size);
+    qint64 sum = 0;
+    switch (container) {
+    case Map: {
+        QMap<int, int> map;
+        insertKeys(map, keys);
+        QBENCHMARK { sum += iterate(map); }
+        break;
+    }
+    case BTreeMap: {
+        QBTreeMap<int, int> map;
+        insertKeys(map, keys);
+        QBENCHMARK { sum += iterate(qAsConst(map)); }
+        break;
+    }
+    case StdMap: {
+        std::map<int, int> map;
+        insertKeys(map, keys);
+        QBENCHMARK { sum += iterate(map); }
+        break;
+    }
+    }
+    QVERIFY(sum != 0);
+}
+
+void tst_QMap::compareRangeScan()
+{
+    QFETCH(Container, container);
+    QFETCH(int, size);
+
+    const QVector<int> keys = randomKeys(size);
+    const QVector<int> starts = randomKeys(1000);
+    qint64 sum = 0;
+    switch (container) {
+    case Map: {
+        QMap<int, int> map;
+        insertKeys(map, keys);
+        QBENCHMARK { sum += rangeScan(map, starts); }
+        break;
+    }
+    case BTreeMap: {
+        QBTreeMap<int, int> map;
+        insertKeys(map, keys);
+        QBENCHMARK { sum += rangeScan(qAsConst(map), starts); }
+        break;
+    }
+    case StdMap: {
+        std::map<int, int> map;
+        insertKeys(map, keys);
+        QBENCHMARK { sum += rangeScan(map, starts); }
+        break;
+    }
+    }
+    QVERIFY(sum != 0);
+}
+
+void tst_QMap::compareBulkLoad()
+{
+    QFETCH(Container, container);
+    QFETCH(int, size);
+
+    const QVector<std::pair<int, int>> items = sortedItems(size);
+    switch (container) {
+    case Map:
+        // QMap has no bulk load; inserting at the end with a hint is the
+        // fastest way to fill it from sorted data
+        QBENCHMARK {
+            QMap<int, int> map;
+            for (const auto &item : items)
+                map.insert(map.constEnd(), item.first, item.second);
+        }
+        break;
+    case BTreeMap:
+        QBENCHMARK {
+            QBTreeMap<int, int> map = QBTreeMap<int, int>::fromSortedRange(items.cbegin(), items.cend());
+            Q_UNUSED(map);
+        }
+        break;
+    case StdMap:
+        QBENCHMARK {
+            std::map<int, int> map(items.cbegin(), items.cend());
+            Q_UNUSED(map);
+        }
+        break;
+    }
+}
+
 QTEST_MAIN(tst_QMap)
 
 #include "main.moc"
@@ -2,6 +2,7 @@ TEMPLATE = subdirs
 SUBDIRS = \
         drawtexture \
         qcolor \
+        qfbscreen \
         qpainter \
         qregion \
         qtransform \
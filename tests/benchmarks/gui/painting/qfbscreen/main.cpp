@@ -0,0 +1,199 @@
+/****************************************************************************
+**
+** Copyright (C) 2020 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the test suite of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+// This file contains benchmarks for the QFbScreen compositor.
+
+#include <QtTest/QtTest>
+#include <QtGui/QWindow>
+#include <QtGui/private/qwindow_p.h>
+#include <qpa/qwindowsysteminterface.h>
+#include <QtFbSupport/private/qfbscreen_p.h>
+#include <QtFbSupport/private/qfbwindow_p.h>
+#include <QtFbSupport/private/qfbbackingstore_p.h>
+
+typedef QVector<QRect> RectList;
+
+class TestScreen : public QFbScreen
+{
+public:
+    TestScreen(const QRect &geometry, QImage::Format format)
+    {
+        mGeometry = geometry;
+        mFormat = format;
+        mDepth = QImage::toPixelFormat(format).bitsPerPixel();
+        mScreenImage = QImage(geometry.size(), format);
+    }
+
+    void pushWindow(QFbWindow *window) { mWindowStack.prepend(window); }
+    void clearWindows() { mWindowStack.clear(); }
+
+    QRegion redraw(const QRegion &region)
+    {
+        mRepaintRegion = region;
+        return doRedraw();
+    }
+
+    // Outputs a frame the way update requests do, which records its statistics
+    FrameStatistics update(const QRegion &region)
+    {
+        mRepaintRegion = region;
+        resetFrameStatistics();
+        QEvent request(QEvent::UpdateRequest);
+        QCoreApplication::sendEvent(this, &request);
+        return frameStatistics();
+    }
+};
+
+class tst_QFbScreen : public QObject
+{
+    Q_OBJECT
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void cleanup();
+
+    void redraw_data();
+    void redraw();
+    void bytesTouched_data();
+    void bytesTouched();
+
+private:
+    void setupWindows(const RectList &windows);
+    void addScenarios();
+
+    TestScreen *m_screen = nullptr;
+    QList<QWindow *> m_windows;
+    QList<QFbWindow *> m_fbWindows;
+    QList<QFbBackingStore *> m_backingStores;
+};
+
+void tst_QFbScreen::initTestCase()
+{
+    m_screen = new TestScreen(QRect(0, 0, 1404, 1872), QImage::Format_RGB16);
+    QWindowSystemInterface::handleScreenAdded(m_screen);
+}
+
+void tst_QFbScreen::cleanupTestCase()
+{
+    QWindowSystemInterface::handleScreenRemoved(m_screen);
+    m_screen = nullptr;
+}
+
+void tst_QFbScreen::cleanup()
+{
+    m_screen->clearWindows();
+    qDeleteAll(m_backingStores);
+    m_backingStores.clear();
+    qDeleteAll(m_fbWindows);
+    m_fbWindows.clear();
+    qDeleteAll(m_windows);
+    m_windows.clear();
+}
+
+// Windows are given bottom to top
+void tst_QFbScreen::setupWindows(const RectList &windows)
+{
+    for (const QRect &rect : windows) {
+        QWindow *window = new QWindow;
+        window->setScreen(m_screen->screen());
+        window->setGeometry(rect);
+        // The window is never created, so mark it visible by hand for the compositor
+        qt_window_private(window)->visible = true;
+
+        QFbWindow *fbWindow = new QFbWindow(window);
+        QFbBackingStore *backingStore = new QFbBackingStore(window);
+        fbWindow->setBackingStore(backingStore);
+        backingStore->resize(rect.size(), QRegion());
+        static_cast<QImage *>(backingStore->paintDevice())->fill(Qt::gray);
+
+        m_screen->pushWindow(fbWindow);
+        m_windows << window;
+        m_fbWindows << fbWindow;
+        m_backingStores << backingStore;
+    }
+}
+
+void tst_QFbScreen::addScenarios()
+{
+    QTest::addColumn<RectList>("windows");
+    QTest::addColumn<QRegion>("dirty");
+
+    const QRect screen(0, 0, 1404, 1872);
+    const QRect dialog(302, 636, 800, 600);
+    const QRect strip(0, 900, 1404, 64);
+
+    QTest::newRow("no windows") << RectList() << QRegion(screen);
+    QTest::newRow("fullscreen") << (RectList() << screen) << QRegion(screen);
+    QTest::newRow("fullscreen, partial damage") << (RectList() << screen) << QRegion(strip);
+    QTest::newRow("fullscreen + dialog") << (RectList() << screen << dialog) << QRegion(screen);
+    QTest::newRow("fullscreen + dialog, dialog damage") << (RectList() << screen << dialog) << QRegion(dialog);
+    QTest::newRow("fullscreen + 2 dialogs")
+        << (RectList() << screen << dialog << dialog.translated(100, 100))
+        << QRegion(screen);
+    QTest::newRow("3 stacked fullscreen") << (RectList() << screen << screen << screen) << QRegion(screen);
+}
+
+void tst_QFbScreen::redraw_data()
+{
+    addScenarios();
+}
+
+void tst_QFbScreen::redraw()
+{
+    QFETCH(RectList, windows);
+    QFETCH(QRegion, dirty);
+
+    setupWindows(windows);
+
+    QBENCHMARK {
+        m_screen->redraw(dirty);
+    }
+}
+
+void tst_QFbScreen::bytesTouched_data()
+{
+    addScenarios();
+}
+
+// Reports the number of bytes of the screen image written per frame, as
+// counted by the compositor. This is the area of the dirty region when
+// every pixel is composited only once.
+void tst_QFbScreen::bytesTouched()
+{
+    QFETCH(RectList, windows);
+    QFETCH(QRegion, dirty);
+
+    setupWindows(windows);
+
+    const QFbScreen::FrameStatistics statistics = m_screen->update(dirty);
+    QCOMPARE(statistics.frameCount, quint64(1));
+    QTest::setBenchmarkResult(statistics.lastComposedArea * m_screen->depth() / 8, QTest::Events);
+}
+
+QTEST_MAIN(tst_QFbScreen)
+
+#include "main.moc"
@@ -0,0 +1,6 @@
+TEMPLATE = app
+TARGET = tst_bench_qfbscreen
+QT += testlib gui-private fb_support-private
+CONFIG += release
+
+SOURCES += main.cpp